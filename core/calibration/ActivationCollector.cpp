@@ -0,0 +1,158 @@
+#include <fstream>
+#include <unordered_map>
+
+#include "ATen/Parallel.h"
+#include "core/calibration/ActivationCollector.h"
+#include "core/calibration/CalibrationTable.h"
+#include "core/lowering/lowering.h"
+#include "core/util/prelude.h"
+
+namespace trtorch {
+namespace core {
+namespace calibration {
+namespace {
+
+bool is_tensor(const torch::jit::Value* v) {
+  return v->type()->isSubtypeOf(c10::TensorType::get());
+}
+
+} // namespace
+
+ActivationCollector::ActivationCollector(
+    std::shared_ptr<torch::jit::Graph> g,
+    std::vector<torch::jit::IValue> params,
+    std::vector<conversion::InputRange> input_ranges,
+    CollectorSettings settings)
+    : settings_(std::move(settings)) {
+  // The key is taken before the graph is instrumented so it matches the one
+  // of the engine built from g
+  auto named_params = conversion::get_named_params(g->inputs(), params);
+  key_ = conversion::CalibrationCacheKey(g->block(), input_ranges, named_params);
+  key_.algorithm = AlgorithmName(settings_.algorithm);
+  instrumented_ = g->copy();
+  num_graph_outputs_ = instrumented_->outputs().size();
+
+  // Names follow conversion: non param tensor inputs become input_<i>, graph
+  // outputs are renamed output_<i> and every other tensor keeps the debug name
+  // of its value
+  std::vector<torch::jit::Value*> recorded;
+  std::unordered_map<torch::jit::Value*, std::string> names;
+  auto record = [&](torch::jit::Value* v, std::string name) {
+    if (names.find(v) == names.end()) {
+      recorded.push_back(v);
+    }
+    names[v] = std::move(name);
+  };
+
+  for (size_t i = 0; i < g->inputs().size(); i++) {
+    auto param = named_params.find(g->inputs()[i]);
+    if (param != named_params.end()) {
+      arguments_.push_back(param->second.toTensor().to(at::kCPU));
+    } else {
+      arguments_.emplace_back();
+      if (is_tensor(instrumented_->inputs()[i])) {
+        record(instrumented_->inputs()[i], "input_" + std::to_string(input_slots_.size()));
+        input_slots_.push_back(i);
+      }
+    }
+  }
+  TRTORCH_CHECK(
+      input_slots_.size() == input_ranges.size(),
+      "Expected input ranges for all input tensors, but found " << input_slots_.size() << " input tensors and "
+                                                                << input_ranges.size() << " input ranges");
+
+  for (auto n : instrumented_->nodes()) {
+    for (auto out : n->outputs()) {
+      if (is_tensor(out)) {
+        record(out, out->debugName());
+      }
+    }
+  }
+  for (size_t i = 0; i < num_graph_outputs_; i++) {
+    record(instrumented_->outputs()[i], "output_" + std::to_string(i));
+  }
+
+  for (auto v : recorded) {
+    instrumented_->registerOutput(v);
+    names_.push_back(names[v]);
+    histograms_.emplace_back(settings_.num_bins);
+  }
+  LOG_DEBUG("Collecting activation statistics for " << names_.size() << " tensors of " << *g);
+  code_ = std::make_shared<torch::jit::Code>(instrumented_, "calibration");
+}
+
+void ActivationCollector::Collect(std::vector<at::Tensor> inputs) {
+  TRTORCH_CHECK(
+      inputs.size() == input_slots_.size(),
+      "Expected " << input_slots_.size() << " inputs for calibration, got " << inputs.size());
+  torch::jit::Stack stack(arguments_);
+  for (size_t i = 0; i < inputs.size(); i++) {
+    stack[input_slots_[i]] = inputs[i].to(at::kCPU);
+  }
+  torch::jit::InterpreterState(*code_).run(stack);
+  TRTORCH_CHECK(
+      stack.size() == num_graph_outputs_ + names_.size(),
+      "Expected " << num_graph_outputs_ + names_.size() << " outputs from the instrumented graph, got "
+                  << stack.size());
+
+  // Every tensor has its own histogram, so tensors are spread over the
+  // intra-op thread pool
+  at::parallel_for(0, names_.size(), 1, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      auto& out = stack[num_graph_outputs_ + i];
+      if (!out.isTensor() || !out.toTensor().is_floating_point()) {
+        continue;
+      }
+      auto t = out.toTensor().to(at::kFloat).contiguous();
+      histograms_[i].Add(t.data_ptr<float>(), t.numel());
+    }
+  });
+  num_batches_++;
+}
+
+std::vector<std::pair<std::string, float>> ActivationCollector::Amax() const {
+  std::vector<float> amax(histograms_.size(), 0);
+  at::parallel_for(0, histograms_.size(), 1, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      amax[i] = ComputeAmax(histograms_[i], settings_.method, settings_.percentile);
+    }
+  });
+
+  std::vector<std::pair<std::string, float>> ranges;
+  for (size_t i = 0; i < names_.size(); i++) {
+    // Tensors which never held floating point data have no range
+    if (histograms_[i].total() > 0) {
+      ranges.emplace_back(names_[i], amax[i]);
+    }
+  }
+  return ranges;
+}
+
+std::string ActivationCollector::Cache() const {
+  TRTORCH_CHECK(num_batches_ > 0, "No calibration batches have been collected");
+  auto table = WriteCalibrationTable(TableVersion(), TableAlgorithmName(settings_.algorithm), Amax());
+  return util::calibration::WrapCache(key_, table.data(), table.size());
+}
+
+void ActivationCollector::WriteCache(const std::string& path) const {
+  auto contents = Cache();
+  std::ofstream cache_file(path, std::ios::binary);
+  TRTORCH_CHECK(cache_file.good(), "Unable to open " << path << " to write the calibration cache");
+  cache_file.write(contents.data(), contents.size());
+  LOG_INFO(
+      "Wrote calibration cache for " << names_.size() << " tensors over " << num_batches_ << " batches to " << path);
+}
+
+ActivationCollector MakeActivationCollector(
+    const torch::jit::script::Module& mod,
+    std::string method_name,
+    std::vector<conversion::InputRange> input_ranges,
+    CollectorSettings settings) {
+  auto graph_and_parameters = lowering::Lower(mod, method_name);
+  return ActivationCollector(
+      graph_and_parameters.first, graph_and_parameters.second, std::move(input_ranges), std::move(settings));
+}
+
+} // namespace calibration
+} // namespace core
+} // namespace trtorch
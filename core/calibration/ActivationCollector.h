@@ -0,0 +1,86 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "NvInfer.h"
+#include "core/calibration/Histogram.h"
+#include "core/conversion/conversion.h"
+#include "core/util/calibration_cache.h"
+#include "torch/csrc/jit/api/module.h"
+#include "torch/csrc/jit/ir/ir.h"
+#include "torch/csrc/jit/runtime/interpreter.h"
+
+namespace trtorch {
+namespace core {
+namespace calibration {
+
+struct CollectorSettings {
+  ScaleMethod method = ScaleMethod::kEntropy;
+  // Only used by ScaleMethod::kPercentile
+  double percentile = 99.99;
+  size_t num_bins = 2048;
+  // Algorithm of the calibrator which will read the cache. It only sets the
+  // name recorded in the cache, scales are always computed with method
+  nvinfer1::CalibrationAlgoType algorithm = nvinfer1::CalibrationAlgoType::kENTROPY_CALIBRATION_2;
+};
+
+// Runs a lowered graph on the CPU and records a histogram of every tensor it
+// produces, named as the tensor will be in the TensorRT network built from the
+// graph (input_<i>, output_<i> and the debug name of the value otherwise).
+// The resulting calibration cache can be read by a cache calibrator in place
+// of running TensorRT's calibration
+class ActivationCollector {
+ public:
+  // g and params as returned by lowering::Lower, input_ranges as they will be
+  // given to the compiler
+  ActivationCollector(
+      std::shared_ptr<torch::jit::Graph> g,
+      std::vector<torch::jit::IValue> params,
+      std::vector<conversion::InputRange> input_ranges,
+      CollectorSettings settings = CollectorSettings());
+
+  // Runs a batch, inputs are moved to the CPU
+  void Collect(std::vector<at::Tensor> inputs);
+
+  // Dynamic range per tensor name
+  std::vector<std::pair<std::string, float>> Amax() const;
+
+  // TensorRT calibration cache behind the key of the graph, input ranges and
+  // algorithm
+  std::string Cache() const;
+
+  void WriteCache(const std::string& path) const;
+
+  size_t num_batches() const {
+    return num_batches_;
+  }
+
+ private:
+  CollectorSettings settings_;
+  util::calibration::CacheKey key_;
+  // Lowered graph with every recorded value added as an output
+  std::shared_ptr<torch::jit::Graph> instrumented_;
+  std::shared_ptr<torch::jit::Code> code_;
+  // Arguments of the graph, params are filled in and user inputs are left
+  // empty
+  std::vector<torch::jit::IValue> arguments_;
+  std::vector<size_t> input_slots_;
+  size_t num_graph_outputs_ = 0;
+  // Name and histogram per recorded output of instrumented_
+  std::vector<std::string> names_;
+  std::vector<Histogram> histograms_;
+  size_t num_batches_ = 0;
+};
+
+// Lowers method_name of mod for an ActivationCollector
+ActivationCollector MakeActivationCollector(
+    const torch::jit::script::Module& mod,
+    std::string method_name,
+    std::vector<conversion::InputRange> input_ranges,
+    CollectorSettings settings = CollectorSettings());
+
+} // namespace calibration
+} // namespace core
+} // namespace trtorch
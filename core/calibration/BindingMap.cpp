@@ -0,0 +1,84 @@
+#include <sstream>
+
+#include "core/calibration/BindingMap.h"
+#include "core/util/prelude.h"
+
+namespace trtorch {
+namespace core {
+namespace calibration {
+namespace {
+
+std::string binding_list(const char* const* binding_names, int nb_bindings) {
+  std::stringstream ss;
+  ss << '[';
+  for (int i = 0; i < nb_bindings; i++) {
+    ss << (i ? ", " : "") << binding_names[i];
+  }
+  ss << ']';
+  return ss.str();
+}
+
+} // namespace
+
+std::string InputBindingName(size_t i) {
+  return "input_" + std::to_string(i);
+}
+
+std::vector<size_t> MapBindings(
+    const std::vector<std::string>& input_names,
+    const char* const* binding_names,
+    int nb_bindings) {
+  TRTORCH_CHECK(
+      input_names.size() == static_cast<size_t>(nb_bindings),
+      "Calibration batch has " << input_names.size() << " inputs, the engine has " << nb_bindings
+                               << " input bindings " << binding_list(binding_names, nb_bindings));
+
+  size_t named = 0;
+  for (const auto& name : input_names) {
+    named += !name.empty();
+  }
+  TRTORCH_CHECK(
+      named == 0 || named == input_names.size(),
+      "Calibration batch mixes named and positional inputs, name all of them or none");
+
+  std::vector<size_t> mapping(nb_bindings);
+  if (named) {
+    std::vector<bool> used(input_names.size(), false);
+    for (int b = 0; b < nb_bindings; b++) {
+      size_t i = 0;
+      while (i < input_names.size() && input_names[i] != binding_names[b]) {
+        i++;
+      }
+      TRTORCH_CHECK(
+          i < input_names.size(),
+          "Calibration batch has no input named " << binding_names[b] << ", the engine expects "
+                                                  << binding_list(binding_names, nb_bindings));
+      TRTORCH_CHECK(!used[i], "Calibration batch has several inputs named " << binding_names[b]);
+      used[i] = true;
+      mapping[b] = i;
+    }
+    return mapping;
+  }
+
+  // Bindings named input_<i> are fed by the i-th input, other engines are fed
+  // in binding order
+  bool trtorch_names = true;
+  for (int b = 0; b < nb_bindings && trtorch_names; b++) {
+    std::string name = binding_names[b];
+    auto digits = name.find_first_not_of("0123456789", 6);
+    trtorch_names = name.compare(0, 6, "input_") == 0 && name.size() > 6 && digits == std::string::npos &&
+        std::stoul(name.substr(6)) < input_names.size();
+  }
+  std::vector<bool> used(input_names.size(), false);
+  for (int b = 0; b < nb_bindings; b++) {
+    size_t i = trtorch_names ? std::stoul(std::string(binding_names[b]).substr(6)) : b;
+    TRTORCH_CHECK(!used[i], "Several engine bindings are named " << binding_names[b]);
+    used[i] = true;
+    mapping[b] = i;
+  }
+  return mapping;
+}
+
+} // namespace calibration
+} // namespace core
+} // namespace trtorch
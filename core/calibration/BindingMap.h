@@ -0,0 +1,26 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace trtorch {
+namespace core {
+namespace calibration {
+
+// Name of the engine binding of the i-th input of a graph compiled by TRTorch
+std::string InputBindingName(size_t i);
+
+// Index of the calibration input feeding each of the nb_bindings bindings.
+// input_names holds one entry per input of the batch, either the name of the
+// binding it feeds or empty to feed inputs by position: the i-th input feeds
+// binding "input_<i>", or the i-th binding if the engine was not built by
+// TRTorch. Named and positional inputs can not be mixed, every binding must be
+// fed by exactly one input
+std::vector<size_t> MapBindings(
+    const std::vector<std::string>& input_names,
+    const char* const* binding_names,
+    int nb_bindings);
+
+} // namespace calibration
+} // namespace core
+} // namespace trtorch
@@ -0,0 +1,67 @@
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+#include "core/calibration/CalibrationTable.h"
+
+namespace trtorch {
+namespace core {
+namespace calibration {
+namespace {
+// Largest magnitude of INT8, scales map [-amax, amax] onto [-127, 127]
+constexpr float kInt8Max = 127.0f;
+} // namespace
+
+std::string AlgorithmName(nvinfer1::CalibrationAlgoType algorithm) {
+  switch (algorithm) {
+    case nvinfer1::CalibrationAlgoType::kLEGACY_CALIBRATION:
+      return "legacy";
+    case nvinfer1::CalibrationAlgoType::kENTROPY_CALIBRATION:
+      return "entropy";
+    case nvinfer1::CalibrationAlgoType::kENTROPY_CALIBRATION_2:
+      return "entropy2";
+    case nvinfer1::CalibrationAlgoType::kMINMAX_CALIBRATION:
+      return "minmax";
+    default:
+      return "unknown";
+  }
+}
+
+std::string TableAlgorithmName(nvinfer1::CalibrationAlgoType algorithm) {
+  switch (algorithm) {
+    case nvinfer1::CalibrationAlgoType::kLEGACY_CALIBRATION:
+      return "LegacyCalibration";
+    case nvinfer1::CalibrationAlgoType::kENTROPY_CALIBRATION:
+      return "EntropyCalibration";
+    case nvinfer1::CalibrationAlgoType::kENTROPY_CALIBRATION_2:
+      return "EntropyCalibration2";
+    case nvinfer1::CalibrationAlgoType::kMINMAX_CALIBRATION:
+      return "MinMaxCalibration";
+    default:
+      return "UnknownCalibration";
+  }
+}
+
+int TableVersion() {
+  return NV_TENSORRT_MAJOR * 1000 + NV_TENSORRT_MINOR * 100 + NV_TENSORRT_PATCH;
+}
+
+std::string WriteCalibrationTable(
+    int version,
+    const std::string& algorithm,
+    const std::vector<std::pair<std::string, float>>& amax) {
+  std::stringstream ss;
+  ss << "TRT-" << version << '-' << algorithm << '\n';
+  for (const auto& entry : amax) {
+    float scale = entry.second / kInt8Max;
+    uint32_t bits;
+    std::memcpy(&bits, &scale, sizeof(bits));
+    ss << entry.first << ": " << std::hex << std::setw(8) << std::setfill('0') << bits << std::dec << '\n';
+  }
+  return ss.str();
+}
+
+} // namespace calibration
+} // namespace core
+} // namespace trtorch
@@ -0,0 +1,34 @@
+#pragma once
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "NvInfer.h"
+
+namespace trtorch {
+namespace core {
+namespace calibration {
+
+// Name of the algorithm in the key of TRTorch calibration caches, e.g.
+// "entropy2"
+std::string AlgorithmName(nvinfer1::CalibrationAlgoType algorithm);
+
+// Name of the algorithm in the first line of TensorRT calibration caches, e.g.
+// "EntropyCalibration2"
+std::string TableAlgorithmName(nvinfer1::CalibrationAlgoType algorithm);
+
+// TensorRT version as written in the first line of calibration caches, e.g.
+// 7100 for 7.1.0
+int TableVersion();
+
+// Calibration cache in the format TensorRT writes, "TRT-<version>-<algorithm>"
+// followed by one "<tensor name>: <scale>" line per tensor. The scale is
+// amax / 127 written as the hex bits of the float
+std::string WriteCalibrationTable(
+    int version,
+    const std::string& algorithm,
+    const std::vector<std::pair<std::string, float>>& amax);
+
+} // namespace calibration
+} // namespace core
+} // namespace trtorch
@@ -0,0 +1,188 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "core/calibration/Histogram.h"
+#include "core/util/prelude.h"
+
+namespace trtorch {
+namespace core {
+namespace calibration {
+namespace {
+
+// Elements processed per block by Histogram::Add, small enough for the block
+// of bin indices to stay in L1
+constexpr size_t kBlockSize = 256;
+// Independent accumulators for the max reduction so it is not serialized on a
+// single register
+constexpr size_t kLanes = 8;
+// Number of INT8 bins the entropy method quantizes to (the positive half of
+// the INT8 range)
+constexpr size_t kQuantizedBins = 128;
+
+// Finite values are at most the largest float, NaN and inf are not
+inline bool is_finite(float abs_value) {
+  return abs_value <= std::numeric_limits<float>::max();
+}
+
+float max_abs_finite(const float* data, size_t size) {
+  float lanes[kLanes] = {0};
+  size_t i = 0;
+  for (; i + kLanes <= size; i += kLanes) {
+    for (size_t l = 0; l < kLanes; l++) {
+      float a = std::fabs(data[i + l]);
+      lanes[l] = (a > lanes[l] && is_finite(a)) ? a : lanes[l];
+    }
+  }
+  for (; i < size; i++) {
+    float a = std::fabs(data[i]);
+    lanes[0] = (a > lanes[0] && is_finite(a)) ? a : lanes[0];
+  }
+  return *std::max_element(lanes, lanes + kLanes);
+}
+
+float entropy_amax(const Histogram& histogram) {
+  const auto& counts = histogram.counts();
+  const size_t num_bins = counts.size();
+  const double width = static_cast<double>(histogram.range()) / num_bins;
+  if (num_bins <= kQuantizedBins) {
+    return histogram.max_abs();
+  }
+
+  // Counts at or above each bin, folded into the last bin of the reference
+  // distribution when clipping there
+  std::vector<uint64_t> above(num_bins + 1, 0);
+  for (size_t i = num_bins; i > 0; i--) {
+    above[i - 1] = above[i] + counts[i - 1];
+  }
+
+  std::vector<double> q(num_bins);
+  double best_divergence = std::numeric_limits<double>::infinity();
+  size_t best_bins = num_bins;
+  for (size_t i = kQuantizedBins; i <= num_bins; i++) {
+    // Quantize the first i bins into kQuantizedBins groups, the last group
+    // takes the remainder, and expand each group back over its non empty bins
+    const size_t merged = i / kQuantizedBins;
+    for (size_t group = 0; group < kQuantizedBins; group++) {
+      size_t start = group * merged;
+      size_t stop = group == kQuantizedBins - 1 ? i : start + merged;
+      double sum = 0;
+      size_t non_empty = 0;
+      for (size_t j = start; j < stop; j++) {
+        sum += counts[j];
+        non_empty += counts[j] != 0;
+      }
+      for (size_t j = start; j < stop; j++) {
+        q[j] = counts[j] != 0 ? sum / non_empty : 0;
+      }
+    }
+
+    // KL(P || Q), P is the first i bins with the clipped outliers in the last
+    const double p_total = static_cast<double>(above[0]);
+    const double q_total = static_cast<double>(above[0] - above[i]);
+    double divergence = 0;
+    for (size_t j = 0; j < i; j++) {
+      double p = static_cast<double>(counts[j]) + (j == i - 1 ? above[i] : 0);
+      if (p == 0) {
+        continue;
+      }
+      if (q[j] == 0) {
+        divergence = std::numeric_limits<double>::infinity();
+        break;
+      }
+      p /= p_total;
+      divergence += p * std::log(p / (q[j] / q_total));
+    }
+    if (divergence < best_divergence) {
+      best_divergence = divergence;
+      best_bins = i;
+    }
+  }
+  return static_cast<float>(std::min(best_bins * width, static_cast<double>(histogram.max_abs())));
+}
+
+float percentile_amax(const Histogram& histogram, double percentile) {
+  TRTORCH_CHECK(
+      percentile > 0 && percentile <= 100, "Percentile for calibration must be in (0, 100], got " << percentile);
+  const auto& counts = histogram.counts();
+  const double width = static_cast<double>(histogram.range()) / counts.size();
+  const double target = std::ceil(histogram.total() * percentile / 100.0);
+  uint64_t seen = 0;
+  for (size_t i = 0; i < counts.size(); i++) {
+    seen += counts[i];
+    if (seen >= target) {
+      return static_cast<float>(std::min((i + 1) * width, static_cast<double>(histogram.max_abs())));
+    }
+  }
+  return histogram.max_abs();
+}
+
+} // namespace
+
+Histogram::Histogram(size_t num_bins) : counts_(num_bins, 0) {
+  TRTORCH_CHECK(num_bins > 0, "A histogram needs at least one bin");
+}
+
+void Histogram::Grow(float range) {
+  if (range_ > 0 && total_ > 0) {
+    // Move every old bin, by its center, into the bin of the new range
+    // holding it
+    std::vector<uint64_t> counts(counts_.size(), 0);
+    const double old_width = static_cast<double>(range_) / counts_.size();
+    const double scale = counts_.size() / static_cast<double>(range);
+    for (size_t i = 0; i < counts_.size(); i++) {
+      auto bin = static_cast<size_t>((i + 0.5) * old_width * scale);
+      counts[std::min(bin, counts_.size() - 1)] += counts_[i];
+    }
+    counts_ = std::move(counts);
+  }
+  range_ = range;
+}
+
+void Histogram::Add(const float* data, size_t size) {
+  float batch_max = max_abs_finite(data, size);
+  if (batch_max > range_) {
+    Grow(batch_max);
+  }
+  max_abs_ = std::max(max_abs_, batch_max);
+
+  // All finite values are 0 while the range is 0, they go in the first bin.
+  // Non finite values get an index past the last bin and are dropped
+  const uint32_t num_bins = static_cast<uint32_t>(counts_.size());
+  const float scale = range_ > 0 ? num_bins / range_ : 0;
+  const float last = static_cast<float>(num_bins - 1);
+  uint32_t bins[kBlockSize];
+  for (size_t start = 0; start < size; start += kBlockSize) {
+    const size_t n = std::min(kBlockSize, size - start);
+    const float* block = data + start;
+    for (size_t i = 0; i < n; i++) {
+      float a = std::fabs(block[i]);
+      bins[i] = is_finite(a) ? static_cast<uint32_t>(std::min(a * scale, last)) : num_bins;
+    }
+    for (size_t i = 0; i < n; i++) {
+      if (bins[i] < num_bins) {
+        counts_[bins[i]]++;
+        total_++;
+      }
+    }
+  }
+}
+
+float ComputeAmax(const Histogram& histogram, ScaleMethod method, double percentile) {
+  if (histogram.total() == 0 || histogram.max_abs() == 0) {
+    return histogram.max_abs();
+  }
+  switch (method) {
+    case ScaleMethod::kEntropy:
+      return entropy_amax(histogram);
+    case ScaleMethod::kPercentile:
+      return percentile_amax(histogram, percentile);
+    case ScaleMethod::kMinMax:
+    default:
+      return histogram.max_abs();
+  }
+}
+
+} // namespace calibration
+} // namespace core
+} // namespace trtorch
@@ -0,0 +1,63 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace trtorch {
+namespace core {
+namespace calibration {
+
+// How the dynamic range (amax) of a tensor is chosen from its histogram
+enum class ScaleMethod {
+  // Range which minimizes the KL divergence between the activations and their
+  // INT8 quantization, as TensorRT's entropy calibrators do
+  kEntropy,
+  // Largest absolute value seen
+  kMinMax,
+  // Smallest range which holds the given percentile of the absolute values
+  kPercentile,
+};
+
+// Histogram of the absolute values of a tensor over [0, range). The range
+// grows to the largest absolute value seen, existing counts are merged into the
+// wider bins when it does
+class Histogram {
+ public:
+  explicit Histogram(size_t num_bins = 2048);
+
+  // Adds the absolute value of every finite element of data. Both passes over
+  // data are written as straight loops over blocks so they vectorize
+  void Add(const float* data, size_t size);
+
+  float range() const {
+    return range_;
+  }
+
+  float max_abs() const {
+    return max_abs_;
+  }
+
+  uint64_t total() const {
+    return total_;
+  }
+
+  const std::vector<uint64_t>& counts() const {
+    return counts_;
+  }
+
+ private:
+  void Grow(float range);
+
+  std::vector<uint64_t> counts_;
+  float range_ = 0;
+  float max_abs_ = 0;
+  uint64_t total_ = 0;
+};
+
+// Dynamic range of the tensor the histogram was collected for. percentile is
+// only used by kPercentile and is in (0, 100]
+float ComputeAmax(const Histogram& histogram, ScaleMethod method, double percentile = 99.99);
+
+} // namespace calibration
+} // namespace core
+} // namespace trtorch
@@ -0,0 +1,144 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#include "core/calibration/NpyFile.h"
+#include "core/util/prelude.h"
+
+namespace trtorch {
+namespace core {
+namespace calibration {
+namespace {
+
+constexpr char kMagic[] = "\x93NUMPY";
+constexpr size_t kMagicSize = 6;
+
+// Value of key in the header dict, up to the next top level comma or the end
+// of the dict. Tuples are returned with their parentheses
+std::string header_value(const std::string& header, const std::string& key) {
+  auto pos = header.find("'" + key + "'");
+  TRTORCH_CHECK(pos != std::string::npos, "npy header has no " << key << ": " << header);
+  pos = header.find(':', pos);
+  TRTORCH_CHECK(pos != std::string::npos, "Malformed npy header: " << header);
+  pos = header.find_first_not_of(' ', pos + 1);
+  TRTORCH_CHECK(pos != std::string::npos, "Malformed npy header: " << header);
+  size_t end;
+  if (header[pos] == '(') {
+    end = header.find(')', pos);
+    TRTORCH_CHECK(end != std::string::npos, "Malformed npy header: " << header);
+    return header.substr(pos, end - pos + 1);
+  }
+  if (header[pos] == '\'' || header[pos] == '"') {
+    end = header.find(header[pos], pos + 1);
+    TRTORCH_CHECK(end != std::string::npos, "Malformed npy header: " << header);
+    return header.substr(pos + 1, end - pos - 1);
+  }
+  end = header.find_first_of(",}", pos);
+  TRTORCH_CHECK(end != std::string::npos, "Malformed npy header: " << header);
+  return header.substr(pos, end - pos);
+}
+
+std::vector<int64_t> parse_shape(const std::string& tuple) {
+  std::vector<int64_t> shape;
+  std::string dim;
+  for (size_t i = 1; i < tuple.size(); i++) {
+    char c = tuple[i];
+    if (c >= '0' && c <= '9') {
+      dim.push_back(c);
+    } else if (c == ',' || c == ')') {
+      if (!dim.empty()) {
+        shape.push_back(std::stoll(dim));
+        dim.clear();
+      }
+    } else {
+      TRTORCH_CHECK(c == ' ' || c == 'L', "Malformed npy shape: " << tuple);
+    }
+  }
+  return shape;
+}
+
+} // namespace
+
+NpyHeader ParseNpyHeader(const char* data, size_t size) {
+  TRTORCH_CHECK(size >= kMagicSize + 4 && std::memcmp(data, kMagic, kMagicSize) == 0, "Not a npy file");
+  auto byte = [data](size_t i) { return static_cast<size_t>(static_cast<uint8_t>(data[i])); };
+  size_t major = byte(6);
+  size_t header_len, header_start;
+  if (major == 1) {
+    header_len = byte(8) | byte(9) << 8;
+    header_start = 10;
+  } else {
+    TRTORCH_CHECK(major == 2 || major == 3, "Unsupported npy format version " << major);
+    TRTORCH_CHECK(size >= 12, "npy header is truncated");
+    header_len = byte(8) | byte(9) << 8 | byte(10) << 16 | byte(11) << 24;
+    header_start = 12;
+  }
+  TRTORCH_CHECK(size >= header_start + header_len, "npy header is truncated");
+  std::string header(data + header_start, header_len);
+
+  NpyHeader parsed;
+  parsed.descr = header_value(header, "descr");
+  TRTORCH_CHECK(parsed.descr.size() >= 3, "Unsupported npy type " << parsed.descr);
+  parsed.item_size = std::stoul(parsed.descr.substr(2));
+  TRTORCH_CHECK(
+      parsed.descr[0] == '<' || parsed.descr[0] == '|' || parsed.item_size == 1,
+      "Only little endian npy files are supported, got type " << parsed.descr);
+  TRTORCH_CHECK(
+      header_value(header, "fortran_order") == "False", "Fortran ordered npy arrays are not supported");
+  parsed.shape = parse_shape(header_value(header, "shape"));
+  parsed.data_offset = header_start + header_len;
+
+  size_t bytes = parsed.item_size;
+  for (auto d : parsed.shape) {
+    bytes *= static_cast<size_t>(d);
+  }
+  TRTORCH_CHECK(
+      size - parsed.data_offset >= bytes,
+      "npy file holds " << size - parsed.data_offset << " bytes of data, its header describes " << bytes);
+  return parsed;
+}
+
+std::shared_ptr<const NpyFile> NpyFile::Open(const std::string& path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  TRTORCH_CHECK(fd >= 0, "Unable to open " << path);
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    TRTORCH_THROW_ERROR("Unable to stat " << path);
+  }
+  auto size = static_cast<size_t>(st.st_size);
+  TRTORCH_CHECK(size > 0, path << " is empty");
+  void* addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  TRTORCH_CHECK(addr != MAP_FAILED, "Unable to map " << path);
+  // Owned from here on, so the mapping is released if the header is invalid
+  return std::shared_ptr<const NpyFile>(new NpyFile(path, static_cast<const char*>(addr), size));
+}
+
+NpyFile::NpyFile(std::string path, const char* base, size_t size) : path_(std::move(path)), base_(base), size_(size) {
+  try {
+    header_ = ParseNpyHeader(base_, size_);
+  } catch (...) {
+    munmap(const_cast<char*>(base_), size_);
+    throw;
+  }
+}
+
+NpyFile::~NpyFile() {
+  munmap(const_cast<char*>(base_), size_);
+}
+
+size_t NpyFile::row_size() const {
+  size_t bytes = header_.item_size;
+  for (size_t i = 1; i < header_.shape.size(); i++) {
+    bytes *= static_cast<size_t>(header_.shape[i]);
+  }
+  return bytes;
+}
+
+} // namespace calibration
+} // namespace core
+} // namespace trtorch
@@ -0,0 +1,63 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace trtorch {
+namespace core {
+namespace calibration {
+
+// Header of a .npy file (format versions 1 to 3)
+struct NpyHeader {
+  // Numpy type descriptor, e.g. "<f4". Only little endian and single byte
+  // types are accepted
+  std::string descr;
+  // Size in bytes of one element
+  size_t item_size = 0;
+  std::vector<int64_t> shape;
+  // Start of the array data in the file
+  size_t data_offset = 0;
+};
+
+// Parses the header at the start of a .npy file of the given size. Fortran
+// ordered arrays and files which do not hold the whole array raise an error
+NpyHeader ParseNpyHeader(const char* data, size_t size);
+
+// A .npy file mapped read only into memory, unmapped when destroyed
+class NpyFile {
+ public:
+  static std::shared_ptr<const NpyFile> Open(const std::string& path);
+  ~NpyFile();
+  NpyFile(const NpyFile&) = delete;
+  NpyFile& operator=(const NpyFile&) = delete;
+
+  const NpyHeader& header() const {
+    return header_;
+  }
+
+  // Start of the array data
+  const char* data() const {
+    return base_ + header_.data_offset;
+  }
+
+  // Size of one entry along the first dimension in bytes
+  size_t row_size() const;
+
+  const std::string& path() const {
+    return path_;
+  }
+
+ private:
+  NpyFile(std::string path, const char* base, size_t size);
+
+  std::string path_;
+  const char* base_;
+  size_t size_;
+  NpyHeader header_;
+};
+
+} // namespace calibration
+} // namespace core
+} // namespace trtorch
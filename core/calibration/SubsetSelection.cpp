@@ -0,0 +1,216 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+
+#include "core/calibration/SubsetSelection.h"
+#include "core/util/prelude.h"
+
+namespace trtorch {
+namespace core {
+namespace calibration {
+namespace {
+
+constexpr uint32_t kSeed = 0;
+
+// Row major matrix of standardized summaries
+struct Standardized {
+  size_t rows;
+  size_t cols;
+  std::vector<double> values;
+
+  const double* row(size_t i) const {
+    return values.data() + i * cols;
+  }
+};
+
+Standardized standardize(const std::vector<float>& summaries, size_t num_samples, size_t num_features) {
+  Standardized z{num_samples, num_features, std::vector<double>(summaries.begin(), summaries.end())};
+  for (size_t j = 0; j < num_features; j++) {
+    double mean = 0;
+    for (size_t i = 0; i < num_samples; i++) {
+      mean += z.values[i * num_features + j];
+    }
+    mean /= num_samples;
+    double var = 0;
+    for (size_t i = 0; i < num_samples; i++) {
+      double d = z.values[i * num_features + j] - mean;
+      var += d * d;
+    }
+    double stddev = std::sqrt(var / num_samples);
+    // Features which do not vary carry no information, they are zeroed
+    double scale = stddev > 0 ? 1.0 / stddev : 0;
+    for (size_t i = 0; i < num_samples; i++) {
+      auto& v = z.values[i * num_features + j];
+      v = (v - mean) * scale;
+    }
+  }
+  return z;
+}
+
+double squared_distance(const double* a, const double* b, size_t n) {
+  double d = 0;
+  for (size_t i = 0; i < n; i++) {
+    double diff = a[i] - b[i];
+    d += diff * diff;
+  }
+  return d;
+}
+
+// Splits samples [begin, end) of order into num_cells cells of equal size,
+// halving along the feature with the largest spread each time, and draws one
+// sample per cell
+void select_stratified(
+    const Standardized& z,
+    std::vector<size_t>& order,
+    size_t begin,
+    size_t end,
+    size_t num_cells,
+    std::mt19937& gen,
+    std::vector<size_t>& selected) {
+  if (num_cells == 1) {
+    std::uniform_int_distribution<size_t> pick(begin, end - 1);
+    selected.push_back(order[pick(gen)]);
+    return;
+  }
+
+  size_t feature = 0;
+  double widest = -1;
+  for (size_t j = 0; j < z.cols; j++) {
+    double lo = std::numeric_limits<double>::infinity();
+    double hi = -lo;
+    for (size_t i = begin; i < end; i++) {
+      lo = std::min(lo, z.row(order[i])[j]);
+      hi = std::max(hi, z.row(order[i])[j]);
+    }
+    if (hi - lo > widest) {
+      widest = hi - lo;
+      feature = j;
+    }
+  }
+
+  // Samples are split in proportion to the cells on each side
+  size_t left_cells = num_cells / 2;
+  size_t split = begin + (end - begin) * left_cells / num_cells;
+  std::nth_element(
+      order.begin() + begin, order.begin() + split, order.begin() + end, [&z, feature](size_t a, size_t b) {
+        return z.row(a)[feature] < z.row(b)[feature];
+      });
+  select_stratified(z, order, begin, split, left_cells, gen, selected);
+  select_stratified(z, order, split, end, num_cells - left_cells, gen, selected);
+}
+
+std::vector<size_t> select_stratified(const Standardized& z, size_t target_size) {
+  std::vector<size_t> order(z.rows);
+  std::iota(order.begin(), order.end(), 0);
+  // The seed is fixed so selections are reproducible
+  std::mt19937 gen(kSeed);
+  std::vector<size_t> selected;
+  select_stratified(z, order, 0, z.rows, target_size, gen, selected);
+  return selected;
+}
+
+std::vector<size_t> select_coreset(const Standardized& z, size_t target_size) {
+  // Start from the sample closest to the mean, which is the origin once
+  // standardized
+  std::vector<double> origin(z.cols, 0);
+  size_t next = 0;
+  double best = std::numeric_limits<double>::infinity();
+  for (size_t i = 0; i < z.rows; i++) {
+    double d = squared_distance(z.row(i), origin.data(), z.cols);
+    if (d < best) {
+      best = d;
+      next = i;
+    }
+  }
+
+  std::vector<size_t> selected;
+  std::vector<double> nearest(z.rows, std::numeric_limits<double>::infinity());
+  // Duplicate samples are all at distance 0, so selected samples are skipped
+  // explicitly
+  std::vector<bool> chosen(z.rows, false);
+  while (selected.size() < target_size) {
+    selected.push_back(next);
+    chosen[next] = true;
+    auto last = z.row(next);
+    double furthest = -1;
+    for (size_t i = 0; i < z.rows; i++) {
+      nearest[i] = std::min(nearest[i], squared_distance(z.row(i), last, z.cols));
+      if (!chosen[i] && nearest[i] > furthest) {
+        furthest = nearest[i];
+        next = i;
+      }
+    }
+  }
+  return selected;
+}
+
+void measure(const Standardized& z, SubsetSelection& selection) {
+  // The full set has mean 0 and standard deviation 1 (or 0 for constant
+  // features) in every standardized feature
+  const double n = static_cast<double>(selection.indices.size());
+  for (size_t j = 0; j < z.cols; j++) {
+    double mean = 0, full_var = 0;
+    for (auto i : selection.indices) {
+      mean += z.row(i)[j];
+    }
+    mean /= n;
+    double var = 0;
+    for (auto i : selection.indices) {
+      double d = z.row(i)[j] - mean;
+      var += d * d;
+    }
+    for (size_t i = 0; i < z.rows; i++) {
+      full_var += z.row(i)[j] * z.row(i)[j];
+    }
+    selection.max_mean_shift = std::max(selection.max_mean_shift, std::abs(mean));
+    if (full_var > 0) {
+      selection.max_std_error = std::max(selection.max_std_error, std::abs(std::sqrt(var / n) - 1.0));
+    }
+  }
+
+  double radius = 0;
+  for (size_t i = 0; i < z.rows; i++) {
+    double nearest = std::numeric_limits<double>::infinity();
+    for (auto s : selection.indices) {
+      nearest = std::min(nearest, squared_distance(z.row(i), z.row(s), z.cols));
+    }
+    radius = std::max(radius, nearest);
+  }
+  selection.coverage_radius = std::sqrt(radius);
+}
+
+} // namespace
+
+SubsetSelection SelectSubset(
+    const std::vector<float>& summaries,
+    size_t num_features,
+    size_t target_size,
+    SubsetStrategy strategy) {
+  TRTORCH_CHECK(target_size > 0, "The calibration subset must hold at least one sample");
+  TRTORCH_CHECK(num_features > 0, "Samples need at least one summary feature to select a subset");
+  TRTORCH_CHECK(
+      summaries.size() % num_features == 0,
+      "Expected " << num_features << " summary features per sample, got " << summaries.size() << " values in total");
+  const size_t num_samples = summaries.size() / num_features;
+  TRTORCH_CHECK(num_samples > 0, "Cannot select a calibration subset of an empty dataset");
+
+  SubsetSelection selection;
+  auto z = standardize(summaries, num_samples, num_features);
+  if (target_size >= num_samples) {
+    selection.indices.resize(num_samples);
+    std::iota(selection.indices.begin(), selection.indices.end(), 0);
+  } else if (strategy == SubsetStrategy::kCoreset) {
+    selection.indices = select_coreset(z, target_size);
+  } else {
+    selection.indices = select_stratified(z, target_size);
+  }
+  std::sort(selection.indices.begin(), selection.indices.end());
+  measure(z, selection);
+  return selection;
+}
+
+} // namespace calibration
+} // namespace core
+} // namespace trtorch
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+namespace trtorch {
+namespace core {
+namespace calibration {
+
+enum class SubsetStrategy {
+  // Recursively halves the samples along the summary feature with the largest
+  // spread into equally sized strata, one per selected sample, and takes a
+  // random sample of each
+  kStratified,
+  // Greedy k-center: repeatedly takes the sample furthest from the ones
+  // already selected, so outliers are covered
+  kCoreset,
+};
+
+struct SubsetSelection {
+  // Selected samples, ascending
+  std::vector<size_t> indices;
+  // Largest difference between the mean of a summary feature over the subset
+  // and over the full set, in standard deviations of the full set
+  double max_mean_shift = 0;
+  // Largest relative difference between the standard deviation of a summary
+  // feature over the subset and over the full set
+  double max_std_error = 0;
+  // Largest distance from any sample to its nearest selected sample, in
+  // standard deviations
+  double coverage_radius = 0;
+};
+
+// Selects target_size representative samples. summaries holds num_features
+// values per sample, row major. Features are standardized before comparing
+// samples, so their scales do not matter
+SubsetSelection SelectSubset(
+    const std::vector<float>& summaries,
+    size_t num_features,
+    size_t target_size,
+    SubsetStrategy strategy);
+
+} // namespace calibration
+} // namespace core
+} // namespace trtorch
@@ -20,6 +20,7 @@
 
 #include "core/conversion/conversion.h"
 #include "core/lowering/lowering.h"
+#include "core/runtime/DirectOps.h"
 #include "core/runtime/runtime.h"
 
 namespace trtorch {
@@ -42,14 +43,17 @@ c10::FunctionSchema GenerateGraphSchema(
   return c10::FunctionSchema(method_name, method_name, args, returns);
 }
 
-void AddEngineToGraph(
+c10::intrusive_ptr<runtime::TRTEngine> AddEngineToGraph(
     torch::jit::script::Module mod,
     std::shared_ptr<torch::jit::Graph>& g,
-    std::string& serialized_engine) {
+    std::string& serialized_engine,
+    runtime::RuntimeSettings runtime_settings) {
   auto engine_ptr = c10::make_intrusive<runtime::TRTEngine>(mod._ivalue()->name(), serialized_engine);
+  engine_ptr->settings = runtime_settings;
   // Get required metadata about the engine out
   auto num_io = engine_ptr->num_io;
   auto name = engine_ptr->name;
+  auto engine = engine_ptr;
 
   // Add the engine as an attribute of the module, this will let the engine be
   // serialized and deserialized
@@ -69,7 +73,7 @@ void AddEngineToGraph(
 
   // Add inputs to the graph corresponding to the number of input tensors
   // expected by the engine Also store those inputs in a vector so that they can
-  // be coalesced into a single list at runtime
+  // be passed to the execution op
   std::vector<torch::jit::Value*> engine_inputs;
   for (uint64_t i = 0; i < num_io.first; i++) {
     auto in_val = g->addInput(std::string("input_") + std::to_string(i));
@@ -77,57 +81,118 @@ void AddEngineToGraph(
     engine_inputs.push_back(in_val);
   }
 
-  // Create a node that will merge all of the input tensors into a single list
-  // argument to the trt::execute_engine op Creates: prim::ListConstruct(<input
-  // tensors>)
-  auto input_list_node = g->createList(c10::TensorType::get(), torch::jit::ArrayRef<torch::jit::Value*>(engine_inputs));
-  g->block()->appendNode(input_list_node);
-
-  // Make a list of inputs to the actual trt::execute_engine op
-  // Note: Ordering of list and then engine is because we can pop off the engine
-  // first which contains all the metadata needed for execution
-  std::vector<torch::jit::Value*> execute_node_inputs;
-  execute_node_inputs.push_back(input_list_node->outputs()[0]);
-  execute_node_inputs.push_back(engine_node->outputs()[0]);
-
-  // Create the actual execution node trt::execute_engine using the assembled
-  // inputs
-  auto execute_node = g->create(
-      c10::Symbol::fromQualString("tensorrt::execute_engine"),
-      torch::jit::ArrayRef<torch::jit::Value*>(execute_node_inputs),
-      1);
-  g->block()->appendNode(execute_node);
-  execute_node->outputs()[0]->setType(c10::ListType::ofTensors());
-
-  // Create a node to unpack the list into seperate tensors, in the case of
-  // there being only one tensor, the tensor will be returned, otherwise they
-  // are returned as a tuple of tensors. Creates: prim::ListUnpack(<engine
-  // output>)
-  auto unpack_node = g->createListUnpack(execute_node->outputs()[0], num_io.second);
-  g->block()->appendNode(unpack_node);
-
-  // If there are multiple output tensors from TensorRT we wrap them in a tuple
-  // to return
-  if (unpack_node->outputs().size() > 1) {
-    // Creates prim::TupleConstruct(<output tensors>) using outputs of the
-    // unpack node
-    auto return_tuple_node = g->createTuple(unpack_node->outputs());
+  torch::jit::ArrayRef<torch::jit::Value*> engine_outputs;
+  if (runtime::HasDirectOp(num_io.first, num_io.second)) {
+    // Pass the input tensors and engine straight to the op for this number of
+    // inputs and outputs, which returns the output tensors directly. Creates:
+    // tensorrt::execute_engine_<N>in_<M>out(<input tensors>, <engine>)
+    std::vector<torch::jit::Value*> execute_node_inputs = engine_inputs;
+    execute_node_inputs.push_back(engine_node->outputs()[0]);
+    auto execute_node = g->create(
+        c10::Symbol::fromQualString(runtime::DirectOpName("tensorrt::execute_engine", num_io.first, num_io.second)),
+        torch::jit::ArrayRef<torch::jit::Value*>(execute_node_inputs),
+        num_io.second);
+    g->block()->appendNode(execute_node);
+    for (auto out : execute_node->outputs()) {
+      out->setType(c10::TensorType::get());
+    }
+    engine_outputs = execute_node->outputs();
+  } else {
+    // Create a node that will merge all of the input tensors into a single list
+    // argument to the trt::execute_engine op Creates: prim::ListConstruct(<input
+    // tensors>)
+    auto input_list_node =
+        g->createList(c10::TensorType::get(), torch::jit::ArrayRef<torch::jit::Value*>(engine_inputs));
+    g->block()->appendNode(input_list_node);
+
+    // Make a list of inputs to the actual trt::execute_engine op
+    // Note: Ordering of list and then engine is because we can pop off the engine
+    // first which contains all the metadata needed for execution
+    std::vector<torch::jit::Value*> execute_node_inputs;
+    execute_node_inputs.push_back(input_list_node->outputs()[0]);
+    execute_node_inputs.push_back(engine_node->outputs()[0]);
+
+    // Create the actual execution node trt::execute_engine using the assembled
+    // inputs
+    auto execute_node = g->create(
+        c10::Symbol::fromQualString("tensorrt::execute_engine"),
+        torch::jit::ArrayRef<torch::jit::Value*>(execute_node_inputs),
+        1);
+    g->block()->appendNode(execute_node);
+    execute_node->outputs()[0]->setType(c10::ListType::ofTensors());
+
+    // Create a node to unpack the list into seperate tensors. Creates:
+    // prim::ListUnpack(<engine output>)
+    auto unpack_node = g->createListUnpack(execute_node->outputs()[0], num_io.second);
+    g->block()->appendNode(unpack_node);
+    engine_outputs = unpack_node->outputs();
+  }
+
+  // In the case of there being only one tensor, the tensor will be returned,
+  // otherwise they are returned as a tuple of tensors
+  if (engine_outputs.size() > 1) {
+    // Creates prim::TupleConstruct(<output tensors>) using the engine outputs
+    auto return_tuple_node = g->createTuple(engine_outputs);
     g->block()->appendNode(return_tuple_node);
     // Set the output as the produced tuple
     g->registerOutput(return_tuple_node->outputs()[0]);
   } else {
     // Set the output as the sole output tensor
-    g->registerOutput(unpack_node->outputs()[0]);
+    g->registerOutput(engine_outputs[0]);
   }
 
   LOG_DEBUG(*g << "(AddEngineToGraph)\n");
 
-  return;
+  return engine;
 }
 
-bool CheckMethodOperatorSupport(const torch::jit::script::Module& mod, std::string method_name) {
+void EnableShapeSpecialization(
+    runtime::TRTEngine& engine,
+    std::shared_ptr<torch::jit::Graph> g,
+    conversion::GraphParams named_params,
+    std::string mod_name,
+    std::string method_name,
+    const CompileSpec& cfg) {
+  if (cfg.convert_info.engine_settings.calibrator) {
+    LOG_WARNING(
+        "Shape specialization is not supported with post training quantization, it is disabled for " << method_name);
+    return;
+  }
+
+  // Keep the graph lowered for the generic engine around, engines for specific
+  // shapes are built from it without lowering the module again. Only the graph
+  // and its parameters are held so the module itself can be released
+  auto convert_info = cfg.convert_info;
+  auto settings = cfg.runtime_settings;
+  mod_name += "_specialized";
+
+  auto build = [g, named_params, convert_info, settings, mod_name](const runtime::InputShapes& shapes) {
+    auto build_info = convert_info;
+    build_info.input_ranges.clear();
+    std::stringstream ss;
+    for (size_t i = 0; i < shapes.size(); i++) {
+      build_info.input_ranges.push_back(conversion::InputRange(shapes[i]));
+      ss << (i ? ", " : "") << c10::IntArrayRef(shapes[i]);
+    }
+    LOG_INFO("Building an engine specialized for input shapes " << ss.str() << " (" << mod_name << ")");
+    auto params = named_params;
+    auto serialized_engine = conversion::ConvertBlockToEngine(g->block(), build_info, params);
+    auto specialized = c10::make_intrusive<runtime::TRTEngine>(mod_name, serialized_engine);
+    specialized->settings = settings;
+    return specialized;
+  };
+  engine.specializer = std::make_unique<runtime::ShapeSpecializer<c10::intrusive_ptr<runtime::TRTEngine>>>(
+      static_cast<size_t>(cfg.runtime_settings.specialize_after),
+      static_cast<size_t>(cfg.runtime_settings.max_specializations),
+      std::move(build));
+}
+
+bool CheckMethodOperatorSupport(
+    const torch::jit::script::Module& mod,
+    std::string method_name,
+    const lowering::LowerInfo& lower_info) {
   // Go through Lowering to simplify graph and extract weight parameters
-  auto graph_and_parameters = lowering::Lower(mod, method_name);
+  auto graph_and_parameters = lowering::Lower(mod, method_name, lower_info);
 
   auto g = graph_and_parameters.first;
   LOG_DEBUG(*g << "(CheckMethodOperatorSupport)\n");
@@ -135,19 +200,25 @@ bool CheckMethodOperatorSupport(const torch::jit::script::Module& mod, std::stri
   return conversion::VerifyConverterSupportForBlock(g->block());
 }
 
+// Converts an already lowered graph, named_params are the parameters of its
+// inputs (see conversion::get_named_params)
+std::string ConvertLoweredGraphToTRTEngine(
+    std::shared_ptr<torch::jit::Graph> g,
+    conversion::GraphParams named_params,
+    conversion::ConversionInfo convert_cfg) {
+  LOG_INFO(*g << "(CompileGraph)\n");
+
+  auto engine = conversion::ConvertBlockToEngine(g->block(), std::move(convert_cfg), named_params);
+  return std::move(engine);
+}
+
 std::string ConvertGraphToTRTEngine(const torch::jit::script::Module& mod, std::string method_name, CompileSpec cfg) {
   // Go through Lowering to simplify graph and extract weight parameters
-  auto graph_and_parameters = lowering::Lower(mod, method_name);
+  auto graph_and_parameters = lowering::Lower(mod, method_name, cfg.lower_info);
 
-  auto convert_cfg = std::move(cfg.convert_info);
   auto g = graph_and_parameters.first;
-  auto params = graph_and_parameters.second;
-  auto named_params = conversion::get_named_params(g->inputs(), params);
-
-  LOG_INFO(*g << "(CompileGraph)\n");
-
-  auto engine = conversion::ConvertBlockToEngine(g->block(), convert_cfg, named_params);
-  return std::move(engine);
+  auto named_params = conversion::get_named_params(g->inputs(), graph_and_parameters.second);
+  return ConvertLoweredGraphToTRTEngine(g, std::move(named_params), std::move(cfg.convert_info));
 }
 
 torch::jit::script::Module CompileGraph(const torch::jit::script::Module& mod, CompileSpec cfg) {
@@ -159,9 +230,16 @@ torch::jit::script::Module CompileGraph(const torch::jit::script::Module& mod, C
   for (const torch::jit::script::Method& method : mod.get_methods()) {
     // Don't convert hidden methods
     if (method.name().rfind("_", 0)) {
-      auto engine = ConvertGraphToTRTEngine(mod, method.name(), cfg);
+      // Lowered once, shape specialization builds its engines from the same graph
+      auto graph_and_parameters = lowering::Lower(mod, method.name(), cfg.lower_info);
+      auto g = graph_and_parameters.first;
+      auto named_params = conversion::get_named_params(g->inputs(), graph_and_parameters.second);
+      auto engine = ConvertLoweredGraphToTRTEngine(g, named_params, cfg.convert_info);
       auto new_g = std::make_shared<torch::jit::Graph>();
-      AddEngineToGraph(new_mod, new_g, engine);
+      auto engine_ptr = AddEngineToGraph(new_mod, new_g, engine, cfg.runtime_settings);
+      if (cfg.runtime_settings.specialize_after > 0) {
+        EnableShapeSpecialization(*engine_ptr, g, std::move(named_params), mod._ivalue()->name(), method.name(), cfg);
+      }
       auto new_method = new_mod._ivalue()->compilation_unit()->create_function(method.name(), new_g);
       auto schema = GenerateGraphSchema(new_mod, new_method->name(), new_g);
       new_mod.type()->addMethod(new_method);
@@ -172,5 +250,31 @@ torch::jit::script::Module CompileGraph(const torch::jit::script::Module& mod, C
   return new_mod;
 }
 
+void SwapEngine(const torch::jit::script::Module& mod, std::string method_name, std::string serialized_engine) {
+  auto g = mod.get_method(method_name).graph();
+  // Find the engine attribute read for the execute_engine call in the graph
+  // built by AddEngineToGraph
+  std::string engine_attr;
+  for (auto n : g->nodes()) {
+    // The engine is the last argument of both the list based and the direct
+    // (tensorrt::execute_engine_<N>in_<M>out) execution ops
+    std::string kind = n->kind().toQualString();
+    if (kind.rfind("tensorrt::execute_engine", 0) == 0) {
+      auto engine_src = n->inputs().back()->node();
+      TRTORCH_CHECK(
+          engine_src->kind() == torch::jit::prim::GetAttr,
+          "Expected the engine executed by " << method_name << " to be read from a module attribute");
+      engine_attr = engine_src->s(torch::jit::attr::name);
+      break;
+    }
+  }
+  TRTORCH_CHECK(!engine_attr.empty(), "Method " << method_name << " does not execute a TensorRT engine");
+
+  auto current = mod.attr(engine_attr).toCustomClass<runtime::TRTEngine>();
+  auto replacement = c10::make_intrusive<runtime::TRTEngine>(mod._ivalue()->name(), serialized_engine);
+  replacement->settings = current->settings;
+  current->Swap(std::move(replacement));
+}
+
 } // namespace core
 } // namespace trtorch
@@ -2,6 +2,8 @@
 
 #include <vector>
 #include "core/conversion/conversion.h"
+#include "core/lowering/lowering.h"
+#include "core/runtime/runtime.h"
 #include "torch/csrc/jit/api/module.h"
 
 namespace trtorch {
@@ -10,13 +12,20 @@ namespace core {
 struct CompileSpec {
   CompileSpec(std::vector<conversion::InputRange> input_ranges) : convert_info(std::move(input_ranges)) {}
   conversion::ConversionInfo convert_info;
+  lowering::LowerInfo lower_info;
+  runtime::RuntimeSettings runtime_settings;
 };
 
-bool CheckMethodOperatorSupport(const torch::jit::script::Module& mod, std::string method_name);
+bool CheckMethodOperatorSupport(
+    const torch::jit::script::Module& mod,
+    std::string method_name,
+    const lowering::LowerInfo& lower_info = lowering::LowerInfo());
 
 std::string ConvertGraphToTRTEngine(const torch::jit::script::Module& mod, std::string method_name, CompileSpec cfg);
 
 torch::jit::script::Module CompileGraph(const torch::jit::script::Module& module, CompileSpec cfg);
 
+void SwapEngine(const torch::jit::script::Module& mod, std::string method_name, std::string serialized_engine);
+
 } // namespace core
 } // namespace trtorch
@@ -5,6 +5,8 @@
 #include "core/conversion/converters/converters.h"
 #include "core/conversion/evaluators/evaluators.h"
 #include "core/conversion/var/Var.h"
+#include "core/runtime/EngineRegistry.h"
+#include "core/util/calibration_cache.h"
 #include "core/util/prelude.h"
 
 namespace trtorch {
@@ -371,6 +373,62 @@ void ConvertBlockToNetDef(
   MarkOutputs(ctx, outputs);
 }
 
+util::calibration::CacheKey CalibrationCacheKey(
+    const torch::jit::Block* b,
+    const std::vector<InputRange>& input_ranges,
+    const GraphParams& static_params) {
+  util::calibration::CacheKey key;
+  // inputs() is not const, it does not modify the graph
+  auto g = const_cast<torch::jit::Graph*>(b->owningGraph());
+  // Debug names are part of the key, TensorRT keys the entries of the cache by
+  // tensor name and tensors are named after them. Source locations do not
+  // change the engine
+  key.graph_hash = util::calibration::HashGraph(g->toString(/*print_source_locations=*/false));
+  // Different weights calibrate differently. Weights can be hundreds of MB so
+  // they are hashed with the block hash used to key engines, not FNV-1a
+  for (auto in : g->inputs()) {
+    auto param = static_params.find(in);
+    if (param == static_params.end()) {
+      continue;
+    }
+    if (param->second.isTensor()) {
+      auto t = param->second.toTensor().to(at::kCPU).contiguous();
+      std::stringstream meta;
+      meta << t.scalar_type() << t.sizes();
+      auto m = meta.str();
+      key.graph_hash = util::calibration::HashBytes(key.graph_hash, m.data(), m.size());
+      auto weights = runtime::GetEngineKey(static_cast<const char*>(t.data_ptr()), t.nbytes());
+      uint64_t weights_hash[] = {weights.hash_lo, weights.hash_hi};
+      key.graph_hash = util::calibration::HashBytes(key.graph_hash, weights_hash, sizeof(weights_hash));
+    } else {
+      std::stringstream value;
+      value << param->second;
+      auto v = value.str();
+      key.graph_hash = util::calibration::HashBytes(key.graph_hash, v.data(), v.size());
+    }
+  }
+  std::stringstream specs;
+  auto dims = [&specs](const nvinfer1::Dims& d) {
+    specs << '(';
+    for (int i = 0; i < d.nbDims; i++) {
+      specs << (i ? "," : "") << d.d[i];
+    }
+    specs << ')';
+  };
+  for (size_t i = 0; i < input_ranges.size(); i++) {
+    const auto& range = input_ranges[i];
+    specs << (i ? " " : "") << '[';
+    dims(range.min);
+    specs << ';';
+    dims(range.opt);
+    specs << ';';
+    dims(range.max);
+    specs << ']';
+  }
+  key.input_specs = specs.str();
+  return key;
+}
+
 // Converts a already lowered block (blocks with no sub blocks) to
 // a serialized TensorRT engine that can be deserialized and run
 
@@ -378,7 +436,28 @@ void ConvertBlockToNetDef(
 std::string ConvertBlockToEngine(const torch::jit::Block* b, ConversionInfo build_info, GraphParams& static_params) {
   ConversionCtx ctx(build_info.engine_settings);
   ConvertBlockToNetDef(&ctx, b, build_info, static_params);
-  std::string engine = ctx.SerializeEngine();
+  // TensorRT calls the calibrator while building the engine, the key lets it
+  // reject caches generated for another graph or other input ranges
+  std::unique_ptr<util::calibration::ActiveKeyGuard> cache_key;
+  if (build_info.engine_settings.calibrator) {
+    cache_key = std::make_unique<util::calibration::ActiveKeyGuard>(
+        CalibrationCacheKey(b, build_info.input_ranges, static_params));
+  }
+  std::string engine;
+  try {
+    engine = ctx.SerializeEngine();
+  } catch (...) {
+    // A calibrator error can be why the build failed, it is the one to report
+    if (cache_key) {
+      cache_key->RethrowCalibratorError();
+    }
+    throw;
+  }
+  // Calibrators cannot throw through TensorRT, errors they ran into are raised
+  // here instead of returning an engine calibrated on part of the data
+  if (cache_key) {
+    cache_key->RethrowCalibratorError();
+  }
   return engine;
 }
 
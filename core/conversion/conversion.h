@@ -4,6 +4,7 @@
 
 #include "NvInfer.h"
 #include "core/conversion/conversionctx/ConversionCtx.h"
+#include "core/util/calibration_cache.h"
 #include "torch/csrc/jit/ir/ir.h"
 
 namespace trtorch {
@@ -38,6 +39,14 @@ GraphParams get_named_params(c10::ArrayRef<torch::jit::Value*> inputs, std::vect
 // a serialized TensorRT engine that can be deserialized and run
 std::string ConvertBlockToEngine(const torch::jit::Block* b, ConversionInfo build_info, GraphParams& static_params);
 
+// Identifies what a calibration cache for the engine built from b with
+// static_params is valid for, the algorithm is filled in by the calibrator.
+// Debug names and source locations of the graph are not part of the key
+util::calibration::CacheKey CalibrationCacheKey(
+    const torch::jit::Block* b,
+    const std::vector<InputRange>& input_ranges,
+    const GraphParams& static_params);
+
 bool OpSupported(const torch::jit::Node* n);
 
 bool VerifyConverterSupportForBlock(const torch::jit::Block* b);
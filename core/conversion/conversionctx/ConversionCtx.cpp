@@ -119,6 +119,7 @@ torch::jit::IValue* ConversionCtx::AssociateValueAndIValue(const torch::jit::Val
 
 std::string ConversionCtx::SerializeEngine() {
   auto engine = builder->buildEngineWithConfig(*net, *cfg);
+  TRTORCH_CHECK(engine, "Unable to build the TensorRT engine");
   auto serialized_engine = engine->serialize();
   engine->destroy();
   return std::string((const char*)serialized_engine->data(), serialized_engine->size());
@@ -1,3 +1,5 @@
+#include <mutex>
+
 #include "core/conversion/converters/converters.h"
 #include "core/util/prelude.h"
 #include "torch/csrc/jit/frontend/function_schema_parser.h"
@@ -43,20 +45,27 @@ std::string canonical_schema_string(const torch::jit::FunctionSchema& schema) {
 namespace {
 using ConverterLUT = std::unordered_map<c10::OperatorName, OpConverter>;
 
+// Patterns are registered by static objects in every converter file, so
+// registering only queues them. Schemas are parsed when converters are first
+// looked up (by a compile or a support check), not when the library is loaded
 class NodeConverterRegistry {
  public:
+  void QueueConverter(ConversionPattern p) {
+    std::lock_guard<std::mutex> lock(mu_);
+    pending_.push_back(std::move(p));
+  }
+
   bool RegisterConverter(torch::jit::FunctionSchema* signature, OpConverter& converter) {
-    LOG_DEBUG("Registering converter for " << canonical_schema_string(*signature));
-    auto name = signature->operator_name();
-    auto iter = converter_lut_.find(name);
-    if (iter != converter_lut_.end()) {
-      LOG_WARNING("Overriding already registered converter " << signature->name() << ", unexpected behavior may occur");
-    }
-    converter_lut_[name] = std::move(converter);
+    std::lock_guard<std::mutex> lock(mu_);
+    // Keeps the order of registration so later converters still override earlier ones
+    LoadPending();
+    Insert(*signature, std::move(converter));
     return true;
   }
 
   OpConverter GetConverter(const torch::jit::FunctionSchema* signature) {
+    std::lock_guard<std::mutex> lock(mu_);
+    LoadPending();
     auto name = signature->operator_name();
     auto iter = converter_lut_.find(name);
     if (iter == converter_lut_.end()) {
@@ -70,6 +79,8 @@ class NodeConverterRegistry {
   bool Convertable(const torch::jit::Node* n) {
     auto schema = n->maybeSchema();
     if (schema) {
+      std::lock_guard<std::mutex> lock(mu_);
+      LoadPending();
       auto name = schema->operator_name();
       auto iter = converter_lut_.find(name);
       if (iter == converter_lut_.end()) {
@@ -84,6 +95,33 @@ class NodeConverterRegistry {
   }
 
  private:
+  void Insert(const torch::jit::FunctionSchema& signature, OpConverter converter) {
+    LOG_DEBUG("Registering converter for " << canonical_schema_string(signature));
+    auto name = signature.operator_name();
+    auto iter = converter_lut_.find(name);
+    if (iter != converter_lut_.end()) {
+      LOG_WARNING("Overriding already registered converter " << signature.name() << ", unexpected behavior may occur");
+    }
+    converter_lut_[name] = std::move(converter);
+  }
+
+  void LoadPending() {
+    if (pending_.empty()) {
+      return;
+    }
+    for (auto& p : pending_) {
+      // A malformed schema used to abort loading the library, now it only loses its converter
+      try {
+        Insert(torch::jit::parseSchema(p.signature), std::move(p.converter));
+      } catch (const std::exception& e) {
+        LOG_ERROR("Skipping converter with invalid schema " << p.signature << ": " << e.what());
+      }
+    }
+    pending_.clear();
+  }
+
+  std::mutex mu_;
+  std::vector<ConversionPattern> pending_;
   ConverterLUT converter_lut_;
 };
 
@@ -98,13 +136,11 @@ void register_node_converter(torch::jit::FunctionSchema* signature, OpConverter&
 }
 
 void register_node_converter(std::string signature, OpConverter& converter) {
-  auto schema = torch::jit::parseSchema(signature);
-  // TODO: CHECKING THIS IS A VALID SCHEMA AND QUITING IF NOT
-  register_node_converter(&schema, converter);
+  register_node_converter({std::move(signature), converter});
 }
 
 void register_node_converter(ConversionPattern p) {
-  register_node_converter(p.signature, p.converter);
+  get_converter_registry().QueueConverter(std::move(p));
 }
 
 OpConverter get_node_converter_for(const torch::jit::FunctionSchema* signature) {
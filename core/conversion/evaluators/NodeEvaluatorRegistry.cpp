@@ -1,9 +1,11 @@
+#include <mutex>
 #include <unordered_map>
 
 #include "ATen/core/List.h"
 #include "ATen/core/functional.h"
 #include "ATen/core/ivalue.h"
 #include "ATen/core/stack.h"
+#include "torch/csrc/jit/frontend/function_schema_parser.h"
 #include "torch/csrc/jit/ir/constants.h"
 #include "torch/csrc/jit/ir/ir.h"
 
@@ -29,6 +31,7 @@ bool FindInVec(std::vector<c10::OperatorName>& names, c10::OperatorName target)
 class NodeEvaluatorRegistry {
  public:
   void RegisterEvaluator(torch::jit::NodeKind node_kind, EvalRegistration eval_reg) {
+    std::lock_guard<std::mutex> lock(mu_);
     LOG_DEBUG("Registering evaluator for " << node_kind.toQualString());
     auto iter = evaluator_lut_.find(node_kind);
     if (iter != evaluator_lut_.end()) {
@@ -41,11 +44,16 @@ class NodeEvaluatorRegistry {
 
   NodeEvaluator FindEvaluator(const torch::jit::Node* n) {
     auto node_kind = n->kind();
-    auto iter = evaluator_lut_.find(node_kind);
-    if (iter == evaluator_lut_.end()) {
-      return nullptr;
+    EvalRegistration eval_reg;
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      auto iter = evaluator_lut_.find(node_kind);
+      if (iter == evaluator_lut_.end()) {
+        return nullptr;
+      }
+      ResolveSchemas(iter->second.options);
+      eval_reg = iter->second;
     }
-    auto eval_reg = iter->second;
     if (eval_reg.options.use()) {
       for (auto o : n->outputs()) {
         if (eval_reg.options.blacklisted_output_types.find(o->type()) !=
@@ -86,6 +94,22 @@ class NodeEvaluatorRegistry {
   }
 
  private:
+  // Evaluators are registered by static objects, their schemas are parsed on
+  // first use rather than while the library loads. Parsed into a copy so a
+  // schema which fails to parse leaves options as they were
+  void ResolveSchemas(EvalOptions& options) {
+    if (options.valid_schema_strings.empty()) {
+      return;
+    }
+    auto valid_schemas = options.valid_schemas;
+    for (const auto& s : options.valid_schema_strings) {
+      valid_schemas.push_back(torch::jit::parseSchema(s).operator_name());
+    }
+    options.valid_schemas = std::move(valid_schemas);
+    options.valid_schema_strings.clear();
+  }
+
+  std::mutex mu_;
   EvaluatorLUT evaluator_lut_;
 };
 
@@ -37,6 +37,9 @@ typedef std::function<c10::optional<torch::jit::IValue>(const torch::jit::Node*,
 
 struct EvalOptions {
   std::set<c10::TypePtr> blacklisted_output_types;
+  // Schemas are kept as strings until the evaluator is first looked up, the
+  // registry then parses them into valid_schemas
+  std::set<std::string> valid_schema_strings;
   std::vector<c10::OperatorName> valid_schemas;
   EvalOptions() = default;
   EvalOptions& blacklistOutputTypes(std::set<c10::TypePtr> types) {
@@ -46,9 +49,7 @@ struct EvalOptions {
   }
   EvalOptions& validSchemas(std::set<std::string> schemas) {
     use_options = true;
-    for (auto s : schemas) {
-      valid_schemas.push_back(torch::jit::parseSchema(s).operator_name());
-    }
+    valid_schema_strings = std::move(schemas);
     return *this;
   }
   bool use() {
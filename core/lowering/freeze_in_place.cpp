@@ -0,0 +1,182 @@
+#include <algorithm>
+#include <functional>
+#include <unordered_set>
+#include <vector>
+
+#include "torch/csrc/jit/ir/constants.h"
+#include "torch/csrc/jit/passes/constant_propagation.h"
+#include "torch/csrc/jit/passes/dead_code_elimination.h"
+#include "torch/csrc/jit/passes/inliner.h"
+
+#include "core/lowering/lowering.h"
+#include "core/util/prelude.h"
+
+namespace trtorch {
+namespace core {
+namespace lowering {
+namespace {
+
+// Value read by a chain of prim::GetAttr starting at self, nullopt for
+// anything else
+c10::optional<torch::jit::IValue> ResolveAttr(
+    const torch::jit::Value* v,
+    const torch::jit::Value* self,
+    const torch::jit::script::Module& mod) {
+  if (v == self) {
+    return torch::jit::IValue(mod._ivalue());
+  }
+  auto n = v->node();
+  if (n->kind() != torch::jit::prim::GetAttr) {
+    return c10::nullopt;
+  }
+  auto owner = ResolveAttr(n->input(), self, mod);
+  if (!owner || !owner->isObject()) {
+    return c10::nullopt;
+  }
+  return owner->toObject()->getAttr(n->s(torch::jit::attr::name));
+}
+
+using ValueSet = std::unordered_set<const torch::jit::Value*>;
+
+bool AnyIn(c10::ArrayRef<torch::jit::Value*> values, const ValueSet& set) {
+  return std::any_of(values.begin(), values.end(), [&set](const torch::jit::Value* v) { return set.count(v); });
+}
+
+// Whether a node in b may write to a value which shares storage with state
+// read from the module. attr_aliases collects those values: outputs of
+// prim::GetAttr and of nodes which may return an alias of one of them (views
+// such as view or select, list and tuple ops, control flow), so writes through
+// a chain of views (e.g. self.w[0].mul_(2)) are found too
+bool WritesAttr(torch::jit::Block* b, ValueSet& attr_aliases) {
+  for (auto n : b->nodes()) {
+    if (n->kind() == torch::jit::prim::GetAttr) {
+      attr_aliases.insert(n->output());
+      continue;
+    }
+
+    bool reads_attr = AnyIn(n->inputs(), attr_aliases);
+    for (auto sub_block : n->blocks()) {
+      // Loop carried values may alias state from the second iteration on, so
+      // the body is visited again once its outputs are found to
+      bool carried = n->kind() == torch::jit::prim::Loop && reads_attr;
+      if (carried) {
+        attr_aliases.insert(sub_block->inputs().begin(), sub_block->inputs().end());
+      }
+      if (WritesAttr(sub_block, attr_aliases)) {
+        return true;
+      }
+      if (n->kind() == torch::jit::prim::Loop && !carried && AnyIn(sub_block->outputs(), attr_aliases)) {
+        attr_aliases.insert(sub_block->inputs().begin(), sub_block->inputs().end());
+        if (WritesAttr(sub_block, attr_aliases)) {
+          return true;
+        }
+      }
+      reads_attr |= AnyIn(sub_block->outputs(), attr_aliases);
+    }
+    if (!reads_attr) {
+      continue;
+    }
+
+    // Without a schema there is no alias information, outputs are assumed to
+    // alias the inputs
+    auto schema = n->maybeSchema();
+    if (!schema) {
+      attr_aliases.insert(n->outputs().begin(), n->outputs().end());
+      continue;
+    }
+    const auto& args = schema->arguments();
+    for (size_t i = 0; i < n->inputs().size() && i < args.size(); i++) {
+      auto alias = args[i].alias_info();
+      if (alias && alias->isWrite() && attr_aliases.count(n->inputs()[i])) {
+        return true;
+      }
+    }
+    const auto& returns = schema->returns();
+    for (size_t i = 0; i < n->outputs().size() && i < returns.size(); i++) {
+      if (returns[i].alias_info()) {
+        attr_aliases.insert(n->outputs()[i]);
+      }
+    }
+  }
+  return false;
+}
+
+// Graph constant for an attribute. Tensors are detached, which shares their
+// storage, so the constant aliases the module's tensor instead of copying it
+c10::optional<torch::jit::Value*> InsertAttrConstant(torch::jit::Graph& g, const torch::jit::IValue& value) {
+  if (value.isTensor()) {
+    return torch::jit::tryInsertConstant(g, value.toTensor().detach());
+  }
+  if (value.isTensorList()) {
+    c10::List<at::Tensor> detached;
+    for (const at::Tensor& t : value.toTensorList()) {
+      detached.push_back(t.detach());
+    }
+    return torch::jit::tryInsertConstant(g, detached);
+  }
+  return torch::jit::tryInsertConstant(g, value);
+}
+
+} // namespace
+
+std::shared_ptr<torch::jit::Graph> FreezeMethodInPlace(
+    const torch::jit::script::Module& mod,
+    const std::string& method_name) {
+  TRTORCH_CHECK(
+      !mod.hasattr("training") || !mod.is_training(), "Modules have to be in eval mode to be frozen (call eval())");
+  auto g = mod.get_method(method_name).graph()->copy();
+  torch::jit::Inline(*g);
+  auto self = g->inputs()[0];
+
+  std::vector<torch::jit::Node*> get_attrs;
+  bool supported = true;
+  std::function<void(torch::jit::Block*)> visit = [&](torch::jit::Block* b) {
+    for (auto n : b->nodes()) {
+      auto kind = n->kind();
+      if (kind == torch::jit::prim::SetAttr || kind == torch::jit::prim::CallMethod) {
+        supported = false;
+      } else if (kind == torch::jit::prim::GetAttr) {
+        get_attrs.push_back(n);
+      }
+      for (auto sub_block : n->blocks()) {
+        visit(sub_block);
+      }
+    }
+  };
+  visit(g->block());
+  ValueSet attr_aliases;
+  if (!supported || WritesAttr(g->block(), attr_aliases)) {
+    LOG_DEBUG(method_name << " writes to module state or calls methods which cannot be inlined");
+    return nullptr;
+  }
+
+  // Nodes were collected in order, so modules read by a GetAttr are resolved
+  // before the attributes read from them
+  for (auto n : get_attrs) {
+    auto value = ResolveAttr(n->output(), self, mod);
+    if (!value) {
+      LOG_DEBUG("Unable to resolve attribute " << n->s(torch::jit::attr::name) << " of " << method_name);
+      return nullptr;
+    }
+    if (value->isObject()) {
+      continue;
+    }
+    torch::jit::WithInsertPoint guard(n);
+    auto constant = InsertAttrConstant(*g, *value);
+    if (!constant) {
+      LOG_DEBUG("Attribute " << n->s(torch::jit::attr::name) << " of " << method_name << " cannot be a constant");
+      return nullptr;
+    }
+    n->output()->replaceAllUsesWith(*constant);
+  }
+
+  torch::jit::EliminateDeadCode(g);
+  // Folds branches on attributes, e.g. self.training
+  torch::jit::ConstantPropagation(g);
+  LOG_GRAPH("Frozen " << method_name << " in place: " << *g);
+  return g;
+}
+
+} // namespace lowering
+} // namespace core
+} // namespace trtorch
@@ -55,11 +55,20 @@ torch::jit::Module LowerModule(const torch::jit::script::Module& mod) {
   return mod_;
 }
 
-std::pair<std::shared_ptr<torch::jit::Graph>, std::vector<torch::jit::IValue>> Lower(
-    const torch::jit::script::Module& mod,
-    std::string method_name) {
-  auto lowered_mod = LowerModule(mod);
-  auto g = lowered_mod.get_method(method_name).graph();
+namespace {
+LoweredMethod LowerMethod(const torch::jit::script::Module& mod, std::string method_name, const LowerInfo& info) {
+  auto lowered_mod = mod;
+  std::shared_ptr<torch::jit::Graph> g;
+  if (info.freeze_in_place) {
+    g = FreezeMethodInPlace(mod, method_name);
+    if (!g) {
+      LOG_WARNING("Unable to freeze " << method_name << " in place, freezing a copy of the module instead");
+    }
+  }
+  if (!g) {
+    lowered_mod = LowerModule(mod);
+    g = lowered_mod.get_method(method_name).graph();
+  }
   LOG_GRAPH(*g);
 
   // Go through TRTorch Lowering to reformat graph to be conversion friendly
@@ -74,6 +83,15 @@ std::pair<std::shared_ptr<torch::jit::Graph>, std::vector<torch::jit::IValue>> L
 
   return graph_and_ivalues;
 }
+} // namespace
+
+LoweredMethod Lower(const torch::jit::script::Module& mod, std::string method_name, const LowerInfo& info) {
+  if (info.cache) {
+    return info.cache->Get(
+        mod, method_name, info.freeze_in_place, [&]() { return LowerMethod(mod, method_name, info); });
+  }
+  return LowerMethod(mod, method_name, info);
+}
 
 } // namespace lowering
 } // namespace core
@@ -1,17 +1,73 @@
 #pragma once
+#include <functional>
+#include <future>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include "torch/csrc/jit/api/module.h"
 #include "torch/csrc/jit/ir/ir.h"
 
 namespace trtorch {
 namespace core {
 namespace lowering {
 
+using LoweredMethod = std::pair<std::shared_ptr<torch::jit::Graph>, std::vector<torch::jit::IValue>>;
+
+// Lowered methods keyed by module, method and freezing mode. Lowering does not
+// depend on the engine settings, so compiling one module with several specs
+// through the same cache lowers each method once. The graphs are shared and
+// must not be modified. Entries keep their module alive until Clear
+class LoweringCache {
+ public:
+  // Cached result for the method, otherwise runs lower. Concurrent calls for
+  // the same method wait for the first one instead of lowering again. Errors
+  // are cached too since lowering the same method again would fail the same way
+  LoweredMethod Get(
+      const torch::jit::script::Module& mod,
+      const std::string& method_name,
+      bool freeze_in_place,
+      const std::function<LoweredMethod()>& lower);
+  // Number of methods lowered so far
+  size_t lowered_methods() const;
+  void Clear();
+
+ private:
+  using Key = std::tuple<const void*, std::string, bool>;
+  struct Entry {
+    // Keeps the module from being freed and its address reused by another
+    c10::intrusive_ptr<c10::ivalue::Object> module;
+    std::shared_future<LoweredMethod> lowered;
+  };
+
+  mutable std::mutex mu_;
+  std::map<Key, Entry> entries_;
+  size_t lowered_methods_ = 0;
+};
+
+struct LowerInfo {
+  // Freeze with FreezeMethodInPlace instead of cloning the module, falls back
+  // to torch::jit::freeze_module for methods it does not support
+  bool freeze_in_place = false;
+  // Reuse methods lowered for an earlier compilation of the same module
+  std::shared_ptr<LoweringCache> cache;
+};
+
 void LowerBlock(torch::jit::Block* b);
 void LowerGraph(std::shared_ptr<torch::jit::Graph>& g);
 torch::jit::Module LowerModule(const torch::jit::script::Module& mod);
-std::pair<std::shared_ptr<torch::jit::Graph>, std::vector<torch::jit::IValue>> Lower(
+// Inlined graph of method_name with the module attributes it reads folded in
+// as constants. Unlike torch::jit::freeze_module the module is not cloned, the
+// constants alias its tensors, so they must not be modified while the graph is
+// in use. Returns nullptr for methods which write to module state
+std::shared_ptr<torch::jit::Graph> FreezeMethodInPlace(
+    const torch::jit::script::Module& mod,
+    const std::string& method_name);
+LoweredMethod Lower(
     const torch::jit::script::Module& mod,
-    std::string method_name);
+    std::string method_name,
+    const LowerInfo& info = LowerInfo());
 
 } // namespace lowering
 } // namespace core
@@ -0,0 +1,55 @@
+#include "core/lowering/lowering.h"
+#include "core/util/prelude.h"
+
+namespace trtorch {
+namespace core {
+namespace lowering {
+
+LoweredMethod LoweringCache::Get(
+    const torch::jit::script::Module& mod,
+    const std::string& method_name,
+    bool freeze_in_place,
+    const std::function<LoweredMethod()>& lower) {
+  Key key(mod._ivalue().get(), method_name, freeze_in_place);
+  std::promise<LoweredMethod> promise;
+  std::shared_future<LoweredMethod> lowered;
+  bool owner = false;
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+      lowered = promise.get_future().share();
+      entries_.emplace(key, Entry{mod._ivalue(), lowered});
+      lowered_methods_++;
+      owner = true;
+    } else {
+      lowered = it->second.lowered;
+    }
+  }
+
+  if (owner) {
+    // Lowered outside of the lock so other modules and methods are not held up
+    try {
+      promise.set_value(lower());
+    } catch (...) {
+      promise.set_exception(std::current_exception());
+    }
+  } else {
+    LOG_DEBUG("Reusing the lowered graph of " << method_name);
+  }
+  return lowered.get();
+}
+
+size_t LoweringCache::lowered_methods() const {
+  std::lock_guard<std::mutex> lock(mu_);
+  return lowered_methods_;
+}
+
+void LoweringCache::Clear() {
+  std::lock_guard<std::mutex> lock(mu_);
+  entries_.clear();
+}
+
+} // namespace lowering
+} // namespace core
+} // namespace trtorch
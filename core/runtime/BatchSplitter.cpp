@@ -0,0 +1,88 @@
+#include <algorithm>
+
+#include "core/runtime/BatchSplitter.h"
+#include "core/util/prelude.h"
+
+namespace trtorch {
+namespace core {
+namespace runtime {
+
+std::vector<BatchChunk> PlanBatchChunks(int64_t batch, int64_t max_batch) {
+  TRTORCH_CHECK(max_batch > 0, "Batches can only be split into chunks of at least one element");
+  std::vector<BatchChunk> chunks;
+  chunks.reserve(static_cast<size_t>((batch + max_batch - 1) / max_batch));
+  for (int64_t offset = 0; offset < batch; offset += max_batch) {
+    chunks.push_back({offset, std::min(max_batch, batch - offset)});
+  }
+  return chunks;
+}
+
+int64_t OversizedBatch(const std::vector<at::Tensor>& inputs, int64_t max_batch) {
+  if (max_batch <= 0) {
+    return 0;
+  }
+  bool oversized = false;
+  for (const auto& in : inputs) {
+    oversized |= in.dim() > 0 && in.size(0) > max_batch;
+  }
+  if (!oversized) {
+    return 0;
+  }
+
+  auto batch = inputs[0].dim() > 0 ? inputs[0].size(0) : -1;
+  for (size_t i = 0; i < inputs.size(); i++) {
+    TRTORCH_CHECK(
+        inputs[i].dim() > 0 && inputs[i].size(0) == batch,
+        "Cannot split inputs larger than the engine's max batch size ("
+            << max_batch << ") since they do not share their leading dimension (input 0: " << inputs[0].sizes()
+            << ", input " << i << ": " << inputs[i].sizes() << ")");
+  }
+  return batch;
+}
+
+std::vector<at::Tensor> RunInChunks(
+    const std::vector<at::Tensor>& inputs,
+    int64_t max_batch,
+    const ChunkExecutor& executor) {
+  TRTORCH_CHECK(!inputs.empty() && inputs[0].dim() > 0, "Expected batched inputs to split");
+  auto batch = inputs[0].size(0);
+  auto chunks = PlanBatchChunks(batch, max_batch);
+
+  auto slice = [](const std::vector<at::Tensor>& tensors, const BatchChunk& chunk) {
+    std::vector<at::Tensor> sliced;
+    sliced.reserve(tensors.size());
+    for (const auto& t : tensors) {
+      sliced.push_back(t.narrow(0, chunk.offset, chunk.size));
+    }
+    return sliced;
+  };
+
+  // Shapes of the whole batch are derived from the first chunk, which is the
+  // largest one
+  auto first = slice(inputs, chunks[0]);
+  auto specs = executor.describe_outputs(first);
+  std::vector<at::Tensor> outputs;
+  outputs.reserve(specs.size());
+  for (size_t o = 0; o < specs.size(); o++) {
+    auto shape = specs[o].shape;
+    TRTORCH_CHECK(
+        !shape.empty() && shape[0] == chunks[0].size,
+        "Cannot split the batch across engine executions since output "
+            << o << " is not batched along its leading dimension (shape " << c10::IntArrayRef(shape)
+            << " for a chunk of " << chunks[0].size << ")");
+    shape[0] = batch;
+    outputs.push_back(at::empty(shape, at::TensorOptions().dtype(specs[o].type).device(inputs[0].device())));
+  }
+
+  for (const auto& chunk : chunks) {
+    auto chunk_inputs = slice(inputs, chunk);
+    // Slices along the leading dimension of contiguous tensors are contiguous
+    auto chunk_outputs = slice(outputs, chunk);
+    executor.run(chunk_inputs, chunk_outputs);
+  }
+  return outputs;
+}
+
+} // namespace runtime
+} // namespace core
+} // namespace trtorch
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "ATen/ATen.h"
+
+namespace trtorch {
+namespace core {
+namespace runtime {
+
+// Range of the leading (batch) dimension covered by one chunk
+struct BatchChunk {
+  int64_t offset;
+  int64_t size;
+};
+
+// Splits a batch into consecutive chunks of max_batch, the last chunk holds the
+// remainder
+std::vector<BatchChunk> PlanBatchChunks(int64_t batch, int64_t max_batch);
+
+// Returns the leading dimension of the inputs if any of them exceeds
+// max_batch, 0 if they all fit (or max_batch is 0). Inputs can only be split if
+// they share their leading dimension, an error is raised otherwise
+int64_t OversizedBatch(const std::vector<at::Tensor>& inputs, int64_t max_batch);
+
+struct OutputSpec {
+  std::vector<int64_t> shape;
+  at::ScalarType type;
+};
+
+// What RunInChunks needs from whatever runs the engine
+struct ChunkExecutor {
+  // Shapes and types of the outputs produced for a chunk of the inputs
+  std::function<std::vector<OutputSpec>(const std::vector<at::Tensor>& chunk)> describe_outputs;
+  // Runs a chunk, writing the results into outputs (contiguous views of the
+  // final outputs). May return before the results are written as long as
+  // later chunks are ordered after it (e.g. enqueued on the same stream)
+  std::function<void(std::vector<at::Tensor>& chunk, std::vector<at::Tensor>& outputs)> run;
+};
+
+// Runs inputs in chunks of at most max_batch along the leading dimension. The
+// outputs for the whole batch are allocated up front (on the device of the
+// inputs) and each chunk writes its part directly, so outputs must be batched
+// along their leading dimension as well
+std::vector<at::Tensor> RunInChunks(
+    const std::vector<at::Tensor>& inputs,
+    int64_t max_batch,
+    const ChunkExecutor& executor);
+
+} // namespace runtime
+} // namespace core
+} // namespace trtorch
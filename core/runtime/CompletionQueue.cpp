@@ -0,0 +1,111 @@
+#include "core/runtime/CompletionQueue.h"
+
+namespace trtorch {
+namespace core {
+namespace runtime {
+
+CompletionQueue::CompletionQueue(size_t max_in_flight) : state_(std::make_shared<State>()) {
+  state_->max_in_flight = max_in_flight;
+}
+
+CompletionQueue::~CompletionQueue() {
+  {
+    std::unique_lock<std::mutex> lock(state_->mu);
+    state_->shutdown = true;
+  }
+  state_->work_available.notify_all();
+  if (worker_.joinable()) {
+    if (worker_.get_id() == std::this_thread::get_id()) {
+      worker_.detach();
+    } else {
+      worker_.join();
+    }
+  }
+}
+
+CompletionQueue::Reservation::~Reservation() {
+  if (state_) {
+    Release(*state_);
+  }
+}
+
+CompletionQueue::Reservation CompletionQueue::Reserve() {
+  std::unique_lock<std::mutex> lock(state_->mu);
+  if (state_->max_in_flight > 0) {
+    state_->entry_finished.wait(lock, [this] { return state_->in_flight < state_->max_in_flight; });
+  }
+  state_->in_flight++;
+  return Reservation(state_);
+}
+
+void CompletionQueue::Submit(Reservation slot, WaitFn wait, DoneFn done) {
+  {
+    std::unique_lock<std::mutex> lock(state_->mu);
+    if (!worker_.joinable()) {
+      worker_ = std::thread(&CompletionQueue::Run, state_);
+    }
+    state_->queue.push_back({std::move(wait), std::move(done)});
+    // The slot is released by the worker once the entry has finished
+    slot.state_.reset();
+  }
+  state_->work_available.notify_one();
+}
+
+void CompletionQueue::Submit(WaitFn wait, DoneFn done) {
+  Submit(Reserve(), std::move(wait), std::move(done));
+}
+
+void CompletionQueue::Release(State& state) {
+  {
+    std::unique_lock<std::mutex> lock(state.mu);
+    state.in_flight--;
+  }
+  state.entry_finished.notify_all();
+}
+
+void CompletionQueue::Drain() {
+  std::unique_lock<std::mutex> lock(state_->mu);
+  state_->entry_finished.wait(lock, [this] { return state_->in_flight == 0; });
+}
+
+size_t CompletionQueue::InFlight() {
+  std::unique_lock<std::mutex> lock(state_->mu);
+  return state_->in_flight;
+}
+
+void CompletionQueue::Run(std::shared_ptr<State> state) {
+  while (true) {
+    Entry entry;
+    {
+      std::unique_lock<std::mutex> lock(state->mu);
+      state->work_available.wait(lock, [&state] { return state->shutdown || !state->queue.empty(); });
+      if (state->queue.empty()) {
+        // Only reached on shutdown once everything submitted has finished
+        return;
+      }
+      entry = std::move(state->queue.front());
+      state->queue.pop_front();
+    }
+
+    std::exception_ptr error = nullptr;
+    try {
+      entry.wait();
+    } catch (...) {
+      error = std::current_exception();
+    }
+    // Exceptions thrown by the completion itself have no one to report to, the
+    // done callback is expected to handle its own errors
+    try {
+      entry.done(error);
+    } catch (...) {
+    }
+    // Release anything captured by the entry (e.g. input and output tensors)
+    // before reporting it as finished. This may destroy the queue object
+    entry = Entry();
+    Release(*state);
+  }
+}
+
+} // namespace runtime
+} // namespace core
+} // namespace trtorch
@@ -0,0 +1,89 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace trtorch {
+namespace core {
+namespace runtime {
+
+// Finishes asynchronous engine executions off of the calling thread. Each
+// entry pairs a blocking wait on work that has already been enqueued on a
+// device (e.g. a CUDA event synchronize) with the work to run once it is done
+// (e.g. completing a future). Entries finish in submission order on a single
+// background thread which is started on first use.
+class CompletionQueue {
+  struct State;
+
+ public:
+  using WaitFn = std::function<void()>;
+  // Called with nullptr on success or the exception thrown by the wait
+  using DoneFn = std::function<void(std::exception_ptr)>;
+
+  // One of the max_in_flight slots, held from before the work is enqueued
+  // until its entry finishes. Given back if it is dropped without submitting
+  class Reservation {
+   public:
+    Reservation(Reservation&& other) noexcept : state_(std::move(other.state_)) {}
+    Reservation& operator=(Reservation&&) = delete;
+    Reservation(const Reservation&) = delete;
+    ~Reservation();
+
+   private:
+    friend class CompletionQueue;
+    explicit Reservation(std::shared_ptr<State> state) : state_(std::move(state)) {}
+    std::shared_ptr<State> state_;
+  };
+
+  // Reserve blocks while max_in_flight slots are taken (0: unbounded)
+  explicit CompletionQueue(size_t max_in_flight = 0);
+  // Finishes all pending entries before returning. When called from the
+  // worker thread itself (e.g. a completion drops the last reference to the
+  // queue's owner) the worker finishes the pending entries on its own instead
+  ~CompletionQueue();
+
+  CompletionQueue(const CompletionQueue&) = delete;
+  CompletionQueue& operator=(const CompletionQueue&) = delete;
+
+  // Takes a slot, to be called before enqueuing the work on the device so
+  // that the limit bounds the work (and memory) in flight there
+  Reservation Reserve();
+  void Submit(Reservation slot, WaitFn wait, DoneFn done);
+  // Reserves and submits, for work which is already on the device
+  void Submit(WaitFn wait, DoneFn done);
+  // Blocks until every submitted entry has finished
+  void Drain();
+  size_t InFlight();
+
+ private:
+  struct Entry {
+    WaitFn wait;
+    DoneFn done;
+  };
+  // Shared with the worker thread so it can outlive the queue object
+  struct State {
+    size_t max_in_flight;
+    // Reserved slots: work being enqueued, entries waiting in the queue or
+    // being finished by the worker
+    size_t in_flight = 0;
+    bool shutdown = false;
+    std::deque<Entry> queue;
+    std::mutex mu;
+    std::condition_variable work_available;
+    std::condition_variable entry_finished;
+  };
+
+  static void Run(std::shared_ptr<State> state);
+  static void Release(State& state);
+
+  std::shared_ptr<State> state_;
+  std::thread worker_;
+};
+
+} // namespace runtime
+} // namespace core
+} // namespace trtorch
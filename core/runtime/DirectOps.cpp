@@ -0,0 +1,82 @@
+#include <sstream>
+
+#include "core/runtime/DirectOps.h"
+#include "core/util/prelude.h"
+
+namespace trtorch {
+namespace core {
+namespace runtime {
+namespace {
+
+std::string direct_schema(
+    const std::string& op,
+    const std::string& engine_type,
+    size_t num_inputs,
+    size_t num_outputs) {
+  std::stringstream ss;
+  ss << DirectOpName(op, num_inputs, num_outputs) << '(';
+  for (size_t i = 0; i < num_inputs; i++) {
+    ss << "Tensor input_" << i << ", ";
+  }
+  ss << engine_type << " engine) -> ";
+  if (num_outputs == 1) {
+    ss << "Tensor";
+  } else {
+    ss << '(';
+    for (size_t i = 0; i < num_outputs; i++) {
+      ss << (i ? ", " : "") << "Tensor";
+    }
+    ss << ')';
+  }
+  return ss.str();
+}
+
+} // namespace
+
+std::string DirectOpName(const std::string& op, size_t num_inputs, size_t num_outputs) {
+  return op + '_' + std::to_string(num_inputs) + "in_" + std::to_string(num_outputs) + "out";
+}
+
+bool HasDirectOp(size_t num_inputs, size_t num_outputs) {
+  return num_inputs > 0 && num_inputs <= kMaxDirectInputs && num_outputs > 0 && num_outputs <= kMaxDirectOutputs;
+}
+
+std::vector<torch::jit::Operator> MakeDirectOperators(
+    const std::string& op,
+    const std::string& engine_type,
+    DirectEngineFn fn) {
+  std::vector<torch::jit::Operator> ops;
+  for (size_t num_inputs = 1; num_inputs <= kMaxDirectInputs; num_inputs++) {
+    for (size_t num_outputs = 1; num_outputs <= kMaxDirectOutputs; num_outputs++) {
+      ops.emplace_back(
+          direct_schema(op, engine_type, num_inputs, num_outputs),
+          [fn, num_inputs, num_outputs](torch::jit::Stack& stack) {
+            // Arguments are the last num_inputs + 1 entries of the stack, the
+            // input tensors are moved out of them rather than copied
+            auto first = stack.end() - (num_inputs + 1);
+            std::vector<at::Tensor> inputs;
+            inputs.reserve(num_inputs);
+            for (auto it = first; it != stack.end() - 1; ++it) {
+              inputs.push_back(std::move(*it).toTensor());
+            }
+            auto engine = std::move(stack.back());
+            stack.erase(first, stack.end());
+
+            auto outputs = fn(std::move(inputs), engine);
+            TRTORCH_CHECK(
+                outputs.size() == num_outputs,
+                "Expected the engine to produce " << num_outputs << " outputs, it produced " << outputs.size());
+            for (auto& out : outputs) {
+              stack.emplace_back(std::move(out));
+            }
+            return 0;
+          },
+          c10::AliasAnalysisKind::FROM_SCHEMA);
+    }
+  }
+  return ops;
+}
+
+} // namespace runtime
+} // namespace core
+} // namespace trtorch
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "ATen/ATen.h"
+#include "torch/csrc/jit/runtime/operator.h"
+
+namespace trtorch {
+namespace core {
+namespace runtime {
+
+// Engine ops with a fixed number of tensor inputs and outputs, e.g.
+//   tensorrt::execute_engine_2in_1out(Tensor input_0, Tensor input_1, Engine engine) -> Tensor
+// The interpreter hands the input tensors to the op directly on the stack and
+// takes the outputs from it, instead of building a Tensor[] for the inputs and
+// unpacking a Tensor[] of outputs around every call. Only common arities are
+// registered (16 schemas) to keep library load cheap, engines with more inputs
+// or outputs use the list based op
+constexpr size_t kMaxDirectInputs = 4;
+constexpr size_t kMaxDirectOutputs = 4;
+
+// Runs the engine (the last argument of the op, as an IValue) on the inputs
+using DirectEngineFn =
+    std::function<std::vector<at::Tensor>(std::vector<at::Tensor> inputs, const c10::IValue& engine)>;
+
+// Qualified name of the variant of op for num_inputs and num_outputs
+std::string DirectOpName(const std::string& op, size_t num_inputs, size_t num_outputs);
+
+// Whether there is a direct variant of an op for the number of inputs and
+// outputs
+bool HasDirectOp(size_t num_inputs, size_t num_outputs);
+
+// Operators for every variant of op up to the limits above, taking the engine
+// as an argument of engine_type and running it with fn
+std::vector<torch::jit::Operator> MakeDirectOperators(
+    const std::string& op,
+    const std::string& engine_type,
+    DirectEngineFn fn);
+
+} // namespace runtime
+} // namespace core
+} // namespace trtorch
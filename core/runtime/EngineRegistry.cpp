@@ -0,0 +1,111 @@
+#include <cstring>
+
+#include "core/runtime/EngineRegistry.h"
+
+namespace trtorch {
+namespace core {
+namespace runtime {
+
+namespace {
+// xxHash64 style mixing over 32 byte stripes, fast enough to hash engines of
+// several hundred MB in a fraction of the time it takes to deserialize them
+constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ull;
+constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4Full;
+constexpr uint64_t kPrime3 = 0x165667B19E3779F9ull;
+constexpr uint64_t kPrime4 = 0x85EBCA77C2B2AE63ull;
+constexpr uint64_t kPrime5 = 0x27D4EB2F165667C5ull;
+
+inline uint64_t rotl(uint64_t v, int r) {
+  return (v << r) | (v >> (64 - r));
+}
+
+inline uint64_t read64(const char* p) {
+  uint64_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline uint64_t hash_round(uint64_t acc, uint64_t input) {
+  return rotl(acc + input * kPrime2, 31) * kPrime1;
+}
+
+inline uint64_t merge(uint64_t acc, uint64_t lane) {
+  return (acc ^ hash_round(0, lane)) * kPrime1 + kPrime4;
+}
+
+// Mixes the bytes past the last full stripe into h and avalanches it
+uint64_t finalize(uint64_t h, const char* p, const char* end, size_t size) {
+  h += static_cast<uint64_t>(size);
+  for (; p + 8 <= end; p += 8) {
+    h = rotl(h ^ hash_round(0, read64(p)), 27) * kPrime1 + kPrime4;
+  }
+  for (; p < end; p++) {
+    h = rotl(h ^ (static_cast<uint8_t>(*p) * kPrime5), 11) * kPrime1;
+  }
+
+  h ^= h >> 33;
+  h *= kPrime2;
+  h ^= h >> 29;
+  h *= kPrime3;
+  h ^= h >> 32;
+  return h;
+}
+} // namespace
+
+EngineKey GetEngineKey(const char* data, size_t size) {
+  const char* p = data;
+  const char* end = data + size;
+  // The two halves of the hash share the pass over the stripes and are
+  // finalized from the lanes in opposite orders
+  uint64_t lo;
+  uint64_t hi;
+
+  if (size >= 32) {
+    uint64_t lanes[4] = {kPrime1 + kPrime2, kPrime2, 0, 0 - kPrime1};
+    for (; p + 32 <= end; p += 32) {
+      for (int l = 0; l < 4; l++) {
+        lanes[l] = hash_round(lanes[l], read64(p + 8 * l));
+      }
+    }
+    lo = rotl(lanes[0], 1) + rotl(lanes[1], 7) + rotl(lanes[2], 12) + rotl(lanes[3], 18);
+    hi = rotl(lanes[3], 1) + rotl(lanes[2], 7) + rotl(lanes[1], 12) + rotl(lanes[0], 18) + kPrime3;
+    for (int l = 0; l < 4; l++) {
+      lo = merge(lo, lanes[l]);
+      hi = merge(hi, lanes[3 - l]);
+    }
+  } else {
+    lo = kPrime5;
+    hi = kPrime3;
+  }
+
+  return {static_cast<uint64_t>(size), finalize(lo, p, end, size), finalize(hi, p, end, size)};
+}
+
+DeserializedEngine::DeserializedEngine(const std::string& name, const char* data, size_t size)
+    : logger(
+          std::string("[") + name + std::string("] - "),
+          util::logging::get_logger().get_reportable_severity(),
+          util::logging::get_logger().get_is_colored_output_on()) {
+  rt = nvinfer1::createInferRuntime(logger);
+  cuda_engine = rt->deserializeCudaEngine(data, size);
+  if (!cuda_engine) {
+    rt->destroy();
+    TRTORCH_THROW_ERROR("Unable to deserialize the TensorRT engine for " << name);
+  }
+}
+
+DeserializedEngine::~DeserializedEngine() {
+  cuda_engine->destroy();
+  rt->destroy();
+}
+
+DeduplicatingRegistry<DeserializedEngine>& GetEngineRegistry() {
+  // Never destroyed so engines released during static destruction can still
+  // unregister themselves
+  static auto registry = new DeduplicatingRegistry<DeserializedEngine>();
+  return *registry;
+}
+
+} // namespace runtime
+} // namespace core
+} // namespace trtorch
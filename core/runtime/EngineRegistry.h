@@ -0,0 +1,157 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+#include "NvInfer.h"
+#include "core/util/prelude.h"
+
+namespace trtorch {
+namespace core {
+namespace runtime {
+
+// Identifies serialized engines by their size and a 128 bit hash of their
+// bytes
+struct EngineKey {
+  uint64_t size;
+  uint64_t hash_lo;
+  uint64_t hash_hi;
+
+  bool operator<(const EngineKey& other) const {
+    return std::tie(size, hash_lo, hash_hi) < std::tie(other.size, other.hash_lo, other.hash_hi);
+  }
+  bool operator==(const EngineKey& other) const {
+    return size == other.size && hash_lo == other.hash_lo && hash_hi == other.hash_hi;
+  }
+  bool operator!=(const EngineKey& other) const {
+    return !(*this == other);
+  }
+};
+EngineKey GetEngineKey(const char* data, size_t size);
+
+// Keeps one live instance per distinct serialized engine. Acquire hands out
+// shared ownership of the instance already created for the same bytes if
+// there is one, otherwise it creates one with the deserializer it is given.
+// Engines are told apart by their key alone, with 128 bits of hash the chance
+// of two different engines colliding is negligible and no copy of the bytes
+// has to be kept. Instances are destroyed when the last owner releases them,
+// the registry only holds weak references. Deserializing happens outside the
+// registry's lock, concurrent loads of the same engine wait for the first one
+// and loads of other engines are not held up.
+template <typename T>
+class DeduplicatingRegistry {
+ public:
+  using Deserializer = std::function<std::unique_ptr<T>(const char* data, size_t size)>;
+
+  std::shared_ptr<T> Acquire(const char* data, size_t size, const Deserializer& deserialize) {
+    auto key = GetEngineKey(data, size);
+    std::promise<std::shared_ptr<T>> promise;
+    std::shared_future<std::shared_ptr<T>> loading;
+    {
+      std::unique_lock<std::mutex> lock(state_->mu);
+      auto& entry = state_->entries[key];
+      if (auto existing = entry.instance.lock()) {
+        LOG_DEBUG("Reusing previously deserialized engine (" << size << " bytes)");
+        return existing;
+      }
+      if (entry.loading.valid()) {
+        loading = entry.loading;
+      } else {
+        entry.loading = promise.get_future().share();
+      }
+    }
+    if (loading.valid()) {
+      // Rethrows the error if the load being waited on failed
+      return loading.get();
+    }
+
+    std::shared_ptr<T> instance;
+    try {
+      auto created = deserialize(data, size);
+      TRTORCH_CHECK(created, "Deserializer returned no engine");
+      // The deleter only refers to the shared state so instances can outlive
+      // the registry object itself
+      auto state = state_;
+      instance = std::shared_ptr<T>(created.release(), [state, key](T* ptr) {
+        {
+          std::unique_lock<std::mutex> lock(state->mu);
+          auto it = state->entries.find(key);
+          // The engine may have been loaded again since this instance expired
+          if (it != state->entries.end() && it->second.instance.expired() && !it->second.loading.valid()) {
+            state->entries.erase(it);
+          }
+        }
+        delete ptr;
+      });
+    } catch (...) {
+      {
+        // Later loads try again rather than getting the error
+        std::unique_lock<std::mutex> lock(state_->mu);
+        state_->entries.erase(key);
+      }
+      promise.set_exception(std::current_exception());
+      throw;
+    }
+
+    {
+      std::unique_lock<std::mutex> lock(state_->mu);
+      auto& entry = state_->entries[key];
+      entry.instance = instance;
+      // Waiters hold their own reference to the result, and instance is still
+      // owned here, so dropping the future never destroys an engine under the
+      // lock
+      entry.loading = std::shared_future<std::shared_ptr<T>>();
+    }
+    promise.set_value(instance);
+    return instance;
+  }
+
+  // Number of distinct engines currently alive
+  size_t Size() {
+    std::unique_lock<std::mutex> lock(state_->mu);
+    size_t alive = 0;
+    for (const auto& entry : state_->entries) {
+      alive += entry.second.instance.expired() ? 0 : 1;
+    }
+    return alive;
+  }
+
+ private:
+  struct Entry {
+    std::weak_ptr<T> instance;
+    // Set while the engine is being deserialized
+    std::shared_future<std::shared_ptr<T>> loading;
+  };
+  struct State {
+    std::mutex mu;
+    std::map<EngineKey, Entry> entries;
+  };
+  std::shared_ptr<State> state_ = std::make_shared<State>();
+};
+
+// A deserialized engine with the runtime and logger it was created by, shared
+// by every TRTEngine loaded from the same bytes. Each TRTEngine creates its
+// own execution context from it. Log messages use the name of the engine that
+// loaded it first
+struct DeserializedEngine {
+  util::logging::TRTorchLogger logger;
+  nvinfer1::IRuntime* rt = nullptr;
+  nvinfer1::ICudaEngine* cuda_engine = nullptr;
+
+  DeserializedEngine(const std::string& name, const char* data, size_t size);
+  ~DeserializedEngine();
+  DeserializedEngine(const DeserializedEngine&) = delete;
+  DeserializedEngine& operator=(const DeserializedEngine&) = delete;
+};
+
+// Process wide registry used by TRTEngine
+DeduplicatingRegistry<DeserializedEngine>& GetEngineRegistry();
+
+} // namespace runtime
+} // namespace core
+} // namespace trtorch
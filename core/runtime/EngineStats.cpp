@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <cmath>
+
+#include "core/runtime/EngineStats.h"
+
+namespace trtorch {
+namespace core {
+namespace runtime {
+
+constexpr size_t LatencyHistogram::kSubBucketBits;
+constexpr size_t LatencyHistogram::kSubBuckets;
+constexpr size_t LatencyHistogram::kNumBuckets;
+constexpr size_t ShapeCounter::kMaxShapes;
+constexpr uint64_t EngineStats::kTimedCallInterval;
+
+uint64_t LatencyHistogram::BucketUpperBound(size_t idx) {
+  if (idx < kSubBuckets) {
+    return idx;
+  }
+  size_t exponent = idx / kSubBuckets + kSubBucketBits - 1;
+  uint64_t sub_bucket = idx % kSubBuckets;
+  uint64_t width = uint64_t(1) << (exponent - kSubBucketBits);
+  uint64_t lower = (kSubBuckets + sub_bucket) * width;
+  return lower + (width - 1);
+}
+
+uint64_t LatencyHistogram::Count() const {
+  uint64_t count = 0;
+  for (const auto& bucket : buckets_) {
+    count += bucket.load(std::memory_order_relaxed);
+  }
+  return count;
+}
+
+uint64_t LatencyHistogram::Percentile(double q) const {
+  uint64_t count = Count();
+  if (count == 0) {
+    return 0;
+  }
+  q = std::min(std::max(q, 0.0), 1.0);
+  auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * static_cast<double>(count))));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kNumBuckets; i++) {
+    seen += buckets_[i].load(std::memory_order_relaxed);
+    if (seen >= rank) {
+      return std::min(BucketUpperBound(i), Max());
+    }
+  }
+  return Max();
+}
+
+void ShapeCounter::FlushRepeats() {
+  if (repeats_.load(std::memory_order_relaxed) == 0) {
+    return;
+  }
+  auto repeats = repeats_.exchange(0, std::memory_order_relaxed);
+  auto last = last_.load(std::memory_order_relaxed);
+  (last < kMaxShapes ? slots_[last].count : overflow_).fetch_add(repeats, std::memory_order_relaxed);
+}
+
+std::map<std::string, uint64_t> ShapeCounter::Counts() const {
+  std::map<std::string, uint64_t> counts;
+  auto last = last_.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < kMaxShapes; i++) {
+    const auto& slot = slots_[i];
+    if (slot.ready.load(std::memory_order_acquire)) {
+      auto count = slot.count.load(std::memory_order_relaxed);
+      counts[slot.shape] = count + (i == last ? repeats_.load(std::memory_order_relaxed) : 0);
+    }
+  }
+  return counts;
+}
+
+uint64_t ShapeCounter::Overflow() const {
+  auto overflow = overflow_.load(std::memory_order_relaxed);
+  if (last_.load(std::memory_order_relaxed) == kMaxShapes) {
+    overflow += repeats_.load(std::memory_order_relaxed);
+  }
+  return overflow;
+}
+
+namespace {
+void summarize(std::map<std::string, int64_t>& summary, const std::string& name, const LatencyHistogram& histogram) {
+  auto count = histogram.Count();
+  summary[name + ".count"] = static_cast<int64_t>(count);
+  summary[name + ".mean"] = static_cast<int64_t>(count ? histogram.Sum() / count : 0);
+  summary[name + ".p50"] = static_cast<int64_t>(histogram.Percentile(0.5));
+  summary[name + ".p90"] = static_cast<int64_t>(histogram.Percentile(0.9));
+  summary[name + ".p99"] = static_cast<int64_t>(histogram.Percentile(0.99));
+  summary[name + ".max"] = static_cast<int64_t>(histogram.Max());
+}
+} // namespace
+
+std::map<std::string, int64_t> EngineStats::Summary() const {
+  std::map<std::string, int64_t> summary;
+  summary["calls"] = static_cast<int64_t>(calls.Load());
+  summary["errors"] = static_cast<int64_t>(errors.load(std::memory_order_relaxed));
+  summary["specialized_calls"] = static_cast<int64_t>(specialized_calls.load(std::memory_order_relaxed));
+  summarize(summary, "host_overhead_ns", host_overhead_ns);
+  summarize(summary, "enqueue_to_return_ns", enqueue_to_return_ns);
+  for (const auto& shape : shapes.Counts()) {
+    summary["shape." + shape.first] = static_cast<int64_t>(shape.second);
+  }
+  summary["shape.overflow"] = static_cast<int64_t>(shapes.Overflow());
+  return summary;
+}
+
+} // namespace runtime
+} // namespace core
+} // namespace trtorch
@@ -0,0 +1,182 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace trtorch {
+namespace core {
+namespace runtime {
+
+// Lock free histogram of durations in nanoseconds. Buckets split each power of
+// two into 4 linear sub-buckets so percentiles are estimated within 25%.
+// Recording is two relaxed atomic increments (plus a CAS on a new maximum),
+// reads are not a consistent snapshot while other threads record.
+class LatencyHistogram {
+ public:
+  static constexpr size_t kSubBucketBits = 2;
+  static constexpr size_t kSubBuckets = 1 << kSubBucketBits;
+  static constexpr size_t kNumBuckets = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+  void Record(uint64_t ns) {
+    buckets_[BucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(ns, std::memory_order_relaxed);
+    auto max = max_.load(std::memory_order_relaxed);
+    while (ns > max && !max_.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+    }
+  }
+
+  // Summed over the buckets so recording does not need a separate counter
+  uint64_t Count() const;
+  uint64_t Sum() const {
+    return sum_.load(std::memory_order_relaxed);
+  }
+  uint64_t Max() const {
+    return max_.load(std::memory_order_relaxed);
+  }
+  // Upper bound of the bucket holding the q-th quantile (0 <= q <= 1)
+  uint64_t Percentile(double q) const;
+
+  static size_t BucketIndex(uint64_t ns) {
+    if (ns < kSubBuckets) {
+      return static_cast<size_t>(ns);
+    }
+    size_t exponent = 63 - __builtin_clzll(ns);
+    size_t sub_bucket = (ns >> (exponent - kSubBucketBits)) & (kSubBuckets - 1);
+    return (exponent - kSubBucketBits + 1) * kSubBuckets + sub_bucket;
+  }
+  static uint64_t BucketUpperBound(size_t idx);
+
+ private:
+  std::array<std::atomic<uint64_t>, kNumBuckets> buckets_ = {};
+  std::atomic<uint64_t> sum_ = {0};
+  std::atomic<uint64_t> max_ = {0};
+};
+
+// Lock free call counts keyed by a hash of the input shapes. A fixed number of
+// shapes are tracked, calls with shapes beyond that are counted as overflow.
+// Calls repeating the shapes of the last recorded call can be counted with
+// RecordRepeat, which skips hashing and the slot lookup
+class ShapeCounter {
+ public:
+  static constexpr size_t kMaxShapes = 64;
+
+  // describe is only called the first time a shape is seen
+  template <typename DescribeFn>
+  void Record(uint64_t key, DescribeFn&& describe) {
+    FlushRepeats();
+    // 0 marks an empty slot, keys 0 and 1 share a slot
+    key = key ? key : 1;
+    size_t start = key % kMaxShapes;
+    for (size_t i = 0; i < kMaxShapes; i++) {
+      size_t idx = (start + i) % kMaxShapes;
+      auto& slot = slots_[idx];
+      auto slot_key = slot.key.load(std::memory_order_acquire);
+      if (slot_key == 0) {
+        uint64_t empty = 0;
+        if (slot.key.compare_exchange_strong(empty, key, std::memory_order_acq_rel)) {
+          slot.shape = describe();
+          slot.ready.store(true, std::memory_order_release);
+          slot.count.fetch_add(1, std::memory_order_relaxed);
+          last_.store(idx, std::memory_order_relaxed);
+          return;
+        }
+        slot_key = empty;
+      }
+      if (slot_key == key) {
+        slot.count.fetch_add(1, std::memory_order_relaxed);
+        last_.store(idx, std::memory_order_relaxed);
+        return;
+      }
+    }
+    overflow_.fetch_add(1, std::memory_order_relaxed);
+    last_.store(kMaxShapes, std::memory_order_relaxed);
+  }
+
+  // Counts a call with the same shapes as the last call passed to Record. Is a
+  // plain load and store, so calls to RecordRepeat and Record must not overlap
+  // (the runtime holds the engine's exec_mu)
+  void RecordRepeat() {
+    repeats_.store(repeats_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+
+  // Shapes whose description has been published and their call counts
+  std::map<std::string, uint64_t> Counts() const;
+  uint64_t Overflow() const;
+
+ private:
+  struct Slot {
+    std::atomic<uint64_t> key = {0};
+    std::atomic<uint64_t> count = {0};
+    std::atomic<bool> ready = {false};
+    std::string shape;
+  };
+  // Moves the repeats counted so far onto the last recorded shape
+  void FlushRepeats();
+
+  std::array<Slot, kMaxShapes> slots_;
+  std::atomic<uint64_t> overflow_ = {0};
+  // Slot of the last recorded shape (kMaxShapes for overflow) and the calls
+  // repeating it which are not added to its count yet
+  std::atomic<size_t> last_ = {kMaxShapes};
+  std::atomic<uint64_t> repeats_ = {0};
+};
+
+// Counter with a single writer at a time (serialized by the caller), so
+// incrementing it is a plain load and store rather than an atomic
+// read-modify-write. Readers on other threads see a recent value
+class SerialCounter {
+ public:
+  uint64_t Increment() {
+    auto value = value_.load(std::memory_order_relaxed);
+    value_.store(value + 1, std::memory_order_relaxed);
+    return value;
+  }
+  uint64_t Load() const {
+    return value_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  std::atomic<uint64_t> value_ = {0};
+};
+
+// Runtime metrics kept per engine. What is updated on every call is kept to a
+// few plain stores made while the engine's exec_mu is held anyway: the call
+// count and, unless the shapes changed since the last call, a repeat of the
+// last shape. Latencies are only measured on one call in kTimedCallInterval,
+// which keeps the clock reads off most calls
+struct EngineStats {
+  static constexpr uint64_t kTimedCallInterval = 32;
+
+  // Whether the call with the given index (the value of calls before it was
+  // counted) has its latencies measured, the first call always does
+  static bool Timed(uint64_t call) {
+    return call % kTimedCallInterval == 0;
+  }
+
+  // Calls to execute the engine (synchronous and asynchronous), counted while
+  // exec_mu is held
+  SerialCounter calls;
+  // Calls which raised an error, either while enqueuing or while waiting
+  std::atomic<uint64_t> errors = {0};
+  // Calls routed to an engine specialized for their shapes, those are counted
+  // in the specialized engine's metrics rather than in this one's
+  std::atomic<uint64_t> specialized_calls = {0};
+  // Time spent on the host from the call until the engine is enqueued
+  // (input checks, binding setup, output allocation, waiting on other callers),
+  // sampled on timed calls
+  LatencyHistogram host_overhead_ns;
+  // Time from enqueuing the engine until the call returns, for asynchronous
+  // calls until the future is completed, sampled on timed calls
+  LatencyHistogram enqueue_to_return_ns;
+  ShapeCounter shapes;
+
+  // Flattened view of the metrics, e.g. "calls", "host_overhead_ns.p99" or
+  // "shape.[1, 3, 224, 224]"
+  std::map<std::string, int64_t> Summary() const;
+};
+
+} // namespace runtime
+} // namespace core
+} // namespace trtorch
@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+
+#include "core/runtime/FlightRecorder.h"
+
+namespace trtorch {
+namespace core {
+namespace runtime {
+
+constexpr size_t ExecutionRecord::kMaxInputs;
+constexpr size_t ExecutionRecord::kMaxDims;
+constexpr size_t FlightRecorder::kCapacity;
+
+void FlightRecorder::Record(const ExecutionRecord& record) {
+  auto id = next_.fetch_add(1, std::memory_order_relaxed);
+  auto& slot = slots_[id % kCapacity];
+
+  auto seq = slot.seq.load(std::memory_order_relaxed);
+  if ((seq & 1) || !slot.seq.compare_exchange_strong(seq, 2 * id + 1, std::memory_order_acquire)) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.record = record;
+  slot.seq.store(2 * (id + 1), std::memory_order_release);
+}
+
+std::vector<std::pair<uint64_t, ExecutionRecord>> FlightRecorder::Snapshot() const {
+  std::vector<std::pair<uint64_t, ExecutionRecord>> records;
+  records.reserve(kCapacity);
+  for (const auto& slot : slots_) {
+    auto before = slot.seq.load(std::memory_order_acquire);
+    if (before == 0 || (before & 1)) {
+      continue;
+    }
+    auto record = slot.record;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.seq.load(std::memory_order_relaxed) != before) {
+      // Overwritten while copying
+      continue;
+    }
+    records.emplace_back(before / 2 - 1, record);
+  }
+  using IdRecord = std::pair<uint64_t, ExecutionRecord>;
+  std::sort(records.begin(), records.end(), [](const IdRecord& a, const IdRecord& b) { return a.first < b.first; });
+  return records;
+}
+
+namespace {
+std::string escape(const std::string& s) {
+  std::stringstream ss;
+  for (auto c : s) {
+    if (c == '"' || c == '\\') {
+      ss << '\\' << c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      ss << ' ';
+    } else {
+      ss << c;
+    }
+  }
+  return ss.str();
+}
+} // namespace
+
+std::string FlightRecorder::ToJSON(const std::string& engine_name) const {
+  auto records = Snapshot();
+
+  // Offset between the steady clock timestamps and wall clock time
+  auto wall_now = std::chrono::duration_cast<std::chrono::microseconds>(
+                      std::chrono::system_clock::now().time_since_epoch())
+                      .count();
+  auto steady_now = std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now().time_since_epoch())
+                        .count();
+
+  std::stringstream ss;
+  ss << "{\"engine\": \"" << escape(engine_name) << "\", \"recorded\": " << Recorded()
+     << ", \"dropped\": " << Dropped() << ", \"executions\": [";
+  for (size_t i = 0; i < records.size(); i++) {
+    const auto& r = records[i].second;
+    auto timestamp_us = wall_now - steady_now + static_cast<int64_t>(r.start_ns / 1000);
+    ss << (i ? ", " : "") << "{\"id\": " << records[i].first << ", \"timestamp_us\": " << timestamp_us
+       << ", \"duration_ns\": " << r.duration_ns << ", \"profile\": " << r.profile << ", \"outcome\": \""
+       << (r.outcome == ExecutionRecord::Outcome::kSuccess ? "success" : "error") << "\", \"truncated\": "
+       << (r.truncated ? "true" : "false") << ", \"inputs\": [";
+    for (size_t j = 0; j < r.num_inputs; j++) {
+      const auto& in = r.inputs[j];
+      ss << (j ? ", " : "") << "{\"dtype\": \"" << (in.dtype ? in.dtype : "unknown") << "\", \"shape\": [";
+      for (size_t d = 0; d < in.num_dims; d++) {
+        ss << (d ? ", " : "") << in.dims[d];
+      }
+      ss << "]}";
+    }
+    ss << "]}";
+  }
+  ss << "]}";
+  return ss.str();
+}
+
+} // namespace runtime
+} // namespace core
+} // namespace trtorch
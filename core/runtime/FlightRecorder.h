@@ -0,0 +1,83 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace trtorch {
+namespace core {
+namespace runtime {
+
+// Description of a single engine execution. Plain data of a fixed size so it
+// can be copied into the recorder without allocating, inputs or dimensions
+// past the limits are dropped and the record is marked as truncated
+struct ExecutionRecord {
+  static constexpr size_t kMaxInputs = 8;
+  static constexpr size_t kMaxDims = 8;
+
+  enum class Outcome : uint8_t {
+    kSuccess = 0,
+    kError,
+  };
+
+  struct Input {
+    // Points to a string with static storage duration (e.g. c10::toString(ScalarType))
+    const char* dtype;
+    uint8_t num_dims;
+    int64_t dims[kMaxDims];
+  };
+
+  // Steady clock time the call started at
+  uint64_t start_ns;
+  uint64_t duration_ns;
+  int32_t profile;
+  Outcome outcome;
+  bool truncated;
+  uint8_t num_inputs;
+  Input inputs[kMaxInputs];
+};
+
+// Fixed size ring buffer of the last kCapacity executions of an engine.
+// Recording is lock free and does not allocate, each slot is guarded by a
+// sequence number (seqlock) so readers skip records that are being written.
+// If two writers race for the same slot the later one drops its record.
+class FlightRecorder {
+ public:
+  static constexpr size_t kCapacity = 64;
+
+  void Record(const ExecutionRecord& record);
+
+  // Number of executions recorded since creation and how many of them were
+  // dropped because their slot was being written concurrently
+  uint64_t Recorded() const {
+    return next_.load(std::memory_order_relaxed);
+  }
+  uint64_t Dropped() const {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+
+  // Copies out the records currently held with their execution ids, oldest
+  // first
+  std::vector<std::pair<uint64_t, ExecutionRecord>> Snapshot() const;
+
+  // JSON object with the engine name, counters and the recorded executions,
+  // start times are converted to wall clock time (microseconds since epoch)
+  std::string ToJSON(const std::string& engine_name) const;
+
+ private:
+  struct Slot {
+    // 0: never written, odd: being written, 2 * (id + 1): holds execution id
+    std::atomic<uint64_t> seq = {0};
+    ExecutionRecord record;
+  };
+
+  std::array<Slot, kCapacity> slots_;
+  std::atomic<uint64_t> next_ = {0};
+  std::atomic<uint64_t> dropped_ = {0};
+};
+
+} // namespace runtime
+} // namespace core
+} // namespace trtorch
@@ -0,0 +1,151 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace trtorch {
+namespace core {
+namespace runtime {
+
+// Holds the version of an engine that calls currently go to and lets it be
+// replaced while calls are running (RCU style). Calls take a Lease on the
+// current version for as long as they use it, Swap makes the replacement
+// current for every later Lease and retires the previous version which is
+// released once its last Lease is gone (right away if it had none).
+//
+// The slot starts out on an initial version which stands for the object
+// owning the slot (Lease::swapped() is false and get() is empty), its
+// on_drained callback is given to the constructor.
+template <typename Ptr>
+class HotSwapSlot {
+ public:
+  // Called with the version's pointer once it is retired and drained, the
+  // pointer is dropped afterwards
+  using DrainedFn = std::function<void(Ptr&)>;
+
+ private:
+  struct Version {
+    Ptr ptr;
+    bool initial = false;
+    size_t in_flight = 0;
+    bool retired = false;
+    DrainedFn on_drained;
+  };
+  struct State {
+    std::mutex mu;
+    std::shared_ptr<Version> current;
+  };
+
+  static void Release(const std::shared_ptr<Version>& version) {
+    // Only reached by one thread per version, after it was retired with no
+    // leases left so no one else refers to its pointer anymore
+    if (version->on_drained) {
+      version->on_drained(version->ptr);
+    }
+    version->ptr = Ptr();
+    version->on_drained = nullptr;
+  }
+
+ public:
+  class Lease {
+   public:
+    Lease() = default;
+    Lease(std::shared_ptr<State> state, std::shared_ptr<Version> version)
+        : state_(std::move(state)), version_(std::move(version)) {}
+    Lease(Lease&& other) = default;
+    Lease& operator=(Lease&& other) {
+      if (this != &other) {
+        Reset();
+        state_ = std::move(other.state_);
+        version_ = std::move(other.version_);
+      }
+      return *this;
+    }
+    Lease(const Lease&) = delete;
+    Lease& operator=(const Lease&) = delete;
+    ~Lease() {
+      Reset();
+    }
+
+    // False while calls still go to the owner of the slot
+    bool swapped() const {
+      return !version_->initial;
+    }
+    const Ptr& get() const {
+      return version_->ptr;
+    }
+
+    void Reset() {
+      if (!version_) {
+        return;
+      }
+      bool drained = false;
+      {
+        std::unique_lock<std::mutex> lock(state_->mu);
+        drained = --version_->in_flight == 0 && version_->retired;
+      }
+      if (drained) {
+        Release(version_);
+      }
+      version_.reset();
+      state_.reset();
+    }
+
+   private:
+    std::shared_ptr<State> state_;
+    std::shared_ptr<Version> version_;
+  };
+
+  explicit HotSwapSlot(DrainedFn on_initial_drained = nullptr) : state_(std::make_shared<State>()) {
+    state_->current = std::make_shared<Version>();
+    state_->current->initial = true;
+    state_->current->on_drained = std::move(on_initial_drained);
+  }
+  HotSwapSlot(const HotSwapSlot&) = delete;
+  HotSwapSlot& operator=(const HotSwapSlot&) = delete;
+
+  Lease Enter() {
+    std::unique_lock<std::mutex> lock(state_->mu);
+    auto version = state_->current;
+    version->in_flight++;
+    return Lease(state_, std::move(version));
+  }
+
+  // Makes next the version later leases get, on_drained runs once it is
+  // replaced in turn and drained
+  void Swap(Ptr next, DrainedFn on_drained = nullptr) {
+    CheckedSwap(std::move(next), [](const Ptr&) {}, std::move(on_drained));
+  }
+
+  // Like Swap, but first calls check with the current version's pointer
+  // (empty for the initial version) under the same lock as the swap, so no
+  // other swap can come in between. If check throws the slot is unchanged
+  template <typename CheckFn>
+  void CheckedSwap(Ptr next, CheckFn&& check, DrainedFn on_drained = nullptr) {
+    auto version = std::make_shared<Version>();
+    version->ptr = std::move(next);
+    version->on_drained = std::move(on_drained);
+
+    std::shared_ptr<Version> previous;
+    bool drained = false;
+    {
+      std::unique_lock<std::mutex> lock(state_->mu);
+      check(state_->current->ptr);
+      previous = std::move(state_->current);
+      state_->current = std::move(version);
+      previous->retired = true;
+      drained = previous->in_flight == 0;
+    }
+    if (drained) {
+      Release(previous);
+    }
+  }
+
+ private:
+  std::shared_ptr<State> state_;
+};
+
+} // namespace runtime
+} // namespace core
+} // namespace trtorch
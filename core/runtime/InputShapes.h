@@ -0,0 +1,14 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace trtorch {
+namespace core {
+namespace runtime {
+
+// Shapes of the inputs of a call, one vector of sizes per input
+using InputShapes = std::vector<std::vector<int64_t>>;
+
+} // namespace runtime
+} // namespace core
+} // namespace trtorch
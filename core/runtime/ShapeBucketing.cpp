@@ -0,0 +1,147 @@
+#include <algorithm>
+
+#include "core/runtime/ShapeBucketing.h"
+#include "core/util/prelude.h"
+
+namespace trtorch {
+namespace core {
+namespace runtime {
+
+namespace {
+// Max size of the policy's dimension, 0 if unknown
+int64_t max_size(const BucketPolicy& policy, const MaxShapes& max_shapes) {
+  if (static_cast<size_t>(policy.input) >= max_shapes.size()) {
+    return 0;
+  }
+  const auto& shape = max_shapes[policy.input];
+  return policy.dim < static_cast<int64_t>(shape.size()) ? shape[policy.dim] : 0;
+}
+} // namespace
+
+int64_t BucketSize(int64_t size, const std::vector<int64_t>& boundaries, int64_t max_size) {
+  if (size <= 0) {
+    return size;
+  }
+  int64_t bucket = size;
+  if (boundaries.empty()) {
+    bucket = 1;
+    while (bucket < size) {
+      bucket <<= 1;
+    }
+  } else {
+    for (auto b : boundaries) {
+      if (size <= b) {
+        bucket = b;
+        break;
+      }
+    }
+  }
+  if (max_size > 0 && bucket > max_size) {
+    return std::max(size, max_size);
+  }
+  return bucket;
+}
+
+void ValidateBucketPolicies(const std::vector<BucketPolicy>& policies, const MaxShapes& max_shapes) {
+  for (const auto& policy : policies) {
+    TRTORCH_CHECK(
+        policy.input >= 0 && static_cast<size_t>(policy.input) < max_shapes.size(),
+        "Bucket policy refers to input " << policy.input << " but there are only " << max_shapes.size()
+                                         << " inputs");
+    const auto& max_shape = max_shapes[policy.input];
+    TRTORCH_CHECK(
+        policy.dim >= 0 && policy.dim < static_cast<int64_t>(max_shape.size()),
+        "Bucket policy pads dimension " << policy.dim << " of input " << policy.input << " whose max shape is "
+                                        << c10::IntArrayRef(max_shape));
+    for (size_t i = 0; i < policy.boundaries.size(); i++) {
+      TRTORCH_CHECK(
+          policy.boundaries[i] > 0 && (i == 0 || policy.boundaries[i] > policy.boundaries[i - 1]),
+          "Bucket boundaries must be positive and ascending, found " << c10::IntArrayRef(policy.boundaries));
+    }
+    TRTORCH_CHECK(
+        policy.boundaries.empty() || policy.boundaries.back() <= max_shape[policy.dim],
+        "Bucket boundaries " << c10::IntArrayRef(policy.boundaries) << " of input " << policy.input
+                             << " exceed the max size " << max_shape[policy.dim] << " of dimension " << policy.dim);
+    for (const auto& out : policy.output_dims) {
+      TRTORCH_CHECK(
+          out.first >= 0 && out.second >= 0,
+          "Bucket policy output dimensions must be 0 or greater, found (" << out.first << ", " << out.second << ")");
+    }
+  }
+}
+
+std::vector<at::Tensor> PadToBuckets(
+    const std::vector<at::Tensor>& inputs,
+    const std::vector<BucketPolicy>& policies,
+    std::vector<int64_t>& unpadded,
+    const MaxShapes& max_shapes) {
+  auto padded = inputs;
+  unpadded.clear();
+  unpadded.reserve(policies.size());
+  for (const auto& policy : policies) {
+    TRTORCH_CHECK(
+        static_cast<size_t>(policy.input) < padded.size(),
+        "Bucket policy refers to input " << policy.input << " but only " << padded.size() << " were provided");
+    auto& in = padded[policy.input];
+    TRTORCH_CHECK(
+        policy.dim < in.dim(),
+        "Bucket policy pads dimension " << policy.dim << " of input " << policy.input << " which has shape "
+                                        << in.sizes());
+    auto size = in.size(policy.dim);
+    unpadded.push_back(size);
+    auto extra = BucketSize(size, policy.boundaries, max_size(policy, max_shapes)) - size;
+    if (extra == 0) {
+      continue;
+    }
+    // constant_pad_nd takes (before, after) pairs starting from the last
+    // dimension
+    std::vector<int64_t> pad(2 * (in.dim() - policy.dim), 0);
+    pad.back() = extra;
+    in = at::constant_pad_nd(in, pad, policy.pad_value);
+  }
+  return padded;
+}
+
+std::vector<std::vector<int64_t>> BucketedShapes(
+    const std::vector<at::Tensor>& inputs,
+    const std::vector<BucketPolicy>& policies,
+    const MaxShapes& max_shapes) {
+  std::vector<std::vector<int64_t>> shapes;
+  shapes.reserve(inputs.size());
+  for (const auto& in : inputs) {
+    shapes.push_back(in.sizes().vec());
+  }
+  for (const auto& policy : policies) {
+    if (static_cast<size_t>(policy.input) < shapes.size() &&
+        policy.dim < static_cast<int64_t>(shapes[policy.input].size())) {
+      auto& size = shapes[policy.input][policy.dim];
+      size = BucketSize(size, policy.boundaries, max_size(policy, max_shapes));
+    }
+  }
+  return shapes;
+}
+
+void SliceFromBuckets(
+    std::vector<at::Tensor>& outputs,
+    const std::vector<BucketPolicy>& policies,
+    const std::vector<int64_t>& unpadded) {
+  TRTORCH_CHECK(unpadded.size() == policies.size(), "Expected one unpadded size per bucket policy");
+  for (size_t p = 0; p < policies.size(); p++) {
+    for (const auto& out : policies[p].output_dims) {
+      TRTORCH_CHECK(
+          static_cast<size_t>(out.first) < outputs.size() && out.second < outputs[out.first].dim(),
+          "Bucket policy slices dimension " << out.second << " of output " << out.first
+                                            << " which does not exist");
+      auto& tensor = outputs[out.first];
+      TRTORCH_CHECK(
+          tensor.size(out.second) >= unpadded[p],
+          "Output " << out.first << " (shape " << tensor.sizes() << ") is smaller than the unpadded size "
+                    << unpadded[p] << " along dimension " << out.second);
+      tensor = tensor.narrow(out.second, 0, unpadded[p]);
+    }
+  }
+}
+
+} // namespace runtime
+} // namespace core
+} // namespace trtorch
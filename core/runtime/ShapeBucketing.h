@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "ATen/ATen.h"
+#include "core/runtime/settings.h"
+
+namespace trtorch {
+namespace core {
+namespace runtime {
+
+// Largest shape the engine accepts for each input (its optimization profile's
+// kMAX), bucket sizes are clamped to it. Inputs or dimensions it does not
+// cover are not clamped
+using MaxShapes = std::vector<std::vector<int64_t>>;
+
+// Size a dimension of the given size is padded to: the smallest boundary it
+// fits in (the size itself past the last one) or the next power of two if
+// there are no boundaries. Never more than max_size (if it is positive) unless
+// size itself is larger
+int64_t BucketSize(int64_t size, const std::vector<int64_t>& boundaries, int64_t max_size = 0);
+
+// Checks that the policies refer to valid inputs and dimensions of the given
+// max shapes (one per input) and that their boundaries are positive,
+// ascending and no larger than the max size of their dimension
+void ValidateBucketPolicies(const std::vector<BucketPolicy>& policies, const MaxShapes& max_shapes);
+
+// Pads the inputs as described by the policies (with at::constant_pad_nd at
+// the end of each dimension). Inputs no policy applies to are passed through.
+// unpadded receives the size each policy's dimension had before padding
+std::vector<at::Tensor> PadToBuckets(
+    const std::vector<at::Tensor>& inputs,
+    const std::vector<BucketPolicy>& policies,
+    std::vector<int64_t>& unpadded,
+    const MaxShapes& max_shapes = {});
+
+// Shapes the inputs have once padded, without padding them
+std::vector<std::vector<int64_t>> BucketedShapes(
+    const std::vector<at::Tensor>& inputs,
+    const std::vector<BucketPolicy>& policies,
+    const MaxShapes& max_shapes = {});
+
+// Cuts the output dimensions declared by the policies back to the sizes the
+// inputs had before padding. The results are views of the padded outputs
+void SliceFromBuckets(
+    std::vector<at::Tensor>& outputs,
+    const std::vector<BucketPolicy>& policies,
+    const std::vector<int64_t>& unpadded);
+
+} // namespace runtime
+} // namespace core
+} // namespace trtorch
@@ -0,0 +1,223 @@
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string>
+
+#include "core/runtime/ShapeProfiles.h"
+#include "core/util/prelude.h"
+
+namespace trtorch {
+namespace core {
+namespace runtime {
+namespace {
+
+std::vector<int64_t> parse_shape(const std::string& token) {
+  TRTORCH_CHECK(
+      token.size() >= 2 && token.front() == '(' && token.back() == ')',
+      "Malformed shape in shape histogram: " << token);
+  std::vector<int64_t> shape;
+  std::stringstream ss(token.substr(1, token.size() - 2));
+  std::string dim;
+  while (std::getline(ss, dim, ',')) {
+    shape.push_back(std::stoll(dim));
+  }
+  return shape;
+}
+
+// Total number of elements over all inputs
+double volume(const InputShapes& shapes) {
+  double total = 0;
+  for (const auto& shape : shapes) {
+    double elements = 1;
+    for (auto d : shape) {
+      elements *= static_cast<double>(d);
+    }
+    total += elements;
+  }
+  return total;
+}
+
+double width(const InputShapes& min, const InputShapes& max) {
+  double total = 0;
+  for (size_t i = 0; i < min.size(); i++) {
+    for (size_t d = 0; d < min[i].size(); d++) {
+      total += static_cast<double>(max[i][d] - min[i][d]);
+    }
+  }
+  return total;
+}
+
+struct Entry {
+  InputShapes shapes;
+  uint64_t calls;
+  double volume;
+};
+
+// Consecutive entries forming a profile, grown one entry at a time
+struct Group {
+  // Elementwise min / max over the shapes of the group
+  InputShapes min;
+  InputShapes max;
+  uint64_t calls = 0;
+  // Number of elements over all calls of the group
+  double volume = 0;
+
+  void Add(const Entry& entry) {
+    calls += entry.calls;
+    volume += entry.volume * static_cast<double>(entry.calls);
+    if (min.empty()) {
+      min = entry.shapes;
+      max = entry.shapes;
+      return;
+    }
+    for (size_t i = 0; i < entry.shapes.size(); i++) {
+      for (size_t d = 0; d < entry.shapes[i].size(); d++) {
+        min[i][d] = std::min(min[i][d], entry.shapes[i][d]);
+        max[i][d] = std::max(max[i][d], entry.shapes[i][d]);
+      }
+    }
+  }
+
+  // Objective summed over the calls of the group
+  double Cost(ProfileObjective objective) const {
+    if (objective == ProfileObjective::kPadding) {
+      return runtime::volume(max) * static_cast<double>(calls) - volume;
+    }
+    return width(min, max) * static_cast<double>(calls);
+  }
+};
+
+} // namespace
+
+void WriteShapeHistogram(std::ostream& os, const ShapeHistogram& histogram) {
+  os << "# trtorch shape histogram: calls followed by the shape of each input" << std::endl;
+  for (const auto& entry : histogram) {
+    os << entry.second;
+    for (const auto& shape : entry.first) {
+      os << " (";
+      for (size_t d = 0; d < shape.size(); d++) {
+        os << (d ? "," : "") << shape[d];
+      }
+      os << ')';
+    }
+    os << std::endl;
+  }
+}
+
+ShapeHistogram ReadShapeHistogram(std::istream& is) {
+  ShapeHistogram histogram;
+  std::string line;
+  while (std::getline(is, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    std::stringstream ss(line);
+    uint64_t calls;
+    TRTORCH_CHECK(ss >> calls, "Malformed line in shape histogram: " << line);
+    InputShapes shapes;
+    std::string token;
+    while (ss >> token) {
+      shapes.push_back(parse_shape(token));
+    }
+    histogram.emplace_back(std::move(shapes), calls);
+  }
+  return histogram;
+}
+
+std::vector<ShapeProfile> ClusterShapeProfiles(
+    const ShapeHistogram& histogram,
+    size_t num_profiles,
+    ProfileObjective objective) {
+  TRTORCH_CHECK(num_profiles > 0, "At least one profile is needed");
+
+  // Merge repeated entries and drop empty ones
+  std::map<InputShapes, uint64_t> merged;
+  for (const auto& entry : histogram) {
+    if (entry.second > 0) {
+      merged[entry.first] += entry.second;
+    }
+  }
+  TRTORCH_CHECK(!merged.empty(), "The shape histogram holds no calls");
+
+  std::vector<Entry> entries;
+  for (const auto& entry : merged) {
+    const auto& reference = merged.begin()->first;
+    TRTORCH_CHECK(
+        entry.first.size() == reference.size(),
+        "All entries of a shape histogram need the same number of inputs, found " << entry.first.size() << " and "
+                                                                                  << reference.size());
+    for (size_t i = 0; i < reference.size(); i++) {
+      TRTORCH_CHECK(
+          entry.first[i].size() == reference[i].size(),
+          "Input " << i << " is recorded with different ranks, it cannot be covered by one input range");
+    }
+    entries.push_back({entry.first, entry.second, volume(entry.first)});
+  }
+  std::stable_sort(
+      entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.volume < b.volume; });
+
+  auto n = entries.size();
+  auto k = std::min(num_profiles, n);
+
+  // cost[g][j]: best objective for entries [0, j] split into g + 1 groups,
+  // split[g][j]: first entry of the last of those groups. Groups are grown
+  // backwards from j so their bounds are updated incrementally
+  const double inf = std::numeric_limits<double>::infinity();
+  std::vector<std::vector<double>> cost(k, std::vector<double>(n, inf));
+  std::vector<std::vector<size_t>> split(k, std::vector<size_t>(n, 0));
+  Group first_group;
+  for (size_t j = 0; j < n; j++) {
+    first_group.Add(entries[j]);
+    cost[0][j] = first_group.Cost(objective);
+  }
+  for (size_t g = 1; g < k; g++) {
+    for (size_t j = g; j < n; j++) {
+      Group last_group;
+      for (size_t i = j; i >= g; i--) {
+        last_group.Add(entries[i]);
+        auto total = cost[g - 1][i - 1] + last_group.Cost(objective);
+        if (total < cost[g][j]) {
+          cost[g][j] = total;
+          split[g][j] = i;
+        }
+      }
+    }
+  }
+
+  // Walk the splits back from the last entry
+  std::vector<std::pair<size_t, size_t>> groups;
+  size_t last = n - 1;
+  for (size_t g = k; g-- > 0;) {
+    size_t first = g == 0 ? 0 : split[g][last];
+    groups.emplace_back(first, last);
+    if (g > 0) {
+      last = first - 1;
+    }
+  }
+  std::reverse(groups.begin(), groups.end());
+
+  std::vector<ShapeProfile> profiles;
+  for (const auto& range : groups) {
+    Group group;
+    ShapeProfile profile;
+    uint64_t most_calls = 0;
+    for (size_t e = range.first; e <= range.second; e++) {
+      group.Add(entries[e]);
+      if (entries[e].calls > most_calls) {
+        most_calls = entries[e].calls;
+        profile.opt = entries[e].shapes;
+      }
+    }
+    profile.min = group.min;
+    profile.max = group.max;
+    profile.calls = group.calls;
+    profile.cost = group.Cost(objective) / static_cast<double>(group.calls);
+    profiles.push_back(std::move(profile));
+  }
+  return profiles;
+}
+
+} // namespace runtime
+} // namespace core
+} // namespace trtorch
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#include "core/runtime/InputShapes.h"
+
+namespace trtorch {
+namespace core {
+namespace runtime {
+
+// Number of calls seen per distinct set of input shapes
+using ShapeHistogram = std::vector<std::pair<InputShapes, uint64_t>>;
+
+// Histograms are stored as text, one line per entry with the number of calls
+// followed by the shape of each input, e.g. "12 (1,3,224,224) (1,128)". Lines
+// starting with '#' are ignored
+void WriteShapeHistogram(std::ostream& os, const ShapeHistogram& histogram);
+ShapeHistogram ReadShapeHistogram(std::istream& is);
+
+enum class ProfileObjective {
+  // Elements added by padding every call up to the max of its profile
+  kPadding,
+  // Width of the profile ranges (summed over all dimensions), weighted by the
+  // number of calls they serve
+  kRangeWidth,
+};
+
+// Input ranges covering a group of recorded shapes. opt is the most frequent
+// shape in the group since that is what TensorRT tunes kernels for
+struct ShapeProfile {
+  InputShapes min;
+  InputShapes opt;
+  InputShapes max;
+  // Recorded calls falling into the profile
+  uint64_t calls;
+  // Objective per call for the calls in the profile (e.g. average number of
+  // elements padded for kPadding)
+  double cost;
+};
+
+// Splits the recorded shapes into at most num_profiles groups minimizing the
+// objective over all calls and returns the profile of each group, smallest
+// shapes first. Shapes are ordered by their number of elements and grouped into
+// contiguous runs of that order (optimal for the order, using dynamic
+// programming). All entries need the same number of inputs and ranks
+std::vector<ShapeProfile> ClusterShapeProfiles(
+    const ShapeHistogram& histogram,
+    size_t num_profiles,
+    ProfileObjective objective = ProfileObjective::kPadding);
+
+} // namespace runtime
+} // namespace core
+} // namespace trtorch
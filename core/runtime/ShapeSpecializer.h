@@ -0,0 +1,237 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "cuda_runtime_api.h"
+
+#include "core/runtime/InputShapes.h"
+#include "core/util/prelude.h"
+
+namespace trtorch {
+namespace core {
+namespace runtime {
+
+// Routes calls to engines built for their exact input shapes. Every call
+// counts toward its shapes, once they have been seen threshold times an
+// engine is built for them in the background (one build at a time) and later
+// calls with those shapes are routed to it. Until then Route returns an empty
+// pointer and the caller uses its generic engine. At most capacity specialized
+// engines are kept, the least recently routed to is evicted first. Builds that
+// fail are not retried. Builds run on the CUDA device of the call which
+// triggered them. Calls routed to a specialized engine only read an immutable
+// snapshot of the engines, the lock is only taken to count calls which are
+// not routed and to publish builds.
+template <typename EnginePtr>
+class ShapeSpecializer {
+ public:
+  using BuildFn = std::function<EnginePtr(const InputShapes& shapes)>;
+  // Runs a build task, by default on a thread owned by the specializer which
+  // is joined when it is destroyed
+  using LaunchFn = std::function<void(std::function<void()> task)>;
+
+  // Shapes counted toward a specialization, counts are reset past this so
+  // workloads with unbounded distinct shapes do not grow the table
+  static constexpr size_t kMaxTrackedShapes = 1024;
+
+  ShapeSpecializer(size_t threshold, size_t capacity, BuildFn build, LaunchFn launch = nullptr)
+      : threshold_(threshold),
+        capacity_(capacity),
+        build_(std::move(build)),
+        launch_(std::move(launch)),
+        state_(std::make_shared<State>()) {}
+  ShapeSpecializer(const ShapeSpecializer&) = delete;
+  ShapeSpecializer& operator=(const ShapeSpecializer&) = delete;
+
+  // Waits for a build in progress on the owned worker
+  ~ShapeSpecializer() {
+    std::unique_lock<std::mutex> lock(worker_mu_);
+    if (worker_.joinable()) {
+      worker_.join();
+    }
+  }
+
+  EnginePtr Route(const InputShapes& shapes) {
+    auto engines = std::atomic_load(&state_->engines);
+    auto it = engines->find(shapes);
+    if (it != engines->end()) {
+      // Only ticks if another engine was routed to (or built) since, so calls
+      // which keep hitting the same engine only read shared state
+      auto& last_routed = it->second->last_routed;
+      if (last_routed.load(std::memory_order_relaxed) != state_->routes.load(std::memory_order_relaxed)) {
+        last_routed.store(state_->routes.fetch_add(1, std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      }
+      return it->second->engine;
+    }
+
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(state_->mu);
+      if (state_->failed.count(shapes)) {
+        return EnginePtr();
+      }
+      if (state_->counts.size() >= kMaxTrackedShapes && !state_->counts.count(shapes)) {
+        state_->counts.clear();
+      }
+      auto& count = state_->counts[shapes];
+      if (++count < threshold_ || state_->building) {
+        return EnginePtr();
+      }
+      state_->counts.erase(shapes);
+      state_->building = true;
+
+      // The task only refers to the shared state so it can outlive this object
+      auto state = state_;
+      auto build = build_;
+      auto capacity = capacity_;
+      int device = -1;
+      if (cudaGetDevice(&device) != cudaSuccess) {
+        device = -1;
+      }
+      task = [state, build, shapes, capacity, device]() {
+        DeviceScope scope(device);
+        Build(state, build, shapes, capacity);
+      };
+    }
+
+    try {
+      if (launch_) {
+        launch_(std::move(task));
+      } else {
+        // The previous build has finished (or is about to), only one runs at a time
+        std::unique_lock<std::mutex> lock(worker_mu_);
+        if (worker_.joinable()) {
+          worker_.join();
+        }
+        worker_ = std::thread(std::move(task));
+      }
+    } catch (const std::exception& e) {
+      LOG_WARNING("Could not start building a shape specialized engine: " << e.what());
+      std::unique_lock<std::mutex> lock(state_->mu);
+      state_->building = false;
+    }
+    return EnginePtr();
+  }
+
+  // Number of specialized engines currently kept
+  size_t Size() {
+    return std::atomic_load(&state_->engines)->size();
+  }
+
+  // Number of specialized engines evicted to stay within capacity
+  size_t Evictions() {
+    std::unique_lock<std::mutex> lock(state_->mu);
+    return state_->evictions;
+  }
+
+  bool Building() {
+    std::unique_lock<std::mutex> lock(state_->mu);
+    return state_->building;
+  }
+
+ private:
+  struct Specialization {
+    EnginePtr engine;
+    // Value of State::routes when it was last routed to
+    std::atomic<uint64_t> last_routed = {0};
+  };
+  using Engines = std::map<InputShapes, std::shared_ptr<Specialization>>;
+
+  struct State {
+    std::mutex mu;
+    // Never modified once published, replaced as a whole under mu and read
+    // without it
+    std::shared_ptr<const Engines> engines = std::make_shared<const Engines>();
+    // Ticks when a call is routed to a different engine than the last one and
+    // on every build, orders the specialized engines by recency
+    std::atomic<uint64_t> routes = {0};
+    std::map<InputShapes, size_t> counts;
+    std::set<InputShapes> failed;
+    bool building = false;
+    size_t evictions = 0;
+  };
+
+  // Makes device current until destroyed, then restores the thread's previous
+  // device. Does nothing for device -1
+  class DeviceScope {
+   public:
+    explicit DeviceScope(int device) {
+      if (device >= 0 && cudaGetDevice(&previous_) == cudaSuccess && previous_ != device) {
+        cudaSetDevice(device);
+      } else {
+        previous_ = -1;
+      }
+    }
+    ~DeviceScope() {
+      if (previous_ >= 0) {
+        cudaSetDevice(previous_);
+      }
+    }
+    DeviceScope(const DeviceScope&) = delete;
+    DeviceScope& operator=(const DeviceScope&) = delete;
+
+   private:
+    int previous_ = -1;
+  };
+
+  static void Build(std::shared_ptr<State> state, const BuildFn& build, const InputShapes& shapes, size_t capacity) {
+    EnginePtr engine;
+    try {
+      engine = build(shapes);
+    } catch (const std::exception& e) {
+      LOG_WARNING("Building a shape specialized engine failed, calls with these shapes keep using the generic engine: "
+                  << e.what());
+    }
+
+    std::vector<std::shared_ptr<Specialization>> evicted;
+    std::shared_ptr<const Engines> previous;
+    {
+      std::unique_lock<std::mutex> lock(state->mu);
+      state->building = false;
+      if (!engine) {
+        state->failed.insert(shapes);
+        return;
+      }
+      auto specialization = std::make_shared<Specialization>();
+      specialization->engine = std::move(engine);
+      // Counts as routed to, so it is the most recent engine
+      specialization->last_routed.store(
+          state->routes.fetch_add(1, std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      auto engines = std::make_shared<Engines>(*state->engines);
+      (*engines)[shapes] = std::move(specialization);
+      while (engines->size() > capacity) {
+        auto victim = std::min_element(engines->begin(), engines->end(), [](const auto& a, const auto& b) {
+          return a.second->last_routed.load(std::memory_order_relaxed) <
+              b.second->last_routed.load(std::memory_order_relaxed);
+        });
+        evicted.push_back(std::move(victim->second));
+        engines->erase(victim);
+        state->evictions++;
+      }
+      previous = std::atomic_load(&state->engines);
+      std::atomic_store(&state->engines, std::shared_ptr<const Engines>(std::move(engines)));
+    }
+    // Evicted engines (and the previous snapshot) are released outside of the
+    // lock, calls still running on them hold their own reference
+  }
+
+  size_t threshold_;
+  size_t capacity_;
+  BuildFn build_;
+  LaunchFn launch_;
+  std::shared_ptr<State> state_;
+  std::mutex worker_mu_;
+  std::thread worker_;
+};
+
+} // namespace runtime
+} // namespace core
+} // namespace trtorch
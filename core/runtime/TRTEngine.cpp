@@ -3,7 +3,10 @@
 #include "NvInfer.h"
 #include "torch/csrc/jit/frontend/function_schema_parser.h"
 
+#include "core/runtime/EngineRegistry.h"
+#include "core/runtime/compression.h"
 #include "core/runtime/runtime.h"
+#include "core/runtime/settings.h"
 #include "core/util/prelude.h"
 
 namespace trtorch {
@@ -15,30 +18,41 @@ std::string slugify(std::string s) {
   return s;
 }
 
-TRTEngine::TRTEngine(std::string serialized_engine)
-    : logger(
-          std::string("[] - "),
-          util::logging::get_logger().get_reportable_severity(),
-          util::logging::get_logger().get_is_colored_output_on()) {
-  std::string _name = "deserialized_trt";
-  new (this) TRTEngine(_name, serialized_engine);
-}
+TRTEngine::TRTEngine(std::string serialized_engine) : TRTEngine("deserialized_trt", std::move(serialized_engine)) {}
 
 TRTEngine::TRTEngine(std::string mod_name, std::string serialized_engine)
     : logger(
           std::string("[") + mod_name + std::string("_engine] - "),
           util::logging::get_logger().get_reportable_severity(),
           util::logging::get_logger().get_is_colored_output_on()) {
-  rt = nvinfer1::createInferRuntime(logger);
-
   name = slugify(mod_name) + "_engine";
 
-  cuda_engine = rt->deserializeCudaEngine(serialized_engine.c_str(), serialized_engine.size());
-  // Easy way to get a unique name for each engine, maybe there is a more
-  // descriptive way (using something associated with the graph maybe)
-  id = reinterpret_cast<EngineID>(cuda_engine);
+  // Instances loaded from the same bytes share the deserialized engine (and
+  // its weights on the device), only the execution context is per instance
+  auto deserialize = [this](const char* data, size_t size) {
+    return std::unique_ptr<DeserializedEngine>(new DeserializedEngine(name, data, size));
+  };
+  // The engine is read in place behind the settings header
+  auto offset = settings::UnwrapSettings(serialized_engine, settings);
+  const char* payload = serialized_engine.data() + offset;
+  size_t payload_size = serialized_engine.size() - offset;
+  if (compression::IsCompressed(payload, payload_size)) {
+    // Only needed until the engine is deserialized, freed when this returns
+    std::string decompressed_engine;
+    compression::DecompressEngine(payload, payload_size, decompressed_engine);
+    settings.compression_level = compression::GetCompressionLevel(payload, payload_size);
+    shared_engine = GetEngineRegistry().Acquire(decompressed_engine.data(), decompressed_engine.size(), deserialize);
+  } else {
+    shared_engine = GetEngineRegistry().Acquire(payload, payload_size, deserialize);
+  }
+  rt = shared_engine->rt;
+  cuda_engine = shared_engine->cuda_engine;
 
   exec_ctx = cuda_engine->createExecutionContext();
+  // Easy way to get a unique name for each engine, maybe there is a more
+  // descriptive way (using something associated with the graph maybe). The
+  // ICudaEngine may be shared with other instances so use the context
+  id = reinterpret_cast<EngineID>(exec_ctx);
 
   uint64_t inputs = 0;
   uint64_t outputs = 0;
@@ -51,6 +65,14 @@ TRTEngine::TRTEngine(std::string mod_name, std::string serialized_engine)
     if (cuda_engine->bindingIsInput(x)) {
       inputs++;
       in_binding_map[x] = idx;
+      auto max_dims = cuda_engine->getProfileDimensions(x, 0, nvinfer1::OptProfileSelector::kMAX);
+      if (max_input_shapes.size() <= idx) {
+        max_input_shapes.resize(idx + 1);
+      }
+      max_input_shapes[idx] = util::toVec(max_dims);
+      if (max_dims.nbDims > 0 && max_dims.d[0] > 0) {
+        max_batch = max_batch == 0 ? max_dims.d[0] : std::min<int64_t>(max_batch, max_dims.d[0]);
+      }
     } else {
       outputs++;
       out_binding_map[x] = idx;
@@ -63,15 +85,126 @@ TRTEngine& TRTEngine::operator=(const TRTEngine& other) {
   id = other.id;
   rt = other.rt;
   cuda_engine = other.cuda_engine;
+  shared_engine = other.shared_engine;
   exec_ctx = other.exec_ctx;
   num_io = other.num_io;
+  settings = other.settings;
+  max_batch = other.max_batch;
+  max_input_shapes = other.max_input_shapes;
   return (*this);
 }
 
+c10::Dict<std::string, int64_t> TRTEngine::GetStats() {
+  c10::Dict<std::string, int64_t> summary;
+  for (const auto& metric : WithActive([](TRTEngine& engine) { return engine.stats.Summary(); })) {
+    summary.insert(metric.first, metric.second);
+  }
+  return summary;
+}
+
+std::string TRTEngine::GetFlightRecord() {
+  return WithActive([](TRTEngine& engine) { return engine.flight_recorder.ToJSON(engine.name); });
+}
+
+namespace {
+// Drained engines are released on a background thread: releasing waits for
+// the device to finish with the execution context and may join a shape
+// specialization build, which the request thread whose call happened to drain
+// the engine should not wait for. Never destroyed, like the engine registry
+CompletionQueue& GetReleaseQueue() {
+  static auto queue = new CompletionQueue();
+  return *queue;
+}
+
+void ReleaseInBackground(std::function<void()> release) {
+  GetReleaseQueue().Submit(std::move(release), [](std::exception_ptr error) {
+    if (error) {
+      try {
+        std::rethrow_exception(error);
+      } catch (const std::exception& e) {
+        LOG_ERROR("Failed to release a drained TensorRT engine: " << e.what());
+      }
+    }
+  });
+}
+} // namespace
+
+void TRTEngine::Swap(c10::intrusive_ptr<TRTEngine> replacement) {
+  TRTORCH_CHECK(replacement.get() != this, "An engine cannot be swapped for itself");
+  auto next = replacement.get();
+  // Checked under the same lock as the swap so concurrent swaps cannot both
+  // pass the check against the same engine
+  auto check = [&](const c10::intrusive_ptr<TRTEngine>& active_engine) {
+    auto& current = active_engine ? *active_engine : *this;
+    TRTORCH_CHECK(
+        next->num_io == current.num_io,
+        "Replacement engine has " << next->num_io.first << " inputs and " << next->num_io.second
+                                  << " outputs, expected " << current.num_io.first << " inputs and "
+                                  << current.num_io.second << " outputs");
+    for (int64_t x = 0; x < current.cuda_engine->getNbBindings(); x++) {
+      TRTORCH_CHECK(
+          next->cuda_engine->bindingIsInput(x) == current.cuda_engine->bindingIsInput(x) &&
+              next->cuda_engine->getBindingDataType(x) == current.cuda_engine->getBindingDataType(x),
+          "Binding " << x << " of the replacement engine does not match the engine it replaces");
+    }
+    // The settings belong to the compiled method, not to the engine it runs
+    next->settings = settings;
+  };
+  // Dropping the last reference to a drained replacement releases it
+  auto on_drained = [](c10::intrusive_ptr<TRTEngine>& drained) {
+    auto engine = std::make_shared<c10::intrusive_ptr<TRTEngine>>(std::move(drained));
+    ReleaseInBackground([engine]() { engine->reset(); });
+  };
+  LOG_INFO("Swapping " << name << " for a new engine, calls in flight finish on the previous one");
+  active.CheckedSwap(std::move(replacement), check, on_drained);
+}
+
+void TRTEngine::ReleaseResources() {
+  LOG_DEBUG("Releasing TensorRT resources of " << name);
+  TakeResources().Release();
+}
+
+void TRTEngine::ReleaseResourcesInBackground() {
+  LOG_DEBUG("Releasing TensorRT resources of " << name << " in the background");
+  // Moved out so the release does not refer to this instance
+  auto resources = std::make_shared<EngineResources>(TakeResources());
+  ReleaseInBackground([resources]() { resources->Release(); });
+}
+
+EngineResources TRTEngine::TakeResources() {
+  EngineResources resources;
+  resources.specializer = std::move(specializer);
+  resources.exec_ctx = exec_ctx;
+  resources.enqueued = last_stream.has_value();
+  if (resources.enqueued) {
+    resources.last_enqueue = std::move(last_enqueue);
+  }
+  resources.shared_engine = std::move(shared_engine);
+  exec_ctx = nullptr;
+  cuda_engine = nullptr;
+  rt = nullptr;
+  last_stream = c10::nullopt;
+  return resources;
+}
+
+void EngineResources::Release() {
+  specializer.reset();
+  if (exec_ctx) {
+    // Synchronous calls return before the device is done with the context
+    if (enqueued) {
+      last_enqueue.synchronize();
+    }
+    exec_ctx->destroy();
+    exec_ctx = nullptr;
+  }
+  // The engine and runtime are destroyed with the last instance using them
+  shared_engine.reset();
+}
+
 TRTEngine::~TRTEngine() {
-  exec_ctx->destroy();
-  cuda_engine->destroy();
-  rt->destroy();
+  // Pending asynchronous executions still use the execution context
+  completion_queue.reset();
+  ReleaseResources();
 }
 
 // TODO: Implement a call method
@@ -86,12 +219,19 @@ namespace {
 static auto TRTORCH_UNUSED TRTEngineTSRegistrtion =
     torch::class_<TRTEngine>("tensorrt", "Engine")
         .def(torch::init<std::string>())
+        .def("stats", &TRTEngine::GetStats)
+        .def("flight_record", &TRTEngine::GetFlightRecord)
         // TODO: .def("__call__", &TRTEngine::Run)
         // TODO: .def("run", &TRTEngine::Run)
         .def_pickle(
             [](const c10::intrusive_ptr<TRTEngine>& self) -> std::string {
-              auto serialized_engine = self->cuda_engine->serialize();
-              return std::string((const char*)serialized_engine->data(), serialized_engine->size());
+              // Saves the engine calls currently go to if it has been swapped
+              auto serialized_engine =
+                  self->WithActive([](TRTEngine& engine) { return engine.cuda_engine->serialize(); });
+              auto payload = compression::CompressEngine(
+                  (const char*)serialized_engine->data(), serialized_engine->size(), self->settings.compression_level);
+              serialized_engine->destroy();
+              return settings::WrapSettings(self->settings, std::move(payload));
             },
             [](std::string seralized_engine) -> c10::intrusive_ptr<TRTEngine> {
               return c10::make_intrusive<TRTEngine>(std::move(seralized_engine));
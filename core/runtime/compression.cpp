@@ -0,0 +1,334 @@
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "core/runtime/compression.h"
+#include "core/util/prelude.h"
+
+namespace trtorch {
+namespace core {
+namespace runtime {
+namespace compression {
+namespace {
+
+// Payload layout (all integers little endian):
+//   [0, 4)   magic "TRTZ"
+//   [4]      format version
+//   [5]      compression level used when writing
+//   [6]      codec (1: LZ4 block)
+//   [7]      reserved
+//   [8, 16)  size of the serialized engine
+//   [16, 20) block size
+//   [20, 24) number of blocks
+// followed by one record per block: a u32 holding the stored size (high bit set
+// if the block is stored uncompressed) and the block data
+constexpr char kMagic[4] = {'T', 'R', 'T', 'Z'};
+constexpr uint8_t kVersion = 1;
+constexpr uint8_t kCodecLZ4 = 1;
+constexpr size_t kHeaderSize = 24;
+constexpr uint32_t kStoredFlag = 0x80000000u;
+
+// LZ4 block format constants
+constexpr size_t kMinMatch = 4;
+constexpr size_t kLastLiterals = 5;
+constexpr size_t kMFLimit = 12;
+constexpr size_t kMaxOffset = 65535;
+constexpr int kHashLog = 16;
+
+inline uint32_t read32(const uint8_t* p) {
+  uint32_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline uint32_t hash4(uint32_t v) {
+  return (v * 2654435761u) >> (32 - kHashLog);
+}
+
+void put_u32(std::string& out, uint32_t v) {
+  for (int i = 0; i < 4; i++) {
+    out.push_back(static_cast<char>((v >> (8 * i)) & 0xff));
+  }
+}
+
+void put_u64(std::string& out, uint64_t v) {
+  for (int i = 0; i < 8; i++) {
+    out.push_back(static_cast<char>((v >> (8 * i)) & 0xff));
+  }
+}
+
+uint64_t get_le(const uint8_t* p, int nbytes) {
+  uint64_t v = 0;
+  for (int i = 0; i < nbytes; i++) {
+    v |= static_cast<uint64_t>(p[i]) << (8 * i);
+  }
+  return v;
+}
+
+void put_length(std::string& out, size_t len) {
+  while (len >= 255) {
+    out.push_back(static_cast<char>(255));
+    len -= 255;
+  }
+  out.push_back(static_cast<char>(len));
+}
+
+void emit_sequence(
+    std::string& out,
+    const uint8_t* literals,
+    size_t num_literals,
+    size_t offset,
+    size_t match_len) {
+  size_t ml = match_len - kMinMatch;
+  uint8_t token = static_cast<uint8_t>((std::min<size_t>(num_literals, 15) << 4) | std::min<size_t>(ml, 15));
+  out.push_back(static_cast<char>(token));
+  if (num_literals >= 15) {
+    put_length(out, num_literals - 15);
+  }
+  out.append(reinterpret_cast<const char*>(literals), num_literals);
+  out.push_back(static_cast<char>(offset & 0xff));
+  out.push_back(static_cast<char>((offset >> 8) & 0xff));
+  if (ml >= 15) {
+    put_length(out, ml - 15);
+  }
+}
+
+void emit_last_literals(std::string& out, const uint8_t* literals, size_t num_literals) {
+  uint8_t token = static_cast<uint8_t>(std::min<size_t>(num_literals, 15) << 4);
+  out.push_back(static_cast<char>(token));
+  if (num_literals >= 15) {
+    put_length(out, num_literals - 15);
+  }
+  out.append(reinterpret_cast<const char*>(literals), num_literals);
+}
+
+// Appends the LZ4 block encoding of src to out. Level 1 keeps a single
+// candidate per hash bucket (LZ4 fast), higher levels walk a hash chain of up
+// to 2^(level - 1) candidates looking for the longest match
+void compress_block(const uint8_t* src, size_t n, int level, std::string& out) {
+  if (n <= kMFLimit) {
+    emit_last_literals(out, src, n);
+    return;
+  }
+
+  const bool use_chain = level > 1;
+  const int max_attempts = use_chain ? (1 << (level - 1)) : 1;
+  std::vector<int64_t> head(1 << kHashLog, -1);
+  std::vector<int64_t> chain(use_chain ? n : 0, -1);
+
+  const size_t match_start_limit = n - kMFLimit;
+  const size_t match_end_limit = n - kLastLiterals;
+
+  auto insert = [&](size_t pos) {
+    auto h = hash4(read32(src + pos));
+    if (use_chain) {
+      chain[pos] = head[h];
+    }
+    head[h] = static_cast<int64_t>(pos);
+  };
+
+  size_t anchor = 0;
+  size_t ip = 0;
+  while (ip < match_start_limit) {
+    uint32_t seq = read32(src + ip);
+    size_t best_len = 0;
+    size_t best_pos = 0;
+
+    int attempts = max_attempts;
+    int64_t cand = head[hash4(seq)];
+    while (cand >= 0 && ip - static_cast<size_t>(cand) <= kMaxOffset && attempts-- > 0) {
+      auto c = static_cast<size_t>(cand);
+      if (read32(src + c) == seq) {
+        size_t len = kMinMatch;
+        while (ip + len < match_end_limit && src[c + len] == src[ip + len]) {
+          len++;
+        }
+        if (len > best_len) {
+          best_len = len;
+          best_pos = c;
+        }
+      }
+      if (!use_chain) {
+        break;
+      }
+      cand = chain[c];
+    }
+    insert(ip);
+
+    if (best_len < kMinMatch || ip + best_len > match_end_limit) {
+      ip++;
+      continue;
+    }
+
+    // Pull the match start back over literals that also match
+    while (ip > anchor && best_pos > 0 && src[ip - 1] == src[best_pos - 1]) {
+      ip--;
+      best_pos--;
+      best_len++;
+    }
+
+    emit_sequence(out, src + anchor, ip - anchor, ip - best_pos, best_len);
+
+    size_t match_end = ip + best_len;
+    if (use_chain) {
+      for (size_t p = ip + 1; p < match_end && p < match_start_limit; p++) {
+        insert(p);
+      }
+    }
+    ip = match_end;
+    anchor = ip;
+  }
+
+  emit_last_literals(out, src + anchor, n - anchor);
+}
+
+// Decodes one LZ4 block into dst, returns the number of bytes written
+size_t decompress_block(const uint8_t* src, size_t n, uint8_t* dst, size_t capacity) {
+  size_t ip = 0;
+  size_t op = 0;
+
+  auto read_length = [&](size_t base) {
+    size_t len = base;
+    if (base == 15) {
+      uint8_t b;
+      do {
+        TRTORCH_CHECK(ip < n, "Compressed engine payload is truncated");
+        b = src[ip++];
+        len += b;
+      } while (b == 255);
+    }
+    return len;
+  };
+
+  while (ip < n) {
+    uint8_t token = src[ip++];
+    size_t num_literals = read_length(token >> 4);
+    TRTORCH_CHECK(
+        ip + num_literals <= n && op + num_literals <= capacity, "Compressed engine payload is corrupted (literals)");
+    std::memcpy(dst + op, src + ip, num_literals);
+    ip += num_literals;
+    op += num_literals;
+
+    if (ip == n) {
+      // The last sequence of a block only carries literals
+      break;
+    }
+
+    TRTORCH_CHECK(ip + 2 <= n, "Compressed engine payload is truncated");
+    size_t offset = src[ip] | (static_cast<size_t>(src[ip + 1]) << 8);
+    ip += 2;
+    TRTORCH_CHECK(offset > 0 && offset <= op, "Compressed engine payload is corrupted (offset)");
+
+    size_t match_len = read_length(token & 0xf) + kMinMatch;
+    TRTORCH_CHECK(op + match_len <= capacity, "Compressed engine payload is corrupted (match length)");
+
+    const uint8_t* match = dst + op - offset;
+    if (offset >= match_len) {
+      std::memcpy(dst + op, match, match_len);
+    } else {
+      // Overlapping copy, the match repeats bytes produced by this copy
+      for (size_t i = 0; i < match_len; i++) {
+        dst[op + i] = match[i];
+      }
+    }
+    op += match_len;
+  }
+  return op;
+}
+
+} // namespace
+
+bool IsCompressed(const char* data, size_t size) {
+  return size >= kHeaderSize && std::memcmp(data, kMagic, sizeof(kMagic)) == 0;
+}
+
+int GetCompressionLevel(const char* data, size_t size) {
+  if (!IsCompressed(data, size)) {
+    return kNoCompression;
+  }
+  return static_cast<int>(static_cast<uint8_t>(data[5]));
+}
+
+std::string CompressEngine(const char* data, size_t size, int level) {
+  TRTORCH_CHECK(
+      level >= kNoCompression && level <= kMaxCompressionLevel,
+      "Engine compression level must be between " << kNoCompression << " and " << kMaxCompressionLevel
+                                                  << ", found " << level);
+  if (level == kNoCompression) {
+    return std::string(data, size);
+  }
+
+  const auto* src = reinterpret_cast<const uint8_t*>(data);
+  uint32_t num_blocks = static_cast<uint32_t>((size + kBlockSize - 1) / kBlockSize);
+
+  std::string out;
+  out.reserve(kHeaderSize + size / 2);
+  out.append(kMagic, sizeof(kMagic));
+  out.push_back(static_cast<char>(kVersion));
+  out.push_back(static_cast<char>(level));
+  out.push_back(static_cast<char>(kCodecLZ4));
+  out.push_back(0);
+  put_u64(out, size);
+  put_u32(out, kBlockSize);
+  put_u32(out, num_blocks);
+
+  std::string block;
+  for (uint32_t b = 0; b < num_blocks; b++) {
+    size_t offset = static_cast<size_t>(b) * kBlockSize;
+    size_t len = std::min<size_t>(kBlockSize, size - offset);
+    block.clear();
+    compress_block(src + offset, len, level, block);
+    if (block.size() < len) {
+      put_u32(out, static_cast<uint32_t>(block.size()));
+      out.append(block);
+    } else {
+      put_u32(out, static_cast<uint32_t>(len) | kStoredFlag);
+      out.append(data + offset, len);
+    }
+  }
+
+  LOG_DEBUG("Compressed engine from " << size << " to " << out.size() << " bytes (level " << level << ")");
+  return out;
+}
+
+void DecompressEngine(const char* data, size_t size, std::string& out) {
+  TRTORCH_CHECK(IsCompressed(data, size), "Payload is not a compressed TensorRT engine");
+  const auto* header = reinterpret_cast<const uint8_t*>(data);
+  TRTORCH_CHECK(
+      header[4] == kVersion, "Unsupported compressed engine format version " << static_cast<int>(header[4]));
+  TRTORCH_CHECK(header[6] == kCodecLZ4, "Unsupported engine compression codec " << static_cast<int>(header[6]));
+
+  auto raw_size = static_cast<size_t>(get_le(header + 8, 8));
+  auto block_size = static_cast<size_t>(get_le(header + 16, 4));
+  auto num_blocks = static_cast<uint32_t>(get_le(header + 20, 4));
+
+  out.resize(raw_size);
+  auto* dst = reinterpret_cast<uint8_t*>(&out[0]);
+
+  size_t ip = kHeaderSize;
+  size_t op = 0;
+  for (uint32_t b = 0; b < num_blocks; b++) {
+    TRTORCH_CHECK(ip + 4 <= size, "Compressed engine payload is truncated");
+    auto record = static_cast<uint32_t>(get_le(header + ip, 4));
+    ip += 4;
+    size_t stored_size = record & ~kStoredFlag;
+    size_t expected = std::min(block_size, raw_size - op);
+    TRTORCH_CHECK(ip + stored_size <= size, "Compressed engine payload is truncated");
+
+    if (record & kStoredFlag) {
+      TRTORCH_CHECK(stored_size == expected, "Compressed engine payload is corrupted (stored block)");
+      std::memcpy(dst + op, header + ip, stored_size);
+    } else {
+      auto written = decompress_block(header + ip, stored_size, dst + op, expected);
+      TRTORCH_CHECK(written == expected, "Compressed engine payload is corrupted (block size)");
+    }
+    ip += stored_size;
+    op += expected;
+  }
+  TRTORCH_CHECK(op == raw_size, "Compressed engine payload is truncated");
+}
+
+} // namespace compression
+} // namespace runtime
+} // namespace core
+} // namespace trtorch
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace trtorch {
+namespace core {
+namespace runtime {
+namespace compression {
+
+// Levels accepted by CompressEngine, 0 stores the engine uncompressed,
+// 1 is the fastest setting and 9 gives the smallest payload
+constexpr int kNoCompression = 0;
+constexpr int kMaxCompressionLevel = 9;
+
+// Serialized engines are split into independently compressed blocks so that
+// decompression can stream into the output buffer one block at a time
+constexpr uint32_t kBlockSize = 4 << 20;
+
+// Checks for the compressed engine header at the start of a payload
+bool IsCompressed(const char* data, size_t size);
+inline bool IsCompressed(const std::string& payload) {
+  return IsCompressed(payload.data(), payload.size());
+}
+
+// Returns the level a compressed payload was written with (0 if the payload is
+// a raw serialized engine)
+int GetCompressionLevel(const char* data, size_t size);
+inline int GetCompressionLevel(const std::string& payload) {
+  return GetCompressionLevel(payload.data(), payload.size());
+}
+
+// Wraps a serialized engine in a compressed payload (LZ4 block format). Blocks
+// that do not shrink are stored as is. Level 0 returns the engine unchanged
+std::string CompressEngine(const char* data, size_t size, int level);
+
+// Decompresses a payload produced by CompressEngine into out, which is resized
+// to the size of the serialized engine. Engines are loaded into a fresh buffer
+// that is freed once TensorRT has deserialized them
+void DecompressEngine(const char* data, size_t size, std::string& out);
+inline void DecompressEngine(const std::string& payload, std::string& out) {
+  DecompressEngine(payload.data(), payload.size(), out);
+}
+
+} // namespace compression
+} // namespace runtime
+} // namespace core
+} // namespace trtorch
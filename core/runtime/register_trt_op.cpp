@@ -1,8 +1,15 @@
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+
 #include "c10/cuda/CUDAStream.h"
 
 #include "torch/csrc/jit/runtime/custom_operator.h"
 #include "torch/torch.h"
 
+#include "core/runtime/BatchSplitter.h"
+#include "core/runtime/DirectOps.h"
+#include "core/runtime/ShapeBucketing.h"
 #include "core/runtime/runtime.h"
 #include "core/util/prelude.h"
 
@@ -10,19 +17,147 @@ namespace trtorch {
 namespace core {
 namespace runtime {
 
-std::vector<at::Tensor> execute_engine(std::vector<at::Tensor> inputs, c10::intrusive_ptr<TRTEngine> compiled_engine) {
-  LOG_DEBUG("Attempting to run engine (ID: " << compiled_engine->name << ")");
+namespace {
+using Clock = std::chrono::steady_clock;
+
+uint64_t ns_between(Clock::time_point from, Clock::time_point to) {
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count());
+}
+
+// Clock reads of a call. start is read on every call (the flight recorder
+// records it), enqueued_at only on calls timed for the engine's stats
+struct CallTiming {
+  Clock::time_point start;
+  bool timed = false;
+  Clock::time_point enqueued_at;
+};
+
+// Counts the call against the shapes of its inputs (FNV-1a over the sizes)
+void record_shape(EngineStats& stats, const std::vector<at::Tensor>& inputs) {
+  uint64_t key = 14695981039346656037ull;
+  auto mix = [&key](int64_t v) { key = (key ^ static_cast<uint64_t>(v)) * 1099511628211ull; };
+  for (const auto& in : inputs) {
+    mix(in.dim());
+    for (auto d : in.sizes()) {
+      mix(d);
+    }
+  }
+  stats.shapes.Record(key, [&inputs]() {
+    std::stringstream ss;
+    for (size_t i = 0; i < inputs.size(); i++) {
+      ss << (i ? ", " : "") << inputs[i].sizes();
+    }
+    return ss.str();
+  });
+}
+
+// Fills in the flight recorder entry for a call with what is known up front,
+// duration and outcome are filled in by finish_record
+ExecutionRecord start_record(
+    TRTEngine& compiled_engine,
+    const std::vector<at::Tensor>& inputs,
+    Clock::time_point start) {
+  ExecutionRecord record = {};
+  record.start_ns =
+      static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(start.time_since_epoch()).count());
+  record.profile = compiled_engine.exec_ctx->getOptimizationProfile();
+  record.num_inputs = static_cast<uint8_t>(std::min(inputs.size(), ExecutionRecord::kMaxInputs));
+  record.truncated = inputs.size() > ExecutionRecord::kMaxInputs;
+  for (size_t i = 0; i < record.num_inputs; i++) {
+    auto& in = record.inputs[i];
+    auto sizes = inputs[i].sizes();
+    in.dtype = c10::toString(inputs[i].scalar_type());
+    in.num_dims = static_cast<uint8_t>(std::min(sizes.size(), ExecutionRecord::kMaxDims));
+    record.truncated |= sizes.size() > ExecutionRecord::kMaxDims;
+    std::copy(sizes.begin(), sizes.begin() + in.num_dims, in.dims);
+  }
+  return record;
+}
+
+void finish_record(
+    TRTEngine& compiled_engine,
+    ExecutionRecord& record,
+    Clock::time_point start,
+    Clock::time_point end,
+    bool success) {
+  record.duration_ns = ns_between(start, end);
+  record.outcome = success ? ExecutionRecord::Outcome::kSuccess : ExecutionRecord::Outcome::kError;
+  compiled_engine.flight_recorder.Record(record);
+  if (!success) {
+    // Dump what led up to the failure since it is about to be reported
+    auto recent = compiled_engine.flight_recorder.ToJSON(compiled_engine.name);
+    LOG_ERROR("Execution of " << compiled_engine.name << " failed, recent executions: " << recent);
+  }
+}
+
+// Counts a call in the engine's stats, exec_mu must be held. Calls split into
+// several executions count once. The shapes are only hashed when they differ
+// from those of the previous call. Returns whether the call is timed
+bool count_call(TRTEngine& compiled_engine, const std::vector<at::Tensor>& inputs) {
+  auto& last = compiled_engine.last_shapes;
+  size_t pos = 0;
+  bool repeat = true;
+  for (const auto& in : inputs) {
+    auto sizes = in.sizes();
+    if (pos + 1 + sizes.size() > last.size() || last[pos] != static_cast<int64_t>(sizes.size()) ||
+        !std::equal(sizes.begin(), sizes.end(), last.begin() + pos + 1)) {
+      repeat = false;
+      break;
+    }
+    pos += 1 + sizes.size();
+  }
+  if (repeat && pos == last.size()) {
+    compiled_engine.stats.shapes.RecordRepeat();
+  } else {
+    last.clear();
+    for (const auto& in : inputs) {
+      last.push_back(in.dim());
+      last.insert(last.end(), in.sizes().begin(), in.sizes().end());
+    }
+    record_shape(compiled_engine.stats, inputs);
+  }
+  return EngineStats::Timed(compiled_engine.stats.calls.Increment());
+}
+
+// Sets the binding dimensions of exec_ctx for inputs, exec_mu must be held
+void bind_input_dims(const std::vector<at::Tensor>& inputs, TRTEngine& compiled_engine) {
+  for (size_t i = 0; i < inputs.size(); i++) {
+    uint64_t pyt_idx = compiled_engine.in_binding_map[i];
+    compiled_engine.exec_ctx->setBindingDimensions(i, core::util::toDimsPad(inputs[pyt_idx].sizes(), 1));
+  }
+}
+
+// Binds inputs and outputs to the engine and enqueues it on stream. Outputs
+// are newly allocated unless into holds the (contiguous) tensors to write them
+// to, in which case the call was already counted. The tensors actually bound as
+// inputs are appended to contig_inputs, they need to stay alive until the
+// engine has finished running. For timed calls enqueued_at is set to the time
+// the engine was first handed to TensorRT for the call
+std::vector<at::Tensor> enqueue_engine(
+    std::vector<at::Tensor>& inputs,
+    TRTEngine& compiled_engine,
+    c10::cuda::CUDAStream stream,
+    std::vector<at::Tensor>& contig_inputs,
+    CallTiming& timing,
+    const std::vector<at::Tensor>* into = nullptr) {
+  LOG_DEBUG("Attempting to run engine (ID: " << compiled_engine.name << ")");
+  // Temporaries and outputs are allocated for the stream the engine runs on
+  c10::cuda::CUDAStreamGuard stream_guard(stream);
+  std::unique_lock<std::mutex> lock(compiled_engine.exec_mu);
+  if (!into) {
+    timing.timed = count_call(compiled_engine, inputs);
+  }
+
   std::vector<void*> gpu_handles;
 
-  std::vector<at::Tensor> contig_inputs{};
-  contig_inputs.reserve(inputs.size());
+  contig_inputs.reserve(contig_inputs.size() + inputs.size());
 
   for (size_t i = 0; i < inputs.size(); i++) {
-    uint64_t pyt_idx = compiled_engine->in_binding_map[i];
+    uint64_t pyt_idx = compiled_engine.in_binding_map[i];
     TRTORCH_CHECK(
         inputs[pyt_idx].is_cuda(),
         "Expected input tensors to have device cuda, found device " << inputs[pyt_idx].device());
-    auto expected_type = util::toATenDType(compiled_engine->exec_ctx->getEngine().getBindingDataType(i));
+    auto expected_type = util::toATenDType(compiled_engine.exec_ctx->getEngine().getBindingDataType(i));
     TRTORCH_CHECK(
         inputs[pyt_idx].dtype() == expected_type,
         "Expected input tensors to have type " << expected_type << ", found type " << inputs[pyt_idx].dtype());
@@ -30,34 +165,287 @@ std::vector<at::Tensor> execute_engine(std::vector<at::Tensor> inputs, c10::intr
     auto shape = core::util::toVec(dims);
     contig_inputs.push_back(inputs[pyt_idx].view(shape).contiguous());
     LOG_DEBUG("Input shape: " << dims);
-    compiled_engine->exec_ctx->setBindingDimensions(i, dims);
+    compiled_engine.exec_ctx->setBindingDimensions(i, dims);
     gpu_handles.push_back(contig_inputs.back().data_ptr());
   }
 
   TRTORCH_CHECK(
-      compiled_engine->exec_ctx->allInputDimensionsSpecified(), "Not enough inputs provided (runtime.RunCudaEngine)");
+      compiled_engine.exec_ctx->allInputDimensionsSpecified(), "Not enough inputs provided (runtime.RunCudaEngine)");
 
-  std::vector<at::Tensor> outputs(compiled_engine->num_io.second);
-  for (size_t o = inputs.size(); o < (compiled_engine->num_io.first + compiled_engine->num_io.second); o++) {
-    uint64_t pyt_idx = compiled_engine->out_binding_map[o];
-    auto out_shape = compiled_engine->exec_ctx->getBindingDimensions(o);
+  std::vector<at::Tensor> outputs(compiled_engine.num_io.second);
+  for (size_t o = inputs.size(); o < (compiled_engine.num_io.first + compiled_engine.num_io.second); o++) {
+    uint64_t pyt_idx = compiled_engine.out_binding_map[o];
+    auto out_shape = compiled_engine.exec_ctx->getBindingDimensions(o);
     LOG_DEBUG("Output shape: " << out_shape);
     auto dims = core::util::toVec(out_shape);
-    auto type = util::toATenDType(compiled_engine->exec_ctx->getEngine().getBindingDataType(o));
-    outputs[pyt_idx] = std::move(at::empty(dims, {at::kCUDA}).to(type).contiguous());
+    auto type = util::toATenDType(compiled_engine.exec_ctx->getEngine().getBindingDataType(o));
+    if (into) {
+      TRTORCH_CHECK(
+          (*into)[pyt_idx].sizes() == c10::IntArrayRef(dims) && (*into)[pyt_idx].is_contiguous(),
+          "Expected a contiguous tensor of shape " << out_shape << " to write output " << pyt_idx << " to, found "
+                                                   << (*into)[pyt_idx].sizes());
+      outputs[pyt_idx] = (*into)[pyt_idx];
+    } else {
+      outputs[pyt_idx] = std::move(at::empty(dims, {at::kCUDA}).to(type).contiguous());
+    }
     gpu_handles.push_back(outputs[pyt_idx].data_ptr());
   }
 
-  c10::cuda::CUDAStream stream = c10::cuda::getCurrentCUDAStream(inputs[0].device().index());
-  compiled_engine->exec_ctx->enqueueV2(gpu_handles.data(), stream, nullptr);
+  if (compiled_engine.last_stream && *compiled_engine.last_stream != stream) {
+    compiled_engine.last_enqueue.block(stream);
+  }
+  if (timing.timed && timing.enqueued_at == Clock::time_point()) {
+    timing.enqueued_at = Clock::now();
+    compiled_engine.stats.host_overhead_ns.Record(ns_between(timing.start, timing.enqueued_at));
+  }
+  compiled_engine.exec_ctx->enqueueV2(gpu_handles.data(), stream, nullptr);
+  compiled_engine.last_enqueue.record(stream);
+  compiled_engine.last_stream = stream;
 
   return outputs;
 }
 
+// Enqueues the call as one execution or, if its batch exceeds the engine's
+// profile and splitting is enabled, as one execution per profile sized chunk.
+// The chunks run back to back on stream and write into slices of outputs
+// allocated for the whole batch
+std::vector<at::Tensor> enqueue_batches(
+    std::vector<at::Tensor>& inputs,
+    TRTEngine& compiled_engine,
+    c10::cuda::CUDAStream stream,
+    std::vector<at::Tensor>& contig_inputs,
+    CallTiming& timing) {
+  auto batch =
+      compiled_engine.settings.split_oversized_batches ? OversizedBatch(inputs, compiled_engine.max_batch) : 0;
+  if (batch == 0) {
+    return enqueue_engine(inputs, compiled_engine, stream, contig_inputs, timing);
+  }
+  LOG_DEBUG(
+      "Splitting a batch of " << batch << " into chunks of " << compiled_engine.max_batch << " for engine "
+                              << compiled_engine.name);
+  {
+    std::unique_lock<std::mutex> lock(compiled_engine.exec_mu);
+    timing.timed = count_call(compiled_engine, inputs);
+  }
+
+  ChunkExecutor executor;
+  executor.describe_outputs = [&compiled_engine](const std::vector<at::Tensor>& chunk) {
+    std::unique_lock<std::mutex> lock(compiled_engine.exec_mu);
+    bind_input_dims(chunk, compiled_engine);
+    std::vector<OutputSpec> specs(compiled_engine.num_io.second);
+    for (size_t o = chunk.size(); o < (compiled_engine.num_io.first + compiled_engine.num_io.second); o++) {
+      uint64_t pyt_idx = compiled_engine.out_binding_map[o];
+      specs[pyt_idx].shape = core::util::toVec(compiled_engine.exec_ctx->getBindingDimensions(o));
+      specs[pyt_idx].type = util::toATenDType(compiled_engine.exec_ctx->getEngine().getBindingDataType(o));
+    }
+    return specs;
+  };
+  executor.run = [&](std::vector<at::Tensor>& chunk, std::vector<at::Tensor>& outputs) {
+    enqueue_engine(chunk, compiled_engine, stream, contig_inputs, timing, &outputs);
+  };
+  // Outputs for the whole batch are allocated for the stream the chunks run on
+  c10::cuda::CUDAStreamGuard stream_guard(stream);
+  return RunInChunks(inputs, compiled_engine.max_batch, executor);
+}
+
+// Pads inputs up to the engine's shape buckets (on stream, like the engine),
+// returns the sizes to slice the outputs back to
+std::vector<int64_t> pad_to_buckets(
+    std::vector<at::Tensor>& inputs,
+    TRTEngine& compiled_engine,
+    c10::cuda::CUDAStream stream) {
+  std::vector<int64_t> unpadded;
+  if (!compiled_engine.settings.bucketing.empty()) {
+    c10::cuda::CUDAStreamGuard stream_guard(stream);
+    inputs = PadToBuckets(inputs, compiled_engine.settings.bucketing, unpadded, compiled_engine.max_input_shapes);
+  }
+  return unpadded;
+}
+
+// Engine built for the shapes of the call if there is one, calls routed to it
+// are counted here and in full in the specialized engine's own metrics
+c10::intrusive_ptr<TRTEngine> route_to_specialized(TRTEngine& compiled_engine, const std::vector<at::Tensor>& inputs) {
+  if (!compiled_engine.specializer) {
+    return {};
+  }
+  auto specialized = compiled_engine.specializer->Route(
+      BucketedShapes(inputs, compiled_engine.settings.bucketing, compiled_engine.max_input_shapes));
+  if (specialized) {
+    compiled_engine.stats.specialized_calls.fetch_add(1, std::memory_order_relaxed);
+  }
+  return specialized;
+}
+
+void slice_from_buckets(
+    std::vector<at::Tensor>& outputs,
+    TRTEngine& compiled_engine,
+    const std::vector<int64_t>& unpadded) {
+  if (!compiled_engine.settings.bucketing.empty()) {
+    SliceFromBuckets(outputs, compiled_engine.settings.bucketing, unpadded);
+  }
+}
+} // namespace
+
+std::vector<at::Tensor> execute_engine(std::vector<at::Tensor> inputs, c10::intrusive_ptr<TRTEngine> compiled_engine) {
+  // Keeps the engine the call runs on from being released if it is swapped
+  // out while the call is running
+  auto lease = compiled_engine->active.Enter();
+  auto& engine = lease.swapped() ? *lease.get() : *compiled_engine;
+  if (auto specialized = route_to_specialized(engine, inputs)) {
+    return execute_engine(std::move(inputs), std::move(specialized));
+  }
+
+  c10::cuda::CUDAStream stream = c10::cuda::getCurrentCUDAStream(inputs[0].device().index());
+  std::vector<at::Tensor> contig_inputs;
+  CallTiming timing;
+  timing.start = Clock::now();
+  auto record = start_record(engine, inputs, timing.start);
+  try {
+    auto unpadded = pad_to_buckets(inputs, engine, stream);
+    auto outputs = enqueue_batches(inputs, engine, stream, contig_inputs, timing);
+    slice_from_buckets(outputs, engine, unpadded);
+    auto end = Clock::now();
+    if (timing.timed) {
+      engine.stats.enqueue_to_return_ns.Record(ns_between(timing.enqueued_at, end));
+    }
+    finish_record(engine, record, timing.start, end, true);
+    return outputs;
+  } catch (...) {
+    engine.stats.errors.fetch_add(1, std::memory_order_relaxed);
+    finish_record(engine, record, timing.start, Clock::now(), false);
+    throw;
+  }
+}
+
+c10::intrusive_ptr<c10::ivalue::Future> SubmitAsync(
+    CompletionQueue& queue,
+    std::function<EnqueuedExecution()> enqueue) {
+  auto future = c10::make_intrusive<c10::ivalue::Future>(c10::ListType::ofTensors());
+  // Wait for a slot before enqueuing, not after, so max_in_flight bounds the
+  // executions (and their inputs and outputs) on the device
+  auto slot = queue.Reserve();
+  auto execution = enqueue();
+  auto outputs = std::move(execution.outputs);
+  queue.Submit(std::move(slot), std::move(execution.wait), [future, outputs](std::exception_ptr error) {
+    if (error) {
+      try {
+        std::rethrow_exception(error);
+      } catch (const std::exception& e) {
+        future->setError(e.what());
+      } catch (...) {
+        future->setError("Unknown error while waiting for TensorRT engine execution");
+      }
+    } else {
+      future->markCompleted(c10::List<at::Tensor>(outputs));
+    }
+  });
+  return future;
+}
+
+c10::intrusive_ptr<c10::ivalue::Future> execute_engine_async(
+    std::vector<at::Tensor> inputs,
+    c10::intrusive_ptr<TRTEngine> compiled_engine,
+    c10::optional<c10::cuda::CUDAStream> stream,
+    std::function<void(c10::ivalue::Future&)> callback) {
+  auto exec_stream = stream ? *stream : c10::cuda::getCurrentCUDAStream(inputs[0].device().index());
+  // Held until the execution completes, see execute_engine
+  auto lease = std::make_shared<HotSwapSlot<c10::intrusive_ptr<TRTEngine>>::Lease>(compiled_engine->active.Enter());
+  auto& engine = lease->swapped() ? *lease->get() : *compiled_engine;
+  if (auto specialized = route_to_specialized(engine, inputs)) {
+    return execute_engine_async(std::move(inputs), std::move(specialized), exec_stream, std::move(callback));
+  }
+
+  CompletionQueue* queue;
+  {
+    std::unique_lock<std::mutex> lock(engine.exec_mu);
+    if (!engine.completion_queue) {
+      engine.completion_queue = std::make_unique<CompletionQueue>(static_cast<size_t>(engine.settings.max_in_flight));
+    }
+    queue = engine.completion_queue.get();
+  }
+
+  CallTiming timing;
+  timing.start = Clock::now();
+  auto record = start_record(engine, inputs, timing.start);
+  c10::intrusive_ptr<c10::ivalue::Future> future;
+  try {
+    future = SubmitAsync(*queue, [&]() {
+      std::vector<at::Tensor> contig_inputs;
+      auto unpadded = pad_to_buckets(inputs, engine, exec_stream);
+      auto outputs = enqueue_batches(inputs, engine, exec_stream, contig_inputs, timing);
+      slice_from_buckets(outputs, engine, unpadded);
+      auto done = std::make_shared<at::cuda::CUDAEvent>();
+      done->record(exec_stream);
+      // The lease keeps the engine alive until the wait is done with it (and
+      // compiled_engine a specialized engine which could be evicted meanwhile).
+      // The inputs are held by the wait so their memory is not reused before
+      // the engine has read them
+      auto engine_ptr = &engine;
+      auto wait = [done, contig_inputs, lease, compiled_engine, engine_ptr, timing, record]() mutable {
+        try {
+          done->synchronize();
+        } catch (...) {
+          engine_ptr->stats.errors.fetch_add(1, std::memory_order_relaxed);
+          finish_record(*engine_ptr, record, timing.start, Clock::now(), false);
+          throw;
+        }
+        auto end = Clock::now();
+        if (timing.timed) {
+          engine_ptr->stats.enqueue_to_return_ns.Record(ns_between(timing.enqueued_at, end));
+        }
+        finish_record(*engine_ptr, record, timing.start, end, true);
+      };
+      return EnqueuedExecution{std::move(outputs), std::move(wait)};
+    });
+  } catch (...) {
+    engine.stats.errors.fetch_add(1, std::memory_order_relaxed);
+    finish_record(engine, record, timing.start, Clock::now(), false);
+    throw;
+  }
+
+  if (callback) {
+    auto future_ptr = future.get();
+    future->addCallback([future_ptr, callback]() { callback(*future_ptr); });
+  }
+  return future;
+}
+
 TORCH_LIBRARY(tensorrt, m) {
   m.def("execute_engine", execute_engine);
 }
 
+namespace {
+c10::AliasAnalysisKind aliasAnalysisFromSchema() {
+  return c10::AliasAnalysisKind::FROM_SCHEMA;
+}
+
+// Futures cannot be returned through the typed TORCH_LIBRARY registration so
+// the asynchronous variant is registered as a boxed operator
+torch::jit::RegisterOperators trt_async_ops_reg({
+    /// Enqueues the engine on the current stream and returns a future of the
+    /// outputs instead of the outputs themselves
+    torch::jit::Operator(
+        "tensorrt::execute_engine_async(Tensor[] inputs, __torch__.torch.classes.tensorrt.Engine engine) -> Future(Tensor[])",
+        [](torch::jit::Stack& stack) {
+          auto engine = torch::jit::pop(stack).toCustomClass<TRTEngine>();
+          auto inputs = torch::jit::pop(stack).toTensorVector();
+          torch::jit::push(stack, execute_engine_async(std::move(inputs), std::move(engine)));
+          return 0;
+        },
+        aliasAnalysisFromSchema()),
+});
+
+// tensorrt::execute_engine_<N>in_<M>out, emitted by the compiler for engines
+// within the limits of DirectOps.h. tensorrt::execute_engine stays registered
+// for modules compiled before and for larger engines
+torch::jit::RegisterOperators trt_direct_ops_reg(MakeDirectOperators(
+    "tensorrt::execute_engine",
+    "__torch__.torch.classes.tensorrt.Engine",
+    [](std::vector<at::Tensor> inputs, const c10::IValue& engine) {
+      return execute_engine(std::move(inputs), engine.toCustomClass<TRTEngine>());
+    }));
+} // namespace
+
 } // namespace runtime
 } // namespace core
 } // namespace trtorch
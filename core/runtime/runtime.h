@@ -1,7 +1,21 @@
 #pragma once
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <utility>
+#include "ATen/core/Dict.h"
 #include "ATen/core/function_schema.h"
+#include "ATen/core/ivalue.h"
+#include "ATen/cuda/CUDAEvent.h"
 #include "NvInfer.h"
+#include "c10/cuda/CUDAStream.h"
+#include "core/runtime/CompletionQueue.h"
+#include "core/runtime/EngineRegistry.h"
+#include "core/runtime/EngineStats.h"
+#include "core/runtime/FlightRecorder.h"
+#include "core/runtime/HotSwap.h"
+#include "core/runtime/ShapeSpecializer.h"
+#include "core/runtime/settings.h"
 #include "core/util/prelude.h"
 #include "torch/custom_class.h"
 
@@ -11,29 +25,121 @@ namespace runtime {
 
 using EngineID = int64_t;
 
+struct EngineResources;
+
 struct TRTEngine : torch::CustomClassHolder {
-  // Each engine needs it's own runtime object
+  // Runtime and engine are owned by shared_engine and shared between all
+  // instances deserialized from the same bytes
   nvinfer1::IRuntime* rt;
   nvinfer1::ICudaEngine* cuda_engine;
+  std::shared_ptr<DeserializedEngine> shared_engine;
   nvinfer1::IExecutionContext* exec_ctx;
   std::pair<uint64_t, uint64_t> num_io;
   EngineID id;
   std::string name;
   util::logging::TRTorchLogger logger;
+  RuntimeSettings settings;
+  // Largest leading dimension the optimization profile accepts across all
+  // inputs (0 if unknown), larger batches are split if the settings allow it
+  int64_t max_batch = 0;
+  // Largest shape of each input (by PyTorch input index) the optimization
+  // profile accepts, bucket sizes are clamped to it
+  std::vector<std::vector<int64_t>> max_input_shapes;
 
   std::unordered_map<uint64_t, uint64_t> in_binding_map;
   std::unordered_map<uint64_t, uint64_t> out_binding_map;
 
+  // Serializes binding setup and enqueues on exec_ctx across threads
+  std::mutex exec_mu;
+  // Marks the end of the last enqueue, calls on a different stream wait on it
+  // since they share exec_ctx's activation memory
+  at::cuda::CUDAEvent last_enqueue;
+  c10::optional<c10::cuda::CUDAStream> last_stream;
+  // Created on the first asynchronous execution
+  std::unique_ptr<CompletionQueue> completion_queue;
+  // Collected on every call, not carried over when the module is saved
+  EngineStats stats;
+  // Rank and sizes of each input of the last call counted in stats, guarded
+  // by exec_mu
+  std::vector<int64_t> last_shapes;
+  // Last executions of the engine for post-mortem debugging, dumped to the log
+  // when an execution fails
+  FlightRecorder flight_recorder;
+  // Engine calls through this instance run on, this one until Swap is called.
+  // Once calls on it have drained this instance releases its own TensorRT
+  // resources in the background
+  HotSwapSlot<c10::intrusive_ptr<TRTEngine>> active{
+      [this](c10::intrusive_ptr<TRTEngine>&) { ReleaseResourcesInBackground(); }};
+  // Set by the compiler if settings.specialize_after is enabled, calls to
+  // engines swapped in later are not specialized
+  std::unique_ptr<ShapeSpecializer<c10::intrusive_ptr<TRTEngine>>> specializer;
+
   ~TRTEngine();
   TRTEngine(std::string serialized_engine);
   TRTEngine(std::string mod_name, std::string serialized_engine);
   TRTEngine& operator=(const TRTEngine& other);
+  // Exposed to TorchScript and Python as Engine.stats(), see EngineStats::Summary
+  c10::Dict<std::string, int64_t> GetStats();
+  // Exposed as Engine.flight_record(), see FlightRecorder::ToJSON
+  std::string GetFlightRecord();
+  // Routes later calls through this instance to replacement, calls already
+  // running finish on the engine they started on which is released after
+  void Swap(c10::intrusive_ptr<TRTEngine> replacement);
+  void ReleaseResources();
+  // Hands the resources to a background thread to be released, for engines
+  // drained by a call on a request thread
+  void ReleaseResourcesInBackground();
+  // Moves the resources out, leaving the engine without any
+  EngineResources TakeResources();
+
+  // Runs fn with the engine calls through this instance currently go to
+  template <typename Fn>
+  auto WithActive(Fn&& fn) -> decltype(fn(std::declval<TRTEngine&>())) {
+    auto lease = active.Enter();
+    return fn(lease.swapped() ? *lease.get() : *this);
+  }
   // TODO: Implement a call method
   // c10::List<at::Tensor> Run(c10::List<at::Tensor> inputs);
 };
 
+// What a TRTEngine holds on to on the device, taken out of the engine to be
+// released together (see TRTEngine::TakeResources)
+struct EngineResources {
+  std::unique_ptr<ShapeSpecializer<c10::intrusive_ptr<TRTEngine>>> specializer;
+  nvinfer1::IExecutionContext* exec_ctx = nullptr;
+  // Recorded after the last enqueue on exec_ctx if enqueued is set
+  at::cuda::CUDAEvent last_enqueue;
+  bool enqueued = false;
+  std::shared_ptr<DeserializedEngine> shared_engine;
+
+  // Joins the specializer's build, waits for the last enqueue and destroys
+  // the execution context
+  void Release();
+};
+
 std::vector<at::Tensor> execute_engine(std::vector<at::Tensor> inputs, c10::intrusive_ptr<TRTEngine> compiled_engine);
 
+// Work enqueued on a device: outputs are valid once wait returns
+struct EnqueuedExecution {
+  std::vector<at::Tensor> outputs;
+  CompletionQueue::WaitFn wait;
+};
+
+// Runs enqueue on the calling thread, once the queue has a free slot, and
+// returns a future which the completion queue fills with the outputs (or the
+// error raised while waiting)
+c10::intrusive_ptr<c10::ivalue::Future> SubmitAsync(
+    CompletionQueue& queue,
+    std::function<EnqueuedExecution()> enqueue);
+
+// Enqueues the engine on stream (defaults to the current stream) and returns
+// without waiting for the device. callback runs once the future is completed
+c10::intrusive_ptr<c10::ivalue::Future> execute_engine_async(
+    std::vector<at::Tensor> inputs,
+    c10::intrusive_ptr<TRTEngine> compiled_engine,
+    c10::optional<c10::cuda::CUDAStream> stream = c10::nullopt,
+    std::function<void(c10::ivalue::Future&)> callback = nullptr);
+
 } // namespace runtime
 } // namespace core
 } // namespace trtorch
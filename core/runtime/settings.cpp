@@ -0,0 +1,129 @@
+#include <limits>
+#include <sstream>
+
+#include "core/runtime/settings.h"
+#include "core/util/prelude.h"
+
+namespace trtorch {
+namespace core {
+namespace runtime {
+namespace settings {
+namespace {
+
+// Header layout:
+//   [0, 4)  magic "TRTS"
+//   [4, 8)  size of the body (little endian)
+// followed by the body, one "key=value\n" line per stored setting, and the
+// engine payload
+constexpr char kMagic[4] = {'T', 'R', 'T', 'S'};
+constexpr size_t kHeaderSize = 8;
+
+void put_setting(std::stringstream& ss, const char* key, int64_t value) {
+  ss << key << '=' << value << '\n';
+}
+
+// Bucket policies are stored as "input,dim,pad_value;boundaries;output:dim ..."
+// with space separated lists
+void put_bucket_policy(std::stringstream& ss, const BucketPolicy& policy) {
+  ss << "bucket=" << policy.input << ',' << policy.dim << ',' << policy.pad_value << ';';
+  for (size_t i = 0; i < policy.boundaries.size(); i++) {
+    ss << (i ? " " : "") << policy.boundaries[i];
+  }
+  ss << ';';
+  for (size_t i = 0; i < policy.output_dims.size(); i++) {
+    ss << (i ? " " : "") << policy.output_dims[i].first << ':' << policy.output_dims[i].second;
+  }
+  ss << '\n';
+}
+
+BucketPolicy parse_bucket_policy(const std::string& value) {
+  BucketPolicy policy;
+  std::stringstream ss(value);
+  char sep[3] = {};
+  ss >> policy.input >> sep[0] >> policy.dim >> sep[1] >> policy.pad_value >> sep[2];
+  TRTORCH_CHECK(
+      !ss.fail() && sep[0] == ',' && sep[1] == ',' && sep[2] == ';', "Malformed bucket policy setting: " << value);
+
+  std::string boundaries, output_dims;
+  std::getline(ss, boundaries, ';');
+  std::getline(ss, output_dims);
+  std::stringstream bs(boundaries);
+  int64_t boundary;
+  while (bs >> boundary) {
+    policy.boundaries.push_back(boundary);
+  }
+  std::stringstream os(output_dims);
+  int64_t output, dim;
+  char colon;
+  while (os >> output >> colon >> dim) {
+    TRTORCH_CHECK(colon == ':', "Malformed bucket policy setting: " << value);
+    policy.output_dims.emplace_back(output, dim);
+  }
+  return policy;
+}
+
+} // namespace
+
+std::string WrapSettings(const RuntimeSettings& settings, std::string payload) {
+  RuntimeSettings defaults;
+  std::stringstream ss;
+  if (settings.max_in_flight != defaults.max_in_flight) {
+    put_setting(ss, "max_in_flight", settings.max_in_flight);
+  }
+  if (settings.split_oversized_batches != defaults.split_oversized_batches) {
+    put_setting(ss, "split_oversized_batches", settings.split_oversized_batches);
+  }
+  ss.precision(std::numeric_limits<double>::max_digits10);
+  for (const auto& policy : settings.bucketing) {
+    put_bucket_policy(ss, policy);
+  }
+  auto body = ss.str();
+  if (body.empty()) {
+    return payload;
+  }
+
+  std::string out(kMagic, sizeof(kMagic));
+  auto size = static_cast<uint32_t>(body.size());
+  for (int i = 0; i < 4; i++) {
+    out.push_back(static_cast<char>((size >> (8 * i)) & 0xff));
+  }
+  out.reserve(kHeaderSize + body.size() + payload.size());
+  out += body;
+  out += payload;
+  return out;
+}
+
+size_t UnwrapSettings(const std::string& payload, RuntimeSettings& settings) {
+  if (payload.size() < kHeaderSize || payload.compare(0, sizeof(kMagic), kMagic, sizeof(kMagic)) != 0) {
+    return 0;
+  }
+  uint32_t size = 0;
+  for (int i = 0; i < 4; i++) {
+    size |= static_cast<uint32_t>(static_cast<uint8_t>(payload[4 + i])) << (8 * i);
+  }
+  TRTORCH_CHECK(payload.size() - kHeaderSize >= size, "Runtime settings header is truncated");
+
+  std::stringstream body(payload.substr(kHeaderSize, size));
+  std::string line;
+  while (std::getline(body, line)) {
+    auto eq = line.find('=');
+    TRTORCH_CHECK(eq != std::string::npos, "Malformed runtime setting: " << line);
+    auto key = line.substr(0, eq);
+    auto value = line.substr(eq + 1);
+    if (key == "max_in_flight") {
+      settings.max_in_flight = std::stoll(value);
+    } else if (key == "split_oversized_batches") {
+      settings.split_oversized_batches = std::stoll(value) != 0;
+    } else if (key == "bucket") {
+      settings.bucketing.push_back(parse_bucket_policy(value));
+    } else {
+      LOG_WARNING("Ignoring unknown runtime setting " << key << " stored with the engine");
+    }
+  }
+  return kHeaderSize + size;
+}
+
+} // namespace settings
+} // namespace runtime
+} // namespace core
+} // namespace trtorch
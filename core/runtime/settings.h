@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace trtorch {
+namespace core {
+namespace runtime {
+
+// Pads a dimension of an input up to the next bucket size before the engine
+// runs and cuts the listed output dimensions back to the unpadded size, so
+// varying sizes map onto a few shapes (see ShapeBucketing.h)
+struct BucketPolicy {
+  int64_t input = 0;
+  int64_t dim = 0;
+  // Ascending bucket sizes, sizes past the last one are not padded. Empty
+  // rounds sizes up to the next power of two
+  std::vector<int64_t> boundaries;
+  double pad_value = 0;
+  // (output, dimension) pairs which follow the size of the input dimension
+  std::vector<std::pair<int64_t, int64_t>> output_dims;
+};
+
+struct RuntimeSettings {
+  // Compression level applied to the serialized engine when the module is
+  // saved (0 stores the engine uncompressed, see compression.h)
+  int64_t compression_level = 0;
+  // Maximum number of asynchronous executions per engine waiting to complete,
+  // further calls to execute_engine_async block until one finishes
+  int64_t max_in_flight = 8;
+  // Run inputs whose leading dimension exceeds the largest batch of the
+  // engine's optimization profile as several profile sized chunks instead of
+  // failing (see BatchSplitter.h)
+  bool split_oversized_batches = false;
+  // Applied in order, several policies can pad different dimensions of the
+  // same input
+  std::vector<BucketPolicy> bucketing;
+  // Calls with the same input shapes after which an engine specialized for
+  // those shapes is built in the background (0 disables specialization, see
+  // ShapeSpecializer.h). Needs the lowered graph so it only applies to modules
+  // compiled in the running process and is not stored with the engine
+  int64_t specialize_after = 0;
+  // Specialized engines kept per compiled method
+  int64_t max_specializations = 4;
+};
+
+namespace settings {
+
+// Settings that differ from the defaults (other than the compression level
+// which the compressed payload records itself) are stored in a small header in
+// front of the engine payload of saved modules. Payloads without non default
+// settings are left unchanged so they load with older versions
+std::string WrapSettings(const RuntimeSettings& settings, std::string payload);
+
+// Applies the settings stored in the header of payload if there is one.
+// Returns the offset of the engine payload behind the header (0 if there is no
+// header), so the engine is not copied out of the payload
+size_t UnwrapSettings(const std::string& payload, RuntimeSettings& settings);
+
+} // namespace settings
+} // namespace runtime
+} // namespace core
+} // namespace trtorch
@@ -0,0 +1,166 @@
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <utility>
+
+#include "core/util/calibration_cache.h"
+#include "core/util/macros.h"
+
+namespace trtorch {
+namespace core {
+namespace util {
+namespace calibration {
+namespace {
+
+// Header layout:
+//   [0, 4)   magic "TRTC"
+//   [4, 8)   format version (little endian)
+//   [8, 12)  size of the key (little endian)
+// followed by the key, one "field=value\n" line per field, and the TensorRT
+// cache. TensorRT caches start with "TRT-" so raw caches are told apart by the
+// magic
+constexpr char kMagic[4] = {'T', 'R', 'T', 'C'};
+constexpr uint32_t kVersion = 1;
+constexpr size_t kHeaderSize = 12;
+
+thread_local const CacheKey* active_key = nullptr;
+thread_local std::exception_ptr* active_error = nullptr;
+
+void put_u32(std::string& out, uint32_t value) {
+  for (int i = 0; i < 4; i++) {
+    out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+  }
+}
+
+uint32_t get_u32(const std::vector<char>& in, size_t offset) {
+  uint32_t value = 0;
+  for (int i = 0; i < 4; i++) {
+    value |= static_cast<uint32_t>(static_cast<uint8_t>(in[offset + i])) << (8 * i);
+  }
+  return value;
+}
+
+} // namespace
+
+uint64_t HashGraph(const std::string& graph) {
+  return HashBytes(14695981039346656037ull, graph.data(), graph.size());
+}
+
+uint64_t HashBytes(uint64_t hash, const void* data, size_t size) {
+  auto bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < size; i++) {
+    hash = (hash ^ bytes[i]) * 1099511628211ull;
+  }
+  return hash;
+}
+
+std::string WrapCache(const CacheKey& key, const void* payload, size_t length) {
+  std::stringstream ss;
+  ss << "graph_hash=" << std::hex << key.graph_hash << std::dec << '\n';
+  ss << "inputs=" << key.input_specs << '\n';
+  ss << "algorithm=" << key.algorithm << '\n';
+  auto body = ss.str();
+
+  std::string out(kMagic, sizeof(kMagic));
+  put_u32(out, kVersion);
+  put_u32(out, static_cast<uint32_t>(body.size()));
+  out.reserve(kHeaderSize + body.size() + length);
+  out += body;
+  out.append(reinterpret_cast<const char*>(payload), length);
+  return out;
+}
+
+ParsedCache ParseCache(const std::vector<char>& contents) {
+  ParsedCache parsed;
+  if (contents.size() < sizeof(kMagic) || std::memcmp(contents.data(), kMagic, sizeof(kMagic)) != 0) {
+    return parsed;
+  }
+  TRTORCH_CHECK(contents.size() >= kHeaderSize, "Calibration cache header is truncated");
+  auto version = get_u32(contents, 4);
+  TRTORCH_CHECK(
+      version == kVersion, "Unsupported calibration cache version " << version << " (expected " << kVersion << ')');
+  auto size = get_u32(contents, 8);
+  TRTORCH_CHECK(contents.size() - kHeaderSize >= size, "Calibration cache header is truncated");
+
+  std::stringstream body(std::string(contents.data() + kHeaderSize, size));
+  std::string line;
+  while (std::getline(body, line)) {
+    auto eq = line.find('=');
+    TRTORCH_CHECK(eq != std::string::npos, "Malformed calibration cache header line: " << line);
+    auto field = line.substr(0, eq);
+    auto value = line.substr(eq + 1);
+    if (field == "graph_hash") {
+      parsed.key.graph_hash = std::stoull(value, nullptr, 16);
+    } else if (field == "inputs") {
+      parsed.key.input_specs = value;
+    } else if (field == "algorithm") {
+      parsed.key.algorithm = value;
+    }
+  }
+  parsed.has_key = true;
+  parsed.payload_offset = kHeaderSize + size;
+  return parsed;
+}
+
+bool ReadFile(const std::string& path, std::vector<char>& contents) {
+  std::ifstream input(path, std::ios::binary | std::ios::ate);
+  if (!input.good()) {
+    return false;
+  }
+  auto size = input.tellg();
+  TRTORCH_CHECK(size >= 0, "Unable to determine the size of " << path);
+  contents.resize(static_cast<size_t>(size));
+  input.seekg(0);
+  input.read(contents.data(), size);
+  TRTORCH_CHECK(input.gcount() == size, "Unable to read " << path);
+  return true;
+}
+
+std::string CheckKey(const CacheKey& expected, const CacheKey& found) {
+  std::stringstream reason;
+  if (expected.graph_hash != 0 && expected.graph_hash != found.graph_hash) {
+    reason << "it was generated for a different graph (hash " << std::hex << found.graph_hash << ", expected "
+           << expected.graph_hash << ")";
+  } else if (!expected.input_specs.empty() && expected.input_specs != found.input_specs) {
+    reason << "it was generated for different input ranges (" << found.input_specs << ", expected "
+           << expected.input_specs << ")";
+  } else if (!expected.algorithm.empty() && expected.algorithm != found.algorithm) {
+    reason << "it was generated with a different calibration algorithm (" << found.algorithm << ", expected "
+           << expected.algorithm << ")";
+  }
+  return reason.str();
+}
+
+const CacheKey* ActiveKey() {
+  return active_key;
+}
+
+void RecordCalibratorError(std::exception_ptr error) {
+  if (active_error && !*active_error) {
+    *active_error = std::move(error);
+  }
+}
+
+ActiveKeyGuard::ActiveKeyGuard(CacheKey key)
+    : key_(std::move(key)), previous_(active_key), previous_error_(active_error) {
+  active_key = &key_;
+  active_error = &error_;
+}
+
+ActiveKeyGuard::~ActiveKeyGuard() {
+  active_key = previous_;
+  active_error = previous_error_;
+}
+
+void ActiveKeyGuard::RethrowCalibratorError() {
+  if (error_) {
+    auto error = error_;
+    error_ = nullptr;
+    std::rethrow_exception(error);
+  }
+}
+
+} // namespace calibration
+} // namespace util
+} // namespace core
+} // namespace trtorch
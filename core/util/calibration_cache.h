@@ -0,0 +1,88 @@
+#pragma once
+#include <cstdint>
+#include <exception>
+#include <string>
+#include <vector>
+
+namespace trtorch {
+namespace core {
+namespace util {
+namespace calibration {
+
+// What a calibration cache was generated for. Caches written by TRTorch start
+// with a small header holding the key followed by the unmodified TensorRT cache
+struct CacheKey {
+  // Hash of the lowered graph the engine was built from and of its parameters
+  // (see HashGraph and HashBytes)
+  uint64_t graph_hash = 0;
+  // Input ranges of the engine, e.g. "[(1,3,32,32);(8,3,32,32);(32,3,32,32)]"
+  // per input
+  std::string input_specs;
+  // Calibration algorithm, e.g. "entropy2"
+  std::string algorithm;
+};
+
+// FNV-1a over the text of the graph
+uint64_t HashGraph(const std::string& graph);
+
+// Continues an FNV-1a hash (e.g. one returned by HashGraph) over size bytes
+uint64_t HashBytes(uint64_t hash, const void* data, size_t size);
+
+// Header followed by payload
+std::string WrapCache(const CacheKey& key, const void* payload, size_t length);
+
+struct ParsedCache {
+  // False for raw TensorRT caches (written by TensorRT directly or older
+  // versions of TRTorch), which cannot be validated
+  bool has_key = false;
+  CacheKey key;
+  // Start of the TensorRT cache in the file
+  size_t payload_offset = 0;
+};
+
+// Splits a cache file into its key and TensorRT cache. Malformed headers raise
+// an error
+ParsedCache ParseCache(const std::vector<char>& contents);
+
+// Reads a whole file with a single read of its size. Returns false if it does
+// not exist
+bool ReadFile(const std::string& path, std::vector<char>& contents);
+
+// Empty if a cache for found can be used for expected, otherwise why not.
+// Fields of expected which are not known (0 / empty) are not compared
+std::string CheckKey(const CacheKey& expected, const CacheKey& found);
+
+// Key of the engine the calling thread is building. TensorRT calls the
+// calibrator from the thread building the engine, so calibrators can look up
+// what the cache they read or write belongs to. Null outside of a build
+const CacheKey* ActiveKey();
+
+// Records an error a calibrator ran into while the calling thread builds an
+// engine. Exceptions must not unwind through TensorRT, so calibrators return
+// false instead and the build raises the error once TensorRT returns (see
+// ActiveKeyGuard::RethrowCalibratorError). Only the first error of a build is
+// kept, outside of a build errors are dropped
+void RecordCalibratorError(std::exception_ptr error);
+
+// Makes key the active key of the calling thread while in scope
+class ActiveKeyGuard {
+ public:
+  explicit ActiveKeyGuard(CacheKey key);
+  ~ActiveKeyGuard();
+  ActiveKeyGuard(const ActiveKeyGuard&) = delete;
+  ActiveKeyGuard& operator=(const ActiveKeyGuard&) = delete;
+
+  // Rethrows the error recorded by RecordCalibratorError while in scope, if any
+  void RethrowCalibratorError();
+
+ private:
+  CacheKey key_;
+  const CacheKey* previous_;
+  std::exception_ptr error_;
+  std::exception_ptr* previous_error_;
+};
+
+} // namespace calibration
+} // namespace util
+} // namespace core
+} // namespace trtorch
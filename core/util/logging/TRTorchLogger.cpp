@@ -1,6 +1,7 @@
 #include "core/util/logging/TRTorchLogger.h"
 
 #include <iostream>
+#include <sstream>
 #include <string>
 
 #define TERM_NORMAL "\033[0m";
@@ -23,30 +24,34 @@ TRTorchLogger::TRTorchLogger(std::string prefix, LogLevel lvl, bool color)
     : prefix_(prefix), reportable_severity_(lvl), color_(color) {}
 
 void TRTorchLogger::log(LogLevel lvl, std::string msg) {
+  std::lock_guard<std::mutex> lock(mu_);
   // suppress messages with severity enum value greater than the reportable
   if (lvl > reportable_severity_) {
     return;
   }
 
+  // Written with a single call so lines from other threads do not interleave
+  std::ostringstream line;
+
   if (color_) {
     switch (lvl) {
       case LogLevel::kINTERNAL_ERROR:
-        std::cerr << TERM_RED;
+        line << TERM_RED;
         break;
       case LogLevel::kERROR:
-        std::cerr << TERM_RED;
+        line << TERM_RED;
         break;
       case LogLevel::kWARNING:
-        std::cerr << TERM_YELLOW;
+        line << TERM_YELLOW;
         break;
       case LogLevel::kINFO:
-        std::cerr << TERM_GREEN;
+        line << TERM_GREEN;
         break;
       case LogLevel::kDEBUG:
-        std::cerr << TERM_MAGENTA;
+        line << TERM_MAGENTA;
         break;
       case LogLevel::kGRAPH:
-        std::cerr << TERM_NORMAL;
+        line << TERM_NORMAL;
         break;
       default:
         break;
@@ -55,33 +60,34 @@ void TRTorchLogger::log(LogLevel lvl, std::string msg) {
 
   switch (lvl) {
     case LogLevel::kINTERNAL_ERROR:
-      std::cerr << "INTERNAL_ERROR: ";
+      line << "INTERNAL_ERROR: ";
       break;
     case LogLevel::kERROR:
-      std::cerr << "ERROR: ";
+      line << "ERROR: ";
       break;
     case LogLevel::kWARNING:
-      std::cerr << "WARNING: ";
+      line << "WARNING: ";
       break;
     case LogLevel::kINFO:
-      std::cerr << "INFO: ";
+      line << "INFO: ";
       break;
     case LogLevel::kDEBUG:
-      std::cerr << "DEBUG: ";
+      line << "DEBUG: ";
       break;
     case LogLevel::kGRAPH:
-      std::cerr << "GRAPH: ";
+      line << "GRAPH: ";
       break;
     default:
-      std::cerr << "UNKNOWN: ";
+      line << "UNKNOWN: ";
       break;
   }
 
   if (color_) {
-    std::cerr << TERM_NORMAL;
+    line << TERM_NORMAL;
   }
 
-  std::cerr << prefix_ << msg << std::endl;
+  line << prefix_ << msg << '\n';
+  std::cerr << line.str() << std::flush;
 }
 
 void TRTorchLogger::log(Severity severity, const char* msg) {
@@ -90,34 +96,42 @@ void TRTorchLogger::log(Severity severity, const char* msg) {
 }
 
 void TRTorchLogger::set_logging_prefix(std::string prefix) {
+  std::lock_guard<std::mutex> lock(mu_);
   prefix_ = prefix;
 }
 
 void TRTorchLogger::set_reportable_severity(Severity severity) {
+  std::lock_guard<std::mutex> lock(mu_);
   reportable_severity_ = (LogLevel)severity;
 }
 
 void TRTorchLogger::set_reportable_log_level(LogLevel lvl) {
+  std::lock_guard<std::mutex> lock(mu_);
   reportable_severity_ = lvl;
 }
 
 void TRTorchLogger::set_is_colored_output_on(bool colored_output_on) {
+  std::lock_guard<std::mutex> lock(mu_);
   color_ = colored_output_on;
 }
 
 std::string TRTorchLogger::get_logging_prefix() {
+  std::lock_guard<std::mutex> lock(mu_);
   return prefix_;
 }
 
 nvinfer1::ILogger::Severity TRTorchLogger::get_reportable_severity() {
+  std::lock_guard<std::mutex> lock(mu_);
   return (Severity)reportable_severity_;
 }
 
 LogLevel TRTorchLogger::get_reportable_log_level() {
+  std::lock_guard<std::mutex> lock(mu_);
   return reportable_severity_;
 }
 
 bool TRTorchLogger::get_is_colored_output_on() {
+  std::lock_guard<std::mutex> lock(mu_);
   return color_;
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <mutex>
 #include <string>
 #include "NvInfer.h"
 
@@ -17,7 +18,8 @@ enum class LogLevel : uint8_t {
   kGRAPH
 };
 
-// Logger for TensorRT info/warning/errors
+// Logger for TensorRT info/warning/errors, may be used from several threads
+// at once (e.g. modules compiled in parallel)
 class TRTorchLogger : public nvinfer1::ILogger {
  public:
   TRTorchLogger(std::string prefix = "[TRTorch] - ", Severity severity = Severity::kWARNING, bool color = true);
@@ -34,6 +36,8 @@ class TRTorchLogger : public nvinfer1::ILogger {
   bool get_is_colored_output_on();
 
  private:
+  // Guards the settings and keeps the lines of concurrent messages apart
+  std::mutex mu_;
   std::string prefix_;
   LogLevel reportable_severity_;
   bool color_;
@@ -0,0 +1,71 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "torch/csrc/jit/serialization/import.h"
+
+#include "core/util/macros.h"
+#include "core/util/module_loading.h"
+
+namespace trtorch {
+namespace core {
+namespace util {
+
+MappedFileAdapter::MappedFileAdapter(const std::string& path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  TRTORCH_CHECK(fd >= 0, "Unable to open " << path);
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    TRTORCH_THROW_ERROR("Unable to stat " << path);
+  }
+  size_ = static_cast<size_t>(st.st_size);
+  if (size_ == 0) {
+    close(fd);
+    TRTORCH_THROW_ERROR(path << " is empty");
+  }
+  void* addr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  TRTORCH_CHECK(addr != MAP_FAILED, "Unable to map " << path);
+  base_ = static_cast<const char*>(addr);
+  // Records are mostly read front to back, one after the other
+  madvise(const_cast<char*>(base_), size_, MADV_SEQUENTIAL);
+}
+
+MappedFileAdapter::~MappedFileAdapter() {
+  munmap(const_cast<char*>(base_), size_);
+}
+
+size_t MappedFileAdapter::size() const {
+  return size_;
+}
+
+size_t MappedFileAdapter::read(uint64_t pos, void* buf, size_t n, const char* what) const {
+  if (pos >= size_) {
+    return 0;
+  }
+  n = std::min(n, size_ - static_cast<size_t>(pos));
+  std::memcpy(buf, base_ + pos, n);
+
+  // Release the whole pages which were copied. The page cache keeps them, so
+  // reading them again (e.g. the zip directory) only faults them back in
+  static const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  size_t begin = (static_cast<size_t>(pos) + page - 1) / page * page;
+  size_t end = (static_cast<size_t>(pos) + n) / page * page;
+  if (end > begin) {
+    madvise(const_cast<char*>(base_) + begin, end - begin, MADV_DONTNEED);
+  }
+  return n;
+}
+
+torch::jit::Module LoadModule(const std::string& path) {
+  return torch::jit::load(std::make_shared<MappedFileAdapter>(path));
+}
+
+} // namespace util
+} // namespace core
+} // namespace trtorch
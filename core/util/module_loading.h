@@ -0,0 +1,37 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "caffe2/serialize/read_adapter_interface.h"
+#include "torch/csrc/jit/api/module.h"
+
+namespace trtorch {
+namespace core {
+namespace util {
+
+// Reads a serialized module through a read-only mapping of the file instead of
+// a buffered stream. Pages are dropped from the mapping once their bytes have
+// been copied out, so the archive itself never adds to the resident set, only
+// the tensors loaded from it do
+class MappedFileAdapter : public caffe2::serialize::ReadAdapterInterface {
+ public:
+  explicit MappedFileAdapter(const std::string& path);
+  ~MappedFileAdapter() override;
+  MappedFileAdapter(const MappedFileAdapter&) = delete;
+  MappedFileAdapter& operator=(const MappedFileAdapter&) = delete;
+
+  size_t size() const override;
+  size_t read(uint64_t pos, void* buf, size_t n, const char* what = "") const override;
+
+ private:
+  const char* base_;
+  size_t size_;
+};
+
+// torch::jit::load through a MappedFileAdapter
+torch::jit::Module LoadModule(const std::string& path);
+
+} // namespace util
+} // namespace core
+} // namespace trtorch
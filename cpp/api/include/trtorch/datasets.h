@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) NVIDIA Corporation.
+ * All rights reserved.
+ *
+ * This library is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "torch/torch.h"
+#include "trtorch/macros.h"
+
+namespace trtorch {
+namespace datasets {
+
+/**
+ * @brief A batch of an NpyDataset
+ *
+ * Has the data and target fields of a stacked torch::data::Example<> so loops
+ * and calibrators written for them accept it unchanged.
+ */
+struct TRTORCH_API NpyBatch {
+  /// First input of the batch
+  torch::Tensor data;
+  /// Every input of the batch with its name, in the order given to the dataset
+  std::vector<std::pair<std::string, torch::Tensor>> inputs;
+  /// Targets of the batch, undefined if the dataset has none
+  torch::Tensor target;
+};
+
+/**
+ * @brief Dataset of named tensors stored as memory mapped .npy shards
+ *
+ * Each input (and the target) is a directory holding .npy files, read in
+ * lexicographic order and concatenated along the first dimension, or a single
+ * <name>.npy file. Rows of the i-th sample of each input are gathered from
+ * the mappings by get_batch, nothing else is read, so the set can be much
+ * larger than host memory. get_batch may be called from several threads, give
+ * the DataLoader workers to prefetch batches while the previous ones are
+ * consumed.
+ *
+ * Supported types are float32, float16, float64, int64, int32, int16, int8,
+ * uint8 and bool, little endian and C ordered.
+ */
+class TRTORCH_API NpyDataset : public torch::data::datasets::BatchDataset<NpyDataset, NpyBatch> {
+ public:
+  /**
+   * @brief Construct a new NpyDataset
+   *
+   * @param root: std::string - Directory holding the inputs
+   * @param input_names: std::vector<std::string> - Inputs to load, all must
+   * have the same number of rows
+   * @param target_name: std::string - Targets to load, none if empty
+   * (Default: "")
+   */
+  NpyDataset(const std::string& root, std::vector<std::string> input_names, std::string target_name = "");
+
+  /**
+   * @brief Gather the samples at indices into a batch
+   *
+   * @param indices: c10::ArrayRef<size_t> - Samples of the batch
+   * @return NpyBatch
+   */
+  NpyBatch get_batch(c10::ArrayRef<size_t> indices) override;
+
+  /**
+   * @brief Number of samples
+   */
+  c10::optional<size_t> size() const override;
+
+ private:
+  struct Impl;
+  std::shared_ptr<const Impl> impl_;
+};
+
+} // namespace datasets
+} // namespace trtorch
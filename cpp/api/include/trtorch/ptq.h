@@ -7,17 +7,42 @@
  */
 #pragma once
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <fstream>
 #include <iostream>
 #include <iterator>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "NvInfer.h"
 #include "torch/torch.h"
+#include "trtorch/datasets.h"
 #include "trtorch/logging.h"
+#include "trtorch/trtorch.h"
+
+namespace trtorch {
+namespace ptq {
+/**
+ * @brief Inputs of a calibration batch
+ *
+ * Each tensor is paired with the name of the engine input it feeds
+ * ("input_0", "input_1", ... in the order of the arguments of the module) or
+ * with an empty name, in which case the tensors feed the inputs in order
+ */
+using CalibrationInputs = std::vector<std::pair<std::string, torch::Tensor>>;
+} // namespace ptq
+} // namespace trtorch
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 namespace nvinfer1 {
@@ -27,7 +52,28 @@ class IInt8EntropyCalibrator2;
 
 namespace trtorch {
 namespace ptq {
-bool get_batch_impl(void* bindings[], const char* names[], int nbBindings, torch::Tensor& data);
+bool get_batch_impl(
+    void* bindings[],
+    const char* names[],
+    int nbBindings,
+    const CalibrationInputs& inputs,
+    std::vector<torch::Tensor>& device_inputs);
+bool stop_calibration_impl(std::exception_ptr error);
+void stage_inputs_impl(CalibrationInputs& inputs);
+std::vector<torch::Tensor> positional_inputs_impl(const CalibrationInputs& inputs);
+bool read_calibration_cache_impl(
+    const std::string& cache_file_path,
+    nvinfer1::CalibrationAlgoType algorithm,
+    bool can_recalibrate,
+    std::vector<char>& cache,
+    size_t& offset);
+void write_calibration_cache_impl(
+    const std::string& cache_file_path,
+    nvinfer1::CalibrationAlgoType algorithm,
+    const void* cache,
+    size_t length);
+torch::Tensor summarize_input_impl(const torch::Tensor& sample);
+void append_summary_impl(std::vector<float>& summaries, size_t& num_features, const torch::Tensor& summary);
 }
 } // namespace trtorch
 #endif // DOXYGEN_SHOULD_SKIP_THIS
@@ -35,10 +81,65 @@ bool get_batch_impl(void* bindings[], const char* names[], int nbBindings, torch
 namespace trtorch {
 namespace ptq {
 
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+// Conversions of the data of a batch to CalibrationInputs. Tensors, vectors
+// and tuples feed the inputs in order, maps feed them by name
+inline CalibrationInputs calibration_inputs(const torch::Tensor& data) {
+  return {{"", data}};
+}
+
+inline CalibrationInputs calibration_inputs(const std::vector<torch::Tensor>& data) {
+  CalibrationInputs inputs;
+  for (const auto& t : data) {
+    inputs.emplace_back("", t);
+  }
+  return inputs;
+}
+
+template <typename Tuple, size_t... I>
+CalibrationInputs tuple_calibration_inputs(const Tuple& data, std::index_sequence<I...>) {
+  return {{"", std::get<I>(data)}...};
+}
+
+template <typename... Tensors>
+CalibrationInputs calibration_inputs(const std::tuple<Tensors...>& data) {
+  return tuple_calibration_inputs(data, std::index_sequence_for<Tensors...>());
+}
+
+inline CalibrationInputs calibration_inputs(const std::map<std::string, torch::Tensor>& data) {
+  return CalibrationInputs(data.begin(), data.end());
+}
+
+inline CalibrationInputs calibration_inputs(const std::unordered_map<std::string, torch::Tensor>& data) {
+  return CalibrationInputs(data.begin(), data.end());
+}
+
+// Inputs of a batch yielded by a DataLoader, from its data field
+template <typename Batch>
+CalibrationInputs batch_inputs(const Batch& batch) {
+  return calibration_inputs(batch.data);
+}
+
+// Inputs of an NpyDataset batch in the order given to the dataset, the names
+// of the arrays need not match the engine inputs
+inline CalibrationInputs batch_inputs(const datasets::NpyBatch& batch) {
+  CalibrationInputs inputs;
+  for (const auto& input : batch.inputs) {
+    inputs.emplace_back("", input.second);
+  }
+  return inputs;
+}
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
 /**
  * @brief Generic Int8Calibrator implementation based on a specified
  * TensorRT calibration algorithm and a LibTorch DataLoader
  *
+ * The data of each batch is a tensor for single input modules. Modules with
+ * several inputs take a std::vector or std::tuple of tensors in the order of
+ * the inputs, or a std::map or std::unordered_map from input name ("input_0",
+ * "input_1", ...) to tensor. NpyDataset batches feed their arrays in order.
+ *
  * @tparam Algorithm: class nvinfer1::IInt8Calibrator (Default:
  * nvinfer1::IInt8EntropyCalibrator2) - Algorithm to use
  * @tparam DataLoaderUniquePtr: std::unique_ptr<torch::data::DataLoader> -
@@ -66,7 +167,8 @@ class Int8Calibrator : Algorithm {
   Int8Calibrator(DataLoaderUniquePtr dataloader, const std::string& cache_file_path, bool use_cache)
       : dataloader_(dataloader.get()), cache_file_path_(cache_file_path), use_cache_(use_cache) {
     for (auto batch : *dataloader_) {
-      batched_data_.push_back(batch.data);
+      batched_data_.push_back(batch_inputs(batch));
+      stage_inputs_impl(batched_data_.back());
     }
     it_ = batched_data_.begin();
   }
@@ -97,21 +199,30 @@ class Int8Calibrator : Algorithm {
    * @return false - There is not a new batch for the calibrator to consume
    */
   bool getBatch(void* bindings[], const char* names[], int nbBindings) override {
-    if (it_ != batched_data_.end()) {
-      auto status = get_batch_impl(bindings, names, nbBindings, *it_);
-      it_ = ++it_;
-      return status;
-    } else {
-      // Reset iterator if incase calibrator is going to be used again
+    // Called from TensorRT, errors stop calibration and are raised once the
+    // engine build returns
+    try {
+      if (it_ != batched_data_.end()) {
+        auto status = get_batch_impl(bindings, names, nbBindings, *it_, device_inputs_);
+        it_ = ++it_;
+        return status;
+      } else {
+        // Reset iterator if incase calibrator is going to be used again
+        it_ = batched_data_.begin();
+        return false;
+      }
+    } catch (...) {
       it_ = batched_data_.begin();
-      return false;
+      return stop_calibration_impl(std::current_exception());
     }
   }
 
   /**
    * @brief Read calibration cache
    *
-   * How to read from the calibration cache, only enabled if use_cache is set
+   * How to read from the calibration cache, only enabled if use_cache is set.
+   * Caches which were generated for a different graph, different input ranges
+   * or another algorithm are not used, the data is calibrated on again instead
    *
    * @param length
    * @return const void* - Pointer to cache data
@@ -122,15 +233,12 @@ class Int8Calibrator : Algorithm {
       ss << "Reading Calibration Cache from " << cache_file_path_;
       logging::log(logging::Level::kINFO, ss.str());
 
-      cache_.clear();
-      std::ifstream input(cache_file_path_, std::ios::binary);
-      input >> std::noskipws;
-      if (input.good()) {
-        std::copy(std::istream_iterator<char>(input), std::istream_iterator<char>(), std::back_inserter(cache_));
-        logging::log(logging::Level::kDEBUG, "Cache read");
+      size_t offset = 0;
+      if (!read_calibration_cache_impl(cache_file_path_, this->getAlgorithm(), true, cache_, offset)) {
+        return nullptr;
       }
-      length = cache_.size();
-      return length ? cache_.data() : nullptr;
+      length = cache_.size() - offset;
+      return length ? cache_.data() + offset : nullptr;
     }
     return nullptr;
   }
@@ -138,14 +246,15 @@ class Int8Calibrator : Algorithm {
   /**
    * @brief Write calibration cache
    *
-   * Write a the calibration cache provided by TensorRT to a specified file
+   * Write a the calibration cache provided by TensorRT to a specified file,
+   * after a header recording the graph, input ranges and algorithm it belongs
+   * to
    *
    * @param cache: const void* - cache data
    * @param length: size_t - length of cache
    */
   void writeCalibrationCache(const void* cache, size_t length) override {
-    std::ofstream cache_file(cache_file_path_, std::ios::binary);
-    cache_file.write(reinterpret_cast<const char*>(cache), length);
+    write_calibration_cache_impl(cache_file_path_, this->getAlgorithm(), cache, length);
     std::stringstream ss;
     ss << "Saved Calibration Cache to " << cache_file_path_;
     logging::log(logging::Level::kINFO, ss.str());
@@ -175,9 +284,311 @@ class Int8Calibrator : Algorithm {
   /// Cache data
   std::vector<char> cache_;
   /// Batched Data
-  std::vector<torch::Tensor> batched_data_;
+  std::vector<CalibrationInputs> batched_data_;
   /// Iterator to move through dataset
-  std::vector<torch::Tensor>::iterator it_;
+  std::vector<CalibrationInputs>::iterator it_;
+  /// Device copy of the current batch, one tensor per binding
+  std::vector<torch::Tensor> device_inputs_;
+};
+
+/**
+ * @brief Loads the batches of a LibTorch DataLoader on a background thread
+ * into a bounded queue
+ *
+ * The thread starts with the first call to Next and stays at most capacity
+ * batches ahead of the consumer, so at most capacity + 2 batches (the queue,
+ * the batch being loaded and the batch handed out last) are in memory at once
+ * regardless of the size of the dataset. Each pass over the data re-iterates
+ * the DataLoader.
+ *
+ * @tparam DataLoaderUniquePtr: std::unique_ptr<torch::data::DataLoader> -
+ * DataLoader type
+ */
+template <typename DataLoaderUniquePtr>
+class BatchPrefetcher {
+ public:
+  /**
+   * @brief Construct a new BatchPrefetcher object
+   *
+   * @param dataloader: std::unique_ptr<torch::data::DataLoader> - DataLoader to
+   * read batches from, owned by the prefetcher
+   * @param capacity: size_t - Maximum number of batches loaded ahead
+   */
+  BatchPrefetcher(DataLoaderUniquePtr dataloader, size_t capacity)
+      : state_(new State(std::move(dataloader), capacity > 0 ? capacity : 1)) {}
+  BatchPrefetcher(BatchPrefetcher&&) = default;
+  BatchPrefetcher& operator=(BatchPrefetcher&&) = default;
+
+  ~BatchPrefetcher() {
+    if (state_) {
+      Stop();
+    }
+  }
+
+  /**
+   * @brief Get the next batch of the current pass, waiting for it to be loaded
+   *
+   * Errors raised while loading are rethrown here
+   *
+   * @param batch: CalibrationInputs& - Set to the inputs of the next batch,
+   * contiguous in host memory
+   * @return true - batch holds the next batch
+   * @return false - The pass is complete, the next call starts a new pass
+   */
+  bool Next(CalibrationInputs& batch) {
+    if (!state_->worker.joinable()) {
+      Start();
+    }
+    std::unique_lock<std::mutex> lock(state_->mu);
+    state_->cv.wait(lock, [this]() { return !state_->queue.empty() || state_->done; });
+    if (!state_->queue.empty()) {
+      batch = std::move(state_->queue.front());
+      state_->queue.pop_front();
+      state_->cv.notify_all();
+      return true;
+    }
+    lock.unlock();
+    state_->worker.join();
+    if (state_->error) {
+      std::rethrow_exception(state_->error);
+    }
+    return false;
+  }
+
+  /**
+   * @brief Get the next batch of a DataLoader of single input batches
+   *
+   * @param batch: torch::Tensor& - Set to the data of the next batch
+   * @return true - batch holds the next batch
+   * @return false - The pass is complete, the next call starts a new pass
+   */
+  bool Next(torch::Tensor& batch) {
+    CalibrationInputs inputs;
+    if (!Next(inputs)) {
+      return false;
+    }
+    TORCH_CHECK(inputs.size() == 1, "Expected batches with a single input, got ", inputs.size());
+    batch = std::move(inputs[0].second);
+    return true;
+  }
+
+  /**
+   * @brief Most batches waiting in the queue at once so far
+   *
+   * @return size_t
+   */
+  size_t peak_queued() const {
+    std::unique_lock<std::mutex> lock(state_->mu);
+    return state_->peak;
+  }
+
+ private:
+  struct State {
+    State(DataLoaderUniquePtr dataloader, size_t capacity) : dataloader(std::move(dataloader)), capacity(capacity) {}
+    DataLoaderUniquePtr dataloader;
+    size_t capacity;
+    mutable std::mutex mu;
+    std::condition_variable cv;
+    std::deque<CalibrationInputs> queue;
+    size_t peak = 0;
+    bool done = false;
+    bool stop = false;
+    std::exception_ptr error;
+    std::thread worker;
+  };
+
+  void Start() {
+    state_->queue.clear();
+    state_->done = false;
+    state_->stop = false;
+    state_->error = nullptr;
+    auto state = state_.get();
+    state_->worker = std::thread([state]() {
+      try {
+        for (auto batch : *state->dataloader) {
+          // Made contiguous here rather than when TensorRT asks for the batch
+          auto inputs = batch_inputs(batch);
+          stage_inputs_impl(inputs);
+          std::unique_lock<std::mutex> lock(state->mu);
+          state->cv.wait(lock, [state]() { return state->queue.size() < state->capacity || state->stop; });
+          if (state->stop) {
+            break;
+          }
+          state->queue.push_back(std::move(inputs));
+          state->peak = std::max(state->peak, state->queue.size());
+          state->cv.notify_all();
+        }
+      } catch (...) {
+        std::unique_lock<std::mutex> lock(state->mu);
+        state->error = std::current_exception();
+      }
+      std::unique_lock<std::mutex> lock(state->mu);
+      state->done = true;
+      state->cv.notify_all();
+    });
+  }
+
+  void Stop() {
+    {
+      std::unique_lock<std::mutex> lock(state_->mu);
+      state_->stop = true;
+      state_->cv.notify_all();
+    }
+    if (state_->worker.joinable()) {
+      state_->worker.join();
+    }
+  }
+
+  /// Shared with the loading thread, kept at a stable address so the
+  /// prefetcher can be moved
+  std::unique_ptr<State> state_;
+};
+
+/**
+ * @brief Int8Calibrator implementation based on a specified TensorRT
+ * calibration algorithm which streams batches from a LibTorch DataLoader
+ *
+ * Unlike Int8Calibrator which loads the whole dataset into memory up front,
+ * batches are loaded on a background thread while TensorRT calibrates on the
+ * previous ones, with a bounded number loaded ahead (see BatchPrefetcher).
+ * Calibration algorithms which take several passes over the data re-iterate
+ * the DataLoader.
+ *
+ * @tparam Algorithm: class nvinfer1::IInt8Calibrator (Default:
+ * nvinfer1::IInt8EntropyCalibrator2) - Algorithm to use
+ * @tparam DataLoaderUniquePtr: std::unique_ptr<torch::data::DataLoader> -
+ * DataLoader type
+ */
+template <typename Algorithm, typename DataLoaderUniquePtr>
+class Int8StreamingCalibrator : Algorithm {
+ public:
+  /**
+   * @brief Construct a new Int8StreamingCalibrator object
+   *
+   * @param dataloader: std::unqiue_ptr<torch::data::DataLoader> - A unique
+   * pointer to the DataLoader, should be what is returned from the
+   * make_data_loader factory
+   * @param cache_file_path: const std::string& - A path to store / find the
+   * calibration cache
+   * @param use_cache : bool - Whether to use the cache (if it exists)
+   * @param prefetch_batches: size_t - Maximum number of batches loaded ahead of
+   * the calibrator
+   */
+  Int8StreamingCalibrator(
+      DataLoaderUniquePtr dataloader,
+      const std::string& cache_file_path,
+      bool use_cache,
+      size_t prefetch_batches)
+      : prefetcher_(std::move(dataloader), prefetch_batches), cache_file_path_(cache_file_path), use_cache_(use_cache) {}
+
+  /**
+   * @brief Get the Batch Size for the next batch (always 1 due to issues with
+   * TRT and explicit batch)
+   *
+   * @return int
+   */
+  int getBatchSize() const override {
+    // HACK: TRTorch only uses explict batch sizing, INT8 Calibrator does not
+    // work when reporting the batch size here and having explicity batching.
+    // So we just report batch size 1 (warnings will still be printed out).
+    return 1;
+  }
+
+  /**
+   * @brief Get the next Batch
+   *
+   * @param bindings: void*[] - An array of binding pointers (fed in from
+   * TensorRT calibrator), these buffers should be filed with batch data for
+   * each input
+   * @param names: const char*[] - Names of bindings
+   * @param nbBindings: int - Number of bindings
+   * @return true - There is a new batch for the calibrator to consume
+   * @return false - There is not a new batch for the calibrator to consume
+   */
+  bool getBatch(void* bindings[], const char* names[], int nbBindings) override {
+    // The device copy of the batch is held until the next call since TensorRT
+    // reads from the bindings after this returns. Called from TensorRT, errors
+    // (including ones raised while loading) stop calibration and are raised
+    // once the engine build returns
+    try {
+      CalibrationInputs batch;
+      if (!prefetcher_.Next(batch)) {
+        device_inputs_.clear();
+        return false;
+      }
+      return get_batch_impl(bindings, names, nbBindings, batch, device_inputs_);
+    } catch (...) {
+      device_inputs_.clear();
+      return stop_calibration_impl(std::current_exception());
+    }
+  }
+
+  /**
+   * @brief Read calibration cache
+   *
+   * How to read from the calibration cache, only enabled if use_cache is set.
+   * Caches which were generated for a different graph, different input ranges
+   * or another algorithm are not used, the data is calibrated on again instead
+   *
+   * @param length
+   * @return const void* - Pointer to cache data
+   */
+  const void* readCalibrationCache(size_t& length) override {
+    if (use_cache_) {
+      std::stringstream ss;
+      ss << "Reading Calibration Cache from " << cache_file_path_;
+      logging::log(logging::Level::kINFO, ss.str());
+
+      size_t offset = 0;
+      if (!read_calibration_cache_impl(cache_file_path_, this->getAlgorithm(), true, cache_, offset)) {
+        return nullptr;
+      }
+      length = cache_.size() - offset;
+      return length ? cache_.data() + offset : nullptr;
+    }
+    return nullptr;
+  }
+
+  /**
+   * @brief Write calibration cache
+   *
+   * Write a the calibration cache provided by TensorRT to a specified file,
+   * after a header recording the graph, input ranges and algorithm it belongs
+   * to
+   *
+   * @param cache: const void* - cache data
+   * @param length: size_t - length of cache
+   */
+  void writeCalibrationCache(const void* cache, size_t length) override {
+    write_calibration_cache_impl(cache_file_path_, this->getAlgorithm(), cache, length);
+    std::stringstream ss;
+    ss << "Saved Calibration Cache to " << cache_file_path_;
+    logging::log(logging::Level::kINFO, ss.str());
+  }
+
+  /**
+   * @brief operator to cast to nvinfer1::IInt8Calibrator*
+   *
+   * Convience function to convert to a IInt8Calibrator* to easily be assigned
+   * to the ptq_calibrator field in CompileSpec
+   *
+   * @return nvinfer1::IInt8Calibrator*
+   */
+  operator nvinfer1::IInt8Calibrator*() {
+    return reinterpret_cast<nvinfer1::IInt8Calibrator*>(this);
+  }
+
+ private:
+  /// Loads batches ahead of the calibrator
+  BatchPrefetcher<DataLoaderUniquePtr> prefetcher_;
+  /// Device copy of the batch handed to TensorRT last, one tensor per binding
+  std::vector<torch::Tensor> device_inputs_;
+  /// Path to cache file
+  std::string cache_file_path_;
+  /// Whether to use the cache or not
+  bool use_cache_;
+  /// Cache data
+  std::vector<char> cache_;
 };
 
 /**
@@ -229,7 +640,8 @@ class Int8CacheCalibrator : Algorithm {
   /**
    * @brief Read calibration cache
    *
-   * How to read from the calibration cache, only enabled if use_cache is set
+   * Caches which were generated for a different graph, different input ranges
+   * or another algorithm are rejected and calibration fails
    *
    * @param length
    * @return const void* - Pointer to cache data
@@ -239,28 +651,26 @@ class Int8CacheCalibrator : Algorithm {
     ss << "Reading Calibration Cache from " << cache_file_path_;
     logging::log(logging::Level::kINFO, ss.str());
 
-    cache_.clear();
-    std::ifstream input(cache_file_path_, std::ios::binary);
-    input >> std::noskipws;
-    if (input.good()) {
-      std::copy(std::istream_iterator<char>(input), std::istream_iterator<char>(), std::back_inserter(cache_));
-      logging::log(logging::Level::kDEBUG, "Cache read");
+    size_t offset = 0;
+    if (!read_calibration_cache_impl(cache_file_path_, this->getAlgorithm(), false, cache_, offset)) {
+      return nullptr;
     }
-    length = cache_.size();
-    return length ? cache_.data() : nullptr;
+    length = cache_.size() - offset;
+    return length ? cache_.data() + offset : nullptr;
   }
 
   /**
    * @brief Write calibration cache
    *
-   * Write a the calibration cache provided by TensorRT to a specified file
+   * Write a the calibration cache provided by TensorRT to a specified file,
+   * after a header recording the graph, input ranges and algorithm it belongs
+   * to
    *
    * @param cache: const void* - cache data
    * @param length: size_t - length of cache
    */
   void writeCalibrationCache(const void* cache, size_t length) override {
-    std::ofstream cache_file(cache_file_path_, std::ios::binary);
-    cache_file.write(reinterpret_cast<const char*>(cache), length);
+    write_calibration_cache_impl(cache_file_path_, this->getAlgorithm(), cache, length);
     std::stringstream ss;
     ss << "Saved Calibration Cache to " << cache_file_path_;
     logging::log(logging::Level::kINFO, ss.str());
@@ -321,6 +731,41 @@ TRTORCH_API inline Int8Calibrator<Algorithm, DataLoader> make_int8_calibrator(
   return Int8Calibrator<Algorithm, DataLoader>(std::move(dataloader), cache_file_path, use_cache);
 }
 
+/**
+ * @brief A factory to build a post training quantization calibrator which
+ * streams batches from a torch dataloader
+ *
+ * Same as make_int8_calibrator but the dataset is not loaded into memory up
+ * front, batches are loaded on a background thread during calibration with at
+ * most prefetch_batches loaded ahead. Use this for calibration sets which do
+ * not fit in host memory.
+ *
+ * e.g.
+ * ``trtorch::ptq::make_int8_streaming_calibrator(std::move(calibration_dataloader),
+ * calibration_cache_file, use_cache);``
+ * @tparam Algorithm: class nvinfer1::IInt8Calibrator (Default:
+ * nvinfer1::IInt8EntropyCalibrator2) - Algorithm to use
+ * @tparam DataLoader: std::unique_ptr<torch::data::DataLoader> - DataLoader
+ * type
+ * @param dataloader: std::unique_ptr<torch::data::DataLoader> - DataLoader
+ * containing data
+ * @param cache_file_path: const std::string& - Path to read/write calibration
+ * cache
+ * @param use_cache: bool - use calibration cache
+ * @param prefetch_batches: size_t - Maximum number of batches loaded ahead
+ * (Default: 2)
+ * @return Int8StreamingCalibrator<Algorithm, DataLoader>
+ */
+template <typename Algorithm = nvinfer1::IInt8EntropyCalibrator2, typename DataLoader>
+TRTORCH_API inline Int8StreamingCalibrator<Algorithm, DataLoader> make_int8_streaming_calibrator(
+    DataLoader dataloader,
+    const std::string& cache_file_path,
+    bool use_cache,
+    size_t prefetch_batches = 2) {
+  return Int8StreamingCalibrator<Algorithm, DataLoader>(
+      std::move(dataloader), cache_file_path, use_cache, prefetch_batches);
+}
+
 /**
  * @brief A factory to build a post training quantization calibrator from a
  * torch dataloader that only uses the calibration cache
@@ -352,5 +797,260 @@ TRTORCH_API inline Int8CacheCalibrator<Algorithm> make_int8_cache_calibrator(con
   return Int8CacheCalibrator<Algorithm>(cache_file_path);
 }
 
+/**
+ * @brief How CPUActivationCollector picks the dynamic range of a tensor from
+ * its activations
+ */
+enum class ScaleMethod {
+  /// Range minimizing the KL divergence to the INT8 quantized activations
+  kEntropy,
+  /// Largest absolute activation
+  kMinMax,
+  /// Smallest range holding the given percentile of absolute activations
+  kPercentile,
+};
+
+/**
+ * @brief Collects activation statistics of a module on the CPU to write a
+ * calibration cache without a GPU
+ *
+ * The module is lowered as it would be for compilation and run by the
+ * TorchScript interpreter on the CPU. Each batch updates a histogram of the
+ * absolute values of every tensor the TensorRT network will hold, named as it
+ * will be in the network. The cache written at the end is in the format
+ * TensorRT writes, behind the same header as caches written by the TRTorch
+ * calibrators, so an Int8CacheCalibrator for the same algorithm can build the
+ * engine from it.
+ *
+ * Tensors TensorRT creates inside of a converter are not covered, the module
+ * should run in FP32 on the CPU.
+ */
+class TRTORCH_API CPUActivationCollector {
+ public:
+  /**
+   * @brief Construct a new CPUActivationCollector
+   *
+   * @param module: const torch::jit::Module& - Module which will be compiled
+   * @param input_ranges: std::vector<CompileSpec::InputRange> - Input ranges
+   * which will be used to compile it, the cache is only valid for them
+   * @param method: ScaleMethod - How ranges are computed (Default: kEntropy)
+   * @param percentile: double - Percentile used by kPercentile (Default: 99.99)
+   * @param algorithm: nvinfer1::CalibrationAlgoType - Algorithm of the
+   * Int8CacheCalibrator which will read the cache (Default:
+   * kENTROPY_CALIBRATION_2)
+   * @param method_name: std::string - Method of the module (Default: "forward")
+   */
+  CPUActivationCollector(
+      const torch::jit::Module& module,
+      std::vector<CompileSpec::InputRange> input_ranges,
+      ScaleMethod method = ScaleMethod::kEntropy,
+      double percentile = 99.99,
+      nvinfer1::CalibrationAlgoType algorithm = nvinfer1::CalibrationAlgoType::kENTROPY_CALIBRATION_2,
+      std::string method_name = "forward");
+
+  /**
+   * @brief Run a batch and add its activations to the statistics
+   *
+   * @param inputs: std::vector<torch::Tensor> - One tensor per input
+   */
+  void collect(std::vector<torch::Tensor> inputs);
+
+  /**
+   * @brief Compute the ranges and write the calibration cache
+   *
+   * @param cache_file_path: const std::string& - Path to write the cache to
+   */
+  void write_calibration_cache(const std::string& cache_file_path) const;
+
+ private:
+  struct Impl;
+  std::shared_ptr<Impl> impl_;
+};
+
+/**
+ * @brief Write a calibration cache for a module by running a dataloader
+ * through it on the CPU
+ *
+ * e.g.
+ * ``trtorch::ptq::make_cpu_calibration_cache(mod, input_ranges,
+ * std::move(calibration_dataloader), calibration_cache_file);``
+ * followed on a GPU node by
+ * ``trtorch::ptq::make_int8_cache_calibrator(calibration_cache_file);``
+ * @tparam DataLoader: std::unique_ptr<torch::data::DataLoader> - DataLoader
+ * type
+ * @param module: const torch::jit::Module& - Module which will be compiled
+ * @param input_ranges: std::vector<CompileSpec::InputRange> - Input ranges
+ * which will be used to compile it
+ * @param dataloader: std::unique_ptr<torch::data::DataLoader> - DataLoader
+ * containing data
+ * @param cache_file_path: const std::string& - Path to write the calibration
+ * cache to
+ * @param method: ScaleMethod - How ranges are computed (Default: kEntropy)
+ * @param algorithm: nvinfer1::CalibrationAlgoType - Algorithm of the
+ * calibrator which will read the cache (Default: kENTROPY_CALIBRATION_2)
+ */
+template <typename DataLoader>
+TRTORCH_API inline void make_cpu_calibration_cache(
+    const torch::jit::Module& module,
+    std::vector<CompileSpec::InputRange> input_ranges,
+    DataLoader dataloader,
+    const std::string& cache_file_path,
+    ScaleMethod method = ScaleMethod::kEntropy,
+    nvinfer1::CalibrationAlgoType algorithm = nvinfer1::CalibrationAlgoType::kENTROPY_CALIBRATION_2) {
+  CPUActivationCollector collector(module, std::move(input_ranges), method, 99.99, algorithm);
+  for (auto batch : *dataloader) {
+    collector.collect(positional_inputs_impl(batch_inputs(batch)));
+  }
+  collector.write_calibration_cache(cache_file_path);
+}
+
+/**
+ * @brief How select_calibration_subset picks samples
+ */
+enum class SubsetStrategy {
+  /// Recursively halves the samples along the summary feature with the largest
+  /// spread into equally sized strata, one per selected sample, and takes a
+  /// random sample of each (with a fixed seed). Matches the distribution of
+  /// the full set
+  kStratified,
+  /// Greedy k-center, repeatedly takes the sample furthest from the ones
+  /// already selected. Covers rare samples at the cost of the distribution
+  kCoreset,
+};
+
+/**
+ * @brief A calibration subset and how closely it matches the full dataset
+ *
+ * Statistics are over the per sample summaries used for the selection
+ */
+struct TRTORCH_API CalibrationSubset {
+  /// Indices of the selected samples in the dataset, ascending
+  std::vector<size_t> indices;
+  /// Largest difference between the mean of a summary feature over the subset
+  /// and over the full set, in standard deviations of the full set
+  double max_mean_shift = 0;
+  /// Largest relative difference between the standard deviation of a summary
+  /// feature over the subset and over the full set
+  double max_std_error = 0;
+  /// Largest distance from any sample to its nearest selected sample, in
+  /// standard deviations
+  double coverage_radius = 0;
+};
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+CalibrationSubset select_calibration_subset_impl(
+    const std::vector<float>& summaries,
+    size_t num_features,
+    size_t target_size,
+    SubsetStrategy strategy);
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+/**
+ * @brief Selects a representative subset of a dataset for calibration
+ *
+ * Streams the dataset once, summarizing each sample with summarize (a CPU
+ * function from the sample tensor to a 1D tensor of features, e.g. activation
+ * statistics of the first layers of the model) and only keeping the
+ * summaries. Then selects target_size samples by strategy. Use the indices
+ * with a SubsetSampler to build the calibration dataloader.
+ *
+ * @tparam Dataset: torch::data::datasets::Dataset - Dataset type, must be
+ * sized and support get(index)
+ * @tparam Summarizer: torch::Tensor(const torch::Tensor&) - Summary function
+ * @param dataset: Dataset& - Full calibration dataset
+ * @param target_size: size_t - Number of samples to select
+ * @param strategy: SubsetStrategy - How samples are picked
+ * @param summarize: Summarizer - Summary function
+ * @return CalibrationSubset
+ */
+template <typename Dataset, typename Summarizer>
+TRTORCH_API inline CalibrationSubset select_calibration_subset(
+    Dataset& dataset,
+    size_t target_size,
+    SubsetStrategy strategy,
+    Summarizer summarize) {
+  std::vector<float> summaries;
+  size_t num_features = 0;
+  const size_t size = dataset.size().value();
+  for (size_t i = 0; i < size; i++) {
+    append_summary_impl(summaries, num_features, summarize(dataset.get(i).data));
+  }
+  return select_calibration_subset_impl(summaries, num_features, target_size, strategy);
+}
+
+/**
+ * @brief Selects a representative subset of a dataset for calibration from
+ * summaries of the inputs
+ *
+ * Same as above, samples are summarized by the mean, standard deviation,
+ * minimum and maximum of their values and the means of 8 equal chunks of
+ * their flattened values.
+ *
+ * e.g.
+ * ``auto subset = trtorch::ptq::select_calibration_subset(dataset, 320);``
+ * ``auto calibration_dataloader = torch::data::make_data_loader(dataset.map(torch::data::transforms::Stack<>()),
+ * trtorch::ptq::SubsetSampler(subset.indices), torch::data::DataLoaderOptions().batch_size(32));``
+ * @tparam Dataset: torch::data::datasets::Dataset - Dataset type, must be
+ * sized and support get(index)
+ * @param dataset: Dataset& - Full calibration dataset
+ * @param target_size: size_t - Number of samples to select
+ * @param strategy: SubsetStrategy - How samples are picked (Default:
+ * kStratified)
+ * @return CalibrationSubset
+ */
+template <typename Dataset>
+TRTORCH_API inline CalibrationSubset select_calibration_subset(
+    Dataset& dataset,
+    size_t target_size,
+    SubsetStrategy strategy = SubsetStrategy::kStratified) {
+  return select_calibration_subset(dataset, target_size, strategy, summarize_input_impl);
+}
+
+/**
+ * @brief Sampler yielding a fixed set of dataset indices in order, e.g. a
+ * subset from select_calibration_subset
+ */
+class SubsetSampler : public torch::data::samplers::Sampler<> {
+ public:
+  /**
+   * @brief Construct a new SubsetSampler
+   *
+   * @param indices: std::vector<size_t> - Indices to yield
+   */
+  explicit SubsetSampler(std::vector<size_t> indices) : indices_(std::move(indices)) {}
+
+  /// Restarts from the first index, the set of indices does not change
+  void reset(torch::optional<size_t> new_size = torch::nullopt) override {
+    index_ = 0;
+  }
+
+  /// Next batch_size indices, nullopt once all have been yielded
+  torch::optional<std::vector<size_t>> next(size_t batch_size) override {
+    if (index_ >= indices_.size()) {
+      return torch::nullopt;
+    }
+    auto end = std::min(indices_.size(), index_ + batch_size);
+    std::vector<size_t> batch(indices_.begin() + index_, indices_.begin() + end);
+    index_ = end;
+    return batch;
+  }
+
+  /// Serializes the position of the sampler
+  void save(torch::serialize::OutputArchive& archive) const override {
+    archive.write("index", torch::tensor(static_cast<int64_t>(index_), torch::kInt64), /*is_buffer=*/true);
+  }
+
+  /// Deserializes the position of the sampler
+  void load(torch::serialize::InputArchive& archive) override {
+    auto tensor = torch::empty(1, torch::kInt64);
+    archive.read("index", tensor, /*is_buffer=*/true);
+    index_ = tensor.item<int64_t>();
+  }
+
+ private:
+  std::vector<size_t> indices_;
+  size_t index_ = 0;
+};
+
 } // namespace ptq
 } // namespace trtorch
\ No newline at end of file
@@ -31,10 +31,49 @@ class ArrayRef;
 namespace nvinfer1 {
 class IInt8Calibrator;
 }
+
+namespace trtorch {
+struct CompileSpec;
+namespace core {
+struct CompileSpec;
+namespace lowering {
+class LoweringCache;
+} // namespace lowering
+} // namespace core
+} // namespace trtorch
 #endif // DOXYGEN_SHOULD_SKIP_THIS
 
 #include "trtorch/macros.h"
 namespace trtorch {
+/**
+ * @brief Lowered graphs shared between compilations of the same module
+ *
+ * Lowering only depends on the module, so when one module is compiled with
+ * several CompileSpecs (different precisions or input ranges) which point to
+ * the same cache, each method is lowered once and the other compilations start
+ * from the lowered graph. Safe to share between threads compiling concurrently.
+ * The cache keeps the modules it has lowered alive until it is cleared or
+ * destroyed, and the modules must not be modified while it holds them
+ */
+class TRTORCH_API LoweringCache {
+ public:
+  LoweringCache();
+
+  /// Drops the lowered graphs and the references to their modules
+  void clear();
+
+  /// Number of methods lowered through the cache so far
+  size_t lowered_methods() const;
+
+ private:
+  friend core::CompileSpec to_internal_compile_spec(CompileSpec external);
+  friend bool CheckMethodOperatorSupport(
+      const torch::jit::Module& module,
+      std::string method_name,
+      std::shared_ptr<LoweringCache> lowering_cache);
+  std::shared_ptr<core::lowering::LoweringCache> impl_;
+};
+
 /**
  * Settings data structure for TRTorch compilation
  *
@@ -373,6 +412,79 @@ struct TRTORCH_API CompileSpec {
    * Calibration dataloaders for each input for post training quantizatiom
    */
   nvinfer1::IInt8Calibrator* ptq_calibrator = nullptr;
+
+  /**
+   * Compression level for TensorRT engines embedded in the compiled module when
+   * it is saved (0 stores engines uncompressed, 1 (fastest) - 9 (smallest))
+   */
+  uint64_t engine_compression_level = 0;
+
+  /**
+   * Run inputs whose leading (batch) dimension exceeds the maximum of the
+   * input range as several chunks of at most that size and concatenate the
+   * results instead of failing. Requires all inputs and outputs to be batched
+   * along their leading dimension. Stored with the engine when the module is
+   * saved
+   */
+  bool split_oversized_batches = false;
+
+  /**
+   * Freeze the module for lowering by folding the attributes its methods read
+   * into their graphs as constants which alias the module's tensors, instead
+   * of freezing a clone of the whole module. Saves a copy of the weights while
+   * compiling. The module's weights must not be modified in place during
+   * compilation (or afterwards if specialize_after is set, since specialized
+   * engines are built from the frozen graph). Methods which write to module
+   * state are frozen from a clone as usual
+   */
+  bool freeze_in_place = false;
+
+  /**
+   * Reuse the lowered graphs of earlier compilations of the same module which
+   * used this cache, see LoweringCache
+   */
+  std::shared_ptr<LoweringCache> lowering_cache;
+
+  /**
+   * @brief Pads a dimension of an input up to a bucket size before the engine
+   * runs so that inputs of many different sizes map onto a few shapes
+   */
+  struct TRTORCH_API BucketPolicy {
+    /// Index of the input to pad
+    uint64_t input = 0;
+    /// Dimension of the input to pad
+    uint64_t dim = 0;
+    /// Ascending bucket sizes, sizes past the last one are not padded. If empty
+    /// sizes are rounded up to the next power of two. May not exceed the max of
+    /// the input's range, padding is capped at it
+    std::vector<int64_t> boundaries;
+    /// Value the padding is filled with
+    double pad_value = 0;
+    /// (output, dimension) pairs which follow the size of the padded input
+    /// dimension and are sliced back to its unpadded size
+    std::vector<std::pair<uint64_t, uint64_t>> output_dims;
+  };
+
+  /**
+   * Bucketing applied to the inputs at runtime, in order. Bucket sizes are
+   * capped at the max of the input ranges. Stored with the engine when the
+   * module is saved
+   */
+  std::vector<BucketPolicy> shape_bucketing;
+
+  /**
+   * Number of calls with the same input shapes after which an engine built
+   * for exactly those shapes is compiled in the background and used for later
+   * calls with them (0 disables specialization). The lowered graph is kept for
+   * this, so it only applies to the compiled module in the running process
+   */
+  uint64_t specialize_after = 0;
+
+  /**
+   * Maximum number of shape specialized engines kept per method, the least
+   * recently used one is evicted first
+   */
+  uint64_t max_specializations = 4;
 };
 
 /**
@@ -405,6 +517,23 @@ TRTORCH_API void dump_build_info();
  */
 TRTORCH_API bool CheckMethodOperatorSupport(const torch::jit::Module& module, std::string method_name);
 
+/**
+ * @brief Check to see if a module is fully supported by the compiler, lowering
+ * it through a cache
+ *
+ * @param module: torch::jit::script::Module - Existing TorchScript module
+ * @param method_name: std::string - Name of method to compile
+ * @param lowering_cache: std::shared_ptr<LoweringCache> - Cache the lowered
+ * method is kept in, so compiling it later with the same cache does not lower
+ * it again
+ *
+ * @returns bool: Method is supported by TRTorch
+ */
+TRTORCH_API bool CheckMethodOperatorSupport(
+    const torch::jit::Module& module,
+    std::string method_name,
+    std::shared_ptr<LoweringCache> lowering_cache);
+
 /**
  * @brief Compile a TorchScript module for NVIDIA GPUs using TensorRT
  *
@@ -421,6 +550,38 @@ TRTORCH_API bool CheckMethodOperatorSupport(const torch::jit::Module& module, st
  */
 TRTORCH_API torch::jit::Module CompileGraph(const torch::jit::Module& module, CompileSpec info);
 
+/**
+ * @brief Load a serialized TorchScript module through a memory mapping of the
+ * file
+ *
+ * @param path: std::string - Module saved with torch::jit::save or
+ * torch.jit.save
+ *
+ * Same as torch::jit::load(path) but the archive is read from the page cache
+ * instead of through a buffered stream, and pages are released from the
+ * process as soon as they are copied into tensors. Peak memory while loading
+ * large models stays close to the size of their weights
+ *
+ * @return: The loaded module
+ */
+TRTORCH_API torch::jit::Module LoadModule(std::string path);
+
+/**
+ * @brief Compile a TorchScript module saved on disk for NVIDIA GPUs using
+ * TensorRT
+ *
+ * @param module_path: std::string - Module saved with torch::jit::save or
+ * torch.jit.save
+ * @param info: trtorch::CompileSpec - Compilation settings
+ *
+ * Loads the module with LoadModule and compiles it like CompileGraph on a
+ * loaded module. The source module is released before returning, so for large
+ * models only the compiled module stays in memory
+ *
+ * @return: A new module trageting a TensorRT engine
+ */
+TRTORCH_API torch::jit::Module CompileGraph(const std::string& module_path, CompileSpec info);
+
 /**
  * @brief Compile a TorchScript method for NVIDIA GPUs using TensorRT
  *
@@ -439,4 +600,56 @@ TRTORCH_API std::string ConvertGraphToTRTEngine(
     const torch::jit::Module& module,
     std::string method_name,
     CompileSpec info);
+
+/**
+ * @brief Replace the TensorRT engine a compiled method runs while it is in use
+ *
+ * @param module: torch::jit::Module - Module returned by CompileGraph (or
+ * loaded from one that was saved)
+ * @param method_name: std::string - Name of the compiled method
+ * @param serialized_engine: std::string - Replacement engine, e.g. from
+ * ConvertGraphToTRTEngine on a retrained version of the source module
+ *
+ * Calls started after the swap run on the new engine, calls already in
+ * flight finish on the previous engine which is released once they are done.
+ * The replacement must have the same inputs and outputs (count and types) as
+ * the engine it replaces. Saving the module afterwards saves the new engine.
+ */
+TRTORCH_API void SwapEngine(const torch::jit::Module& module, std::string method_name, std::string serialized_engine);
+
+/**
+ * @brief Objective minimized when grouping recorded input shapes into
+ * optimization profiles
+ */
+enum class ProfileObjective {
+  /// Elements added by padding each call up to the max shape of its profile
+  kPadding,
+  /// Width of the input ranges, weighted by the number of calls they serve
+  kRangeWidth,
+};
+
+/**
+ * @brief Derive input ranges from the input shapes a module was called with
+ *
+ * @param shape_histogram_path: std::string - Histogram of the recorded input
+ * shapes, one line per distinct set of shapes with the number of calls followed
+ * by the shape of each input, e.g. "12 (1,3,224,224) (1,128)" (as written by
+ * trtorch.ShapeRecorder)
+ * @param num_profiles: size_t - Maximum number of profiles to split the shapes
+ * into
+ * @param objective: trtorch::ProfileObjective - What the split minimizes
+ *
+ * Each profile covers a contiguous run of the recorded shapes ordered by size,
+ * with the most frequent shape of the run as the optimal size. An engine is
+ * built for a single profile, so the input ranges of one profile are what
+ * CompileSpec takes, several profiles show how the traffic would be split
+ * across separately compiled engines.
+ *
+ * @return: std::vector<std::vector<CompileSpec::InputRange>>: The input ranges
+ * (one per input) of each profile, smallest shapes first
+ */
+TRTORCH_API std::vector<std::vector<CompileSpec::InputRange>> DeriveInputRanges(
+    std::string shape_histogram_path,
+    size_t num_profiles = 1,
+    ProfileObjective objective = ProfileObjective::kPadding);
 } // namespace trtorch
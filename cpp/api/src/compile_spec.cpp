@@ -1,6 +1,8 @@
 #include "torch/csrc/jit/api/module.h"
 
 #include "core/compiler.h"
+#include "core/runtime/ShapeBucketing.h"
+#include "core/runtime/compression.h"
 #include "core/util/prelude.h"
 
 #include "trtorch/trtorch.h"
@@ -62,6 +64,16 @@ CompileSpec::CompileSpec(std::vector<std::vector<int64_t>> fixed_sizes) {
   }
 }
 
+LoweringCache::LoweringCache() : impl_(std::make_shared<core::lowering::LoweringCache>()) {}
+
+void LoweringCache::clear() {
+  impl_->Clear();
+}
+
+size_t LoweringCache::lowered_methods() const {
+  return impl_->lowered_methods();
+}
+
 core::conversion::InputRange to_internal_input_range(CompileSpec::InputRange i) {
   return core::conversion::InputRange(i.min, i.opt, i.max);
 }
@@ -126,6 +138,39 @@ core::CompileSpec to_internal_compile_spec(CompileSpec external) {
     internal.convert_info.engine_settings.calibrator = nullptr;
   }
 
+  TRTORCH_CHECK(
+      external.engine_compression_level <= static_cast<uint64_t>(core::runtime::compression::kMaxCompressionLevel),
+      "Engine compression level must be between 0 and " << core::runtime::compression::kMaxCompressionLevel);
+  internal.runtime_settings.compression_level = external.engine_compression_level;
+  internal.runtime_settings.split_oversized_batches = external.split_oversized_batches;
+  internal.lower_info.freeze_in_place = external.freeze_in_place;
+  if (external.lowering_cache) {
+    internal.lower_info.cache = external.lowering_cache->impl_;
+  }
+
+  for (const auto& policy : external.shape_bucketing) {
+    core::runtime::BucketPolicy internal_policy;
+    internal_policy.input = static_cast<int64_t>(policy.input);
+    internal_policy.dim = static_cast<int64_t>(policy.dim);
+    internal_policy.boundaries = policy.boundaries;
+    internal_policy.pad_value = policy.pad_value;
+    for (const auto& out : policy.output_dims) {
+      internal_policy.output_dims.emplace_back(static_cast<int64_t>(out.first), static_cast<int64_t>(out.second));
+    }
+    internal.runtime_settings.bucketing.push_back(internal_policy);
+  }
+  core::runtime::MaxShapes max_shapes;
+  for (const auto& range : external.input_ranges) {
+    max_shapes.push_back(range.max);
+  }
+  core::runtime::ValidateBucketPolicies(internal.runtime_settings.bucketing, max_shapes);
+
+  TRTORCH_CHECK(
+      external.specialize_after == 0 || external.max_specializations > 0,
+      "At least one specialized engine must be allowed to enable shape specialization");
+  internal.runtime_settings.specialize_after = external.specialize_after;
+  internal.runtime_settings.max_specializations = external.max_specializations;
+
   return internal;
 }
 
@@ -0,0 +1,166 @@
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+
+#include "ATen/Parallel.h"
+#include "trtorch/datasets.h"
+
+#include "core/calibration/NpyFile.h"
+#include "core/util/prelude.h"
+
+namespace trtorch {
+namespace datasets {
+namespace {
+
+at::ScalarType npy_scalar_type(const core::calibration::NpyHeader& header) {
+  static const std::map<std::string, at::ScalarType> types = {
+      {"f4", at::kFloat},
+      {"f2", at::kHalf},
+      {"f8", at::kDouble},
+      {"i8", at::kLong},
+      {"i4", at::kInt},
+      {"i2", at::kShort},
+      {"i1", at::kChar},
+      {"u1", at::kByte},
+      {"b1", at::kBool},
+  };
+  auto type = types.find(header.descr.substr(1));
+  TRTORCH_CHECK(type != types.end(), "Unsupported npy type " << header.descr);
+  return type->second;
+}
+
+// <root>/<name>.npy if it exists, otherwise the .npy files in <root>/<name>
+std::vector<std::string> shard_paths(const std::string& root, const std::string& name) {
+  struct stat st;
+  auto file = root + '/' + name + ".npy";
+  if (stat(file.c_str(), &st) == 0 && S_ISREG(st.st_mode)) {
+    return {file};
+  }
+
+  auto dir_path = root + '/' + name;
+  DIR* dir = opendir(dir_path.c_str());
+  TRTORCH_CHECK(dir, "Found neither " << file << " nor a directory " << dir_path);
+  std::vector<std::string> paths;
+  while (auto entry = readdir(dir)) {
+    std::string entry_name = entry->d_name;
+    if (entry_name.size() > 4 && entry_name.compare(entry_name.size() - 4, 4, ".npy") == 0) {
+      paths.push_back(dir_path + '/' + entry_name);
+    }
+  }
+  closedir(dir);
+  TRTORCH_CHECK(!paths.empty(), "No .npy files in " << dir_path);
+  std::sort(paths.begin(), paths.end());
+  return paths;
+}
+
+// One input or the target, its shards concatenated along the first dimension
+struct ShardedArray {
+  std::string name;
+  std::vector<std::shared_ptr<const core::calibration::NpyFile>> shards;
+  // First row of each shard, then the total number of rows
+  std::vector<size_t> offsets;
+  at::ScalarType type;
+  // Shape of one row
+  std::vector<int64_t> row_shape;
+  size_t row_size;
+
+  ShardedArray(const std::string& root, std::string array_name) : name(std::move(array_name)) {
+    offsets.push_back(0);
+    for (const auto& path : shard_paths(root, name)) {
+      auto shard = core::calibration::NpyFile::Open(path);
+      const auto& header = shard->header();
+      TRTORCH_CHECK(!header.shape.empty(), path << " holds a scalar, expected rows along its first dimension");
+      std::vector<int64_t> shape(header.shape.begin() + 1, header.shape.end());
+      if (shards.empty()) {
+        type = npy_scalar_type(header);
+        row_shape = shape;
+        row_size = shard->row_size();
+      } else {
+        TRTORCH_CHECK(
+            npy_scalar_type(header) == type && shape == row_shape,
+            "Shard " << path << " of " << name << " has type " << header.descr << " and rows of shape "
+                     << c10::IntArrayRef(shape) << ", the first shard has rows of shape "
+                     << c10::IntArrayRef(row_shape));
+      }
+      offsets.push_back(offsets.back() + header.shape[0]);
+      shards.push_back(std::move(shard));
+    }
+  }
+
+  size_t rows() const {
+    return offsets.back();
+  }
+
+  torch::Tensor gather(c10::ArrayRef<size_t> indices) const {
+    std::vector<int64_t> shape = {static_cast<int64_t>(indices.size())};
+    shape.insert(shape.end(), row_shape.begin(), row_shape.end());
+    auto batch = torch::empty(shape, torch::TensorOptions().dtype(type));
+    auto out = static_cast<char*>(batch.data_ptr());
+
+    // Only the pages of the requested rows are read from the mappings
+    at::parallel_for(0, static_cast<int64_t>(indices.size()), 16, [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; i++) {
+        size_t index = indices[i];
+        TRTORCH_CHECK(
+            index < rows(), "Index " << index << " is out of range for " << name << " of " << rows() << " rows");
+        auto shard = std::upper_bound(offsets.begin(), offsets.end(), index) - offsets.begin() - 1;
+        auto row = shards[shard]->data() + (index - offsets[shard]) * row_size;
+        std::memcpy(out + i * row_size, row, row_size);
+      }
+    });
+    return batch;
+  }
+};
+
+} // namespace
+
+struct NpyDataset::Impl {
+  std::vector<ShardedArray> inputs;
+  std::unique_ptr<ShardedArray> target;
+};
+
+NpyDataset::NpyDataset(const std::string& root, std::vector<std::string> input_names, std::string target_name) {
+  TRTORCH_CHECK(!input_names.empty(), "NpyDataset needs at least one input");
+  auto impl = std::make_shared<Impl>();
+  for (auto& name : input_names) {
+    impl->inputs.emplace_back(root, std::move(name));
+  }
+  if (!target_name.empty()) {
+    impl->target.reset(new ShardedArray(root, std::move(target_name)));
+  }
+
+  auto rows = impl->inputs[0].rows();
+  for (const auto& input : impl->inputs) {
+    TRTORCH_CHECK(
+        input.rows() == rows,
+        "Input " << input.name << " has " << input.rows() << " rows, " << impl->inputs[0].name << " has " << rows);
+  }
+  if (impl->target) {
+    TRTORCH_CHECK(
+        impl->target->rows() == rows,
+        "Target " << impl->target->name << " has " << impl->target->rows() << " rows, the inputs have " << rows);
+  }
+  impl_ = std::move(impl);
+}
+
+NpyBatch NpyDataset::get_batch(c10::ArrayRef<size_t> indices) {
+  NpyBatch batch;
+  for (const auto& input : impl_->inputs) {
+    batch.inputs.emplace_back(input.name, input.gather(indices));
+  }
+  batch.data = batch.inputs[0].second;
+  if (impl_->target) {
+    batch.target = impl_->target->gather(indices);
+  }
+  return batch;
+}
+
+c10::optional<size_t> NpyDataset::size() const {
+  return impl_->inputs[0].rows();
+}
+
+} // namespace datasets
+} // namespace trtorch
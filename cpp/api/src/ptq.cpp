@@ -1,16 +1,232 @@
 #include "trtorch/ptq.h"
 #include "torch/torch.h"
 
+#include "core/calibration/ActivationCollector.h"
+#include "core/calibration/BindingMap.h"
+#include "core/calibration/CalibrationTable.h"
+#include "core/calibration/SubsetSelection.h"
+#include "core/util/calibration_cache.h"
+#include "core/util/prelude.h"
+
 namespace trtorch {
+std::vector<core::conversion::InputRange> to_vec_internal_input_ranges(std::vector<CompileSpec::InputRange> external);
+
 namespace ptq {
 
-bool get_batch_impl(void* bindings[], const char* names[], int nbBindings, torch::Tensor& data) {
+namespace {
+std::vector<std::string> input_names(const CalibrationInputs& inputs) {
+  std::vector<std::string> names;
+  for (const auto& input : inputs) {
+    names.push_back(input.first);
+  }
+  return names;
+}
+} // namespace
+
+bool get_batch_impl(
+    void* bindings[],
+    const char* names[],
+    int nbBindings,
+    const CalibrationInputs& inputs,
+    std::vector<torch::Tensor>& device_inputs) {
+  auto mapping = core::calibration::MapBindings(input_names(inputs), names, nbBindings);
+  device_inputs.resize(nbBindings);
   for (int i = 0; i < nbBindings; i++) {
-    data = data.to(at::kCUDA).contiguous();
-    bindings[i] = data.data_ptr();
+    const auto& host = inputs[mapping[i]].second;
+    auto& device = device_inputs[i];
+    // Batches of the same shape reuse the buffers of the previous one, so each
+    // binding costs a single copy of the staged (contiguous) host tensor
+    if (!device.defined() || device.sizes() != host.sizes() || device.scalar_type() != host.scalar_type()) {
+      device = torch::empty(host.sizes(), host.options().device(at::kCUDA));
+    }
+    device.copy_(host);
+    bindings[i] = device.data_ptr();
   }
   return true;
 }
 
+bool stop_calibration_impl(std::exception_ptr error) {
+  try {
+    std::rethrow_exception(error);
+  } catch (const std::exception& e) {
+    LOG_ERROR("Stopping calibration, unable to get the next batch: " << e.what());
+  } catch (...) {
+    LOG_ERROR("Stopping calibration, unable to get the next batch");
+  }
+  core::util::calibration::RecordCalibratorError(error);
+  return false;
+}
+
+void stage_inputs_impl(CalibrationInputs& inputs) {
+  for (auto& input : inputs) {
+    input.second = input.second.contiguous();
+  }
+}
+
+std::vector<torch::Tensor> positional_inputs_impl(const CalibrationInputs& inputs) {
+  std::vector<std::string> positions;
+  std::vector<const char*> position_names;
+  for (size_t i = 0; i < inputs.size(); i++) {
+    positions.push_back(core::calibration::InputBindingName(i));
+  }
+  for (const auto& name : positions) {
+    position_names.push_back(name.c_str());
+  }
+  auto mapping =
+      core::calibration::MapBindings(input_names(inputs), position_names.data(), static_cast<int>(positions.size()));
+  std::vector<torch::Tensor> ordered;
+  for (auto i : mapping) {
+    ordered.push_back(inputs[i].second);
+  }
+  return ordered;
+}
+
+namespace {
+// Key of the engine being built, only the algorithm is known if the
+// calibrator is used outside of TRTorch
+core::util::calibration::CacheKey expected_key(nvinfer1::CalibrationAlgoType algorithm) {
+  auto active = core::util::calibration::ActiveKey();
+  auto key = active ? *active : core::util::calibration::CacheKey();
+  key.algorithm = core::calibration::AlgorithmName(algorithm);
+  return key;
+}
+} // namespace
+
+bool read_calibration_cache_impl(
+    const std::string& cache_file_path,
+    nvinfer1::CalibrationAlgoType algorithm,
+    bool can_recalibrate,
+    std::vector<char>& cache,
+    size_t& offset) {
+  cache.clear();
+  offset = 0;
+  try {
+    if (!core::util::calibration::ReadFile(cache_file_path, cache)) {
+      return false;
+    }
+    auto parsed = core::util::calibration::ParseCache(cache);
+    if (!parsed.has_key) {
+      LOG_INFO(
+          "Calibration cache " << cache_file_path
+                               << " has no header, it cannot be checked against the engine being built");
+      return true;
+    }
+    auto mismatch = core::util::calibration::CheckKey(expected_key(algorithm), parsed.key);
+    if (!mismatch.empty()) {
+      if (can_recalibrate) {
+        LOG_WARNING("Not using calibration cache " << cache_file_path << " since " << mismatch << ", recalibrating");
+      } else {
+        LOG_ERROR("Rejecting calibration cache " << cache_file_path << " since " << mismatch);
+      }
+      cache.clear();
+      return false;
+    }
+    offset = parsed.payload_offset;
+    LOG_DEBUG("Cache read");
+    return true;
+  } catch (const std::exception& e) {
+    LOG_ERROR("Unable to read calibration cache " << cache_file_path << ": " << e.what());
+    cache.clear();
+    return false;
+  }
+}
+
+void write_calibration_cache_impl(
+    const std::string& cache_file_path,
+    nvinfer1::CalibrationAlgoType algorithm,
+    const void* cache,
+    size_t length) {
+  // Called from TensorRT, which errors must not unwind through
+  try {
+    auto contents = core::util::calibration::WrapCache(expected_key(algorithm), cache, length);
+    std::ofstream cache_file(cache_file_path, std::ios::binary);
+    cache_file.write(contents.data(), contents.size());
+  } catch (const std::exception& e) {
+    LOG_ERROR("Unable to write calibration cache " << cache_file_path << ": " << e.what());
+  }
+}
+
+struct CPUActivationCollector::Impl {
+  core::calibration::ActivationCollector collector;
+};
+
+namespace {
+core::calibration::ScaleMethod to_internal_scale_method(ScaleMethod method) {
+  switch (method) {
+    case ScaleMethod::kMinMax:
+      return core::calibration::ScaleMethod::kMinMax;
+    case ScaleMethod::kPercentile:
+      return core::calibration::ScaleMethod::kPercentile;
+    case ScaleMethod::kEntropy:
+    default:
+      return core::calibration::ScaleMethod::kEntropy;
+  }
+}
+} // namespace
+
+CPUActivationCollector::CPUActivationCollector(
+    const torch::jit::Module& module,
+    std::vector<CompileSpec::InputRange> input_ranges,
+    ScaleMethod method,
+    double percentile,
+    nvinfer1::CalibrationAlgoType algorithm,
+    std::string method_name) {
+  core::calibration::CollectorSettings settings;
+  settings.method = to_internal_scale_method(method);
+  settings.percentile = percentile;
+  settings.algorithm = algorithm;
+  impl_ = std::make_shared<Impl>(Impl{core::calibration::MakeActivationCollector(
+      module, method_name, to_vec_internal_input_ranges(std::move(input_ranges)), settings)});
+}
+
+void CPUActivationCollector::collect(std::vector<torch::Tensor> inputs) {
+  impl_->collector.Collect(std::move(inputs));
+}
+
+void CPUActivationCollector::write_calibration_cache(const std::string& cache_file_path) const {
+  impl_->collector.WriteCache(cache_file_path);
+}
+
+torch::Tensor summarize_input_impl(const torch::Tensor& sample) {
+  auto flat = sample.detach().to(torch::kCPU, torch::kFloat).reshape({1, 1, -1});
+  auto chunks = torch::adaptive_avg_pool1d(flat, 8).flatten();
+  return torch::cat({torch::stack({flat.mean(), flat.std(/*unbiased=*/false), flat.min(), flat.max()}), chunks});
+}
+
+void append_summary_impl(std::vector<float>& summaries, size_t& num_features, const torch::Tensor& summary) {
+  auto flat = summary.detach().to(torch::kCPU, torch::kFloat).contiguous().flatten();
+  auto n = static_cast<size_t>(flat.numel());
+  if (summaries.empty()) {
+    num_features = n;
+  }
+  TRTORCH_CHECK(n == num_features, "Expected " << num_features << " summary features for every sample, got " << n);
+  summaries.insert(summaries.end(), flat.data_ptr<float>(), flat.data_ptr<float>() + n);
+}
+
+CalibrationSubset select_calibration_subset_impl(
+    const std::vector<float>& summaries,
+    size_t num_features,
+    size_t target_size,
+    SubsetStrategy strategy) {
+  auto selection = core::calibration::SelectSubset(
+      summaries,
+      num_features,
+      target_size,
+      strategy == SubsetStrategy::kCoreset ? core::calibration::SubsetStrategy::kCoreset
+                                           : core::calibration::SubsetStrategy::kStratified);
+  LOG_INFO(
+      "Selected " << selection.indices.size() << " of " << summaries.size() / num_features
+                  << " samples for calibration (max mean shift " << selection.max_mean_shift
+                  << " std, max std error " << selection.max_std_error << ", coverage radius "
+                  << selection.coverage_radius << " std)");
+
+  CalibrationSubset subset;
+  subset.indices = std::move(selection.indices);
+  subset.max_mean_shift = selection.max_mean_shift;
+  subset.max_std_error = selection.max_std_error;
+  subset.coverage_radius = selection.coverage_radius;
+  return subset;
+}
+
 } // namespace ptq
-} // namespace trtorch
\ No newline at end of file
+} // namespace trtorch
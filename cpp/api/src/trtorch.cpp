@@ -1,6 +1,10 @@
+#include <fstream>
+
 #include "torch/csrc/jit/api/module.h"
 
 #include "core/compiler.h"
+#include "core/runtime/ShapeProfiles.h"
+#include "core/util/module_loading.h"
 #include "core/util/prelude.h"
 
 #include "trtorch/trtorch.h"
@@ -14,6 +18,17 @@ bool CheckMethodOperatorSupport(const torch::jit::script::Module& module, std::s
   return core::CheckMethodOperatorSupport(module, method_name);
 }
 
+bool CheckMethodOperatorSupport(
+    const torch::jit::script::Module& module,
+    std::string method_name,
+    std::shared_ptr<LoweringCache> lowering_cache) {
+  core::lowering::LowerInfo lower_info;
+  if (lowering_cache) {
+    lower_info.cache = lowering_cache->impl_;
+  }
+  return core::CheckMethodOperatorSupport(module, method_name, lower_info);
+}
+
 std::string ConvertGraphToTRTEngine(
     const torch::jit::script::Module& module,
     std::string method_name,
@@ -31,6 +46,47 @@ torch::jit::script::Module CompileGraph(const torch::jit::script::Module& module
   return core::CompileGraph(module, to_internal_compile_spec(info));
 }
 
+torch::jit::Module LoadModule(std::string path) {
+  return core::util::LoadModule(path);
+}
+
+torch::jit::script::Module CompileGraph(const std::string& module_path, CompileSpec info) {
+  LOG_DEBUG(get_build_info());
+  auto module = LoadModule(module_path);
+  return core::CompileGraph(module, to_internal_compile_spec(info));
+}
+
+void SwapEngine(const torch::jit::script::Module& module, std::string method_name, std::string serialized_engine) {
+  core::SwapEngine(module, method_name, std::move(serialized_engine));
+}
+
+std::vector<std::vector<CompileSpec::InputRange>> DeriveInputRanges(
+    std::string shape_histogram_path,
+    size_t num_profiles,
+    ProfileObjective objective) {
+  std::ifstream in(shape_histogram_path);
+  TRTORCH_CHECK(in.is_open(), "Unable to open shape histogram " << shape_histogram_path);
+  auto histogram = core::runtime::ReadShapeHistogram(in);
+  auto profiles = core::runtime::ClusterShapeProfiles(
+      histogram,
+      num_profiles,
+      objective == ProfileObjective::kPadding ? core::runtime::ProfileObjective::kPadding
+                                              : core::runtime::ProfileObjective::kRangeWidth);
+
+  std::vector<std::vector<CompileSpec::InputRange>> ranges;
+  for (const auto& profile : profiles) {
+    LOG_INFO(
+        "Derived a profile covering " << profile.calls << " recorded calls (objective per call: " << profile.cost
+                                      << ')');
+    std::vector<CompileSpec::InputRange> profile_ranges;
+    for (size_t i = 0; i < profile.min.size(); i++) {
+      profile_ranges.push_back(CompileSpec::InputRange(profile.min[i], profile.opt[i], profile.max[i]));
+    }
+    ranges.push_back(std::move(profile_ranges));
+  }
+  return ranges;
+}
+
 std::string get_build_info() {
   auto info = core::util::get_build_info();
   return std::string("TRTorch Version: ") + TRTORCH_VERSION + '\n' + info;
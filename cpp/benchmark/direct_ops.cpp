@@ -0,0 +1,115 @@
+#include "core/runtime/DirectOps.h"
+#include "torch/csrc/jit/ir/irparser.h"
+#include "torch/csrc/jit/runtime/custom_operator.h"
+#include "torch/csrc/jit/runtime/interpreter.h"
+#include "torch/torch.h"
+
+#include "timer.h"
+
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#define NUM_CALLS 20000
+
+// Stand-in for an engine which does no work, returns its first inputs as the
+// outputs so the cost of the op call itself is all that is measured
+std::vector<at::Tensor> stand_in_engine(const std::vector<at::Tensor>& inputs, size_t num_outputs) {
+  std::vector<at::Tensor> outputs;
+  for (size_t i = 0; i < num_outputs; i++) {
+    outputs.push_back(inputs[i % inputs.size()]);
+  }
+  return outputs;
+}
+
+// The list based op cannot know how many outputs to produce from its schema,
+// the "engine" is the number of outputs
+static torch::jit::RegisterOperators stand_in_list_reg({
+    torch::jit::Operator(
+        "trtorch_benchmark::stand_in(Tensor[] inputs, int engine) -> Tensor[]",
+        [](torch::jit::Stack& stack) {
+          auto num_outputs = torch::jit::pop(stack).toInt();
+          auto inputs = torch::jit::pop(stack).toTensorVector();
+          torch::jit::push(stack, c10::List<at::Tensor>(stand_in_engine(inputs, num_outputs)));
+          return 0;
+        },
+        c10::AliasAnalysisKind::FROM_SCHEMA),
+});
+
+static torch::jit::RegisterOperators stand_in_direct_reg(trtorch::core::runtime::MakeDirectOperators(
+    "trtorch_benchmark::stand_in",
+    "int",
+    [](std::vector<at::Tensor> inputs, const c10::IValue& engine) {
+      return stand_in_engine(inputs, engine.toInt());
+    }));
+
+// The graphs the compiler emits around the list based and the direct op
+std::shared_ptr<torch::jit::Graph> make_graph(size_t arity, bool direct) {
+  std::stringstream ins, outs, out_types;
+  for (size_t i = 0; i < arity; i++) {
+    ins << (i ? ", " : "") << "%in" << i;
+    outs << (i ? ", " : "") << "%out" << i;
+    out_types << (i ? ", " : "") << "%out" << i << " : Tensor";
+  }
+
+  std::stringstream ir;
+  ir << "graph(";
+  for (size_t i = 0; i < arity; i++) {
+    ir << (i ? ", " : "") << "%in" << i << " : Tensor";
+  }
+  ir << "):\n";
+  ir << "  %engine : int = prim::Constant[value=" << arity << "]()\n";
+  if (direct) {
+    ir << "  " << out_types.str() << " = "
+       << trtorch::core::runtime::DirectOpName("trtorch_benchmark::stand_in", arity, arity) << '(' << ins.str()
+       << ", %engine)\n";
+  } else {
+    ir << "  %list : Tensor[] = prim::ListConstruct(" << ins.str() << ")\n";
+    ir << "  %results : Tensor[] = trtorch_benchmark::stand_in(%list, %engine)\n";
+    ir << "  " << out_types.str() << " = prim::ListUnpack(%results)\n";
+  }
+  ir << "  %tuple : (";
+  for (size_t i = 0; i < arity; i++) {
+    ir << (i ? ", " : "") << "Tensor";
+  }
+  ir << ") = prim::TupleConstruct(" << outs.str() << ")\n";
+  ir << "  return (%tuple)\n";
+
+  auto g = std::make_shared<torch::jit::Graph>();
+  torch::jit::parseIR(ir.str(), g.get());
+  return g;
+}
+
+void run(torch::jit::Code& code, const std::vector<at::Tensor>& inputs) {
+  torch::jit::Stack stack(inputs.begin(), inputs.end());
+  torch::jit::InterpreterState(code).run(stack);
+}
+
+int main() {
+  auto timer = timers::PreciseCPUTimer();
+  for (size_t arity = 1; arity <= trtorch::core::runtime::kMaxDirectInputs; arity *= 2) {
+    std::vector<at::Tensor> inputs;
+    for (size_t i = 0; i < arity; i++) {
+      inputs.push_back(at::randn({2, 3}));
+    }
+
+    float per_call_ns[2];
+    for (int direct = 0; direct < 2; direct++) {
+      torch::jit::Code code(make_graph(arity, direct), direct ? "direct" : "list");
+      run(code, inputs);
+      timer.reset();
+      timer.start();
+      for (int i = 0; i < NUM_CALLS; i++) {
+        run(code, inputs);
+      }
+      timer.stop();
+      per_call_ns[direct] = timer.microseconds() * 1000.f / NUM_CALLS;
+    }
+
+    std::cout << "[" << arity << " inputs / " << arity << " outputs]:"
+              << "\n    List op: " << per_call_ns[0] << " ns per call"
+              << "\n    Direct op: " << per_call_ns[1] << " ns per call" << std::endl;
+  }
+}
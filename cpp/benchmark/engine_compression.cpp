@@ -0,0 +1,67 @@
+#include "core/runtime/compression.h"
+
+#include "timer.h"
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#define NUM_RUNS 10
+
+float average(std::vector<float>& runtimes) {
+  return std::accumulate(runtimes.begin(), runtimes.end(), 0.0) / runtimes.size();
+}
+
+int main(int argc, const char* argv[]) {
+  if (argc < 2) {
+    std::cerr << "usage: engine_compression <path-to-serialized-engine>\n" << std::endl;
+    return -1;
+  }
+
+  std::ifstream engine_file(argv[1], std::ios::binary | std::ios::ate);
+  if (!engine_file.good()) {
+    std::cerr << "error loading the engine\n";
+    return -1;
+  }
+  std::string engine(static_cast<size_t>(engine_file.tellg()), '\0');
+  engine_file.seekg(0, std::ios::beg);
+  engine_file.read(&engine[0], engine.size());
+
+  auto timer = timers::PreciseCPUTimer();
+  // Shared across runs so only decompression is timed, not the allocation
+  std::string decompressed;
+
+  std::cout << "Engine size: " << engine.size() << " bytes" << std::endl;
+  for (int level = 1; level <= trtorch::core::runtime::compression::kMaxCompressionLevel; level++) {
+    std::vector<float> compress_runtimes;
+    std::vector<float> decompress_runtimes;
+    std::string payload;
+
+    for (uint64_t i = 0; i < NUM_RUNS; i++) {
+      timer.start();
+      payload = trtorch::core::runtime::compression::CompressEngine(engine.data(), engine.size(), level);
+      timer.stop();
+      compress_runtimes.push_back(timer.milliseconds());
+      timer.reset();
+
+      timer.start();
+      trtorch::core::runtime::compression::DecompressEngine(payload, decompressed);
+      timer.stop();
+      decompress_runtimes.push_back(timer.milliseconds());
+      timer.reset();
+    }
+
+    if (decompressed != engine) {
+      std::cerr << "Decompressed engine does not match the original (level " << level << ")" << std::endl;
+      return -1;
+    }
+
+    std::cout << "[Level " << level << "]: compressed size: " << payload.size() << " bytes"
+              << "\n    Compression ratio: " << static_cast<float>(engine.size()) / payload.size()
+              << "\n    Average compression time: " << average(compress_runtimes) << " ms"
+              << "\n    Average load (decompression) time: " << average(decompress_runtimes) << " ms" << std::endl;
+  }
+}
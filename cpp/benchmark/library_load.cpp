@@ -0,0 +1,98 @@
+#include <dlfcn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "timer.h"
+
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#define NUM_RUNS 10
+
+struct LoadResult {
+  float milliseconds;
+  // Resident memory added by loading the library (and the libraries it
+  // depends on which were not loaded yet)
+  long rss_kb;
+};
+
+float average(std::vector<float>& runtimes) {
+  return std::accumulate(runtimes.begin(), runtimes.end(), 0.0) / runtimes.size();
+}
+
+long rss_kb() {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.rfind("VmRSS:", 0) == 0) {
+      return std::stol(line.substr(6));
+    }
+  }
+  return -1;
+}
+
+// Loads the library in a fresh child process, a library cannot be fully
+// unloaded so each run needs its own process. Returns false if it could not be
+// loaded
+bool load_in_child(const std::string& path, LoadResult& result) {
+  int fds[2];
+  if (pipe(fds) != 0) {
+    return false;
+  }
+  auto pid = fork();
+  if (pid < 0) {
+    close(fds[0]);
+    close(fds[1]);
+    return false;
+  }
+  if (pid == 0) {
+    close(fds[0]);
+    auto timer = timers::PreciseCPUTimer();
+    auto rss_before = rss_kb();
+    timer.start();
+    auto handle = dlopen(path.c_str(), RTLD_NOW | RTLD_GLOBAL);
+    timer.stop();
+    if (!handle) {
+      std::cerr << dlerror() << std::endl;
+      _exit(1);
+    }
+    LoadResult loaded = {timer.milliseconds(), rss_kb() - rss_before};
+    auto written = write(fds[1], &loaded, sizeof(loaded));
+    _exit(written == sizeof(loaded) ? 0 : 1);
+  }
+
+  close(fds[1]);
+  auto read_bytes = read(fds[0], &result, sizeof(result));
+  close(fds[0]);
+  int status = 0;
+  waitpid(pid, &status, 0);
+  return read_bytes == sizeof(result) && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+int main(int argc, const char* argv[]) {
+  if (argc < 2) {
+    std::cerr << "usage: library_load <path-to-library> [<path-to-library> ...]\n" << std::endl;
+    return -1;
+  }
+
+  for (int i = 1; i < argc; i++) {
+    std::vector<float> load_runtimes;
+    std::vector<float> rss_increases;
+    for (uint64_t run = 0; run < NUM_RUNS; run++) {
+      LoadResult result;
+      if (!load_in_child(argv[i], result)) {
+        std::cerr << "error loading " << argv[i] << std::endl;
+        return -1;
+      }
+      load_runtimes.push_back(result.milliseconds);
+      rss_increases.push_back(static_cast<float>(result.rss_kb));
+    }
+
+    std::cout << "[" << argv[i] << "]:"
+              << "\n    Average load time: " << average(load_runtimes) << " ms"
+              << "\n    Average resident memory added: " << average(rss_increases) / 1024 << " MB" << std::endl;
+  }
+}
@@ -6,9 +6,13 @@
 
 #include <cstddef>
 #include <string>
+#include <vector>
 
 namespace datasets {
 // The CIFAR10 Dataset
+//
+// The record files are memory mapped rather than read, images are converted to
+// float (and normalized) a batch at a time when they are requested
 class CIFAR10 : public torch::data::datasets::Dataset<CIFAR10> {
  public:
   // The mode in which the dataset is loaded
@@ -23,23 +27,35 @@ class CIFAR10 : public torch::data::datasets::Dataset<CIFAR10> {
   // Returns the pair at index in the dataset
   torch::data::Example<> get(size_t index) override;
 
+  // Returns the pairs at indices, converted together
+  std::vector<torch::data::Example<>> get_batch(c10::ArrayRef<size_t> indices) override;
+
   // The size of the dataset
   c10::optional<size_t> size() const override;
 
   // The mode the dataset is in
   bool is_train() const noexcept;
 
-  // Returns all images stacked into a single tensor
-  const torch::Tensor& images() const;
+  // Returns all images as uint8 [N, 3, 32, 32], a view of the mapped file in
+  // test mode
+  torch::Tensor images() const;
 
-  // Returns all targets stacked into a single tensor
-  const torch::Tensor& targets() const;
+  // Returns all targets as uint8 [N]
+  torch::Tensor targets() const;
 
   // Trims the dataset to the first n pairs
   CIFAR10&& use_subset(int64_t new_size);
 
+  // Normalizes each channel of the images as they are converted, replaces
+  // .map(torch::data::transforms::Normalize<>(mean, stddev))
+  CIFAR10&& normalize(std::vector<double> mean, std::vector<double> stddev);
+
  private:
   Mode mode_;
-  torch::Tensor images_, targets_;
+  // Mapped record files, uint8 [records, 1 + 3072]
+  std::vector<torch::Tensor> records_;
+  size_t size_ = 0;
+  // Per channel normalization, undefined if not normalizing
+  torch::Tensor mean_, stddev_;
 };
 } // namespace datasets
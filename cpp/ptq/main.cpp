@@ -33,7 +33,7 @@ torch::jit::Module compile_int8_model(const std::string& data_dir, torch::jit::M
   auto calibration_dataset =
       datasets::CIFAR10(data_dir, datasets::CIFAR10::Mode::kTest)
           .use_subset(320)
-          .map(torch::data::transforms::Normalize<>({0.4914, 0.4822, 0.4465}, {0.2023, 0.1994, 0.2010}))
+          .normalize({0.4914, 0.4822, 0.4465}, {0.2023, 0.1994, 0.2010})
           .map(torch::data::transforms::Stack<>());
   auto calibration_dataloader = torch::data::make_data_loader(
       std::move(calibration_dataset), torch::data::DataLoaderOptions().batch_size(32).workers(2));
@@ -92,7 +92,7 @@ int main(int argc, const char* argv[]) {
 
   /// Dataloader moved into calibrator so need another for inference
   auto eval_dataset = datasets::CIFAR10(data_dir, datasets::CIFAR10::Mode::kTest)
-                          .map(torch::data::transforms::Normalize<>({0.4914, 0.4822, 0.4465}, {0.2023, 0.1994, 0.2010}))
+                          .normalize({0.4914, 0.4822, 0.4465}, {0.2023, 0.1994, 0.2010})
                           .map(torch::data::transforms::Stack<>());
   auto eval_dataloader = torch::data::make_data_loader(
       std::move(eval_dataset), torch::data::DataLoaderOptions().batch_size(32).workers(2));
@@ -1,4 +1,6 @@
 #include <stdlib.h>
+#include <chrono>
+#include <iomanip>
 #include <iostream>
 #include <sstream>
 
@@ -17,6 +19,7 @@
 #endif
 
 #include "NvInfer.h"
+#include "cpp/trtorchc/manifest.h"
 #include "third_party/args/args.hpp"
 #include "torch/script.h"
 #include "torch/torch.h"
@@ -99,6 +102,20 @@ trtorch::CompileSpec::InputRange parseDynamicDim(std::string shape_str) {
   return trtorch::CompileSpec::InputRange(shape[0], shape[1], shape[2]);
 }
 
+std::string toDimStr(const std::vector<int64_t>& shape) {
+  std::stringstream ss;
+  ss << '(';
+  for (size_t i = 0; i < shape.size(); i++) {
+    ss << (i ? "," : "") << shape[i];
+  }
+  ss << ')';
+  return ss.str();
+}
+
+std::string toRangeStr(const trtorch::CompileSpec::InputRange& range) {
+  return '[' + toDimStr(range.min) + ';' + toDimStr(range.opt) + ';' + toDimStr(range.max) + ']';
+}
+
 std::string get_cwd() {
   char buff[FILENAME_MAX]; // create string buffer to hold path
   if (getcwd(buff, FILENAME_MAX)) {
@@ -130,6 +147,138 @@ std::string resolve_path(std::string path) {
   return rpath;
 }
 
+trtorch::CompileSpec toCompileSpec(const trtorchc::Job& job) {
+  std::vector<trtorch::CompileSpec::InputRange> ranges;
+  for (const auto& shape : job.input_shapes) {
+    ranges.push_back(trtorch::CompileSpec::InputRange(shape.min, shape.opt, shape.max));
+  }
+  auto spec = trtorch::CompileSpec(ranges);
+  spec.debug = job.debug;
+  spec.strict_types = job.strict_types;
+  spec.allow_gpu_fallback = job.allow_gpu_fallback;
+
+  if (job.op_precision == "half") {
+    spec.op_precision = torch::kF16;
+  } else if (job.op_precision == "int8") {
+    spec.op_precision = torch::kI8;
+  }
+  if (job.device_type == "dla") {
+    spec.device = trtorch::CompileSpec::DeviceType::kDLA;
+  }
+  if (job.engine_capability == "safe_gpu") {
+    spec.capability = trtorch::CompileSpec::EngineCapability::kSAFE_GPU;
+  } else if (job.engine_capability == "safe_dla") {
+    spec.capability = trtorch::CompileSpec::EngineCapability::kSAFE_DLA;
+  }
+
+  if (job.num_min_timing_iters >= 0) {
+    spec.num_min_timing_iters = job.num_min_timing_iters;
+  }
+  if (job.num_avg_timing_iters >= 0) {
+    spec.num_avg_timing_iters = job.num_avg_timing_iters;
+  }
+  if (job.workspace_size >= 0) {
+    spec.workspace_size = job.workspace_size;
+  }
+  if (job.max_batch_size >= 0) {
+    spec.max_batch_size = job.max_batch_size;
+  }
+  spec.engine_compression_level = job.engine_compression_level;
+  spec.split_oversized_batches = job.split_oversized_batches;
+  spec.freeze_in_place = job.freeze_in_place;
+  return spec;
+}
+
+// Compiles every job of the manifest in one process. Each model is loaded
+// once and its lowered graph is shared by the jobs compiling it
+int runManifest(const std::string& manifest_path, int workers) {
+  std::vector<trtorchc::Job> jobs;
+  try {
+    jobs = trtorchc::LoadManifest(manifest_path);
+  } catch (const std::exception& e) {
+    trtorch::logging::log(trtorch::logging::Level::kERROR, e.what());
+    return 1;
+  }
+  if (workers > 1) {
+    for (const auto& job : jobs) {
+      if (job.debug) {
+        trtorch::logging::log(
+            trtorch::logging::Level::kERROR,
+            "Job " + job.name + " sets \"debug\", debuggable engines can only be built with --jobs=1");
+        return 1;
+      }
+    }
+  }
+
+  struct Model {
+    torch::jit::Module mod;
+    std::shared_ptr<trtorch::LoweringCache> lowering_cache;
+  };
+  trtorchc::ModelStore<Model> models(jobs, [](const std::string& path) {
+    auto model = std::make_shared<Model>();
+    try {
+      model->mod = trtorch::LoadModule(path);
+    } catch (const std::exception& e) {
+      throw std::runtime_error("Error loading the model " + path + " (path may be incorrect): " + e.what());
+    }
+    // Checked through the cache so jobs which do not freeze in place reuse the
+    // lowered graph
+    model->lowering_cache = std::make_shared<trtorch::LoweringCache>();
+    if (!trtorch::CheckMethodOperatorSupport(model->mod, "forward", model->lowering_cache)) {
+      throw std::runtime_error("Module " + path + " is not currently supported by TRTorch");
+    }
+    return model;
+  });
+
+  auto start = std::chrono::steady_clock::now();
+  auto results = trtorchc::RunJobs(
+      jobs,
+      static_cast<size_t>(workers),
+      [&](const trtorchc::Job& job) {
+        auto model = models.Acquire(job.input_path);
+        auto compile_settings = toCompileSpec(job);
+        compile_settings.lowering_cache = model->lowering_cache;
+        auto calibrator = trtorch::ptq::make_int8_cache_calibrator(job.calibration_cache_file);
+        if (job.op_precision == "int8") {
+          compile_settings.ptq_calibrator = calibrator;
+        }
+
+        if (job.save_engine) {
+          auto engine = trtorch::ConvertGraphToTRTEngine(model->mod, "forward", compile_settings);
+          std::ofstream out(job.output_path);
+          out << engine;
+          out.close();
+          if (!out) {
+            throw std::runtime_error("Unable to write the engine to " + job.output_path);
+          }
+        } else {
+          trtorch::CompileGraph(model->mod, compile_settings).save(job.output_path);
+        }
+      },
+      [](const trtorchc::JobResult& result) {
+        std::cout << (result.ok ? "[ OK ] " : "[FAIL] ") << result.name << " (" << std::fixed
+                  << std::setprecision(1) << result.seconds << " s)";
+        if (!result.ok) {
+          std::cout << ": " << result.error;
+        }
+        std::cout << std::endl;
+      });
+  auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  size_t failed = 0;
+  for (const auto& result : results) {
+    failed += result.ok ? 0 : 1;
+  }
+  std::cout << results.size() - failed << " of " << results.size() << " jobs succeeded in " << std::fixed
+            << std::setprecision(1) << seconds << " s" << std::endl;
+  for (const auto& result : results) {
+    if (!result.ok) {
+      std::cout << "  failed: " << result.name << std::endl;
+    }
+  }
+  return failed ? 1 : 0;
+}
+
 int main(int argc, char** argv) {
   trtorch::logging::set_is_colored_output_on(true);
   trtorch::logging::set_reportable_log_level(trtorch::logging::Level::kWARNING);
@@ -192,6 +341,36 @@ int main(int argc, char** argv) {
       parser, "workspace_size", "Maximum size of workspace given to TensorRT", {"workspace-size"});
   args::ValueFlag<int> max_batch_size(
       parser, "max_batch_size", "Maximum batch size (must be >= 1 to be set, 0 means not set)", {"max-batch-size"});
+  args::ValueFlag<int> engine_compression_level(
+      parser,
+      "level",
+      "Compression level for the TensorRT engine embedded in the saved TorchScript program (0 disables compression, 1 (fastest) - 9 (smallest)) (default: 0)",
+      {"engine-compression-level"});
+  args::Flag split_oversized_batches(
+      parser,
+      "split-oversized-batches",
+      "Run inputs with a batch larger than the max input shape as several max sized chunks instead of failing",
+      {"split-oversized-batches"});
+  args::Flag freeze_in_place(
+      parser,
+      "freeze-in-place",
+      "Fold module attributes into the graph without cloning the module, saves a copy of the weights while compiling",
+      {"freeze-in-place"});
+  args::ValueFlag<std::string> shape_histogram(
+      parser,
+      "file_path",
+      "Derive the input shapes from a histogram of recorded input shapes (e.g. written by trtorch.ShapeRecorder) instead of passing them",
+      {"shape-histogram"});
+  args::ValueFlag<int> num_profiles(
+      parser,
+      "num_profiles",
+      "Number of profiles to split the recorded shapes into, more than one is printed for analysis only since an engine is built for one profile (default: 1)",
+      {"num-profiles"});
+  args::ValueFlag<std::string> profile_objective(
+      parser,
+      "objective",
+      "What the split of recorded shapes into profiles minimizes [ padding | range_width ] (default: padding)",
+      {"profile-objective"});
   args::ValueFlag<double> threshold(
       parser,
       "threshold",
@@ -203,6 +382,13 @@ int main(int argc, char** argv) {
       "save_engine",
       "Instead of compiling a full a TorchScript program, save the created engine to the path specified as the output path",
       {"save-engine"});
+  args::ValueFlag<std::string> manifest(
+      parser,
+      "file_path",
+      "Compile every job of a JSON manifest in one process instead of a single module, the settings of each job are read from the manifest",
+      {"manifest"});
+  args::ValueFlag<int> num_jobs(
+      parser, "num_jobs", "Number of manifest jobs compiled at the same time (default: 1)", {"jobs"});
   args::Positional<std::string> input_path(parser, "input_file_path", "Path to input TorchScript file");
   args::Positional<std::string> output_path(
       parser, "output_file_path", "Path for compiled TorchScript (or TensorRT engine) file");
@@ -234,6 +420,22 @@ int main(int argc, char** argv) {
     trtorch::logging::set_reportable_log_level(trtorch::logging::Level::kERROR);
   }
 
+  if (manifest) {
+    if (input_path || output_path || !args::get(input_shapes).empty()) {
+      trtorch::logging::log(
+          trtorch::logging::Level::kERROR, "Input and output paths and shapes are read from the manifest");
+      std::cerr << parser;
+      return 1;
+    }
+    int workers = num_jobs ? args::get(num_jobs) : 1;
+    if (workers < 1) {
+      trtorch::logging::log(trtorch::logging::Level::kERROR, "The number of jobs must be at least 1");
+      std::cerr << parser;
+      return 1;
+    }
+    return runManifest(resolve_path(args::get(manifest)), workers);
+  }
+
   std::vector<trtorch::CompileSpec::InputRange> ranges;
   for (const auto shapes : args::get(input_shapes)) {
     if (shapes.rfind("(", 0) == 0) {
@@ -249,6 +451,68 @@ int main(int argc, char** argv) {
     }
   }
 
+  if (shape_histogram) {
+    if (!ranges.empty()) {
+      trtorch::logging::log(
+          trtorch::logging::Level::kERROR, "Input shapes cannot be passed together with a shape histogram");
+      std::cerr << parser;
+      return 1;
+    }
+
+    auto objective = trtorch::ProfileObjective::kPadding;
+    if (profile_objective) {
+      auto objective_str = args::get(profile_objective);
+      if (objective_str == "range_width") {
+        objective = trtorch::ProfileObjective::kRangeWidth;
+      } else if (objective_str != "padding") {
+        trtorch::logging::log(
+            trtorch::logging::Level::kERROR, "Invalid profile objective, options are [ padding | range_width ]");
+        std::cerr << parser;
+        return 1;
+      }
+    }
+
+    int profile_count = num_profiles ? args::get(num_profiles) : 1;
+    if (profile_count < 1) {
+      trtorch::logging::log(trtorch::logging::Level::kERROR, "The number of profiles must be at least 1");
+      std::cerr << parser;
+      return 1;
+    }
+
+    std::vector<std::vector<trtorch::CompileSpec::InputRange>> profiles;
+    try {
+      profiles = trtorch::DeriveInputRanges(resolve_path(args::get(shape_histogram)), profile_count, objective);
+    } catch (const std::exception& e) {
+      trtorch::logging::log(
+          trtorch::logging::Level::kERROR, std::string("Unable to derive input shapes: ") + e.what());
+      return 1;
+    }
+
+    for (size_t p = 0; p < profiles.size(); p++) {
+      std::cout << "Profile " << p << ":";
+      for (const auto& range : profiles[p]) {
+        std::cout << " \"" << toRangeStr(range) << '"';
+      }
+      std::cout << std::endl;
+    }
+
+    if (profiles.size() > 1) {
+      if (input_path) {
+        trtorch::logging::log(
+            trtorch::logging::Level::kERROR,
+            "An engine is built for a single profile, compile once per profile passing its input shapes");
+        return 1;
+      }
+      return 0;
+    }
+    ranges = profiles[0];
+  }
+
+  if (!input_path && shape_histogram) {
+    // Only asked for the derived input shapes
+    return 0;
+  }
+
   auto compile_settings = trtorch::CompileSpec(ranges);
 
   if (build_debuggable_engine) {
@@ -346,14 +610,34 @@ int main(int argc, char** argv) {
     compile_settings.max_batch_size = args::get(max_batch_size);
   }
 
+  if (engine_compression_level) {
+    auto level = args::get(engine_compression_level);
+    if (level < 0 || level > 9) {
+      trtorch::logging::log(
+          trtorch::logging::Level::kERROR, "Invalid engine compression level, options are [ 0 - 9 ]");
+      std::cerr << parser;
+      return 1;
+    }
+    compile_settings.engine_compression_level = level;
+  }
+
+  if (split_oversized_batches) {
+    compile_settings.split_oversized_batches = true;
+  }
+
+  if (freeze_in_place) {
+    compile_settings.freeze_in_place = true;
+  }
+
   auto real_input_path = resolve_path(args::get(input_path));
   auto real_output_path = resolve_path(args::get(output_path));
 
   torch::jit::Module mod;
   try {
-    // Deserialize the ScriptModule from a file using torch::jit::load().
-    mod = torch::jit::load(real_input_path);
-  } catch (const c10::Error& e) {
+    // Deserialize the ScriptModule from a file, reading it through a memory
+    // mapping (see trtorch::LoadModule)
+    mod = trtorch::LoadModule(real_input_path);
+  } catch (const std::exception& e) {
     trtorch::logging::log(trtorch::logging::Level::kERROR, "Error loading the model (path may be incorrect)");
     std::cerr << parser;
     return 1;
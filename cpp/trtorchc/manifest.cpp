@@ -0,0 +1,587 @@
+#include "cpp/trtorchc/manifest.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+namespace trtorchc {
+namespace {
+
+// Just enough JSON for manifests, there is no JSON library in the dependencies
+struct Value {
+  enum class Type { kNull, kBool, kNumber, kString, kArray, kObject };
+  Type type = Type::kNull;
+  bool boolean = false;
+  double number = 0;
+  std::string string;
+  std::vector<Value> array;
+  // Keys in the order they appear in the file
+  std::vector<std::pair<std::string, Value>> object;
+};
+
+class Parser {
+ public:
+  explicit Parser(const std::string& text) : text_(text) {}
+
+  Value ParseDocument() {
+    auto value = ParseValue();
+    SkipSpace();
+    if (pos_ != text_.size()) {
+      Fail("Unexpected characters after the manifest");
+    }
+    return value;
+  }
+
+ private:
+  [[noreturn]] void Fail(const std::string& message) {
+    size_t line = 1;
+    size_t column = 1;
+    for (size_t i = 0; i < pos_ && i < text_.size(); i++) {
+      if (text_[i] == '\n') {
+        line++;
+        column = 1;
+      } else {
+        column++;
+      }
+    }
+    std::stringstream ss;
+    ss << message << " (line " << line << ", column " << column << ")";
+    throw std::runtime_error(ss.str());
+  }
+
+  void SkipSpace() {
+    while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_]))) {
+      pos_++;
+    }
+  }
+
+  bool Consume(char c) {
+    SkipSpace();
+    if (pos_ < text_.size() && text_[pos_] == c) {
+      pos_++;
+      return true;
+    }
+    return false;
+  }
+
+  void Expect(char c) {
+    if (!Consume(c)) {
+      Fail(std::string("Expected '") + c + "'");
+    }
+  }
+
+  bool ConsumeWord(const char* word) {
+    size_t len = std::char_traits<char>::length(word);
+    if (text_.compare(pos_, len, word) == 0) {
+      pos_ += len;
+      return true;
+    }
+    return false;
+  }
+
+  Value ParseValue() {
+    SkipSpace();
+    if (pos_ >= text_.size()) {
+      Fail("Unexpected end of the manifest");
+    }
+    Value v;
+    char c = text_[pos_];
+    if (c == '{') {
+      pos_++;
+      v.type = Value::Type::kObject;
+      if (!Consume('}')) {
+        do {
+          SkipSpace();
+          if (pos_ >= text_.size() || text_[pos_] != '"') {
+            Fail("Expected a string as key");
+          }
+          auto key = ParseString();
+          Expect(':');
+          v.object.emplace_back(std::move(key), ParseValue());
+        } while (Consume(','));
+        Expect('}');
+      }
+    } else if (c == '[') {
+      pos_++;
+      v.type = Value::Type::kArray;
+      if (!Consume(']')) {
+        do {
+          v.array.push_back(ParseValue());
+        } while (Consume(','));
+        Expect(']');
+      }
+    } else if (c == '"') {
+      v.type = Value::Type::kString;
+      v.string = ParseString();
+    } else if (ConsumeWord("true")) {
+      v.type = Value::Type::kBool;
+      v.boolean = true;
+    } else if (ConsumeWord("false")) {
+      v.type = Value::Type::kBool;
+    } else if (ConsumeWord("null")) {
+      v.type = Value::Type::kNull;
+    } else if (c == '-' || std::isdigit(static_cast<unsigned char>(c))) {
+      v.type = Value::Type::kNumber;
+      v.number = ParseNumber();
+    } else {
+      Fail(std::string("Unexpected character '") + c + "'");
+    }
+    return v;
+  }
+
+  double ParseNumber() {
+    size_t start = pos_;
+    if (text_[pos_] == '-') {
+      pos_++;
+    }
+    while (pos_ < text_.size() &&
+           (std::isdigit(static_cast<unsigned char>(text_[pos_])) || text_[pos_] == '.' || text_[pos_] == 'e' ||
+            text_[pos_] == 'E' || text_[pos_] == '+' || text_[pos_] == '-')) {
+      pos_++;
+    }
+    std::istringstream ss(text_.substr(start, pos_ - start));
+    double number;
+    if (!(ss >> number) || !ss.eof()) {
+      pos_ = start;
+      Fail("Invalid number");
+    }
+    return number;
+  }
+
+  unsigned ParseHex4() {
+    if (pos_ + 4 > text_.size()) {
+      Fail("Invalid unicode escape");
+    }
+    unsigned code = 0;
+    for (int i = 0; i < 4; i++) {
+      char h = text_[pos_++];
+      code <<= 4;
+      if (h >= '0' && h <= '9') {
+        code |= h - '0';
+      } else if (h >= 'a' && h <= 'f') {
+        code |= h - 'a' + 10;
+      } else if (h >= 'A' && h <= 'F') {
+        code |= h - 'A' + 10;
+      } else {
+        Fail("Invalid unicode escape");
+      }
+    }
+    return code;
+  }
+
+  static void AppendUtf8(std::string& out, unsigned code) {
+    if (code < 0x80) {
+      out.push_back(static_cast<char>(code));
+    } else if (code < 0x800) {
+      out.push_back(static_cast<char>(0xc0 | (code >> 6)));
+      out.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+    } else if (code < 0x10000) {
+      out.push_back(static_cast<char>(0xe0 | (code >> 12)));
+      out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+      out.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+    } else {
+      out.push_back(static_cast<char>(0xf0 | (code >> 18)));
+      out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3f)));
+      out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+      out.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+    }
+  }
+
+  std::string ParseString() {
+    // Opening quote
+    pos_++;
+    std::string out;
+    while (true) {
+      if (pos_ >= text_.size()) {
+        Fail("Unterminated string");
+      }
+      char c = text_[pos_++];
+      if (c == '"') {
+        return out;
+      } else if (static_cast<unsigned char>(c) < 0x20) {
+        pos_--;
+        Fail("Control character in string");
+      } else if (c != '\\') {
+        out.push_back(c);
+        continue;
+      }
+      if (pos_ >= text_.size()) {
+        Fail("Unterminated string");
+      }
+      char e = text_[pos_++];
+      switch (e) {
+        case '"':
+        case '\\':
+        case '/':
+          out.push_back(e);
+          break;
+        case 'b':
+          out.push_back('\b');
+          break;
+        case 'f':
+          out.push_back('\f');
+          break;
+        case 'n':
+          out.push_back('\n');
+          break;
+        case 'r':
+          out.push_back('\r');
+          break;
+        case 't':
+          out.push_back('\t');
+          break;
+        case 'u': {
+          auto code = ParseHex4();
+          if (code >= 0xd800 && code < 0xdc00 && ConsumeWord("\\u")) {
+            auto low = ParseHex4();
+            if (low < 0xdc00 || low >= 0xe000) {
+              Fail("Invalid unicode surrogate pair");
+            }
+            code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+          }
+          AppendUtf8(out, code);
+          break;
+        }
+        default:
+          pos_--;
+          Fail(std::string("Invalid escape '\\") + e + "'");
+      }
+    }
+  }
+
+  const std::string& text_;
+  size_t pos_ = 0;
+};
+
+std::string lower(std::string s) {
+  std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return std::tolower(c); });
+  return s;
+}
+
+std::string resolve(const std::string& path, const std::string& base_dir) {
+  if (path.empty() || path[0] == '/' || base_dir.empty()) {
+    return path;
+  }
+  return base_dir + '/' + path;
+}
+
+std::string file_name(const std::string& path) {
+  auto slash = path.find_last_of('/');
+  return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+class JobBuilder {
+ public:
+  JobBuilder(std::string context) : context_(std::move(context)) {}
+
+  [[noreturn]] void Fail(const std::string& key, const std::string& message) const {
+    throw std::runtime_error(context_ + ", \"" + key + "\": " + message);
+  }
+
+  std::string String(const std::string& key, const Value& v) const {
+    if (v.type != Value::Type::kString) {
+      Fail(key, "expected a string");
+    }
+    return v.string;
+  }
+
+  bool Bool(const std::string& key, const Value& v) const {
+    if (v.type != Value::Type::kBool) {
+      Fail(key, "expected true or false");
+    }
+    return v.boolean;
+  }
+
+  int64_t Int(const std::string& key, const Value& v) const {
+    if (v.type != Value::Type::kNumber || v.number != std::floor(v.number) || std::fabs(v.number) > 9.0e15) {
+      Fail(key, "expected an integer");
+    }
+    return static_cast<int64_t>(v.number);
+  }
+
+  std::vector<int64_t> Dims(const std::string& key, const Value& v) const {
+    if (v.type != Value::Type::kArray || v.array.empty()) {
+      Fail(key, "expected a shape, e.g. [1, 3, 224, 224]");
+    }
+    std::vector<int64_t> dims;
+    for (const auto& d : v.array) {
+      auto dim = Int(key, d);
+      if (dim < 0) {
+        Fail(key, "dimensions cannot be negative");
+      }
+      dims.push_back(dim);
+    }
+    return dims;
+  }
+
+  ShapeRange Range(const std::string& key, const Value& v) const {
+    ShapeRange range;
+    if (v.type == Value::Type::kArray) {
+      range.min = range.opt = range.max = Dims(key, v);
+      return range;
+    }
+    if (v.type != Value::Type::kObject) {
+      Fail(key, "expected a shape or an object with min, opt and max shapes");
+    }
+    bool has_min = false, has_opt = false, has_max = false;
+    for (const auto& kv : v.object) {
+      if (kv.first == "min") {
+        range.min = Dims(key, kv.second);
+        has_min = true;
+      } else if (kv.first == "opt") {
+        range.opt = Dims(key, kv.second);
+        has_opt = true;
+      } else if (kv.first == "max") {
+        range.max = Dims(key, kv.second);
+        has_max = true;
+      } else {
+        Fail(key, "unknown shape range key \"" + kv.first + "\", options are min, opt and max");
+      }
+    }
+    if (!has_min || !has_opt || !has_max) {
+      Fail(key, "shape ranges need min, opt and max shapes");
+    }
+    if (range.min.size() != range.opt.size() || range.opt.size() != range.max.size()) {
+      Fail(key, "min, opt and max shapes need the same number of dimensions");
+    }
+    return range;
+  }
+
+  std::string OneOf(
+      const std::string& key,
+      const Value& v,
+      const std::vector<std::pair<std::vector<std::string>, std::string>>& options,
+      const std::string& help) const {
+    auto s = lower(String(key, v));
+    for (const auto& o : options) {
+      if (std::find(o.first.begin(), o.first.end(), s) != o.first.end()) {
+        return o.second;
+      }
+    }
+    Fail(key, "invalid value \"" + s + "\", options are [ " + help + " ]");
+  }
+
+  void Set(Job& job, const std::string& key, const Value& v, const std::string& base_dir) const {
+    if (key == "name") {
+      job.name = String(key, v);
+    } else if (key == "input") {
+      job.input_path = resolve(String(key, v), base_dir);
+    } else if (key == "output") {
+      job.output_path = resolve(String(key, v), base_dir);
+    } else if (key == "input_shapes") {
+      if (v.type != Value::Type::kArray || v.array.empty()) {
+        Fail(key, "expected a list with the shape of each input");
+      }
+      job.input_shapes.clear();
+      for (const auto& s : v.array) {
+        job.input_shapes.push_back(Range(key, s));
+      }
+    } else if (key == "op_precision") {
+      job.op_precision = OneOf(
+          key,
+          v,
+          {{{"float", "float32", "f32"}, "float"}, {{"half", "float16", "f16"}, "half"}, {{"int8", "i8"}, "int8"}},
+          "float | float32 | f32 | half | float16 | f16 | int8 | i8");
+    } else if (key == "calibration_cache_file") {
+      job.calibration_cache_file = resolve(String(key, v), base_dir);
+    } else if (key == "device_type") {
+      job.device_type = OneOf(key, v, {{{"gpu"}, "gpu"}, {{"dla"}, "dla"}}, "gpu | dla");
+    } else if (key == "engine_capability") {
+      job.engine_capability = OneOf(
+          key,
+          v,
+          {{{"default"}, "default"}, {{"safe_gpu"}, "safe_gpu"}, {{"safe_dla"}, "safe_dla"}},
+          "default | safe_gpu | safe_dla");
+    } else if (key == "debug") {
+      job.debug = Bool(key, v);
+    } else if (key == "strict_types") {
+      job.strict_types = Bool(key, v);
+    } else if (key == "allow_gpu_fallback") {
+      job.allow_gpu_fallback = Bool(key, v);
+    } else if (key == "num_min_timing_iters") {
+      job.num_min_timing_iters = Int(key, v);
+    } else if (key == "num_avg_timing_iters") {
+      job.num_avg_timing_iters = Int(key, v);
+    } else if (key == "workspace_size") {
+      job.workspace_size = Int(key, v);
+    } else if (key == "max_batch_size") {
+      job.max_batch_size = Int(key, v);
+    } else if (key == "engine_compression_level") {
+      job.engine_compression_level = Int(key, v);
+      if (job.engine_compression_level < 0 || job.engine_compression_level > 9) {
+        Fail(key, "options are [ 0 - 9 ]");
+      }
+    } else if (key == "split_oversized_batches") {
+      job.split_oversized_batches = Bool(key, v);
+    } else if (key == "freeze_in_place") {
+      job.freeze_in_place = Bool(key, v);
+    } else if (key == "save_engine") {
+      job.save_engine = Bool(key, v);
+    } else {
+      Fail(key, "unknown setting");
+    }
+  }
+
+  void Check(const Job& job) const {
+    if (job.input_path.empty()) {
+      Fail("input", "missing path of the TorchScript module to compile");
+    }
+    if (job.output_path.empty()) {
+      Fail("output", "missing path to save the compiled module (or engine) to");
+    }
+    if (job.input_shapes.empty()) {
+      Fail("input_shapes", "missing input shapes");
+    }
+    if (job.op_precision == "int8" && job.calibration_cache_file.empty()) {
+      Fail("calibration_cache_file", "INT8 jobs need a calibration cache file");
+    }
+  }
+
+ private:
+  std::string context_;
+};
+
+} // namespace
+
+std::vector<Job> ParseManifest(const std::string& text, const std::string& base_dir) {
+  auto root = Parser(text).ParseDocument();
+  if (root.type != Value::Type::kObject) {
+    throw std::runtime_error("The manifest should be an object with a \"jobs\" list");
+  }
+
+  const Value* defaults = nullptr;
+  const Value* job_list = nullptr;
+  for (const auto& kv : root.object) {
+    if (kv.first == "defaults") {
+      defaults = &kv.second;
+    } else if (kv.first == "jobs") {
+      job_list = &kv.second;
+    } else {
+      throw std::runtime_error("Unknown manifest key \"" + kv.first + "\", options are defaults and jobs");
+    }
+  }
+  if (!job_list || job_list->type != Value::Type::kArray) {
+    throw std::runtime_error("The manifest should have a \"jobs\" list");
+  }
+  if (defaults && defaults->type != Value::Type::kObject) {
+    throw std::runtime_error("The manifest \"defaults\" should be an object");
+  }
+
+  std::vector<Job> jobs;
+  std::unordered_map<std::string, size_t> outputs;
+  for (size_t i = 0; i < job_list->array.size(); i++) {
+    const auto& entry = job_list->array[i];
+    JobBuilder builder("Job " + std::to_string(i));
+    if (entry.type != Value::Type::kObject) {
+      throw std::runtime_error("Job " + std::to_string(i) + " should be an object");
+    }
+
+    Job job;
+    if (defaults) {
+      for (const auto& kv : defaults->object) {
+        JobBuilder("Manifest defaults").Set(job, kv.first, kv.second, base_dir);
+      }
+    }
+    for (const auto& kv : entry.object) {
+      builder.Set(job, kv.first, kv.second, base_dir);
+    }
+    if (job.name.empty()) {
+      job.name = file_name(job.output_path);
+    }
+    JobBuilder named("Job " + std::to_string(i) + (job.name.empty() ? "" : " (" + job.name + ")"));
+    named.Check(job);
+
+    auto prev = outputs.find(job.output_path);
+    if (prev != outputs.end()) {
+      named.Fail("output", "already written by job " + std::to_string(prev->second));
+    }
+    outputs[job.output_path] = i;
+    jobs.push_back(std::move(job));
+  }
+  return jobs;
+}
+
+std::vector<Job> LoadManifest(const std::string& path) {
+  std::ifstream in(path);
+  if (!in.is_open()) {
+    throw std::runtime_error("Unable to open manifest " + path);
+  }
+  std::stringstream ss;
+  ss << in.rdbuf();
+
+  std::string base_dir;
+  auto slash = path.find_last_of('/');
+  if (slash != std::string::npos) {
+    base_dir = slash == 0 ? "/" : path.substr(0, slash);
+  }
+  try {
+    return ParseManifest(ss.str(), base_dir);
+  } catch (const std::runtime_error& e) {
+    throw std::runtime_error(path + ": " + e.what());
+  }
+}
+
+std::vector<JobResult> RunJobs(
+    const std::vector<Job>& jobs,
+    size_t workers,
+    const std::function<void(const Job&)>& run,
+    const std::function<void(const JobResult&)>& done) {
+  // Group the jobs by input, in the order each input first appears
+  std::unordered_map<std::string, size_t> first_use;
+  for (size_t i = 0; i < jobs.size(); i++) {
+    first_use.emplace(jobs[i].input_path, i);
+  }
+  std::vector<size_t> order(jobs.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return first_use[jobs[a].input_path] < first_use[jobs[b].input_path];
+  });
+
+  std::vector<JobResult> results(jobs.size());
+  std::atomic<size_t> next(0);
+  std::mutex done_mu;
+  auto work = [&]() {
+    for (size_t n = next++; n < order.size(); n = next++) {
+      auto i = order[n];
+      auto& result = results[i];
+      result.name = jobs[i].name;
+      auto start = std::chrono::steady_clock::now();
+      try {
+        run(jobs[i]);
+        result.ok = true;
+      } catch (const std::exception& e) {
+        result.error = e.what();
+      } catch (...) {
+        result.error = "Unknown error";
+      }
+      result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      if (done) {
+        std::lock_guard<std::mutex> lock(done_mu);
+        done(result);
+      }
+    }
+  };
+
+  workers = std::max<size_t>(1, std::min(workers, jobs.size()));
+  std::vector<std::thread> threads;
+  for (size_t w = 1; w < workers; w++) {
+    threads.emplace_back(work);
+  }
+  work();
+  for (auto& t : threads) {
+    t.join();
+  }
+  return results;
+}
+
+} // namespace trtorchc
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace trtorchc {
+
+// Min, optimal and max shape of an input, all the same for static shapes
+struct ShapeRange {
+  std::vector<int64_t> min;
+  std::vector<int64_t> opt;
+  std::vector<int64_t> max;
+};
+
+// One compilation of a manifest, the same settings as the command line
+// options. Paths are absolute
+struct Job {
+  std::string name;
+  std::string input_path;
+  std::string output_path;
+  std::vector<ShapeRange> input_shapes;
+  // float, half or int8
+  std::string op_precision = "float";
+  std::string calibration_cache_file;
+  // gpu or dla
+  std::string device_type = "gpu";
+  // default, safe_gpu or safe_dla
+  std::string engine_capability = "default";
+  bool debug = false;
+  bool strict_types = false;
+  bool allow_gpu_fallback = false;
+  // Negative values leave the library defaults
+  int64_t num_min_timing_iters = -1;
+  int64_t num_avg_timing_iters = -1;
+  int64_t workspace_size = -1;
+  int64_t max_batch_size = -1;
+  int64_t engine_compression_level = 0;
+  bool split_oversized_batches = false;
+  bool freeze_in_place = false;
+  bool save_engine = false;
+};
+
+// Parses a JSON manifest of the form
+//
+//   {
+//     "defaults": { "input_shapes": [[1, 3, 224, 224]] },
+//     "jobs": [
+//       { "input": "resnet50.ts", "output": "resnet50_fp16.ts", "op_precision": "half" },
+//       { "input": "resnet50.ts", "output": "resnet50_dyn.ts",
+//         "input_shapes": [{ "min": [1, 3, 224, 224], "opt": [8, 3, 224, 224], "max": [32, 3, 224, 224] }] }
+//     ]
+//   }
+//
+// where the settings in defaults apply to every job which does not set them.
+// Relative paths are resolved against base_dir. Throws std::runtime_error
+// naming the job (or the line and column for syntax errors) on invalid input
+std::vector<Job> ParseManifest(const std::string& text, const std::string& base_dir);
+
+// Reads and parses the manifest at path, relative paths in it are resolved
+// against its directory
+std::vector<Job> LoadManifest(const std::string& path);
+
+struct JobResult {
+  std::string name;
+  bool ok = false;
+  std::string error;
+  double seconds = 0;
+};
+
+// Runs run on workers threads for every job and returns the results in
+// manifest order. Jobs are started grouped by input so that each model is
+// only needed by a few workers at once and can be released early. An
+// exception thrown by run fails that job only. done is called with the result
+// of each job as it finishes, one call at a time
+std::vector<JobResult> RunJobs(
+    const std::vector<Job>& jobs,
+    size_t workers,
+    const std::function<void(const Job&)>& run,
+    const std::function<void(const JobResult&)>& done = nullptr);
+
+// Models shared by the jobs of a manifest. Each input is loaded once, on the
+// first Acquire, and dropped by the store when the last job using it has
+// acquired it, so the model is freed as soon as those jobs are done with it
+template <typename Model>
+class ModelStore {
+ public:
+  using Loader = std::function<std::shared_ptr<Model>(const std::string&)>;
+
+  ModelStore(const std::vector<Job>& jobs, Loader load) : load_(std::move(load)) {
+    for (const auto& job : jobs) {
+      entries_[job.input_path].uses++;
+    }
+  }
+
+  // The model for input_path, loading it if needed. Concurrent callers wait
+  // for the load in progress, a failed load throws for every job of the input
+  std::shared_ptr<Model> Acquire(const std::string& input_path) {
+    std::promise<std::shared_ptr<Model>> promise;
+    std::shared_future<std::shared_ptr<Model>> model;
+    bool owner = false;
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      auto& entry = entries_[input_path];
+      if (!entry.model.valid()) {
+        entry.model = promise.get_future().share();
+        loads_++;
+        owner = true;
+      }
+      model = entry.model;
+      if (entry.uses > 0 && --entry.uses == 0) {
+        entry.model = std::shared_future<std::shared_ptr<Model>>();
+      }
+    }
+    if (owner) {
+      try {
+        promise.set_value(load_(input_path));
+      } catch (...) {
+        promise.set_exception(std::current_exception());
+      }
+    }
+    return model.get();
+  }
+
+  // Number of models loaded so far
+  size_t loads() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return loads_;
+  }
+
+ private:
+  struct Entry {
+    // Jobs which have not acquired the model yet
+    int64_t uses = 0;
+    std::shared_future<std::shared_ptr<Model>> model;
+  };
+
+  Loader load_;
+  mutable std::mutex mu_;
+  std::map<std::string, Entry> entries_;
+  size_t loads_ = 0;
+};
+
+} // namespace trtorchc
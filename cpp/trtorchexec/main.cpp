@@ -29,9 +29,10 @@ int main(int argc, const char* argv[]) {
 
   torch::jit::Module mod;
   try {
-    // Deserialize the ScriptModule from a file using torch::jit::load().
-    mod = torch::jit::load(argv[1]);
-  } catch (const c10::Error& e) {
+    // Deserialize the ScriptModule from a file, reading it through a memory
+    // mapping (see trtorch::LoadModule)
+    mod = trtorch::LoadModule(argv[1]);
+  } catch (const std::exception& e) {
     std::cerr << "error loading the model\n";
     return -1;
   }
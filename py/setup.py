@@ -169,6 +169,7 @@ ext_modules = [
     cpp_extension.CUDAExtension(
         'trtorch._C', [
             'trtorch/csrc/trtorch_py.cpp',
+            'trtorch/csrc/calibrator.cpp',
             'trtorch/csrc/tensorrt_backend.cpp',
             'trtorch/csrc/tensorrt_classes.cpp',
             'trtorch/csrc/register_tensorrt_classes.cpp',
@@ -178,6 +179,7 @@ ext_modules = [
         include_dirs=[
             dir_path + "trtorch/csrc",
             dir_path + "/../",
+            dir_path + "/../cpp/api/include",
             dir_path + "/../bazel-TRTorch/external/tensorrt/include",
         ],
         extra_compile_args=[
@@ -10,8 +10,10 @@ import torch
 from trtorch._version import __version__
 from trtorch._compiler import *
 from trtorch._compile_spec import TensorRTCompileSpec
+from trtorch._shape_profiles import ShapeRecorder, derive_input_ranges
 from trtorch._types import *
 from trtorch import logging
+from trtorch import ptq
 
 
 def _register_with_torch():
@@ -60,6 +60,25 @@ def _parse_input_ranges(input_sizes: List) -> List:
     return parsed_input_sizes
 
 
+def _parse_shape_bucketing(policies: List) -> List:
+    parsed_policies = []
+    for p in policies:
+        if not isinstance(p, dict) or "input" not in p or "dim" not in p:
+            raise KeyError("A shape bucketing policy must be a Dict with at least an input index and a dimension")
+        policy = trtorch._C.BucketPolicy()
+        policy.input = p["input"]
+        policy.dim = p["dim"]
+        if "boundaries" in p:
+            policy.boundaries = list(p["boundaries"])
+        if "pad_value" in p:
+            policy.pad_value = float(p["pad_value"])
+        if "output_dims" in p:
+            policy.output_dims = [tuple(o) for o in p["output_dims"]]
+        parsed_policies.append(policy)
+
+    return parsed_policies
+
+
 def _parse_op_precision(precision: Any) -> _types.dtype:
     if isinstance(precision, torch.dtype):
         if precision == torch.int8:
@@ -151,6 +170,35 @@ def _parse_compile_spec(compile_spec: Dict[str, Any]) -> trtorch._C.CompileSpec:
         assert type(compile_spec["max_batch_size"]) is int
         info.max_batch_size = compile_spec["max_batch_size"]
 
+    if "engine_compression_level" in compile_spec:
+        assert type(compile_spec["engine_compression_level"]) is int
+        info.engine_compression_level = compile_spec["engine_compression_level"]
+
+    if "split_oversized_batches" in compile_spec:
+        assert type(compile_spec["split_oversized_batches"]) is bool
+        info.split_oversized_batches = compile_spec["split_oversized_batches"]
+
+    if "freeze_in_place" in compile_spec:
+        assert type(compile_spec["freeze_in_place"]) is bool
+        info.freeze_in_place = compile_spec["freeze_in_place"]
+
+    if "specialize_after" in compile_spec:
+        assert type(compile_spec["specialize_after"]) is int
+        info.specialize_after = compile_spec["specialize_after"]
+
+    if "max_specializations" in compile_spec:
+        assert type(compile_spec["max_specializations"]) is int
+        info.max_specializations = compile_spec["max_specializations"]
+
+    if "shape_bucketing" in compile_spec:
+        info.shape_bucketing = _parse_shape_bucketing(compile_spec["shape_bucketing"])
+
+    if "calibrator" in compile_spec:
+        if not hasattr(compile_spec["calibrator"], "_c"):
+            raise TypeError("calibrator must be a trtorch.ptq.DataLoaderCalibrator or CacheCalibrator, got: " +
+                            str(type(compile_spec["calibrator"])))
+        info.ptq_calibrator = compile_spec["calibrator"]._c
+
     return info
 
 
@@ -186,6 +234,9 @@ def TensorRTCompileSpec(compile_spec: Dict[str, Any]):
                         "num_avg_timing_iters": 1, # Number of averaging timing iterations used to select kernels
                         "workspace_size": 0, # Maximum size of workspace given to TensorRT
                         "max_batch_size": 0, # Maximum batch size (must be >= 1 to be set, 0 means not set)
+                        "engine_compression_level": 0, # Compression level for engines in saved modules (0: none, 1 (fastest) - 9 (smallest))
+                        "split_oversized_batches": False, # Run batches larger than the max input shape in max sized chunks
+                        "freeze_in_place": False, # Fold attributes into the graph without cloning the module (saves a copy of the weights)
                     })
                 }
 
@@ -220,5 +271,8 @@ def TensorRTCompileSpec(compile_spec: Dict[str, Any]):
     backend_spec.set_num_avg_timing_iters(parsed_spec.num_avg_timing_iters)
     backend_spec.set_workspace_size(parsed_spec.workspace_size)
     backend_spec.set_max_batch_size(parsed_spec.max_batch_size)
+    backend_spec.set_engine_compression_level(parsed_spec.engine_compression_level)
+    backend_spec.set_split_oversized_batches(parsed_spec.split_oversized_batches)
+    backend_spec.set_freeze_in_place(parsed_spec.freeze_in_place)
 
     return backend_spec
@@ -1,4 +1,7 @@
-from typing import List, Dict, Any
+from typing import List, Dict, Any, Optional
+from concurrent.futures import Executor, Future, ThreadPoolExecutor
+import json
+import threading
 import torch
 from torch import nn
 
@@ -45,6 +48,21 @@ def compile(module: torch.jit.ScriptModule, compile_spec: Any) -> torch.jit.Scri
                     "num_avg_timing_iters": 1, # Number of averaging timing iterations used to select kernels
                     "workspace_size": 0, # Maximum size of workspace given to TensorRT
                     "max_batch_size": 0, # Maximum batch size (must be >= 1 to be set, 0 means not set)
+                    "engine_compression_level": 0, # Compression level for engines in saved modules (0: none, 1 (fastest) - 9 (smallest))
+                    "split_oversized_batches": False, # Run batches larger than the max input shape in max sized chunks
+                    "freeze_in_place": False, # Fold attributes into the graph without cloning the module (saves a copy of the weights)
+                    "specialize_after": 0, # Build an engine for input shapes seen this many times in the background (0: disabled)
+                    "max_specializations": 4, # Maximum number of shape specialized engines kept per method
+                    "shape_bucketing": [
+                        {
+                            "input": 0,
+                            "dim": 1,
+                            "boundaries": [32, 64, 128], # Pad dimension 1 of input #1 up to one of these sizes (default: powers of two)
+                            "pad_value": 0,
+                            "output_dims": [(0, 1)] # Slice dimension 1 of output #1 back to the unpadded size
+                        }
+                    ],
+                    "calibrator": trtorch.ptq.DataLoaderCalibrator(dataloader), # INT8 calibrator (see trtorch.ptq)
                 }
 
             Input Sizes can be specified as torch sizes, tuples or lists. Op precisions can be specified using
@@ -64,6 +82,58 @@ def compile(module: torch.jit.ScriptModule, compile_spec: Any) -> torch.jit.Scri
     return compiled_module
 
 
+_async_executor = None
+_async_executor_lock = threading.Lock()
+
+
+def _default_async_executor() -> Executor:
+    global _async_executor
+    with _async_executor_lock:
+        if _async_executor is None:
+            _async_executor = ThreadPoolExecutor(thread_name_prefix="trtorch_compile")
+        return _async_executor
+
+
+def compile_async(module: torch.jit.ScriptModule, compile_spec: Any, executor: Optional[Executor] = None) -> Future:
+    """Compile a TorchScript module for NVIDIA GPUs using TensorRT on a background thread
+
+    Same as ``trtorch.compile`` but returns immediately with a future for the compiled module. The compiler does not
+    hold the GIL while it runs, so the calling thread and other compilations keep going in the meantime, e.g. to
+    compile several modules at once. The compile spec is checked before returning, errors during compilation are
+    raised by ``Future.result()``.
+
+    Args:
+        module (torch.jit.ScriptModule): Source module, a result of tracing or scripting a PyTorch
+            ``torch.nn.Module``
+        compile_spec (dict): Compilation settings, see ``trtorch.compile``
+        executor (concurrent.futures.Executor): Where to run the compilation, by default a thread pool shared by all
+            calls sized for the machine
+
+    Returns:
+        concurrent.futures.Future: Resolves to the compiled TorchScript Module
+
+    Example::
+
+        futures = [trtorch.compile_async(m, spec) for m in modules]
+        trt_modules = [f.result() for f in futures]
+    """
+
+    if isinstance(module, torch.jit.ScriptFunction):
+        raise TypeError(
+            "torch.jit.ScriptFunction currently is not directly supported, wrap the function in a module to compile")
+
+    # Parsed here so mistakes in the spec are raised by the caller
+    parsed_spec = _parse_compile_spec(compile_spec)
+
+    def run():
+        compiled_cpp_mod = trtorch._C.compile_graph(module._c, parsed_spec)
+        return torch.jit._recursive.wrap_cpp_module(compiled_cpp_mod)
+
+    if executor is None:
+        executor = _default_async_executor()
+    return executor.submit(run)
+
+
 def convert_method_to_trt_engine(module: torch.jit.ScriptModule, method_name: str, compile_spec: Any) -> str:
     """Convert a TorchScript module method to a serialized TensorRT engine
 
@@ -115,6 +185,21 @@ def convert_method_to_trt_engine(module: torch.jit.ScriptModule, method_name: st
     return trtorch._C.convert_graph_to_trt_engine(module._c, method_name, _parse_compile_spec(compile_spec))
 
 
+def swap_engine(module: torch.jit.ScriptModule, method_name: str, serialized_engine: bytes) -> None:
+    """Replaces the TensorRT engine a compiled method runs while the module is in use
+
+    Calls started after the swap run on the new engine, calls already in flight finish on the previous engine
+    which is released once they are done. This allows rolling out an updated model without reloading the module.
+
+    Args:
+        module (torch.jit.ScriptModule): Module returned by ``trtorch.compile`` (or loaded from one that was saved)
+        method_name (str): Name of the compiled method
+        serialized_engine (bytes): Replacement engine with the same inputs and outputs, e.g. from
+            ``trtorch.convert_method_to_trt_engine`` on a retrained version of the source module
+    """
+    trtorch._C.swap_engine(module._c, method_name, serialized_engine)
+
+
 def check_method_op_support(module: torch.jit.ScriptModule, method_name: str) -> bool:
     """Checks to see if a method is fully supported by TRTorch
 
@@ -132,6 +217,40 @@ def check_method_op_support(module: torch.jit.ScriptModule, method_name: str) ->
     return trtorch._C.check_method_op_support(module._c, method_name)
 
 
+def get_engine_stats(module: torch.jit.ScriptModule) -> Dict[str, Dict[str, int]]:
+    """Returns the runtime metrics collected by the TensorRT engines embedded in a compiled module
+
+    Every engine counts its calls, errors and calls per input shape and keeps latency histograms
+    of the host side overhead of a call and of the time from enqueuing the engine until the call
+    returns. Metrics are collected since the module was loaded or compiled and are not saved with it.
+
+    Args:
+        module (torch.jit.ScriptModule): Module returned by ``trtorch.compile`` (or loaded from one that was saved)
+
+    Returns:
+        Dict[str, Dict[str, int]]: For each engine attribute in the module, a flat mapping of metric names to values
+        (e.g. ``calls``, ``errors``, ``host_overhead_ns.p99``, ``enqueue_to_return_ns.mean``, ``shape.[1, 3, 224, 224]``)
+    """
+    return trtorch._C.get_engine_stats(module._c)
+
+
+def get_flight_records(module: torch.jit.ScriptModule) -> Dict[str, Dict[str, Any]]:
+    """Returns the most recent executions recorded by the TensorRT engines embedded in a compiled module
+
+    Every engine keeps the last 64 executions in a ring buffer with their start time, input shapes and dtypes,
+    optimization profile, duration and outcome. The same record is written to the log when an execution fails.
+
+    Args:
+        module (torch.jit.ScriptModule): Module returned by ``trtorch.compile`` (or loaded from one that was saved)
+
+    Returns:
+        Dict[str, Dict[str, Any]]: For each engine attribute in the module, the parsed record with the keys ``engine``,
+        ``recorded``, ``dropped`` and ``executions`` (oldest first)
+    """
+    records = trtorch._C.get_flight_records(module._c)
+    return {name: json.loads(record) for name, record in records.items()}
+
+
 def dump_build_info():
     """Prints build information about the TRTorch distribution to stdout
     """
@@ -0,0 +1,96 @@
+from typing import List, Dict, Tuple, Any
+import threading
+import torch
+
+import trtorch._C
+
+
+class ShapeRecorder(object):
+    """Records the shapes of the tensors a module is called with
+
+    Wraps a module (TorchScript, compiled or ``torch.nn.Module``) and counts the calls made through it per
+    distinct set of input shapes. The histogram can be saved with ``dump`` and passed to
+    ``trtorch.derive_input_ranges`` or ``trtorchc --shape-histogram`` to pick input ranges that fit the traffic
+    the module actually serves.
+
+    Only tensor arguments are recorded, in the order they are passed (positional arguments first).
+
+    Args:
+        module: Module to record the calls of, calls are forwarded to it unchanged
+
+    Example::
+
+        recorder = trtorch.ShapeRecorder(model)
+        for batch in loader:
+            recorder(batch)
+        recorder.dump("shapes.txt")
+        input_ranges = trtorch.derive_input_ranges("shapes.txt")[0]
+    """
+
+    def __init__(self, module: Any):
+        self.module = module
+        self._lock = threading.Lock()
+        self._histogram = {}
+
+    def __call__(self, *args, **kwargs):
+        self.record(*args, **kwargs)
+        return self.module(*args, **kwargs)
+
+    def record(self, *args, **kwargs):
+        """Counts a call with the given arguments without running the module
+        """
+        inputs = list(args) + [kwargs[k] for k in sorted(kwargs)]
+        shapes = tuple(tuple(i.shape) for i in inputs if isinstance(i, torch.Tensor))
+        with self._lock:
+            self._histogram[shapes] = self._histogram.get(shapes, 0) + 1
+
+    def histogram(self) -> Dict[Tuple[Tuple[int, ...], ...], int]:
+        """Returns the number of calls recorded per set of input shapes
+        """
+        with self._lock:
+            return dict(self._histogram)
+
+    def reset(self):
+        """Drops the recorded calls
+        """
+        with self._lock:
+            self._histogram = {}
+
+    def dump(self, path: str):
+        """Writes the histogram to a file, one line per set of input shapes with the number of calls followed by the
+        shape of each input, e.g. ``12 (1,3,224,224) (1,128)``
+        """
+        histogram = self.histogram()
+        with open(path, "w") as f:
+            f.write("# trtorch shape histogram: calls followed by the shape of each input\n")
+            for shapes, calls in sorted(histogram.items(), key=lambda e: -e[1]):
+                f.write(str(calls))
+                for shape in shapes:
+                    f.write(" (" + ",".join(str(d) for d in shape) + ")")
+                f.write("\n")
+
+
+def derive_input_ranges(shape_histogram_path: str, num_profiles: int = 1,
+                        objective: str = "padding") -> List[List[Dict[str, List[int]]]]:
+    """Derives input ranges from a histogram of the input shapes a module was called with
+
+    The recorded shapes are ordered by size and split into at most ``num_profiles`` contiguous groups minimizing the
+    objective over all recorded calls. Each group becomes a profile covering its shapes, with the most frequent shape
+    of the group as the optimal size.
+
+    An engine is built for a single profile, so the input ranges of one profile can be used directly as
+    ``input_shapes`` in the compile spec. Several profiles show how the traffic would be split across separately
+    compiled modules.
+
+    Args:
+        shape_histogram_path (str): Histogram written by ``trtorch.ShapeRecorder.dump``
+        num_profiles (int): Maximum number of profiles to split the shapes into
+        objective (str): What the split minimizes, ``"padding"`` for the elements added by padding each call up to
+            the max shape of its profile or ``"range_width"`` for the width of the ranges weighted by the calls they
+            serve
+
+    Returns:
+        List[List[Dict[str, List[int]]]]: For each profile (smallest shapes first) a ``{"min", "opt", "max"}`` range
+        per input
+    """
+    return trtorch._C.derive_input_ranges(shape_histogram_path, num_profiles, objective)
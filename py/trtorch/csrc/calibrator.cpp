@@ -0,0 +1,215 @@
+#include "calibrator.h"
+
+#include <algorithm>
+
+#include "pybind11/stl.h"
+#include "torch/csrc/jit/python/pybind_utils.h"
+
+#include "core/util/prelude.h"
+#include "trtorch/ptq.h"
+
+namespace trtorch {
+namespace pyapi {
+namespace {
+
+// Releases the GIL for the current scope if the calling thread holds it.
+// TensorRT asks for batches from the thread which called compile, which may
+// or may not hold the GIL
+std::unique_ptr<py::gil_scoped_release> release_gil() {
+  if (PyGILState_Check()) {
+    return std::unique_ptr<py::gil_scoped_release>(new py::gil_scoped_release());
+  }
+  return nullptr;
+}
+
+template <typename Algorithm>
+class StreamCalibrator : public Algorithm {
+ public:
+  StreamCalibrator(std::shared_ptr<BatchStream> stream, std::string cache_file_path, bool use_cache)
+      : stream_(std::move(stream)), cache_file_path_(std::move(cache_file_path)), use_cache_(use_cache) {}
+
+  int getBatchSize() const override {
+    // TRTorch builds explicit batch networks, see ptq::Int8Calibrator
+    return 1;
+  }
+
+  bool getBatch(void* bindings[], const char* names[], int nbBindings) override {
+    // Called from TensorRT, so loading errors and errors raised by start_pass
+    // (py::error_already_set) stop calibration and compile raises them once
+    // the engine build returns, see ptq::stop_calibration_impl
+    try {
+      CalibrationInputs batch;
+      if (!stream_ || !stream_->Next(batch)) {
+        device_inputs_.clear();
+        return false;
+      }
+      return ptq::get_batch_impl(bindings, names, nbBindings, batch, device_inputs_);
+    } catch (...) {
+      device_inputs_.clear();
+      return ptq::stop_calibration_impl(std::current_exception());
+    }
+  }
+
+  const void* readCalibrationCache(size_t& length) override {
+    if (!use_cache_ || cache_file_path_.empty()) {
+      return nullptr;
+    }
+    LOG_INFO("Reading Calibration Cache from " << cache_file_path_);
+    size_t offset = 0;
+    // Without a dataloader there is nothing to calibrate again on
+    bool can_recalibrate = stream_ != nullptr;
+    if (!ptq::read_calibration_cache_impl(cache_file_path_, this->getAlgorithm(), can_recalibrate, cache_, offset)) {
+      return nullptr;
+    }
+    length = cache_.size() - offset;
+    return length ? cache_.data() + offset : nullptr;
+  }
+
+  void writeCalibrationCache(const void* cache, size_t length) override {
+    if (cache_file_path_.empty()) {
+      return;
+    }
+    ptq::write_calibration_cache_impl(cache_file_path_, this->getAlgorithm(), cache, length);
+    LOG_INFO("Saved Calibration Cache to " << cache_file_path_);
+  }
+
+ private:
+  std::shared_ptr<BatchStream> stream_;
+  std::string cache_file_path_;
+  bool use_cache_;
+  std::vector<char> cache_;
+  // Device copy of the batch handed to TensorRT last, one tensor per binding
+  std::vector<torch::Tensor> device_inputs_;
+};
+
+} // namespace
+
+BatchStream::BatchStream(py::function start_pass, size_t capacity)
+    : start_pass_(std::move(start_pass)), capacity_(capacity > 0 ? capacity : 1) {}
+
+BatchStream::~BatchStream() {
+  Stop();
+  py::gil_scoped_acquire gil;
+  start_pass_ = py::function();
+}
+
+bool BatchStream::Next(CalibrationInputs& batch) {
+  bool start = false;
+  uint64_t pass;
+  {
+    std::unique_lock<std::mutex> lock(mu_);
+    if (!active_) {
+      queue_.clear();
+      active_ = true;
+      done_ = false;
+      error_.clear();
+      pass_++;
+      start = true;
+    }
+    pass = pass_;
+  }
+  if (start) {
+    try {
+      py::gil_scoped_acquire gil;
+      start_pass_(pass);
+    } catch (...) {
+      std::unique_lock<std::mutex> lock(mu_);
+      active_ = false;
+      throw;
+    }
+  }
+
+  auto nogil = release_gil();
+  std::unique_lock<std::mutex> lock(mu_);
+  cv_.wait(lock, [this]() { return !queue_.empty() || done_; });
+  if (!queue_.empty()) {
+    batch = std::move(queue_.front());
+    queue_.pop_front();
+    cv_.notify_all();
+    return true;
+  }
+  active_ = false;
+  TRTORCH_CHECK(error_.empty(), "Loading a calibration batch failed: " << error_);
+  return false;
+}
+
+bool BatchStream::Push(uint64_t pass, CalibrationInputs batch) {
+  auto nogil = release_gil();
+  // Done before queueing so the consumer only has to copy to the device
+  ptq::stage_inputs_impl(batch);
+  std::unique_lock<std::mutex> lock(mu_);
+  cv_.wait(lock, [this, pass]() { return queue_.size() < capacity_ || pass != pass_; });
+  if (pass != pass_) {
+    return false;
+  }
+  queue_.push_back(std::move(batch));
+  peak_ = std::max(peak_, queue_.size());
+  cv_.notify_all();
+  return true;
+}
+
+void BatchStream::Finish(uint64_t pass) {
+  std::unique_lock<std::mutex> lock(mu_);
+  if (pass == pass_) {
+    done_ = true;
+    cv_.notify_all();
+  }
+}
+
+void BatchStream::Fail(uint64_t pass, const std::string& error) {
+  std::unique_lock<std::mutex> lock(mu_);
+  if (pass == pass_) {
+    error_ = error;
+    done_ = true;
+    cv_.notify_all();
+  }
+}
+
+void BatchStream::Stop() {
+  std::unique_lock<std::mutex> lock(mu_);
+  // Batches of the stopped pass are rejected from here on
+  pass_++;
+  active_ = false;
+  done_ = true;
+  queue_.clear();
+  cv_.notify_all();
+}
+
+py::object BatchStream::NextTensors() {
+  CalibrationInputs batch;
+  if (!Next(batch)) {
+    return py::none();
+  }
+  return py::cast(ptq::positional_inputs_impl(batch));
+}
+
+size_t BatchStream::peak_queued() const {
+  std::unique_lock<std::mutex> lock(mu_);
+  return peak_;
+}
+
+Calibrator::Calibrator(
+    std::shared_ptr<BatchStream> stream,
+    std::string cache_file_path,
+    bool use_cache,
+    nvinfer1::CalibrationAlgoType algorithm) {
+  switch (algorithm) {
+    case nvinfer1::CalibrationAlgoType::kENTROPY_CALIBRATION:
+      calibrator_.reset(
+          new StreamCalibrator<nvinfer1::IInt8EntropyCalibrator>(stream, std::move(cache_file_path), use_cache));
+      break;
+    case nvinfer1::CalibrationAlgoType::kENTROPY_CALIBRATION_2:
+      calibrator_.reset(
+          new StreamCalibrator<nvinfer1::IInt8EntropyCalibrator2>(stream, std::move(cache_file_path), use_cache));
+      break;
+    case nvinfer1::CalibrationAlgoType::kMINMAX_CALIBRATION:
+      calibrator_.reset(
+          new StreamCalibrator<nvinfer1::IInt8MinMaxCalibrator>(stream, std::move(cache_file_path), use_cache));
+      break;
+    default:
+      TRTORCH_THROW_ERROR("Unsupported calibration algorithm, options are entropy, entropy2 and minmax");
+  }
+}
+
+} // namespace pyapi
+} // namespace trtorch
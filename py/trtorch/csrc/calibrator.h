@@ -0,0 +1,93 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "NvInfer.h"
+#include "pybind11/pybind11.h"
+#include "torch/torch.h"
+
+namespace py = pybind11;
+
+namespace trtorch {
+namespace pyapi {
+
+// Inputs of a batch, named by engine input ("input_<i>") or unnamed to feed
+// the inputs in order, same as ptq::CalibrationInputs
+using CalibrationInputs = std::vector<std::pair<std::string, torch::Tensor>>;
+
+// Batches pushed by a Python thread iterating a DataLoader and consumed by
+// TensorRT. At most capacity batches wait in the queue, tensors are handed
+// over by reference. Neither side holds the GIL while it waits and the GIL is
+// never taken with the queue locked, so the producer runs while TensorRT
+// calibrates on the thread which called compile
+class BatchStream {
+ public:
+  // start_pass is called (with the GIL) with the id of a new pass when the
+  // consumer asks for a batch and no pass is running, it should start a thread
+  // pushing the batches of one pass over the data under that id
+  BatchStream(py::function start_pass, size_t capacity);
+  ~BatchStream();
+
+  // Consumer side, waits for the next batch of the pass. Returns false once
+  // the pass is complete, the next call starts a new one. Errors raised by the
+  // producer are rethrown here
+  bool Next(CalibrationInputs& batch);
+
+  // Producer side, makes the tensors contiguous and waits for room in the
+  // queue. Returns false if the pass was stopped, the producer should end.
+  // Calls for a pass other than the current one are ignored
+  bool Push(uint64_t pass, CalibrationInputs batch);
+  void Finish(uint64_t pass);
+  void Fail(uint64_t pass, const std::string& error);
+
+  // Ends the current pass, unblocking the producer
+  void Stop();
+
+  // Next batch as tensors in input order, None at the end of a pass. Lets the
+  // prefetch pipeline be exercised from Python without TensorRT
+  py::object NextTensors();
+
+  // Most batches waiting in the queue at once so far
+  size_t peak_queued() const;
+
+ private:
+  py::function start_pass_;
+  size_t capacity_;
+  mutable std::mutex mu_;
+  std::condition_variable cv_;
+  std::deque<CalibrationInputs> queue_;
+  size_t peak_ = 0;
+  // Id of the current (or last) pass
+  uint64_t pass_ = 0;
+  bool active_ = false;
+  bool done_ = false;
+  std::string error_;
+};
+
+// INT8 calibrator handed to CompileSpec from Python. Batches come from a
+// BatchStream, or only from the calibration cache if there is none
+class Calibrator {
+ public:
+  Calibrator(
+      std::shared_ptr<BatchStream> stream,
+      std::string cache_file_path,
+      bool use_cache,
+      nvinfer1::CalibrationAlgoType algorithm);
+
+  nvinfer1::IInt8Calibrator* get() {
+    return calibrator_.get();
+  }
+
+ private:
+  std::unique_ptr<nvinfer1::IInt8Calibrator> calibrator_;
+};
+
+} // namespace pyapi
+} // namespace trtorch
@@ -32,6 +32,11 @@ void RegisterTRTCompileSpec() {
   ADD_FIELD_GET_SET_REGISTRATION(TRTCompileSpecTSRegistrtion, trtorch::pyapi::CompileSpec, num_avg_timing_iters);
   ADD_FIELD_GET_SET_REGISTRATION(TRTCompileSpecTSRegistrtion, trtorch::pyapi::CompileSpec, workspace_size);
   ADD_FIELD_GET_SET_REGISTRATION(TRTCompileSpecTSRegistrtion, trtorch::pyapi::CompileSpec, max_batch_size);
+  ADD_FIELD_GET_SET_REGISTRATION(
+      TRTCompileSpecTSRegistrtion, trtorch::pyapi::CompileSpec, engine_compression_level);
+  ADD_FIELD_GET_SET_REGISTRATION(
+      TRTCompileSpecTSRegistrtion, trtorch::pyapi::CompileSpec, split_oversized_batches);
+  ADD_FIELD_GET_SET_REGISTRATION(TRTCompileSpecTSRegistrtion, trtorch::pyapi::CompileSpec, freeze_in_place);
 }
 
 struct TRTTSRegistrations {
@@ -58,6 +58,7 @@ c10::impl::GenericDict TensorRTBackend::compile(c10::IValue processed_mod, c10::
 
     auto serialized_engine = core::conversion::ConvertBlockToEngine(g->block(), convert_cfg, named_params);
     auto engine_handle = c10::make_intrusive<core::runtime::TRTEngine>(it->key(), serialized_engine);
+    engine_handle->settings = cfg.runtime_settings;
     handles.insert(method.name(), at::IValue(engine_handle));
   }
 
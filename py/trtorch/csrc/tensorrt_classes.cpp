@@ -1,5 +1,5 @@
-
 #include "tensorrt_classes.h"
+#include "calibrator.h"
 
 namespace trtorch {
 namespace pyapi {
@@ -24,6 +24,36 @@ std::string to_str(InputRange& value) {
   return ss.str();
 }
 
+core::runtime::BucketPolicy BucketPolicy::toInternalBucketPolicy() {
+  core::runtime::BucketPolicy policy;
+  policy.input = input;
+  policy.dim = dim;
+  policy.boundaries = boundaries;
+  policy.pad_value = pad_value;
+  policy.output_dims = output_dims;
+  return policy;
+}
+
+std::string to_str(BucketPolicy& value) {
+  std::stringstream ss;
+  ss << "        {" << std::endl;
+  ss << "            input: " << value.input << ',' << std::endl;
+  ss << "            dim: " << value.dim << ',' << std::endl;
+  ss << "            boundaries: [";
+  for (auto b : value.boundaries) {
+    ss << b << ',';
+  }
+  ss << "]," << std::endl;
+  ss << "            pad_value: " << value.pad_value << ',' << std::endl;
+  ss << "            output_dims: [";
+  for (auto o : value.output_dims) {
+    ss << '(' << o.first << ',' << o.second << "),";
+  }
+  ss << "]," << std::endl;
+  ss << "        }" << std::endl;
+  return ss.str();
+}
+
 std::string to_str(DataType value) {
   switch (value) {
     case DataType::kHalf:
@@ -113,6 +143,29 @@ core::CompileSpec CompileSpec::toInternalCompileSpec() {
   info.convert_info.engine_settings.workspace_size = workspace_size;
   TRTORCH_CHECK(max_batch_size >= 0, "max_batch_size must be 0 or greater");
   info.convert_info.engine_settings.max_batch_size = max_batch_size;
+  TRTORCH_CHECK(
+      engine_compression_level >= 0 && engine_compression_level <= 9,
+      "engine_compression_level must be between 0 and 9");
+  info.runtime_settings.compression_level = engine_compression_level;
+  info.runtime_settings.split_oversized_batches = split_oversized_batches;
+  info.lower_info.freeze_in_place = freeze_in_place;
+  for (auto policy : shape_bucketing) {
+    info.runtime_settings.bucketing.push_back(policy.toInternalBucketPolicy());
+  }
+  core::runtime::MaxShapes max_shapes;
+  for (const auto& range : input_ranges) {
+    max_shapes.push_back(range.max);
+  }
+  core::runtime::ValidateBucketPolicies(info.runtime_settings.bucketing, max_shapes);
+  TRTORCH_CHECK(specialize_after >= 0, "specialize_after must be 0 or greater");
+  TRTORCH_CHECK(
+      specialize_after == 0 || max_specializations > 0,
+      "max_specializations must be greater than 0 to enable shape specialization");
+  info.runtime_settings.specialize_after = specialize_after;
+  info.runtime_settings.max_specializations = max_specializations;
+  if (ptq_calibrator) {
+    info.convert_info.engine_settings.calibrator = ptq_calibrator->get();
+  }
   return info;
 }
 
@@ -135,6 +188,16 @@ std::string CompileSpec::stringify() {
   ss << "     \"Num Avg Timing Iters\": " << num_avg_timing_iters << std::endl;
   ss << "     \"Workspace Size\": " << workspace_size << std::endl;
   ss << "     \"Max Batch Size\": " << max_batch_size << std::endl;
+  ss << "     \"Engine Compression Level\": " << engine_compression_level << std::endl;
+  ss << "     \"Split Oversized Batches\": " << split_oversized_batches << std::endl;
+  ss << "     \"Freeze In Place\": " << freeze_in_place << std::endl;
+  ss << "     \"Specialize After\": " << specialize_after << std::endl;
+  ss << "     \"Max Specializations\": " << max_specializations << std::endl;
+  ss << "     \"Shape Bucketing\": [" << std::endl;
+  for (auto policy : shape_bucketing) {
+    ss << to_str(policy);
+  }
+  ss << "     ]" << std::endl;
   ss << "}";
   return ss.str();
 }
@@ -2,6 +2,7 @@
 
 #include "core/compiler.h"
 #include "core/conversion/conversion.h"
+#include "core/runtime/ShapeBucketing.h"
 #include "torch/custom_class.h"
 #include "torch/script.h"
 #include "torch/torch.h"
@@ -9,6 +10,8 @@
 namespace trtorch {
 namespace pyapi {
 
+class Calibrator;
+
 #define ADD_FIELD_GET_SET(field_name, type) \
   void set_##field_name(type val) {         \
     field_name = val;                       \
@@ -33,6 +36,18 @@ struct InputRange : torch::CustomClassHolder {
 
 std::string to_str(InputRange& value);
 
+struct BucketPolicy {
+  int64_t input = 0;
+  int64_t dim = 0;
+  std::vector<int64_t> boundaries;
+  double pad_value = 0;
+  std::vector<std::pair<int64_t, int64_t>> output_dims;
+
+  core::runtime::BucketPolicy toInternalBucketPolicy();
+};
+
+std::string to_str(BucketPolicy& value);
+
 enum class DataType : int8_t {
   kFloat,
   kHalf,
@@ -87,6 +102,9 @@ struct CompileSpec : torch::CustomClassHolder {
   ADD_FIELD_GET_SET(num_avg_timing_iters, int64_t);
   ADD_FIELD_GET_SET(workspace_size, int64_t);
   ADD_FIELD_GET_SET(max_batch_size, int64_t);
+  ADD_FIELD_GET_SET(engine_compression_level, int64_t);
+  ADD_FIELD_GET_SET(split_oversized_batches, bool);
+  ADD_FIELD_GET_SET(freeze_in_place, bool);
 
   std::vector<InputRange> input_ranges;
   DataType op_precision = DataType::kFloat;
@@ -100,6 +118,14 @@ struct CompileSpec : torch::CustomClassHolder {
   int64_t num_avg_timing_iters = 1;
   int64_t workspace_size = 0;
   int64_t max_batch_size = 0;
+  int64_t engine_compression_level = 0;
+  bool split_oversized_batches = false;
+  bool freeze_in_place = false;
+  std::vector<BucketPolicy> shape_bucketing;
+  int64_t specialize_after = 0;
+  int64_t max_specializations = 4;
+  // Only settable from Python, not through the TorchScript backend
+  std::shared_ptr<Calibrator> ptq_calibrator;
 };
 
 } // namespace pyapi
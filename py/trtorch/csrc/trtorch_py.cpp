@@ -1,9 +1,14 @@
+#include <fstream>
+
 #include "pybind11/pybind11.h"
 #include "pybind11/stl.h"
 
 #include "Python.h"
+#include "calibrator.h"
 #include "core/compiler.h"
 #include "core/conversion/conversion.h"
+#include "core/runtime/ShapeProfiles.h"
+#include "core/runtime/runtime.h"
 #include "tensorrt_classes.h"
 #include "torch/csrc/jit/python/pybind_utils.h"
 #include "torch/custom_class.h"
@@ -15,22 +20,92 @@ namespace py = pybind11;
 namespace trtorch {
 namespace pyapi {
 
+// Lowering, conversion and engine building run without the GIL so other
+// Python threads keep running (and several modules can be compiled at once).
+// Nothing in them calls back into Python except calibrators written in Python,
+// which take the GIL themselves
 torch::jit::Module CompileGraph(const torch::jit::Module& mod, CompileSpec& info) {
-  py::gil_scoped_acquire gil;
-  auto trt_mod = core::CompileGraph(mod, info.toInternalCompileSpec());
-  return trt_mod;
+  auto internal_info = info.toInternalCompileSpec();
+  py::gil_scoped_release nogil;
+  return core::CompileGraph(mod, internal_info);
 }
 
 py::bytes ConvertGraphToTRTEngine(const torch::jit::Module& mod, const std::string& method_name, CompileSpec& info) {
-  py::gil_scoped_acquire gil;
-  auto trt_engine = core::ConvertGraphToTRTEngine(mod, method_name, info.toInternalCompileSpec());
+  auto internal_info = info.toInternalCompileSpec();
+  std::string trt_engine;
+  {
+    py::gil_scoped_release nogil;
+    trt_engine = core::ConvertGraphToTRTEngine(mod, method_name, internal_info);
+  }
   return py::bytes(trt_engine);
 }
 
+void SwapEngine(const torch::jit::Module& mod, const std::string& method_name, const std::string& serialized_engine) {
+  core::SwapEngine(mod, method_name, serialized_engine);
+}
+
 bool CheckMethodOperatorSupport(const torch::jit::Module& module, const std::string& method_name) {
+  py::gil_scoped_release nogil;
   return core::CheckMethodOperatorSupport(module, method_name);
 }
 
+// TensorRT engines embedded in a module (and its submodules) keyed by attribute name
+std::vector<std::pair<std::string, c10::intrusive_ptr<core::runtime::TRTEngine>>> GetEngines(
+    const torch::jit::Module& mod) {
+  auto engine_type = torch::getCustomClass("__torch__.torch.classes.tensorrt.Engine");
+  std::vector<std::pair<std::string, c10::intrusive_ptr<core::runtime::TRTEngine>>> engines;
+  for (const auto& attr : mod.named_attributes(/*recurse=*/true)) {
+    if (attr.value.type() == engine_type) {
+      engines.emplace_back(attr.name, attr.value.toCustomClass<core::runtime::TRTEngine>());
+    }
+  }
+  return engines;
+}
+
+std::unordered_map<std::string, std::map<std::string, int64_t>> GetEngineStats(const torch::jit::Module& mod) {
+  std::unordered_map<std::string, std::map<std::string, int64_t>> stats;
+  for (const auto& engine : GetEngines(mod)) {
+    stats[engine.first] =
+        engine.second->WithActive([](core::runtime::TRTEngine& active) { return active.stats.Summary(); });
+  }
+  return stats;
+}
+
+std::unordered_map<std::string, std::string> GetFlightRecords(const torch::jit::Module& mod) {
+  std::unordered_map<std::string, std::string> records;
+  for (const auto& engine : GetEngines(mod)) {
+    records[engine.first] = engine.second->GetFlightRecord();
+  }
+  return records;
+}
+
+// Input ranges (min, opt, max per input) of each profile derived from a shape histogram
+std::vector<std::vector<std::map<std::string, std::vector<int64_t>>>> DeriveInputRanges(
+    const std::string& shape_histogram_path,
+    size_t num_profiles,
+    const std::string& objective) {
+  TRTORCH_CHECK(
+      objective == "padding" || objective == "range_width",
+      "Invalid profile objective " << objective << ", options are [ padding | range_width ]");
+  std::ifstream in(shape_histogram_path);
+  TRTORCH_CHECK(in.is_open(), "Unable to open shape histogram " << shape_histogram_path);
+  auto profiles = core::runtime::ClusterShapeProfiles(
+      core::runtime::ReadShapeHistogram(in),
+      num_profiles,
+      objective == "padding" ? core::runtime::ProfileObjective::kPadding
+                             : core::runtime::ProfileObjective::kRangeWidth);
+
+  std::vector<std::vector<std::map<std::string, std::vector<int64_t>>>> ranges;
+  for (const auto& profile : profiles) {
+    std::vector<std::map<std::string, std::vector<int64_t>>> profile_ranges;
+    for (size_t i = 0; i < profile.min.size(); i++) {
+      profile_ranges.push_back({{"min", profile.min[i]}, {"opt", profile.opt[i]}, {"max", profile.max[i]}});
+    }
+    ranges.push_back(std::move(profile_ranges));
+  }
+  return ranges;
+}
+
 std::string get_build_info() {
   auto info = core::util::get_build_info();
   return info;
@@ -77,6 +152,14 @@ PYBIND11_MODULE(_C, m) {
       .def_readwrite("opt", &InputRange::opt)
       .def_readwrite("max", &InputRange::max);
 
+  py::class_<BucketPolicy>(m, "BucketPolicy")
+      .def(py::init<>())
+      .def_readwrite("input", &BucketPolicy::input)
+      .def_readwrite("dim", &BucketPolicy::dim)
+      .def_readwrite("boundaries", &BucketPolicy::boundaries)
+      .def_readwrite("pad_value", &BucketPolicy::pad_value)
+      .def_readwrite("output_dims", &BucketPolicy::output_dims);
+
   py::enum_<DataType>(m, "dtype", "Enum to specifiy operating precision for engine execution")
       .value("float", DataType::kFloat, "32 bit floating point number")
       .value("float32", DataType::kFloat, "32 bit floating point number")
@@ -98,6 +181,34 @@ PYBIND11_MODULE(_C, m) {
       .value("safe_dla", EngineCapability::kSAFE_DLA, "Use safety DLA kernels only")
       .value("default", EngineCapability::kDEFAULT, "Use default behavior");
 
+  py::enum_<nvinfer1::CalibrationAlgoType>(m, "CalibrationAlgo", "Enum to select the INT8 calibration algorithm")
+      .value("ENTROPY_CALIBRATION", nvinfer1::CalibrationAlgoType::kENTROPY_CALIBRATION, "Entropy calibration")
+      .value(
+          "ENTROPY_CALIBRATION_2",
+          nvinfer1::CalibrationAlgoType::kENTROPY_CALIBRATION_2,
+          "Entropy calibration, version 2 (recommended for CNNs)")
+      .value("MINMAX_CALIBRATION", nvinfer1::CalibrationAlgoType::kMINMAX_CALIBRATION, "Min max calibration (for NLP)")
+      .export_values();
+
+  py::class_<BatchStream, std::shared_ptr<BatchStream>>(m, "BatchStream")
+      .def(py::init<py::function, size_t>())
+      .def(
+          "push",
+          [](BatchStream& self, uint64_t pass, CalibrationInputs batch) { return self.Push(pass, std::move(batch)); })
+      .def("finish", &BatchStream::Finish)
+      .def("fail", &BatchStream::Fail)
+      .def("stop", &BatchStream::Stop)
+      .def("next", &BatchStream::NextTensors)
+      .def("peak_queued", &BatchStream::peak_queued);
+
+  py::class_<Calibrator, std::shared_ptr<Calibrator>>(m, "Calibrator")
+      .def(
+          py::init<std::shared_ptr<BatchStream>, std::string, bool, nvinfer1::CalibrationAlgoType>(),
+          py::arg("stream").none(true),
+          py::arg("cache_file"),
+          py::arg("use_cache"),
+          py::arg("algorithm"));
+
   py::class_<CompileSpec>(m, "CompileSpec")
       .def(py::init<>())
       .def_readwrite("input_ranges", &CompileSpec::input_ranges)
@@ -111,7 +222,14 @@ PYBIND11_MODULE(_C, m) {
       .def_readwrite("num_min_timing_iters", &CompileSpec::num_min_timing_iters)
       .def_readwrite("num_avg_timing_iters", &CompileSpec::num_avg_timing_iters)
       .def_readwrite("workspace_size", &CompileSpec::workspace_size)
-      .def_readwrite("max_batch_size", &CompileSpec::max_batch_size);
+      .def_readwrite("max_batch_size", &CompileSpec::max_batch_size)
+      .def_readwrite("engine_compression_level", &CompileSpec::engine_compression_level)
+      .def_readwrite("split_oversized_batches", &CompileSpec::split_oversized_batches)
+      .def_readwrite("freeze_in_place", &CompileSpec::freeze_in_place)
+      .def_readwrite("shape_bucketing", &CompileSpec::shape_bucketing)
+      .def_readwrite("specialize_after", &CompileSpec::specialize_after)
+      .def_readwrite("max_specializations", &CompileSpec::max_specializations)
+      .def_readwrite("ptq_calibrator", &CompileSpec::ptq_calibrator);
 
   m.doc() =
       "TRTorch Internal C Bindings: Ahead of Time compilation for PyTorch JIT. A tool to convert PyTorch JIT to TensorRT";
@@ -127,6 +245,22 @@ PYBIND11_MODULE(_C, m) {
       "check_method_op_support",
       &trtorch::pyapi::CheckMethodOperatorSupport,
       "Takes a module and a method name and checks if the method graph contains purely convertable operators");
+  m.def(
+      "swap_engine",
+      &trtorch::pyapi::SwapEngine,
+      "Replaces the TensorRT engine a compiled method runs, calls in flight finish on the previous engine");
+  m.def(
+      "get_engine_stats",
+      &trtorch::pyapi::GetEngineStats,
+      "Returns the runtime metrics of each TensorRT engine embedded in a module keyed by attribute name");
+  m.def(
+      "get_flight_records",
+      &trtorch::pyapi::GetFlightRecords,
+      "Returns the JSON dump of the recent executions of each TensorRT engine embedded in a module keyed by attribute name");
+  m.def(
+      "derive_input_ranges",
+      &trtorch::pyapi::DeriveInputRanges,
+      "Groups the input shapes recorded in a shape histogram into profiles and returns the input ranges of each");
   m.def("get_build_info", &get_build_info, "Returns build info about the compiler as a string");
 
   m.def("_get_logging_prefix", &logging::get_logging_prefix, "Get the current prefix for the logging output");
@@ -0,0 +1,135 @@
+from typing import Any, Callable, List, Optional
+import threading
+import weakref
+import torch
+
+import trtorch._C
+from trtorch._types import CalibrationAlgo
+
+
+def _default_inputs(batch: Any) -> Any:
+    # (data, target) pairs as yielded for most datasets
+    if isinstance(batch, (list, tuple)):
+        return batch[0]
+    return batch
+
+
+def _calibration_inputs(data: Any) -> List:
+    if isinstance(data, torch.Tensor):
+        return [("", data)]
+    elif isinstance(data, dict):
+        return [(str(k), v) for k, v in data.items()]
+    elif isinstance(data, (list, tuple)):
+        return [("", d) for d in data]
+    else:
+        raise TypeError("Calibration inputs must be a tensor, a sequence of tensors or a dict of tensors, got: " +
+                        str(type(data)))
+
+
+def _produce(dataloader: Any, input_fn: Callable, stream: Any, pass_id: int):
+    try:
+        for batch in dataloader:
+            if not stream.push(pass_id, _calibration_inputs(input_fn(batch))):
+                return
+        stream.finish(pass_id)
+    except Exception as e:
+        stream.fail(pass_id, repr(e))
+
+
+class DataLoaderCalibrator(object):
+    """INT8 calibrator fed from a ``torch.utils.data.DataLoader``
+
+    Set as ``"calibrator"`` in the compile spec of an INT8 compilation. Batches are loaded on a background thread while
+    TensorRT calibrates on the previous ones, with at most ``prefetch_batches`` loaded ahead, and each calibration pass
+    iterates the dataloader again. Neither side holds the GIL while it waits for the other. Errors raised while loading
+    stop calibration and are raised by ``trtorch.compile``. Tensors are handed to the calibrator without copying; they
+    are made contiguous on the loading thread if needed and copied to the GPU once when TensorRT asks for them, so
+    ``pin_memory=True`` in the dataloader speeds up that copy.
+
+    By default the first element of a ``(data, target)`` batch (or the batch itself if it is a single tensor) is the
+    input. It can be a tensor, a list or tuple of tensors (one per input of the module, in order) or a dict from
+    input name (``"input_0"``, ``"input_1"``, ...) to tensor. Pass ``input_fn`` to extract the inputs from other
+    batches.
+
+    Args:
+        dataloader: Iterable of batches, usually a ``torch.utils.data.DataLoader``
+        cache_file (str): Where to read and write the calibration cache, no cache if empty
+        use_cache (bool): Use the cache if it exists and was generated for the same graph, input ranges and algorithm
+        algo_type (trtorch.CalibrationAlgo): Calibration algorithm
+        prefetch_batches (int): Maximum number of batches loaded ahead of the calibrator
+        input_fn (callable): Maps a batch of the dataloader to the inputs of the module
+
+    Example::
+
+        dataloader = torch.utils.data.DataLoader(dataset, batch_size=32, num_workers=2, pin_memory=True)
+        calibrator = trtorch.ptq.DataLoaderCalibrator(dataloader, cache_file="calibration.cache")
+        trt_mod = trtorch.compile(module, {
+            "input_shapes": [[32, 3, 32, 32]],
+            "op_precision": torch.int8,
+            "calibrator": calibrator,
+        })
+    """
+
+    def __init__(self,
+                 dataloader: Any,
+                 cache_file: str = "",
+                 use_cache: bool = True,
+                 algo_type: CalibrationAlgo = CalibrationAlgo.ENTROPY_CALIBRATION_2,
+                 prefetch_batches: int = 2,
+                 input_fn: Optional[Callable] = None):
+        self._dataloader = dataloader
+        self._input_fn = input_fn if input_fn is not None else _default_inputs
+        self._thread = None
+        # The stream only holds a weak reference back so the calibrator can be collected
+        ref = weakref.ref(self)
+
+        def start_pass(pass_id: int):
+            calibrator = ref()
+            if calibrator is not None:
+                calibrator._start_pass(pass_id)
+
+        self._stream = trtorch._C.BatchStream(start_pass, prefetch_batches)
+        self._c = trtorch._C.Calibrator(self._stream, cache_file, use_cache, algo_type)
+
+    def __del__(self):
+        if hasattr(self, "_stream"):
+            self._stream.stop()
+
+    def _start_pass(self, pass_id: int):
+        if self._thread is not None:
+            self._thread.join()
+        self._thread = threading.Thread(target=_produce,
+                                        args=(self._dataloader, self._input_fn, self._stream, pass_id),
+                                        daemon=True)
+        self._thread.start()
+
+    def next_batch(self) -> Optional[List[torch.Tensor]]:
+        """Returns the next batch as TensorRT would receive it (one tensor per input, in order), or None at the end of
+        a pass, after which the next call starts a new pass. Errors raised while loading are raised here. Lets the
+        loading pipeline be checked without a GPU.
+        """
+        return self._stream.next()
+
+    def stop(self):
+        """Ends the current pass, the next batch requested starts a new one
+        """
+        self._stream.stop()
+
+    def peak_queued(self) -> int:
+        """Returns the most batches that were loaded ahead of the calibrator at once
+        """
+        return self._stream.peak_queued()
+
+
+class CacheCalibrator(object):
+    """INT8 calibrator which only reads a calibration cache, e.g. one written by a DataLoaderCalibrator, for
+    machines without the calibration data. Compilation fails if the cache does not exist or was generated for a
+    different graph, input ranges or algorithm.
+
+    Args:
+        cache_file (str): Calibration cache to read
+        algo_type (trtorch.CalibrationAlgo): Algorithm the cache was generated with
+    """
+
+    def __init__(self, cache_file: str, algo_type: CalibrationAlgo = CalibrationAlgo.ENTROPY_CALIBRATION_2):
+        self._c = trtorch._C.Calibrator(None, cache_file, True, algo_type)
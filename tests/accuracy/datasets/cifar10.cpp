@@ -1,13 +1,17 @@
 #include "tests/accuracy/datasets/cifar10.h"
 
+#include "ATen/Parallel.h"
 #include "torch/data/example.h"
 #include "torch/torch.h"
 #include "torch/types.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <cstddef>
-#include <fstream>
-#include <iostream>
-#include <memory>
+#include <cstring>
 #include <sstream>
 #include <string>
 #include <utility>
@@ -20,117 +24,166 @@ constexpr const uint32_t kNumTrainFiles = 5;
 constexpr const char* kTestFilename = "test_batch.bin";
 constexpr const size_t kLabelSize = 1; // B
 constexpr const size_t kImageSize = 3072; // B
+constexpr const size_t kRecordSize = kLabelSize + kImageSize;
 constexpr const size_t kImageDim = 32;
 constexpr const size_t kImageChannels = 3;
-constexpr const size_t kBatchSize = 10000;
-
-std::pair<torch::Tensor, torch::Tensor> read_batch(const std::string& path) {
-  std::ifstream batch;
-  batch.open(path, std::ios::in | std::ios::binary | std::ios::ate);
-
-  auto file_size = batch.tellg();
-  std::unique_ptr<char[]> buf(new char[file_size]);
-
-  batch.seekg(0, std::ios::beg);
-  batch.read(buf.get(), file_size);
-  batch.close();
 
-  std::vector<uint8_t> labels;
-  std::vector<torch::Tensor> images;
-  labels.reserve(kBatchSize);
-  images.reserve(kBatchSize);
-
-  for (size_t i = 0; i < kBatchSize; i++) {
-    uint8_t label = buf[i * (kImageSize + kLabelSize)];
-    std::vector<uint8_t> image;
-    image.reserve(kImageSize);
-    std::copy(
-        &buf[i * (kImageSize + kLabelSize) + 1],
-        &buf[i * (kImageSize + kLabelSize) + kImageSize],
-        std::back_inserter(image));
-    labels.push_back(label);
-    auto image_tensor =
-        torch::from_blob(image.data(), {kImageChannels, kImageDim, kImageDim}, torch::TensorOptions().dtype(torch::kU8))
-            .to(torch::kF32);
-    images.push_back(image_tensor);
+// Maps a record file read only, the tensor unmaps it when it is released
+torch::Tensor map_records(const std::string& path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  TORCH_CHECK(fd >= 0, "Unable to open ", path);
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    TORCH_CHECK(false, "Unable to stat ", path);
   }
-
-  auto labels_tensor =
-      torch::from_blob(labels.data(), {kBatchSize}, torch::TensorOptions().dtype(torch::kU8)).to(torch::kF32);
-  assert(labels_tensor.size(0) == kBatchSize);
-
-  auto images_tensor = torch::stack(images);
-  assert(images_tensor.size(0) == kBatchSize);
-
-  return std::make_pair(images_tensor, labels_tensor);
+  size_t file_size = static_cast<size_t>(st.st_size);
+  TORCH_CHECK(
+      file_size > 0 && file_size % kRecordSize == 0,
+      path,
+      " is not a CIFAR10 record file (size ",
+      file_size,
+      " is not a multiple of ",
+      kRecordSize,
+      ")");
+  void* addr = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  TORCH_CHECK(addr != MAP_FAILED, "Unable to map ", path);
+
+  int64_t num_records = static_cast<int64_t>(file_size / kRecordSize);
+  return torch::from_blob(
+      addr,
+      {num_records, static_cast<int64_t>(kRecordSize)},
+      [file_size](void* p) { munmap(p, file_size); },
+      torch::TensorOptions().dtype(torch::kU8));
 }
 
-std::pair<torch::Tensor, torch::Tensor> read_train_data(const std::string& root) {
-  std::vector<torch::Tensor> images, targets;
-  for (uint32_t i = 1; i <= 5; i++) {
+std::vector<torch::Tensor> map_train_data(const std::string& root) {
+  std::vector<torch::Tensor> records;
+  for (uint32_t i = 1; i <= kNumTrainFiles; i++) {
     std::stringstream ss;
     ss << root << '/' << kTrainFilenamePrefix << i << ".bin";
-    auto batch = read_batch(ss.str());
-    images.push_back(batch.first);
-    targets.push_back(batch.second);
+    records.push_back(map_records(ss.str()));
   }
-
-  torch::Tensor image_tensor =
-      std::accumulate(++images.begin(), images.end(), *images.begin(), [&](torch::Tensor a, torch::Tensor b) {
-        return torch::cat({a, b}, 0);
-      });
-  torch::Tensor target_tensor =
-      std::accumulate(++targets.begin(), targets.end(), *targets.begin(), [&](torch::Tensor a, torch::Tensor b) {
-        return torch::cat({a, b}, 0);
-      });
-
-  return std::make_pair(image_tensor, target_tensor);
+  return records;
 }
 
-std::pair<torch::Tensor, torch::Tensor> read_test_data(const std::string& root) {
+std::vector<torch::Tensor> map_test_data(const std::string& root) {
   std::stringstream ss;
   ss << root << '/' << kTestFilename;
-  return read_batch(ss.str());
+  return {map_records(ss.str())};
+}
+
+// Images of a record file as a strided view, [records, 3, 32, 32]
+torch::Tensor image_view(const torch::Tensor& records) {
+  return records.as_strided(
+      {records.size(0), kImageChannels, kImageDim, kImageDim},
+      {static_cast<int64_t>(kRecordSize), kImageDim * kImageDim, kImageDim, 1},
+      kLabelSize);
+}
+
+torch::Tensor label_view(const torch::Tensor& records) {
+  return records.as_strided({records.size(0)}, {static_cast<int64_t>(kRecordSize)}, 0);
 }
 } // namespace
 
 CIFAR10::CIFAR10(const std::string& root, Mode mode) : mode_(mode) {
-  std::pair<torch::Tensor, torch::Tensor> data;
   if (mode_ == Mode::kTrain) {
-    data = read_train_data(root);
+    records_ = map_train_data(root);
   } else {
-    data = read_test_data(root);
+    records_ = map_test_data(root);
+  }
+  for (const auto& r : records_) {
+    size_ += r.size(0);
   }
-
-  images_ = std::move(data.first);
-  targets_ = std::move(data.second);
-  assert(images_.sizes()[0] == images_.sizes()[0]);
 }
 
 torch::data::Example<> CIFAR10::get(size_t index) {
-  return {images_[index], targets_[index]};
+  return get_batch(c10::ArrayRef<size_t>(index))[0];
+}
+
+std::vector<torch::data::Example<>> CIFAR10::get_batch(c10::ArrayRef<size_t> indices) {
+  const int64_t batch_size = static_cast<int64_t>(indices.size());
+  auto images = torch::empty({batch_size, kImageChannels, kImageDim, kImageDim}, torch::kU8);
+  auto labels = torch::empty({batch_size}, torch::kU8);
+  auto image_ptr = images.data_ptr<uint8_t>();
+  auto label_ptr = labels.data_ptr<uint8_t>();
+
+  // Gather the records of the batch straight from the mapping, then convert
+  // the whole batch at once
+  at::parallel_for(0, batch_size, 64, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      size_t index = indices[i];
+      TORCH_CHECK(index < size_, "Index ", index, " is out of range for a dataset of size ", size_);
+      size_t file = 0;
+      while (index >= static_cast<size_t>(records_[file].size(0))) {
+        index -= records_[file].size(0);
+        file++;
+      }
+      auto record = records_[file].data_ptr<uint8_t>() + index * kRecordSize;
+      label_ptr[i] = record[0];
+      std::memcpy(image_ptr + i * kImageSize, record + kLabelSize, kImageSize);
+    }
+  });
+
+  auto data = images.to(torch::kF32);
+  if (mean_.defined()) {
+    data.sub_(mean_).div_(stddev_);
+  }
+  auto targets = labels.to(torch::kF32);
+
+  std::vector<torch::data::Example<>> batch;
+  batch.reserve(indices.size());
+  for (int64_t i = 0; i < batch_size; i++) {
+    batch.emplace_back(data[i], targets[i]);
+  }
+  return batch;
 }
 
 c10::optional<size_t> CIFAR10::size() const {
-  return images_.size(0);
+  return size_;
 }
 
 bool CIFAR10::is_train() const noexcept {
   return mode_ == Mode::kTrain;
 }
 
-const torch::Tensor& CIFAR10::images() const {
-  return images_;
+torch::Tensor CIFAR10::images() const {
+  std::vector<torch::Tensor> images;
+  for (const auto& r : records_) {
+    images.push_back(image_view(r));
+  }
+  auto all = images.size() == 1 ? images[0] : torch::cat(images, 0);
+  return all.slice(0, 0, size_);
 }
 
-const torch::Tensor& CIFAR10::targets() const {
-  return targets_;
+torch::Tensor CIFAR10::targets() const {
+  std::vector<torch::Tensor> labels;
+  for (const auto& r : records_) {
+    labels.push_back(label_view(r));
+  }
+  auto all = labels.size() == 1 ? labels[0] : torch::cat(labels, 0);
+  return all.slice(0, 0, size_);
 }
 
 CIFAR10&& CIFAR10::use_subset(int64_t new_size) {
-  assert(new_size <= images_.sizes()[0]);
-  images_ = images_.slice(0, 0, new_size);
-  targets_ = targets_.slice(0, 0, new_size);
+  TORCH_CHECK(
+      new_size >= 0 && static_cast<size_t>(new_size) <= size_,
+      "Subset of size ",
+      new_size,
+      " is larger than the dataset (",
+      size_,
+      ")");
+  size_ = static_cast<size_t>(new_size);
+  return std::move(*this);
+}
+
+CIFAR10&& CIFAR10::normalize(std::vector<double> mean, std::vector<double> stddev) {
+  TORCH_CHECK(
+      mean.size() == kImageChannels && stddev.size() == kImageChannels,
+      "Expected a mean and standard deviation per channel");
+  mean_ = torch::tensor(mean, torch::kF32).view({1, kImageChannels, 1, 1});
+  stddev_ = torch::tensor(stddev, torch::kF32).view({1, kImageChannels, 1, 1});
   return std::move(*this);
 }
 
@@ -6,7 +6,7 @@ TEST_P(AccuracyTests, FP16AccuracyIsClose) {
   auto eval_dataset =
       datasets::CIFAR10("tests/accuracy/datasets/data/cifar-10-batches-bin/", datasets::CIFAR10::Mode::kTest)
           .use_subset(3200)
-          .map(torch::data::transforms::Normalize<>({0.4914, 0.4822, 0.4465}, {0.2023, 0.1994, 0.2010}))
+          .normalize({0.4914, 0.4822, 0.4465}, {0.2023, 0.1994, 0.2010})
           .map(torch::data::transforms::Stack<>());
   auto eval_dataloader = torch::data::make_data_loader(
       std::move(eval_dataset), torch::data::DataLoaderOptions().batch_size(32).workers(2));
@@ -0,0 +1,48 @@
+#include <string>
+#include "core/conversion/converters/converters.h"
+#include "gtest/gtest.h"
+#include "torch/csrc/jit/ir/irparser.h"
+
+namespace converters = trtorch::core::conversion::converters;
+
+namespace {
+const torch::jit::Node* find_node(const std::shared_ptr<torch::jit::Graph>& g, const std::string& kind) {
+  for (auto n : g->nodes()) {
+    if (n->kind().toQualString() == kind) {
+      return n;
+    }
+  }
+  return nullptr;
+}
+
+bool unused_converter(trtorch::core::conversion::ConversionCtx*, const torch::jit::Node*, converters::args&) {
+  return false;
+}
+} // namespace
+
+TEST(Converters, PatternsRegisteredAfterFirstLookupAreFound) {
+  const auto graph = R"IR(
+      graph(%0 : Tensor):
+        %1 : Tensor = aten::relu(%0)
+        %2 : Tensor = aten::erfinv(%1)
+        return (%2))IR";
+
+  auto g = std::make_shared<torch::jit::Graph>();
+  torch::jit::parseIR(graph, &*g);
+  auto relu = find_node(g, "aten::relu");
+  auto erfinv = find_node(g, "aten::erfinv");
+  ASSERT_TRUE(relu && erfinv);
+
+  // The first lookup loads the patterns registered by the converter libraries
+  ASSERT_TRUE(converters::node_is_convertable(relu));
+  ASSERT_FALSE(converters::node_is_convertable(erfinv));
+
+  converters::RegisterNodeConversionPatterns()
+      .pattern({"not a function schema", unused_converter})
+      .pattern({"aten::erfinv(Tensor self) -> (Tensor)", unused_converter});
+
+  // The malformed schema is skipped without losing the pattern after it
+  ASSERT_TRUE(converters::node_is_convertable(erfinv));
+  ASSERT_TRUE(converters::get_node_converter_for(erfinv->maybeSchema()) != nullptr);
+  ASSERT_TRUE(converters::node_is_convertable(relu));
+}
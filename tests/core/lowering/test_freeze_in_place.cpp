@@ -0,0 +1,91 @@
+#include <algorithm>
+#include "core/lowering/lowering.h"
+#include "gtest/gtest.h"
+#include "tests/util/util.h"
+#include "torch/csrc/jit/api/module.h"
+#include "torch/torch.h"
+
+namespace {
+torch::jit::Module linear_module() {
+  torch::jit::Module mod("m");
+  mod.register_parameter("weight", torch::randn({16, 8}, torch::requires_grad()), false);
+  mod.register_parameter("bias", torch::randn({16}, torch::requires_grad()), false);
+  mod.register_attribute("scale", c10::FloatType::get(), 2.0);
+  mod.define(R"JIT(
+    def forward(self, x):
+        return torch.linear(x, self.weight, self.bias) * self.scale
+  )JIT");
+  return mod;
+}
+} // namespace
+
+TEST(Lowering, FreezeInPlaceAliasesModuleTensors) {
+  auto mod = linear_module();
+  auto g = trtorch::core::lowering::FreezeMethodInPlace(mod, "forward");
+  ASSERT_TRUE(g);
+
+  std::vector<void*> constant_data;
+  for (auto n : g->nodes()) {
+    ASSERT_NE(n->kind(), torch::jit::prim::GetAttr);
+    if (n->kind() == torch::jit::prim::Constant && n->output()->type()->isSubtypeOf(c10::TensorType::get())) {
+      constant_data.push_back(n->t(torch::jit::attr::value).data_ptr());
+    }
+  }
+  // The weights are shared with the module, not copied
+  ASSERT_EQ(constant_data.size(), 2u);
+  auto weight = mod.attr("weight").toTensor().data_ptr();
+  auto bias = mod.attr("bias").toTensor().data_ptr();
+  ASSERT_TRUE(std::count(constant_data.begin(), constant_data.end(), weight));
+  ASSERT_TRUE(std::count(constant_data.begin(), constant_data.end(), bias));
+
+  // Lowering the frozen graph gives the same results as the module
+  auto lowered = trtorch::core::lowering::Lower(mod, "forward", {true});
+  ASSERT_TRUE(lowered.second.empty());
+  auto x = torch::randn({4, 8});
+  auto expected = mod.forward({x}).toTensor();
+  auto params = trtorch::core::conversion::get_named_params(lowered.first->inputs(), lowered.second);
+  auto actual = trtorch::tests::util::RunGraph(lowered.first, params, {x});
+  ASSERT_TRUE(torch::allclose(expected, actual[0]));
+}
+
+TEST(Lowering, FreezeInPlaceRejectsMethodsWritingState) {
+  auto mod = linear_module();
+  mod.register_attribute("calls", c10::IntType::get(), 0);
+  mod.define(R"JIT(
+    def count(self, x):
+        self.calls += 1
+        return x
+  )JIT");
+  ASSERT_FALSE(trtorch::core::lowering::FreezeMethodInPlace(mod, "count"));
+}
+
+TEST(Lowering, FreezeInPlaceRejectsWritesThroughViews) {
+  auto mod = linear_module();
+  mod.register_buffer("running", torch::zeros({4}));
+  mod.define(R"JIT(
+    def view_add(self, x):
+        self.running.view(2, 2).add_(1.0)
+        return x
+
+    def select_mul(self, x):
+        self.running[0].mul_(2.0)
+        return x
+
+    def loop_add(self, x):
+        y = x
+        for i in range(2):
+            y.add_(1.0)
+            y = self.running
+        return x
+
+    def fresh_add(self, x):
+        y = self.running + 1.0
+        y.add_(x)
+        return y
+  )JIT");
+  ASSERT_FALSE(trtorch::core::lowering::FreezeMethodInPlace(mod, "view_add"));
+  ASSERT_FALSE(trtorch::core::lowering::FreezeMethodInPlace(mod, "select_mul"));
+  ASSERT_FALSE(trtorch::core::lowering::FreezeMethodInPlace(mod, "loop_add"));
+  // Writes to new tensors computed from state are fine
+  ASSERT_TRUE(trtorch::core::lowering::FreezeMethodInPlace(mod, "fresh_add"));
+}
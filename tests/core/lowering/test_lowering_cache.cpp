@@ -0,0 +1,56 @@
+#include <thread>
+#include <vector>
+#include "core/lowering/lowering.h"
+#include "gtest/gtest.h"
+#include "torch/csrc/jit/api/module.h"
+#include "torch/torch.h"
+
+namespace {
+torch::jit::Module conv_module() {
+  torch::jit::Module mod("m");
+  mod.register_parameter("weight", torch::randn({4, 3, 3, 3}), false);
+  mod.define(R"JIT(
+    def forward(self, x):
+        return torch.relu(torch.conv2d(x, self.weight))
+
+    def features(self, x):
+        return torch.conv2d(x, self.weight)
+  )JIT");
+  return mod;
+}
+} // namespace
+
+TEST(Lowering, LoweringCacheLowersEachMethodOnce) {
+  auto mod = conv_module();
+  trtorch::core::lowering::LowerInfo info;
+  info.cache = std::make_shared<trtorch::core::lowering::LoweringCache>();
+
+  // Compilations with different engine settings running at the same time
+  std::vector<trtorch::core::lowering::LoweredMethod> lowered(4);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < lowered.size(); i++) {
+    threads.emplace_back([&, i]() { lowered[i] = trtorch::core::lowering::Lower(mod, "forward", info); });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  ASSERT_EQ(info.cache->lowered_methods(), 1u);
+  for (const auto& l : lowered) {
+    ASSERT_EQ(l.first, lowered[0].first);
+  }
+
+  // Other methods, modules and freezing modes are lowered separately
+  trtorch::core::lowering::Lower(mod, "features", info);
+  trtorch::core::lowering::Lower(conv_module(), "forward", info);
+  auto in_place = info;
+  in_place.freeze_in_place = true;
+  trtorch::core::lowering::Lower(mod, "forward", in_place);
+  ASSERT_EQ(info.cache->lowered_methods(), 4u);
+
+  auto uncached = trtorch::core::lowering::Lower(mod, "forward");
+  ASSERT_NE(uncached.first, lowered[0].first);
+
+  info.cache->Clear();
+  ASSERT_NE(trtorch::core::lowering::Lower(mod, "forward", info).first, lowered[0].first);
+  ASSERT_EQ(info.cache->lowered_methods(), 5u);
+}
@@ -0,0 +1,138 @@
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "core/runtime/runtime.h"
+#include "gtest/gtest.h"
+#include "torch/torch.h"
+
+namespace {
+// Stand-in for an engine execution: outputs are produced on the host right
+// away, completion is controlled by the test through the promise
+trtorch::core::runtime::EnqueuedExecution enqueue_stand_in(
+    std::vector<at::Tensor> outputs,
+    std::shared_future<void> device_done) {
+  return {std::move(outputs), [device_done]() { device_done.wait(); }};
+}
+} // namespace
+
+TEST(Runtime, AsyncFutureCompletesOnlyOnceWorkFinishes) {
+  trtorch::core::runtime::CompletionQueue queue(4);
+  std::promise<void> device_done;
+  auto done = device_done.get_future().share();
+  auto out = at::ones({2, 2});
+
+  auto future = trtorch::core::runtime::SubmitAsync(queue, [&]() { return enqueue_stand_in({out}, done); });
+  ASSERT_FALSE(future->completed());
+
+  device_done.set_value();
+  future->wait();
+  ASSERT_TRUE(future->completed());
+  auto results = future->value().toTensorVector();
+  ASSERT_EQ(results.size(), 1);
+  ASSERT_TRUE(results[0].equal(out));
+}
+
+TEST(Runtime, AsyncExecutionsCompleteInSubmissionOrder) {
+  trtorch::core::runtime::CompletionQueue queue(8);
+  std::vector<std::promise<void>> device_done(4);
+  std::vector<c10::intrusive_ptr<c10::ivalue::Future>> futures;
+  std::vector<int> completion_order;
+  std::mutex order_mu;
+
+  for (size_t i = 0; i < device_done.size(); i++) {
+    auto done = device_done[i].get_future().share();
+    auto future = trtorch::core::runtime::SubmitAsync(
+        queue, [&]() { return enqueue_stand_in({at::full({1}, static_cast<float>(i))}, done); });
+    future->addCallback([&, i]() {
+      std::unique_lock<std::mutex> lock(order_mu);
+      completion_order.push_back(static_cast<int>(i));
+    });
+    futures.push_back(future);
+  }
+  ASSERT_EQ(queue.InFlight(), device_done.size());
+
+  // Device work finishing out of order still completes futures in order
+  for (auto it = device_done.rbegin(); it != device_done.rend(); ++it) {
+    it->set_value();
+  }
+  queue.Drain();
+
+  ASSERT_EQ(completion_order, std::vector<int>({0, 1, 2, 3}));
+  for (size_t i = 0; i < futures.size(); i++) {
+    ASSERT_EQ(futures[i]->value().toTensorVector()[0].item<float>(), static_cast<float>(i));
+  }
+}
+
+TEST(Runtime, AsyncWaitErrorsAreReportedThroughTheFuture) {
+  trtorch::core::runtime::CompletionQueue queue(1);
+  auto future = trtorch::core::runtime::SubmitAsync(queue, []() {
+    return trtorch::core::runtime::EnqueuedExecution{
+        {at::ones({1})}, []() { throw std::runtime_error("stand-in device failure"); }};
+  });
+  queue.Drain();
+  ASSERT_TRUE(future->completed());
+  ASSERT_TRUE(future->hasError());
+}
+
+TEST(Runtime, AsyncSubmitAppliesBackpressure) {
+  trtorch::core::runtime::CompletionQueue queue(2);
+  std::promise<void> release;
+  auto done = release.get_future().share();
+
+  trtorch::core::runtime::SubmitAsync(queue, [&]() { return enqueue_stand_in({at::ones({1})}, done); });
+  trtorch::core::runtime::SubmitAsync(queue, [&]() { return enqueue_stand_in({at::ones({1})}, done); });
+
+  std::atomic<bool> third_enqueued{false};
+  std::atomic<bool> third_submitted{false};
+  auto submitter = std::thread([&]() {
+    trtorch::core::runtime::SubmitAsync(queue, [&]() {
+      third_enqueued = true;
+      return enqueue_stand_in({at::ones({1})}, done);
+    });
+    third_submitted = true;
+  });
+
+  // The third call waits before its work reaches the device, not after
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(third_enqueued);
+  EXPECT_FALSE(third_submitted);
+  release.set_value();
+  submitter.join();
+  queue.Drain();
+  ASSERT_TRUE(third_enqueued);
+  ASSERT_TRUE(third_submitted);
+  ASSERT_EQ(queue.InFlight(), 0);
+}
+
+TEST(Runtime, UnsubmittedReservationsAreReleased) {
+  trtorch::core::runtime::CompletionQueue queue(1);
+  // An enqueue which throws gives its slot back
+  ASSERT_ANY_THROW(trtorch::core::runtime::SubmitAsync(
+      queue, []() -> trtorch::core::runtime::EnqueuedExecution { throw std::runtime_error("enqueue failed"); }));
+  ASSERT_EQ(queue.InFlight(), 0);
+  {
+    auto slot = queue.Reserve();
+    ASSERT_EQ(queue.InFlight(), 1);
+  }
+  ASSERT_EQ(queue.InFlight(), 0);
+}
+
+TEST(Runtime, CompletionQueueCanBeDestroyedByItsOwnCompletions) {
+  // e.g. an engine replaced while calls were in flight is released by the
+  // completion of its last call
+  auto queue = std::make_shared<trtorch::core::runtime::CompletionQueue>(4);
+  auto owner = std::make_shared<std::shared_ptr<trtorch::core::runtime::CompletionQueue>>(queue);
+  std::promise<void> finished;
+  queue->Submit([]() {}, [](std::exception_ptr) {});
+  queue->Submit([]() {}, [owner, &finished](std::exception_ptr) {
+    owner->reset();
+    finished.set_value();
+  });
+  queue.reset();
+  finished.get_future().wait();
+}
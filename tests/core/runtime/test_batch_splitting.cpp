@@ -0,0 +1,67 @@
+#include <vector>
+#include "core/runtime/BatchSplitter.h"
+#include "gtest/gtest.h"
+#include "torch/torch.h"
+
+namespace {
+// Stand-in for an engine whose profile accepts batches of up to max_batch:
+// doubles its input and sums it over the remaining dimensions
+trtorch::core::runtime::ChunkExecutor make_executor(int64_t max_batch, std::vector<int64_t>& chunk_sizes) {
+  trtorch::core::runtime::ChunkExecutor executor;
+  executor.describe_outputs = [](const std::vector<at::Tensor>& chunk) {
+    auto batch = chunk[0].size(0);
+    return std::vector<trtorch::core::runtime::OutputSpec>{{{batch, chunk[0].size(1)}, at::kFloat},
+                                                            {{batch}, at::kFloat}};
+  };
+  executor.run = [max_batch, &chunk_sizes](std::vector<at::Tensor>& chunk, std::vector<at::Tensor>& outputs) {
+    EXPECT_LE(chunk[0].size(0), max_batch);
+    EXPECT_TRUE(outputs[0].is_contiguous());
+    chunk_sizes.push_back(chunk[0].size(0));
+    at::mul_out(outputs[0], chunk[0], 2);
+    at::sum_out(outputs[1], chunk[0], {1});
+  };
+  return executor;
+}
+} // namespace
+
+TEST(Runtime, PlanBatchChunksCoversTheBatch) {
+  auto chunks = trtorch::core::runtime::PlanBatchChunks(10, 4);
+  ASSERT_EQ(chunks.size(), 3);
+  ASSERT_EQ(chunks[0].offset, 0);
+  ASSERT_EQ(chunks[0].size, 4);
+  ASSERT_EQ(chunks[1].offset, 4);
+  ASSERT_EQ(chunks[2].offset, 8);
+  ASSERT_EQ(chunks[2].size, 2);
+  ASSERT_EQ(trtorch::core::runtime::PlanBatchChunks(8, 4).size(), 2);
+}
+
+TEST(Runtime, OversizedBatchOnlyReportsBatchesOverTheMax) {
+  using trtorch::core::runtime::OversizedBatch;
+  auto small = at::zeros({4, 3});
+  auto large = at::zeros({9, 3});
+  ASSERT_EQ(OversizedBatch({small}, 4), 0);
+  ASSERT_EQ(OversizedBatch({large}, 4), 9);
+  ASSERT_EQ(OversizedBatch({large, at::zeros({9})}, 4), 9);
+  ASSERT_EQ(OversizedBatch({large}, 0), 0);
+  ASSERT_ANY_THROW(OversizedBatch({large, small}, 4));
+}
+
+TEST(Runtime, RunInChunksMatchesUnsplitExecution) {
+  auto input = at::randn({10, 3});
+  std::vector<int64_t> chunk_sizes;
+  auto outputs = trtorch::core::runtime::RunInChunks({input}, 4, make_executor(4, chunk_sizes));
+
+  ASSERT_EQ(chunk_sizes, std::vector<int64_t>({4, 4, 2}));
+  ASSERT_EQ(outputs.size(), 2);
+  ASSERT_TRUE(at::allclose(outputs[0], input * 2));
+  ASSERT_TRUE(at::allclose(outputs[1], input.sum({1})));
+}
+
+TEST(Runtime, RunInChunksRejectsUnbatchedOutputs) {
+  trtorch::core::runtime::ChunkExecutor executor;
+  executor.describe_outputs = [](const std::vector<at::Tensor>&) {
+    return std::vector<trtorch::core::runtime::OutputSpec>{{{1000}, at::kFloat}};
+  };
+  executor.run = [](std::vector<at::Tensor>&, std::vector<at::Tensor>&) { FAIL(); };
+  ASSERT_ANY_THROW(trtorch::core::runtime::RunInChunks({at::zeros({10, 3})}, 4, executor));
+}
@@ -0,0 +1,156 @@
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "core/runtime/DirectOps.h"
+#include "gtest/gtest.h"
+#include "torch/csrc/jit/ir/irparser.h"
+#include "torch/csrc/jit/runtime/custom_operator.h"
+#include "torch/csrc/jit/runtime/interpreter.h"
+#include "torch/torch.h"
+
+namespace {
+// Stand-in for an engine running on the CPU, the "engine" is an int offset
+// added to every input, outputs cycle through the inputs. Cheap enough that
+// the cost of the op call itself dominates
+std::vector<at::Tensor> stand_in_engine(const std::vector<at::Tensor>& inputs, int64_t engine, size_t num_outputs) {
+  std::vector<at::Tensor> outputs;
+  for (size_t i = 0; i < num_outputs; i++) {
+    outputs.push_back(engine ? inputs[i % inputs.size()] + engine : inputs[i % inputs.size()]);
+  }
+  return outputs;
+}
+
+// The list based stand-in cannot know how many outputs to produce from its
+// schema, so the engine encodes it as engine * 16 + num_outputs
+torch::jit::RegisterOperators stand_in_list_reg({
+    torch::jit::Operator(
+        "trtorch_test::stand_in(Tensor[] inputs, int engine) -> Tensor[]",
+        [](torch::jit::Stack& stack) {
+          auto engine = torch::jit::pop(stack).toInt();
+          auto inputs = torch::jit::pop(stack).toTensorVector();
+          torch::jit::push(stack, c10::List<at::Tensor>(stand_in_engine(inputs, engine / 16, engine % 16)));
+          return 0;
+        },
+        c10::AliasAnalysisKind::FROM_SCHEMA),
+});
+
+torch::jit::RegisterOperators stand_in_direct_reg(trtorch::core::runtime::MakeDirectOperators(
+    "trtorch_test::stand_in",
+    "int",
+    [](std::vector<at::Tensor> inputs, const c10::IValue& engine) {
+      auto encoded = engine.toInt();
+      return stand_in_engine(inputs, encoded / 16, encoded % 16);
+    }));
+
+// The graphs AddEngineToGraph emits for the list based and the direct op
+std::shared_ptr<torch::jit::Graph> make_graph(size_t num_inputs, size_t num_outputs, int64_t engine, bool direct) {
+  std::stringstream ins, outs;
+  for (size_t i = 0; i < num_inputs; i++) {
+    ins << (i ? ", " : "") << "%in" << i;
+  }
+  for (size_t i = 0; i < num_outputs; i++) {
+    outs << (i ? ", " : "") << "%out" << i;
+  }
+
+  std::stringstream ir;
+  ir << "graph(";
+  for (size_t i = 0; i < num_inputs; i++) {
+    ir << (i ? ", " : "") << "%in" << i << " : Tensor";
+  }
+  ir << "):\n";
+  ir << "  %engine : int = prim::Constant[value=" << engine * 16 + static_cast<int64_t>(num_outputs) << "]()\n";
+  if (direct) {
+    ir << "  ";
+    for (size_t i = 0; i < num_outputs; i++) {
+      ir << (i ? ", " : "") << "%out" << i << " : Tensor";
+    }
+    ir << " = " << trtorch::core::runtime::DirectOpName("trtorch_test::stand_in", num_inputs, num_outputs) << '('
+       << ins.str() << ", %engine)\n";
+  } else {
+    ir << "  %list : Tensor[] = prim::ListConstruct(" << ins.str() << ")\n";
+    ir << "  %results : Tensor[] = trtorch_test::stand_in(%list, %engine)\n";
+    ir << "  ";
+    for (size_t i = 0; i < num_outputs; i++) {
+      ir << (i ? ", " : "") << "%out" << i << " : Tensor";
+    }
+    ir << " = prim::ListUnpack(%results)\n";
+  }
+  if (num_outputs > 1) {
+    ir << "  %tuple : (";
+    for (size_t i = 0; i < num_outputs; i++) {
+      ir << (i ? ", " : "") << "Tensor";
+    }
+    ir << ") = prim::TupleConstruct(" << outs.str() << ")\n";
+    ir << "  return (%tuple)\n";
+  } else {
+    ir << "  return (%out0)\n";
+  }
+
+  auto g = std::make_shared<torch::jit::Graph>();
+  torch::jit::parseIR(ir.str(), g.get());
+  return g;
+}
+
+std::vector<at::Tensor> run(torch::jit::Code& code, const std::vector<at::Tensor>& inputs) {
+  torch::jit::Stack stack(inputs.begin(), inputs.end());
+  torch::jit::InterpreterState(code).run(stack);
+  auto result = stack.back();
+  if (result.isTensor()) {
+    return {result.toTensor()};
+  }
+  std::vector<at::Tensor> outputs;
+  for (const auto& out : result.toTuple()->elements()) {
+    outputs.push_back(out.toTensor());
+  }
+  return outputs;
+}
+
+std::vector<at::Tensor> make_inputs(size_t num_inputs) {
+  std::vector<at::Tensor> inputs;
+  for (size_t i = 0; i < num_inputs; i++) {
+    inputs.push_back(at::randn({2, 3}));
+  }
+  return inputs;
+}
+} // namespace
+
+TEST(Runtime, DirectOpNamesEncodeArity) {
+  using namespace trtorch::core::runtime;
+  ASSERT_EQ(DirectOpName("tensorrt::execute_engine", 2, 3), "tensorrt::execute_engine_2in_3out");
+  ASSERT_TRUE(HasDirectOp(1, 1));
+  ASSERT_TRUE(HasDirectOp(kMaxDirectInputs, kMaxDirectOutputs));
+  ASSERT_FALSE(HasDirectOp(0, 1));
+  ASSERT_FALSE(HasDirectOp(kMaxDirectInputs + 1, 1));
+  ASSERT_FALSE(HasDirectOp(1, kMaxDirectOutputs + 1));
+}
+
+TEST(Runtime, DirectOpsMatchListOp) {
+  for (size_t num_inputs : {1, 3}) {
+    for (size_t num_outputs : {1, 2, 4}) {
+      auto inputs = make_inputs(num_inputs);
+      torch::jit::Code list_code(make_graph(num_inputs, num_outputs, 1, false), "list");
+      torch::jit::Code direct_code(make_graph(num_inputs, num_outputs, 1, true), "direct");
+      auto expected = run(list_code, inputs);
+      auto outputs = run(direct_code, inputs);
+      ASSERT_EQ(outputs.size(), num_outputs);
+      ASSERT_EQ(expected.size(), num_outputs);
+      for (size_t i = 0; i < num_outputs; i++) {
+        ASSERT_TRUE(at::equal(outputs[i], expected[i]));
+        ASSERT_TRUE(at::equal(outputs[i], inputs[i % num_inputs] + 1));
+      }
+    }
+  }
+}
+
+TEST(Runtime, DirectOpChecksOutputCount) {
+  // Claims 3 outputs in the encoded engine but the op is the 1 output variant
+  auto g = make_graph(2, 1, 0, true);
+  for (auto n : g->nodes()) {
+    if (n->kind() == torch::jit::prim::Constant) {
+      n->i_(torch::jit::attr::value, 3);
+    }
+  }
+  torch::jit::Code code(g, "direct");
+  ASSERT_ANY_THROW(run(code, make_inputs(2)));
+}
@@ -0,0 +1,55 @@
+#include <random>
+#include <string>
+#include "core/runtime/compression.h"
+#include "gtest/gtest.h"
+
+namespace {
+// Stand-in for a serialized engine, mixes highly repetitive regions (like
+// padded weights and tactic tables) with incompressible noise
+std::string make_payload(size_t size, uint32_t seed) {
+  std::mt19937 gen(seed);
+  std::string payload(size, '\0');
+  for (size_t i = 0; i < size; i++) {
+    payload[i] = (i % 4096 < 3072) ? static_cast<char>(gen() % 4) : static_cast<char>(gen());
+  }
+  return payload;
+}
+} // namespace
+
+TEST(Runtime, EngineCompressionRoundTripsAllLevels) {
+  auto engine = make_payload(100000, 0);
+  std::string decompressed;
+  for (int level = 1; level <= trtorch::core::runtime::compression::kMaxCompressionLevel; level++) {
+    auto payload = trtorch::core::runtime::compression::CompressEngine(engine.data(), engine.size(), level);
+    ASSERT_TRUE(trtorch::core::runtime::compression::IsCompressed(payload));
+    ASSERT_EQ(trtorch::core::runtime::compression::GetCompressionLevel(payload), level);
+    ASSERT_LT(payload.size(), engine.size());
+    trtorch::core::runtime::compression::DecompressEngine(payload, decompressed);
+    ASSERT_EQ(decompressed, engine);
+  }
+}
+
+TEST(Runtime, EngineCompressionHandlesMultipleAndSmallBlocks) {
+  std::string decompressed;
+  for (size_t size : {0ul, 1ul, 12ul, 13ul, 255ul, (size_t)trtorch::core::runtime::compression::kBlockSize + 17}) {
+    auto engine = make_payload(size, static_cast<uint32_t>(size));
+    auto payload = trtorch::core::runtime::compression::CompressEngine(engine.data(), engine.size(), 1);
+    trtorch::core::runtime::compression::DecompressEngine(payload, decompressed);
+    ASSERT_EQ(decompressed, engine);
+  }
+}
+
+TEST(Runtime, EngineCompressionLevelZeroKeepsRawEngine) {
+  auto engine = make_payload(1000, 1);
+  auto payload = trtorch::core::runtime::compression::CompressEngine(engine.data(), engine.size(), 0);
+  ASSERT_FALSE(trtorch::core::runtime::compression::IsCompressed(payload));
+  ASSERT_EQ(payload, engine);
+}
+
+TEST(Runtime, EngineCompressionRejectsTruncatedPayload) {
+  auto engine = make_payload(10000, 2);
+  auto payload = trtorch::core::runtime::compression::CompressEngine(engine.data(), engine.size(), 3);
+  payload.resize(payload.size() - 10);
+  std::string decompressed;
+  ASSERT_ANY_THROW(trtorch::core::runtime::compression::DecompressEngine(payload, decompressed));
+}
@@ -0,0 +1,170 @@
+#include <atomic>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "core/runtime/EngineRegistry.h"
+#include "gtest/gtest.h"
+
+namespace {
+// Stand-in for a deserialized engine, counts how many are alive
+struct StandInEngine {
+  static std::atomic<int> alive;
+  std::string bytes;
+  explicit StandInEngine(std::string b) : bytes(std::move(b)) {
+    alive++;
+  }
+  ~StandInEngine() {
+    alive--;
+  }
+};
+std::atomic<int> StandInEngine::alive = {0};
+
+struct CountingDeserializer {
+  std::shared_ptr<std::atomic<int>> calls = std::make_shared<std::atomic<int>>(0);
+  std::unique_ptr<StandInEngine> operator()(const char* data, size_t size) const {
+    (*calls)++;
+    return std::unique_ptr<StandInEngine>(new StandInEngine(std::string(data, size)));
+  }
+};
+} // namespace
+
+TEST(Runtime, EngineRegistrySharesIdenticalEngines) {
+  trtorch::core::runtime::DeduplicatingRegistry<StandInEngine> registry;
+  CountingDeserializer deserialize;
+  std::string engine_a(1000, 'a');
+  std::string engine_b(1000, 'b');
+
+  auto a1 = registry.Acquire(engine_a.data(), engine_a.size(), deserialize);
+  auto a2 = registry.Acquire(engine_a.data(), engine_a.size(), deserialize);
+  auto b1 = registry.Acquire(engine_b.data(), engine_b.size(), deserialize);
+
+  ASSERT_EQ(a1.get(), a2.get());
+  ASSERT_NE(a1.get(), b1.get());
+  ASSERT_EQ(*deserialize.calls, 2);
+  ASSERT_EQ(registry.Size(), 2);
+  ASSERT_EQ(b1->bytes, engine_b);
+}
+
+TEST(Runtime, EngineRegistryReleasesEnginesWithTheirLastOwner) {
+  trtorch::core::runtime::DeduplicatingRegistry<StandInEngine> registry;
+  CountingDeserializer deserialize;
+  std::string engine(64, 'x');
+  auto alive_before = StandInEngine::alive.load();
+
+  auto first = registry.Acquire(engine.data(), engine.size(), deserialize);
+  auto second = registry.Acquire(engine.data(), engine.size(), deserialize);
+  first.reset();
+  ASSERT_EQ(StandInEngine::alive, alive_before + 1);
+  second.reset();
+  ASSERT_EQ(StandInEngine::alive, alive_before);
+  ASSERT_EQ(registry.Size(), 0);
+
+  // Loading it again deserializes a new instance
+  auto third = registry.Acquire(engine.data(), engine.size(), deserialize);
+  ASSERT_EQ(*deserialize.calls, 2);
+  ASSERT_EQ(registry.Size(), 1);
+}
+
+TEST(Runtime, EngineRegistryInstancesCanOutliveTheRegistry) {
+  CountingDeserializer deserialize;
+  std::string engine(16, 'y');
+  auto alive_before = StandInEngine::alive.load();
+  std::shared_ptr<StandInEngine> instance;
+  {
+    trtorch::core::runtime::DeduplicatingRegistry<StandInEngine> registry;
+    instance = registry.Acquire(engine.data(), engine.size(), deserialize);
+  }
+  ASSERT_EQ(instance->bytes, engine);
+  instance.reset();
+  ASSERT_EQ(StandInEngine::alive, alive_before);
+}
+
+TEST(Runtime, EngineRegistryDeserializesOnceUnderConcurrentLoads) {
+  trtorch::core::runtime::DeduplicatingRegistry<StandInEngine> registry;
+  CountingDeserializer deserialize;
+  std::string engine(4096, 'z');
+  std::vector<std::shared_ptr<StandInEngine>> instances(8);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < instances.size(); t++) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < 1000; i++) {
+        instances[t] = registry.Acquire(engine.data(), engine.size(), deserialize);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  for (const auto& instance : instances) {
+    ASSERT_EQ(instance.get(), instances[0].get());
+  }
+  ASSERT_EQ(*deserialize.calls, 1);
+}
+
+TEST(Runtime, EngineKeysDependOnEveryByte) {
+  using trtorch::core::runtime::GetEngineKey;
+  std::string engine(1 << 16, '\0');
+  for (size_t i = 0; i < engine.size(); i++) {
+    engine[i] = static_cast<char>(i * 31);
+  }
+  auto key = GetEngineKey(engine.data(), engine.size());
+  for (size_t pos : {size_t(0), size_t(31), size_t(32), engine.size() - 9, engine.size() - 1}) {
+    auto modified = engine;
+    modified[pos] ^= 1;
+    ASSERT_NE(GetEngineKey(modified.data(), modified.size()), key);
+  }
+  ASSERT_NE(GetEngineKey(engine.data(), engine.size() - 1), key);
+  ASSERT_EQ(GetEngineKey(engine.data(), engine.size()), key);
+}
+
+TEST(Runtime, EngineKeyHalvesAreIndependent) {
+  using trtorch::core::runtime::GetEngineKey;
+  for (size_t size : {size_t(7), size_t(32), size_t(100)}) {
+    std::string engine(size, 'k');
+    auto key = GetEngineKey(engine.data(), engine.size());
+    ASSERT_EQ(key.size, size);
+    ASSERT_NE(key.hash_lo, key.hash_hi);
+  }
+}
+
+TEST(Runtime, EngineRegistryDeserializesOutsideItsLock) {
+  trtorch::core::runtime::DeduplicatingRegistry<StandInEngine> registry;
+  CountingDeserializer deserialize;
+  std::string engine_a(128, 'a');
+  std::string engine_b(128, 'b');
+  std::promise<void> b_loaded;
+  auto b_loaded_future = b_loaded.get_future();
+
+  // Loading a only finishes once b was loaded on another thread
+  auto blocking = [&](const char* data, size_t size) {
+    b_loaded_future.wait();
+    return deserialize(data, size);
+  };
+  std::thread load_b([&]() {
+    auto b = registry.Acquire(engine_b.data(), engine_b.size(), deserialize);
+    EXPECT_EQ(b->bytes, engine_b);
+    b_loaded.set_value();
+  });
+  auto a = registry.Acquire(engine_a.data(), engine_a.size(), blocking);
+  load_b.join();
+  ASSERT_EQ(a->bytes, engine_a);
+  ASSERT_EQ(*deserialize.calls, 2);
+}
+
+TEST(Runtime, EngineRegistryDoesNotKeepFailedLoads) {
+  trtorch::core::runtime::DeduplicatingRegistry<StandInEngine> registry;
+  CountingDeserializer deserialize;
+  std::string engine(32, 'f');
+  auto failing = [](const char*, size_t) -> std::unique_ptr<StandInEngine> {
+    throw std::runtime_error("bad engine");
+  };
+
+  ASSERT_THROW(registry.Acquire(engine.data(), engine.size(), failing), std::runtime_error);
+  ASSERT_EQ(registry.Size(), 0);
+  auto instance = registry.Acquire(engine.data(), engine.size(), deserialize);
+  ASSERT_EQ(instance->bytes, engine);
+  ASSERT_EQ(*deserialize.calls, 1);
+}
@@ -0,0 +1,119 @@
+#include <string>
+#include <thread>
+#include <vector>
+#include "core/runtime/EngineStats.h"
+#include "gtest/gtest.h"
+
+TEST(Runtime, LatencyHistogramBucketsContainTheirSamples) {
+  using trtorch::core::runtime::LatencyHistogram;
+  for (uint64_t ns : {0ull, 1ull, 7ull, 8ull, 9ull, 1000ull, 123456789ull, ~0ull}) {
+    auto idx = LatencyHistogram::BucketIndex(ns);
+    ASSERT_LT(idx, LatencyHistogram::kNumBuckets);
+    ASSERT_LE(ns, LatencyHistogram::BucketUpperBound(idx));
+    if (idx > 0) {
+      ASSERT_GT(ns, LatencyHistogram::BucketUpperBound(idx - 1));
+    }
+  }
+}
+
+TEST(Runtime, LatencyHistogramEstimatesPercentiles) {
+  trtorch::core::runtime::LatencyHistogram histogram;
+  for (uint64_t i = 1; i <= 1000; i++) {
+    histogram.Record(i * 1000);
+  }
+  ASSERT_EQ(histogram.Count(), 1000);
+  ASSERT_EQ(histogram.Max(), 1000000);
+  ASSERT_EQ(histogram.Sum(), 500500000);
+
+  auto p50 = histogram.Percentile(0.5);
+  ASSERT_GE(p50, 500000);
+  ASSERT_LE(p50, 500000 * 1.25);
+  auto p99 = histogram.Percentile(0.99);
+  ASSERT_GE(p99, 990000);
+  ASSERT_LE(p99, 1000000);
+  ASSERT_EQ(histogram.Percentile(1.0), 1000000);
+}
+
+TEST(Runtime, ShapeCounterCountsConcurrentCalls) {
+  trtorch::core::runtime::ShapeCounter shapes;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&shapes]() {
+      for (uint64_t i = 0; i < 10000; i++) {
+        auto key = i % 3 + 1;
+        shapes.Record(key, [key]() { return "[" + std::to_string(key) + "]"; });
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  auto counts = shapes.Counts();
+  ASSERT_EQ(counts.size(), 3);
+  ASSERT_EQ(counts["[1]"] + counts["[2]"] + counts["[3]"], 40000);
+  ASSERT_EQ(shapes.Overflow(), 0);
+}
+
+TEST(Runtime, ShapeCounterOverflowsPastMaxShapes) {
+  using trtorch::core::runtime::ShapeCounter;
+  ShapeCounter shapes;
+  for (uint64_t key = 1; key <= ShapeCounter::kMaxShapes + 10; key++) {
+    shapes.Record(key, [key]() { return std::to_string(key); });
+  }
+  ASSERT_EQ(shapes.Counts().size(), ShapeCounter::kMaxShapes);
+  ASSERT_EQ(shapes.Overflow(), 10);
+}
+
+TEST(Runtime, ShapeCounterCountsRepeatsOnTheLastShape) {
+  using trtorch::core::runtime::ShapeCounter;
+  ShapeCounter shapes;
+  shapes.Record(1, []() { return std::string("[1]"); });
+  shapes.RecordRepeat();
+  shapes.RecordRepeat();
+  ASSERT_EQ(shapes.Counts()["[1]"], 3);
+
+  shapes.Record(2, []() { return std::string("[2]"); });
+  shapes.RecordRepeat();
+  shapes.Record(1, []() { return std::string("[1]"); });
+  auto counts = shapes.Counts();
+  ASSERT_EQ(counts["[1]"], 4);
+  ASSERT_EQ(counts["[2]"], 2);
+
+  for (uint64_t key = 3; key <= ShapeCounter::kMaxShapes + 1; key++) {
+    shapes.Record(key, [key]() { return std::to_string(key); });
+  }
+  shapes.RecordRepeat();
+  ASSERT_EQ(shapes.Overflow(), 2);
+}
+
+TEST(Runtime, EngineStatsTimesOneCallInAnInterval) {
+  using trtorch::core::runtime::EngineStats;
+  EngineStats stats;
+  uint64_t timed = 0;
+  for (uint64_t i = 0; i < 4 * EngineStats::kTimedCallInterval; i++) {
+    timed += EngineStats::Timed(stats.calls.Increment());
+  }
+  ASSERT_EQ(timed, 4);
+  ASSERT_EQ(stats.calls.Load(), 4 * EngineStats::kTimedCallInterval);
+}
+
+TEST(Runtime, EngineStatsSummaryFlattensMetrics) {
+  trtorch::core::runtime::EngineStats stats;
+  stats.calls.Increment();
+  stats.calls.Increment();
+  stats.errors += 1;
+  stats.host_overhead_ns.Record(100);
+  stats.host_overhead_ns.Record(300);
+  stats.shapes.Record(42, []() { return std::string("[1, 3, 224, 224]"); });
+
+  auto summary = stats.Summary();
+  ASSERT_EQ(summary["calls"], 2);
+  ASSERT_EQ(summary["errors"], 1);
+  ASSERT_EQ(summary["host_overhead_ns.count"], 2);
+  ASSERT_EQ(summary["host_overhead_ns.mean"], 200);
+  ASSERT_EQ(summary["host_overhead_ns.max"], 300);
+  ASSERT_EQ(summary["enqueue_to_return_ns.count"], 0);
+  ASSERT_EQ(summary["shape.[1, 3, 224, 224]"], 1);
+  ASSERT_EQ(summary["shape.overflow"], 0);
+}
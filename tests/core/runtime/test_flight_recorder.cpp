@@ -0,0 +1,77 @@
+#include <string>
+#include <thread>
+#include <vector>
+#include "core/runtime/FlightRecorder.h"
+#include "gtest/gtest.h"
+
+namespace {
+trtorch::core::runtime::ExecutionRecord make_record(uint64_t start_ns, bool success) {
+  trtorch::core::runtime::ExecutionRecord record = {};
+  record.start_ns = start_ns;
+  record.duration_ns = 1000;
+  record.profile = 0;
+  record.outcome = success ? trtorch::core::runtime::ExecutionRecord::Outcome::kSuccess
+                           : trtorch::core::runtime::ExecutionRecord::Outcome::kError;
+  record.num_inputs = 1;
+  record.inputs[0].dtype = "Float";
+  record.inputs[0].num_dims = 4;
+  int64_t dims[] = {1, 3, 224, 224};
+  std::copy(dims, dims + 4, record.inputs[0].dims);
+  return record;
+}
+} // namespace
+
+TEST(Runtime, FlightRecorderKeepsTheLastExecutionsInOrder) {
+  using trtorch::core::runtime::FlightRecorder;
+  FlightRecorder recorder;
+  auto total = FlightRecorder::kCapacity + 10;
+  for (uint64_t i = 0; i < total; i++) {
+    recorder.Record(make_record(i, true));
+  }
+
+  auto records = recorder.Snapshot();
+  ASSERT_EQ(records.size(), FlightRecorder::kCapacity);
+  ASSERT_EQ(recorder.Recorded(), total);
+  for (size_t i = 0; i < records.size(); i++) {
+    ASSERT_EQ(records[i].first, 10 + i);
+    ASSERT_EQ(records[i].second.start_ns, 10 + i);
+  }
+}
+
+TEST(Runtime, FlightRecorderDumpsJSON) {
+  trtorch::core::runtime::FlightRecorder recorder;
+  recorder.Record(make_record(0, true));
+  recorder.Record(make_record(1, false));
+
+  auto json = recorder.ToJSON("test_engine");
+  ASSERT_NE(json.find("\"engine\": \"test_engine\""), std::string::npos);
+  ASSERT_NE(json.find("\"recorded\": 2"), std::string::npos);
+  ASSERT_NE(json.find("\"outcome\": \"success\""), std::string::npos);
+  ASSERT_NE(json.find("\"outcome\": \"error\""), std::string::npos);
+  ASSERT_NE(json.find("{\"dtype\": \"Float\", \"shape\": [1, 3, 224, 224]}"), std::string::npos);
+  ASSERT_EQ(json.find("\"id\": 1") > json.find("\"id\": 0"), true);
+}
+
+TEST(Runtime, FlightRecorderAcceptsConcurrentWriters) {
+  using trtorch::core::runtime::FlightRecorder;
+  FlightRecorder recorder;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&recorder]() {
+      for (uint64_t i = 0; i < 10000; i++) {
+        recorder.Record(make_record(i, true));
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  ASSERT_EQ(recorder.Recorded(), 40000);
+  auto records = recorder.Snapshot();
+  ASSERT_LE(records.size(), FlightRecorder::kCapacity);
+  ASSERT_GT(records.size(), 0);
+  for (const auto& r : records) {
+    ASSERT_EQ(r.second.inputs[0].dims[3], 224);
+  }
+}
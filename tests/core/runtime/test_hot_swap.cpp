@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "core/runtime/HotSwap.h"
+#include "gtest/gtest.h"
+
+namespace {
+// Stand-in for an engine, released flags that its resources have been freed
+struct StandInEngine {
+  explicit StandInEngine(int v) : version(v) {}
+  int version;
+  std::atomic<bool> released = {false};
+  std::atomic<int> calls_while_released = {0};
+};
+
+using Slot = trtorch::core::runtime::HotSwapSlot<std::shared_ptr<StandInEngine>>;
+
+void release(std::shared_ptr<StandInEngine>& engine) {
+  ASSERT_FALSE(engine->released.exchange(true));
+}
+} // namespace
+
+TEST(Runtime, HotSwapInFlightCallsFinishOnTheOldEngine) {
+  std::atomic<bool> initial_released = {false};
+  Slot slot([&](std::shared_ptr<StandInEngine>&) { initial_released = true; });
+
+  auto in_flight = slot.Enter();
+  ASSERT_FALSE(in_flight.swapped());
+
+  auto v1 = std::make_shared<StandInEngine>(1);
+  slot.Swap(v1, release);
+  ASSERT_FALSE(initial_released);
+
+  auto next = slot.Enter();
+  ASSERT_TRUE(next.swapped());
+  ASSERT_EQ(next.get()->version, 1);
+
+  in_flight.Reset();
+  ASSERT_TRUE(initial_released);
+
+  auto v2 = std::make_shared<StandInEngine>(2);
+  slot.Swap(v2, release);
+  ASSERT_FALSE(v1->released);
+  next.Reset();
+  ASSERT_TRUE(v1->released);
+  ASSERT_FALSE(v2->released);
+}
+
+TEST(Runtime, HotSwapReleasesIdleEnginesRightAway) {
+  Slot slot;
+  auto v1 = std::make_shared<StandInEngine>(1);
+  slot.Swap(v1, release);
+  slot.Swap(std::make_shared<StandInEngine>(2), release);
+  ASSERT_TRUE(v1->released);
+  // The slot drops its reference once the engine is released
+  ASSERT_EQ(v1.use_count(), 1);
+}
+
+TEST(Runtime, HotSwapCheckSeesTheVersionItReplaces) {
+  Slot slot;
+  auto v1 = std::make_shared<StandInEngine>(1);
+  slot.CheckedSwap(v1, [](const std::shared_ptr<StandInEngine>& current) { ASSERT_FALSE(current); }, release);
+
+  auto v2 = std::make_shared<StandInEngine>(2);
+  ASSERT_ANY_THROW(slot.CheckedSwap(v2, [](const std::shared_ptr<StandInEngine>&) { throw std::runtime_error("no"); }));
+  auto lease = slot.Enter();
+  ASSERT_EQ(lease.get()->version, 1);
+  lease.Reset();
+
+  // Concurrent swaps each see the version their own swap replaces
+  std::vector<int> replaced;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < 100; i++) {
+        auto next = std::make_shared<StandInEngine>(2 + t * 100 + i);
+        auto record = [&](const std::shared_ptr<StandInEngine>& current) { replaced.push_back(current->version); };
+        slot.CheckedSwap(next, record, release);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  std::sort(replaced.begin(), replaced.end());
+  ASSERT_EQ(replaced.size(), 400u);
+  ASSERT_EQ(std::unique(replaced.begin(), replaced.end()), replaced.end());
+}
+
+TEST(Runtime, HotSwapStress) {
+  Slot slot;
+  std::atomic<bool> stop = {false};
+  std::atomic<uint64_t> calls = {0};
+  std::vector<std::shared_ptr<StandInEngine>> engines;
+
+  std::vector<std::thread> callers;
+  for (int t = 0; t < 8; t++) {
+    callers.emplace_back([&]() {
+      while (!stop) {
+        auto lease = slot.Enter();
+        if (!lease.swapped()) {
+          continue;
+        }
+        auto& engine = lease.get();
+        // A call which takes a little while, the engine must stay alive
+        // for all of it
+        for (int i = 0; i < 100; i++) {
+          if (engine->released) {
+            engine->calls_while_released++;
+          }
+        }
+        calls++;
+      }
+    });
+  }
+
+  const int kSwaps = 2000;
+  for (int v = 1; v <= kSwaps; v++) {
+    auto engine = std::make_shared<StandInEngine>(v);
+    engines.push_back(engine);
+    slot.Swap(engine, release);
+    if (v % 100 == 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+  stop = true;
+  for (auto& t : callers) {
+    t.join();
+  }
+
+  ASSERT_GT(calls, 0);
+  for (int v = 0; v < kSwaps; v++) {
+    ASSERT_EQ(engines[v]->calls_while_released, 0);
+    // Every replaced engine is released once its calls drained, the current
+    // one stays alive
+    ASSERT_EQ(engines[v]->released.load(), v < kSwaps - 1);
+  }
+}
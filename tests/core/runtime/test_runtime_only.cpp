@@ -0,0 +1,14 @@
+#include "NvInfer.h"
+#include "gtest/gtest.h"
+#include "torch/csrc/jit/runtime/operator.h"
+#include "torch/custom_class.h"
+
+TEST(Runtime, RuntimeOnlyBuildCanRunCompiledModules) {
+  // What torch::jit::load needs to deserialize and run a compiled module
+  ASSERT_NE(torch::getCustomClass("__torch__.torch.classes.tensorrt.Engine"), nullptr);
+  auto execute = torch::jit::getAllOperatorsFor(c10::Symbol::fromQualString("tensorrt::execute_engine"));
+  ASSERT_FALSE(execute.empty());
+
+  // Engines built with interpolate layers need the plugin to deserialize
+  ASSERT_NE(getPluginRegistry()->getPluginCreator("Interpolate", "1", ""), nullptr);
+}
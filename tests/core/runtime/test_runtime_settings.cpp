@@ -0,0 +1,62 @@
+#include <string>
+#include "core/runtime/settings.h"
+#include "gtest/gtest.h"
+
+TEST(Runtime, DefaultSettingsLeaveThePayloadUnchanged) {
+  trtorch::core::runtime::RuntimeSettings defaults;
+  auto payload = trtorch::core::runtime::settings::WrapSettings(defaults, "engine");
+  ASSERT_EQ(payload, "engine");
+
+  trtorch::core::runtime::RuntimeSettings loaded;
+  ASSERT_EQ(trtorch::core::runtime::settings::UnwrapSettings(payload, loaded), 0u);
+}
+
+TEST(Runtime, NonDefaultSettingsRoundTrip) {
+  trtorch::core::runtime::RuntimeSettings settings;
+  settings.max_in_flight = 3;
+  settings.split_oversized_batches = true;
+  std::string engine("\0TRTZ engine bytes", 18);
+  auto payload = trtorch::core::runtime::settings::WrapSettings(settings, engine);
+  ASSERT_NE(payload, engine);
+
+  trtorch::core::runtime::RuntimeSettings loaded;
+  auto offset = trtorch::core::runtime::settings::UnwrapSettings(payload, loaded);
+  ASSERT_EQ(payload.substr(offset), engine);
+  ASSERT_EQ(loaded.max_in_flight, 3);
+  ASSERT_TRUE(loaded.split_oversized_batches);
+}
+
+TEST(Runtime, TruncatedSettingsHeaderIsRejected) {
+  trtorch::core::runtime::RuntimeSettings settings;
+  settings.split_oversized_batches = true;
+  auto payload = trtorch::core::runtime::settings::WrapSettings(settings, "engine");
+  payload.resize(10);
+  trtorch::core::runtime::RuntimeSettings loaded;
+  ASSERT_ANY_THROW(trtorch::core::runtime::settings::UnwrapSettings(payload, loaded));
+}
+
+TEST(Runtime, BucketPoliciesRoundTrip) {
+  trtorch::core::runtime::RuntimeSettings settings;
+  trtorch::core::runtime::BucketPolicy policy;
+  policy.input = 1;
+  policy.dim = 2;
+  policy.boundaries = {16, 32, 128};
+  policy.pad_value = -0.1;
+  policy.output_dims = {{0, 1}, {2, 2}};
+  settings.bucketing.push_back(policy);
+  settings.bucketing.push_back(trtorch::core::runtime::BucketPolicy());
+  auto payload = trtorch::core::runtime::settings::WrapSettings(settings, "engine");
+
+  trtorch::core::runtime::RuntimeSettings loaded;
+  auto offset = trtorch::core::runtime::settings::UnwrapSettings(payload, loaded);
+  ASSERT_EQ(payload.substr(offset), "engine");
+  ASSERT_EQ(loaded.bucketing.size(), 2);
+  const auto& restored = loaded.bucketing[0];
+  ASSERT_EQ(restored.input, 1);
+  ASSERT_EQ(restored.dim, 2);
+  ASSERT_EQ(restored.boundaries, policy.boundaries);
+  ASSERT_EQ(restored.pad_value, -0.1);
+  ASSERT_EQ(restored.output_dims, policy.output_dims);
+  ASSERT_TRUE(loaded.bucketing[1].boundaries.empty());
+  ASSERT_TRUE(loaded.bucketing[1].output_dims.empty());
+}
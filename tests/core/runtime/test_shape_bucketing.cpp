@@ -0,0 +1,89 @@
+#include <vector>
+#include "core/runtime/ShapeBucketing.h"
+#include "gtest/gtest.h"
+#include "torch/torch.h"
+
+TEST(Runtime, BucketSizeRoundsUpToBoundaries) {
+  using trtorch::core::runtime::BucketSize;
+  std::vector<int64_t> boundaries = {16, 32, 128};
+  ASSERT_EQ(BucketSize(1, boundaries), 16);
+  ASSERT_EQ(BucketSize(16, boundaries), 16);
+  ASSERT_EQ(BucketSize(17, boundaries), 32);
+  ASSERT_EQ(BucketSize(100, boundaries), 128);
+  ASSERT_EQ(BucketSize(200, boundaries), 200);
+  ASSERT_EQ(BucketSize(1, {}), 1);
+  ASSERT_EQ(BucketSize(5, {}), 8);
+  ASSERT_EQ(BucketSize(64, {}), 64);
+}
+
+TEST(Runtime, BucketSizesAreClampedToTheMaxSize) {
+  using trtorch::core::runtime::BucketSize;
+  ASSERT_EQ(BucketSize(33, {}, 48), 48);
+  ASSERT_EQ(BucketSize(17, {16, 32, 64}, 48), 32);
+  ASSERT_EQ(BucketSize(40, {16, 32, 64}, 48), 48);
+  // Sizes past the max are left for the engine to reject
+  ASSERT_EQ(BucketSize(50, {}, 48), 50);
+
+  trtorch::core::runtime::BucketPolicy policy;
+  policy.dim = 1;
+  auto input = at::randn({2, 33});
+  std::vector<int64_t> unpadded;
+  auto padded = trtorch::core::runtime::PadToBuckets({input}, {policy}, unpadded, {{4, 48}});
+  ASSERT_EQ(padded[0].sizes(), at::IntArrayRef({2, 48}));
+  auto shapes = trtorch::core::runtime::BucketedShapes({input}, {policy}, {{4, 48}});
+  ASSERT_EQ(shapes[0], std::vector<int64_t>({2, 48}));
+}
+
+TEST(Runtime, PaddingAndSlicingRoundTrips) {
+  trtorch::core::runtime::BucketPolicy policy;
+  policy.input = 0;
+  policy.dim = 1;
+  policy.boundaries = {8, 16};
+  policy.pad_value = -1;
+  policy.output_dims = {{0, 1}};
+  std::vector<trtorch::core::runtime::BucketPolicy> policies = {policy};
+
+  auto tokens = at::randn({2, 5, 3});
+  auto mask = at::ones({2});
+  std::vector<int64_t> unpadded;
+  auto padded = trtorch::core::runtime::PadToBuckets({tokens, mask}, policies, unpadded);
+  ASSERT_EQ(unpadded, std::vector<int64_t>({5}));
+  ASSERT_EQ(padded[0].sizes(), at::IntArrayRef({2, 8, 3}));
+  ASSERT_TRUE(at::equal(padded[0].narrow(1, 0, 5), tokens));
+  ASSERT_TRUE(at::equal(padded[0].narrow(1, 5, 3), at::full({2, 3, 3}, -1)));
+  ASSERT_TRUE(padded[1].is_same(mask));
+
+  // Stand-in for the engine, keeps the padded shape
+  std::vector<at::Tensor> outputs = {padded[0] * 2, padded[1]};
+  trtorch::core::runtime::SliceFromBuckets(outputs, policies, unpadded);
+  ASSERT_EQ(outputs[0].sizes(), tokens.sizes());
+  ASSERT_TRUE(at::equal(outputs[0], tokens * 2));
+  ASSERT_TRUE(outputs[1].is_same(mask));
+}
+
+TEST(Runtime, InputsInABucketAreNotPadded) {
+  trtorch::core::runtime::BucketPolicy policy;
+  policy.dim = 0;
+  auto input = at::randn({16});
+  std::vector<int64_t> unpadded;
+  auto padded = trtorch::core::runtime::PadToBuckets({input}, {policy}, unpadded);
+  ASSERT_TRUE(padded[0].is_same(input));
+  ASSERT_EQ(unpadded, std::vector<int64_t>({16}));
+}
+
+TEST(Runtime, InvalidBucketPoliciesAreRejected) {
+  using trtorch::core::runtime::ValidateBucketPolicies;
+  trtorch::core::runtime::BucketPolicy policy;
+  policy.input = 1;
+  ASSERT_ANY_THROW(ValidateBucketPolicies({policy}, {{64}}));
+  ASSERT_NO_THROW(ValidateBucketPolicies({policy}, {{64}, {64}}));
+  policy.boundaries = {32, 16};
+  ASSERT_ANY_THROW(ValidateBucketPolicies({policy}, {{64}, {64}}));
+  // Boundaries past the max size of the dimension
+  policy.boundaries = {32, 128};
+  ASSERT_ANY_THROW(ValidateBucketPolicies({policy}, {{64}, {64}}));
+  policy.boundaries = {32, 64};
+  ASSERT_NO_THROW(ValidateBucketPolicies({policy}, {{64}, {64}}));
+  policy.dim = 1;
+  ASSERT_ANY_THROW(ValidateBucketPolicies({policy}, {{64}, {64}}));
+}
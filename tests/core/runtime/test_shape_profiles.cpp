@@ -0,0 +1,69 @@
+#include <sstream>
+#include "core/runtime/ShapeProfiles.h"
+#include "gtest/gtest.h"
+
+namespace {
+using trtorch::core::runtime::InputShapes;
+using trtorch::core::runtime::ShapeHistogram;
+
+// Sequence lengths of a single (1, L) input
+ShapeHistogram sequence_lengths(std::vector<std::pair<int64_t, uint64_t>> lengths) {
+  ShapeHistogram histogram;
+  for (const auto& l : lengths) {
+    histogram.push_back({InputShapes{{1, l.first}}, l.second});
+  }
+  return histogram;
+}
+} // namespace
+
+TEST(Runtime, ShapeHistogramRoundTrips) {
+  ShapeHistogram histogram = {{{{1, 3, 224, 224}, {1, 128}}, 12}, {{{}, {4}}, 1}};
+  std::stringstream ss;
+  trtorch::core::runtime::WriteShapeHistogram(ss, histogram);
+  ASSERT_NE(ss.str().find("12 (1,3,224,224) (1,128)"), std::string::npos);
+
+  auto restored = trtorch::core::runtime::ReadShapeHistogram(ss);
+  ASSERT_EQ(restored, histogram);
+}
+
+TEST(Runtime, MalformedShapeHistogramIsRejected) {
+  std::stringstream ss("3 1,128\n");
+  ASSERT_ANY_THROW(trtorch::core::runtime::ReadShapeHistogram(ss));
+}
+
+TEST(Runtime, SingleProfileCoversAllShapesWithTheMostFrequentAsOpt) {
+  auto profiles = trtorch::core::runtime::ClusterShapeProfiles(sequence_lengths({{16, 5}, {64, 50}, {128, 2}}), 1);
+  ASSERT_EQ(profiles.size(), 1);
+  ASSERT_EQ(profiles[0].min, InputShapes({{1, 16}}));
+  ASSERT_EQ(profiles[0].opt, InputShapes({{1, 64}}));
+  ASSERT_EQ(profiles[0].max, InputShapes({{1, 128}}));
+  ASSERT_EQ(profiles[0].calls, 57);
+  // (5 * 112 + 50 * 64) / 57 elements padded per call
+  ASSERT_NEAR(profiles[0].cost, (5.0 * 112 + 50.0 * 64) / 57, 1e-9);
+}
+
+TEST(Runtime, ClusteringSeparatesDistantShapes) {
+  auto histogram = sequence_lengths({{8, 10}, {10, 10}, {12, 10}, {500, 10}, {512, 10}});
+  auto profiles = trtorch::core::runtime::ClusterShapeProfiles(histogram, 2);
+  ASSERT_EQ(profiles.size(), 2);
+  ASSERT_EQ(profiles[0].min, InputShapes({{1, 8}}));
+  ASSERT_EQ(profiles[0].max, InputShapes({{1, 12}}));
+  ASSERT_EQ(profiles[1].min, InputShapes({{1, 500}}));
+  ASSERT_EQ(profiles[1].max, InputShapes({{1, 512}}));
+
+  auto by_width = trtorch::core::runtime::ClusterShapeProfiles(
+      histogram, 2, trtorch::core::runtime::ProfileObjective::kRangeWidth);
+  ASSERT_EQ(by_width[0].max, InputShapes({{1, 12}}));
+}
+
+TEST(Runtime, ClusteringNeverReturnsMoreProfilesThanShapes) {
+  auto profiles = trtorch::core::runtime::ClusterShapeProfiles(sequence_lengths({{8, 1}, {16, 1}}), 4);
+  ASSERT_EQ(profiles.size(), 2);
+  ASSERT_EQ(profiles[0].cost, 0);
+  ASSERT_EQ(profiles[1].cost, 0);
+}
+
+TEST(Runtime, ClusteringRejectsMismatchedRanks) {
+  ShapeHistogram histogram = {{{{1, 8}}, 1}, {{{1, 8, 8}}, 1}};
+  ASSERT_ANY_THROW(trtorch::core::runtime::ClusterShapeProfiles(histogram, 1));
+}
@@ -0,0 +1,151 @@
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "core/runtime/ShapeSpecializer.h"
+#include "gtest/gtest.h"
+
+namespace {
+using trtorch::core::runtime::InputShapes;
+using Specializer = trtorch::core::runtime::ShapeSpecializer<std::shared_ptr<std::string>>;
+
+// Stand-in for the compiler, names the engine after the shape it was built for
+std::shared_ptr<std::string> build_engine(const InputShapes& shapes) {
+  return std::make_shared<std::string>(std::to_string(shapes[0][0]));
+}
+
+// Runs build tasks right away
+void launch_inline(std::function<void()> task) {
+  task();
+}
+} // namespace
+
+TEST(Runtime, ShapeSpecializerBuildsAfterThreshold) {
+  int builds = 0;
+  Specializer specializer(
+      3,
+      4,
+      [&builds](const InputShapes& shapes) {
+        builds++;
+        return build_engine(shapes);
+      },
+      launch_inline);
+  InputShapes shapes = {{8, 128}};
+  ASSERT_FALSE(specializer.Route(shapes));
+  ASSERT_FALSE(specializer.Route(shapes));
+  // The third call triggers the build but still runs on the generic engine
+  ASSERT_FALSE(specializer.Route(shapes));
+  ASSERT_EQ(builds, 1);
+
+  auto engine = specializer.Route(shapes);
+  ASSERT_TRUE(engine);
+  ASSERT_EQ(*engine, "8");
+  ASSERT_FALSE(specializer.Route({{16, 128}}));
+  ASSERT_EQ(builds, 1);
+}
+
+TEST(Runtime, ShapeSpecializerEvictsLeastRecentlyUsed) {
+  Specializer specializer(1, 2, build_engine, launch_inline);
+  for (int64_t batch : {1, 2}) {
+    specializer.Route({{batch}});
+  }
+  ASSERT_EQ(specializer.Size(), 2);
+  // Touch 1 so 2 is the least recently used when 3 comes in
+  ASSERT_TRUE(specializer.Route({{1}}));
+  specializer.Route({{3}});
+
+  ASSERT_EQ(specializer.Size(), 2);
+  ASSERT_EQ(specializer.Evictions(), 1);
+  ASSERT_TRUE(specializer.Route({{1}}));
+  ASSERT_TRUE(specializer.Route({{3}}));
+  ASSERT_FALSE(specializer.Route({{2}}));
+}
+
+TEST(Runtime, ShapeSpecializerBuildsOneEngineAtATime) {
+  std::vector<std::function<void()>> pending;
+  Specializer specializer(
+      1, 4, build_engine, [&pending](std::function<void()> task) { pending.push_back(std::move(task)); });
+  specializer.Route({{1}});
+  specializer.Route({{2}});
+  ASSERT_EQ(pending.size(), 1);
+  ASSERT_TRUE(specializer.Building());
+
+  pending[0]();
+  ASSERT_FALSE(specializer.Building());
+  ASSERT_TRUE(specializer.Route({{1}}));
+  // Shape 2 kept counting while the first build ran
+  specializer.Route({{2}});
+  ASSERT_EQ(pending.size(), 2);
+}
+
+TEST(Runtime, ShapeSpecializerDoesNotRetryFailedBuilds) {
+  int builds = 0;
+  Specializer specializer(
+      1,
+      4,
+      [&builds](const InputShapes&) -> std::shared_ptr<std::string> {
+        builds++;
+        throw std::runtime_error("unsupported shape");
+      },
+      launch_inline);
+  for (int i = 0; i < 5; i++) {
+    ASSERT_FALSE(specializer.Route({{7}}));
+  }
+  ASSERT_EQ(builds, 1);
+  ASSERT_FALSE(specializer.Building());
+}
+
+TEST(Runtime, ShapeSpecializerBuildsInTheBackground) {
+  auto specializer = std::make_unique<Specializer>(1, 4, build_engine);
+  specializer->Route({{4}});
+  std::shared_ptr<std::string> engine;
+  for (int i = 0; i < 1000 && !engine; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    engine = specializer->Route({{4}});
+  }
+  ASSERT_TRUE(engine);
+  ASSERT_EQ(*engine, "4");
+}
+
+TEST(Runtime, ShapeSpecializerRoutesWhileEnginesAreBuiltAndEvicted) {
+  Specializer specializer(1, 2, build_engine, launch_inline);
+  specializer.Route({{1}});
+  std::atomic<bool> done(false);
+  std::vector<std::thread> routers;
+  for (int t = 0; t < 4; t++) {
+    routers.emplace_back([&]() {
+      while (!done) {
+        auto engine = specializer.Route({{1}});
+        ASSERT_TRUE(engine);
+        ASSERT_EQ(*engine, "1");
+      }
+    });
+  }
+  // Shape 1 is routed to before every build so the others evict each other
+  for (int64_t batch = 2; batch < 50; batch++) {
+    ASSERT_TRUE(specializer.Route({{1}}));
+    specializer.Route({{batch}});
+  }
+  done = true;
+  for (auto& t : routers) {
+    t.join();
+  }
+  ASSERT_EQ(specializer.Size(), 2);
+  ASSERT_TRUE(specializer.Route({{1}}));
+}
+
+TEST(Runtime, ShapeSpecializerJoinsItsWorkerWhenDestroyed) {
+  std::atomic<bool> built(false);
+  auto specializer = std::make_unique<Specializer>(1, 4, [&built](const InputShapes& shapes) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    built = true;
+    return build_engine(shapes);
+  });
+  specializer->Route({{5}});
+  specializer.reset();
+  ASSERT_TRUE(built);
+}
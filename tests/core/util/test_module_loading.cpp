@@ -0,0 +1,64 @@
+#include <stdlib.h>
+#include <unistd.h>
+#include <fstream>
+#include <string>
+#include "core/util/module_loading.h"
+#include "gtest/gtest.h"
+#include "torch/torch.h"
+
+namespace {
+// Resident set size (VmRSS) or its peak (VmHWM) in bytes
+size_t status_bytes(const std::string& field) {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.rfind(field + ":", 0) == 0) {
+      return std::stoull(line.substr(field.size() + 1)) * 1024;
+    }
+  }
+  return 0;
+}
+
+// Makes VmHWM start again from the current resident set size
+bool reset_peak_rss() {
+  std::ofstream clear_refs("/proc/self/clear_refs");
+  clear_refs << "5";
+  clear_refs.flush();
+  return clear_refs.good();
+}
+} // namespace
+
+TEST(Util, MappedLoadingKeepsPeakMemoryNearTheWeights) {
+  char path_template[] = "/tmp/trtorch_module_XXXXXX";
+  int fd = mkstemp(path_template);
+  ASSERT_GE(fd, 0);
+  close(fd);
+  std::string path = path_template;
+
+  const int64_t numel = 32 << 20;
+  const size_t weight_bytes = numel * sizeof(float);
+  float expected_sum;
+  {
+    torch::jit::Module mod("m");
+    auto weight = torch::arange(numel, torch::kFloat).remainder(7);
+    expected_sum = weight.sum().item<float>();
+    mod.register_parameter("weight", weight, false);
+    mod.save(path);
+  }
+
+  auto baseline = status_bytes("VmRSS");
+  bool peak_tracked = reset_peak_rss();
+  auto loaded = trtorch::core::util::LoadModule(path);
+  auto peak = peak_tracked ? status_bytes("VmHWM") : status_bytes("VmRSS");
+
+  auto weight = loaded.attr("weight").toTensor();
+  ASSERT_EQ(weight.numel(), numel);
+  ASSERT_EQ(weight.sum().item<float>(), expected_sum);
+
+  // One copy of the weights in tensors, none held by the reader
+  ASSERT_GT(peak, baseline);
+  ASSERT_LT(peak - baseline, weight_bytes + weight_bytes / 4) << "peak " << peak << ", baseline " << baseline;
+
+  unlink(path.c_str());
+  ASSERT_ANY_THROW(trtorch::core::util::LoadModule(path));
+}
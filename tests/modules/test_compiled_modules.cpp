@@ -23,6 +23,17 @@ TEST_P(ModuleTests, CompiledModuleIsClose) {
   }
 }
 
+TEST_P(ModuleTests, SupportCheckSharesTheLoweringCache) {
+  auto cache = std::make_shared<trtorch::LoweringCache>();
+  ASSERT_TRUE(trtorch::CheckMethodOperatorSupport(mod, "forward", cache));
+  ASSERT_EQ(cache->lowered_methods(), 1u);
+
+  auto spec = trtorch::CompileSpec(input_shapes);
+  spec.lowering_cache = cache;
+  trtorch::CompileGraph(mod, spec);
+  ASSERT_EQ(cache->lowered_methods(), 1u);
+}
+
 INSTANTIATE_TEST_SUITE_P(
     CompiledModuleForwardIsCloseSuite,
     ModuleTests,
@@ -0,0 +1,36 @@
+#include <string>
+#include "gtest/gtest.h"
+#include "tests/util/util.h"
+#include "torch/script.h"
+#include "trtorch/trtorch.h"
+
+TEST(ModuleTests, CanSwapEngineOfCompiledModule) {
+  torch::jit::script::Module mod1;
+  torch::jit::script::Module mod2;
+  try {
+    mod1 = torch::jit::load("tests/modules/resnet18_traced.jit.pt");
+    mod2 = torch::jit::load("tests/modules/resnet50_traced.jit.pt");
+  } catch (const c10::Error& e) {
+    std::cerr << "error loading the model\n";
+    return;
+  }
+
+  const std::vector<std::vector<int64_t>> input_shapes = {{1, 3, 224, 224}};
+  auto in = at::randint(5, input_shapes[0], {at::kCUDA});
+
+  std::vector<torch::jit::IValue> jit2_inputs_ivalues = {in.clone()};
+  auto jit2_results = trtorch::tests::util::RunModuleForward(mod2, jit2_inputs_ivalues).toTensor();
+
+  auto trt_mod = trtorch::CompileGraph(mod1, input_shapes);
+  std::vector<torch::jit::IValue> warmup_inputs_ivalues = {in.clone()};
+  trtorch::tests::util::RunModuleForward(trt_mod, warmup_inputs_ivalues);
+
+  // resnet50 has the same inputs and outputs as resnet18 so its engine can
+  // replace the one the compiled resnet18 runs
+  auto engine = trtorch::ConvertGraphToTRTEngine(mod2, "forward", input_shapes);
+  trtorch::SwapEngine(trt_mod, "forward", engine);
+
+  std::vector<torch::jit::IValue> trt_inputs_ivalues = {in.clone()};
+  auto trt_results = trtorch::tests::util::RunModuleForward(trt_mod, trt_inputs_ivalues).toTensor();
+  ASSERT_TRUE(trtorch::tests::util::almostEqual(jit2_results, trt_results.reshape_as(jit2_results), 2e-5));
+}
@@ -0,0 +1,103 @@
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include "core/util/calibration_cache.h"
+#include "gtest/gtest.h"
+#include "torch/torch.h"
+#include "trtorch/ptq.h"
+
+namespace {
+// Synthetic calibration data on the CPU, example i is filled with i
+class SyntheticDataset : public torch::data::datasets::Dataset<SyntheticDataset> {
+ public:
+  explicit SyntheticDataset(size_t size, int64_t fail_at = -1) : size_(size), fail_at_(fail_at) {}
+
+  torch::data::Example<> get(size_t index) override {
+    if (static_cast<int64_t>(index) == fail_at_) {
+      throw std::runtime_error("Failed to load example");
+    }
+    return {torch::full({4}, static_cast<float>(index)), torch::tensor(static_cast<int64_t>(index))};
+  }
+
+  torch::optional<size_t> size() const override {
+    return size_;
+  }
+
+ private:
+  size_t size_;
+  int64_t fail_at_;
+};
+
+auto make_loader(size_t size, int64_t fail_at = -1) {
+  return torch::data::make_data_loader<torch::data::samplers::SequentialSampler>(
+      SyntheticDataset(size, fail_at).map(torch::data::transforms::Stack<>()),
+      torch::data::DataLoaderOptions().batch_size(2));
+}
+
+using Prefetcher = trtorch::ptq::BatchPrefetcher<decltype(make_loader(0))>;
+} // namespace
+
+TEST(PTQ, PrefetcherStreamsEveryPassInOrder) {
+  Prefetcher prefetcher(make_loader(10), 2);
+  for (int pass = 0; pass < 3; pass++) {
+    torch::Tensor batch;
+    int64_t batches = 0;
+    while (prefetcher.Next(batch)) {
+      ASSERT_EQ(batch.size(0), 2);
+      ASSERT_EQ(batch[0][0].item<float>(), static_cast<float>(batches * 2));
+      ASSERT_EQ(batch[1][0].item<float>(), static_cast<float>(batches * 2 + 1));
+      batches++;
+    }
+    ASSERT_EQ(batches, 5);
+  }
+}
+
+TEST(PTQ, PrefetcherStaysWithinCapacity) {
+  Prefetcher prefetcher(make_loader(64), 3);
+  torch::Tensor batch;
+  while (prefetcher.Next(batch)) {
+    // A slow consumer lets the loading thread fill the queue
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  ASSERT_GT(prefetcher.peak_queued(), 0);
+  ASSERT_LE(prefetcher.peak_queued(), 3);
+}
+
+TEST(PTQ, PrefetcherRethrowsLoadingErrors) {
+  Prefetcher prefetcher(make_loader(10, 5), 2);
+  torch::Tensor batch;
+  int batches = 0;
+  ASSERT_THROW(
+      {
+        while (prefetcher.Next(batch)) {
+          batches++;
+        }
+      },
+      std::exception);
+  ASSERT_EQ(batches, 2);
+}
+
+TEST(PTQ, PrefetcherCanBeDestroyedMidPass) {
+  Prefetcher prefetcher(make_loader(100), 1);
+  torch::Tensor batch;
+  ASSERT_TRUE(prefetcher.Next(batch));
+  auto moved = std::move(prefetcher);
+  ASSERT_TRUE(moved.Next(batch));
+  ASSERT_EQ(batch[0][0].item<float>(), 2.0f);
+}
+
+TEST(PTQ, StreamingCalibratorStopsOnLoadingErrors) {
+  using Calibrator = trtorch::ptq::Int8StreamingCalibrator<nvinfer1::IInt8EntropyCalibrator2, decltype(make_loader(0))>;
+  Calibrator calibrator(make_loader(10, 0), "/tmp/trtorch_test_streaming.cache", false, 2);
+  const char* names[] = {"input_0"};
+  void* bindings[1] = {nullptr};
+
+  // TensorRT calls getBatch while building the engine, which raises the error
+  // once the build returns
+  trtorch::core::util::calibration::ActiveKeyGuard build({});
+  bool has_batch = true;
+  ASSERT_NO_THROW(has_batch = calibrator.getBatch(bindings, names, 1));
+  ASSERT_FALSE(has_batch);
+  ASSERT_THROW(build.RethrowCalibratorError(), std::exception);
+}
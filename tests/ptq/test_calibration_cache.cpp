@@ -0,0 +1,118 @@
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "core/util/calibration_cache.h"
+#include "gtest/gtest.h"
+
+namespace calibration = trtorch::core::util::calibration;
+
+namespace {
+// Start of a cache as written by TensorRT
+const std::string kTRTCache = "TRT-7100-EntropyCalibration2\ninput_0: 3c010a14\n";
+
+calibration::CacheKey make_key() {
+  calibration::CacheKey key;
+  key.graph_hash = calibration::HashGraph("graph(%x : Tensor):\n  return (%x)\n");
+  key.input_specs = "[(1,3,32,32);(8,3,32,32);(32,3,32,32)]";
+  key.algorithm = "entropy2";
+  return key;
+}
+
+std::vector<char> to_vec(const std::string& s) {
+  return std::vector<char>(s.begin(), s.end());
+}
+} // namespace
+
+TEST(PTQ, CalibrationCacheRoundTrips) {
+  auto key = make_key();
+  auto contents = to_vec(calibration::WrapCache(key, kTRTCache.data(), kTRTCache.size()));
+  auto parsed = calibration::ParseCache(contents);
+  ASSERT_TRUE(parsed.has_key);
+  ASSERT_EQ(parsed.key.graph_hash, key.graph_hash);
+  ASSERT_EQ(parsed.key.input_specs, key.input_specs);
+  ASSERT_EQ(parsed.key.algorithm, key.algorithm);
+  // The TensorRT cache follows the header unchanged
+  ASSERT_EQ(std::string(contents.begin() + parsed.payload_offset, contents.end()), kTRTCache);
+  ASSERT_TRUE(calibration::CheckKey(key, parsed.key).empty());
+}
+
+TEST(PTQ, CalibrationCacheAcceptsRawTensorRTCaches) {
+  auto parsed = calibration::ParseCache(to_vec(kTRTCache));
+  ASSERT_FALSE(parsed.has_key);
+  ASSERT_EQ(parsed.payload_offset, 0u);
+}
+
+TEST(PTQ, CalibrationCacheRejectsMismatchedKeys) {
+  auto key = make_key();
+
+  auto other_graph = key;
+  other_graph.graph_hash = calibration::HashGraph("graph(%y : Tensor):\n  return (%y)\n");
+  ASSERT_NE(calibration::CheckKey(key, other_graph).find("different graph"), std::string::npos);
+
+  auto other_inputs = key;
+  other_inputs.input_specs = "[(1,3,64,64);(8,3,64,64);(32,3,64,64)]";
+  ASSERT_NE(calibration::CheckKey(key, other_inputs).find("input ranges"), std::string::npos);
+
+  auto other_algorithm = key;
+  other_algorithm.algorithm = "minmax";
+  ASSERT_NE(calibration::CheckKey(key, other_algorithm).find("algorithm"), std::string::npos);
+
+  // Only the algorithm is known when calibrating outside of a TRTorch build
+  calibration::CacheKey algorithm_only;
+  algorithm_only.algorithm = "entropy2";
+  ASSERT_TRUE(calibration::CheckKey(algorithm_only, other_graph).empty());
+  ASSERT_FALSE(calibration::CheckKey(algorithm_only, other_algorithm).empty());
+}
+
+TEST(PTQ, CalibrationCacheRejectsTruncatedHeaders) {
+  auto contents = calibration::WrapCache(make_key(), kTRTCache.data(), kTRTCache.size());
+  ASSERT_ANY_THROW(calibration::ParseCache(to_vec(contents.substr(0, 20))));
+  ASSERT_ANY_THROW(calibration::ParseCache(to_vec(contents.substr(0, 6))));
+}
+
+TEST(PTQ, CalibrationCacheReadsWholeFile) {
+  std::string path = "/tmp/trtorch_test_calibration.cache";
+  auto contents = calibration::WrapCache(make_key(), kTRTCache.data(), kTRTCache.size());
+  {
+    std::ofstream out(path, std::ios::binary);
+    out.write(contents.data(), contents.size());
+  }
+  std::vector<char> read;
+  ASSERT_TRUE(calibration::ReadFile(path, read));
+  ASSERT_EQ(std::string(read.begin(), read.end()), contents);
+  ASSERT_FALSE(calibration::ReadFile("/tmp/trtorch_test_missing.cache", read));
+}
+
+TEST(PTQ, CalibrationCacheActiveKeyIsScoped) {
+  ASSERT_EQ(calibration::ActiveKey(), nullptr);
+  {
+    calibration::ActiveKeyGuard outer(make_key());
+    ASSERT_EQ(calibration::ActiveKey()->algorithm, "entropy2");
+    {
+      auto inner_key = make_key();
+      inner_key.algorithm = "minmax";
+      calibration::ActiveKeyGuard inner(inner_key);
+      ASSERT_EQ(calibration::ActiveKey()->algorithm, "minmax");
+    }
+    ASSERT_EQ(calibration::ActiveKey()->algorithm, "entropy2");
+  }
+  ASSERT_EQ(calibration::ActiveKey(), nullptr);
+}
+
+TEST(PTQ, CalibrationCacheRethrowsTheFirstCalibratorError) {
+  // Outside of a build there is nothing to raise the error, it is dropped
+  calibration::RecordCalibratorError(std::make_exception_ptr(std::runtime_error("dropped")));
+
+  calibration::ActiveKeyGuard guard(make_key());
+  ASSERT_NO_THROW(guard.RethrowCalibratorError());
+  calibration::RecordCalibratorError(std::make_exception_ptr(std::runtime_error("first")));
+  calibration::RecordCalibratorError(std::make_exception_ptr(std::runtime_error("second")));
+  try {
+    guard.RethrowCalibratorError();
+    FAIL() << "Expected the recorded error";
+  } catch (const std::runtime_error& e) {
+    ASSERT_STREQ(e.what(), "first");
+  }
+  ASSERT_NO_THROW(guard.RethrowCalibratorError());
+}
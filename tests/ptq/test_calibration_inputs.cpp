@@ -0,0 +1,57 @@
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "core/calibration/BindingMap.h"
+#include "gtest/gtest.h"
+#include "torch/torch.h"
+#include "trtorch/ptq.h"
+
+namespace calibration = trtorch::core::calibration;
+
+TEST(PTQ, PositionalInputsFeedTRTorchBindingsByIndex) {
+  // TensorRT does not guarantee the bindings are in input order
+  const char* bindings[] = {"input_1", "input_0", "input_2"};
+  auto mapping = calibration::MapBindings({"", "", ""}, bindings, 3);
+  ASSERT_EQ(mapping, std::vector<size_t>({1, 0, 2}));
+
+  // Engines not built by TRTorch are fed in binding order
+  const char* foreign[] = {"image", "mask"};
+  ASSERT_EQ(calibration::MapBindings({"", ""}, foreign, 2), std::vector<size_t>({0, 1}));
+}
+
+TEST(PTQ, NamedInputsFeedBindingsByName) {
+  const char* bindings[] = {"input_0", "input_1"};
+  ASSERT_EQ(calibration::MapBindings({"input_1", "input_0"}, bindings, 2), std::vector<size_t>({1, 0}));
+
+  ASSERT_ANY_THROW(calibration::MapBindings({"input_0", "mask"}, bindings, 2));
+  ASSERT_ANY_THROW(calibration::MapBindings({"input_0", "input_0"}, bindings, 2));
+  ASSERT_ANY_THROW(calibration::MapBindings({"input_0", ""}, bindings, 2));
+  ASSERT_ANY_THROW(calibration::MapBindings({"input_0"}, bindings, 2));
+}
+
+TEST(PTQ, BatchesConvertToCalibrationInputs) {
+  auto image = torch::zeros({2, 3});
+  auto mask = torch::ones({2, 5});
+
+  auto single = trtorch::ptq::calibration_inputs(image);
+  ASSERT_EQ(single.size(), 1u);
+  ASSERT_TRUE(single[0].first.empty());
+
+  auto tuple = trtorch::ptq::calibration_inputs(std::make_tuple(image, mask));
+  ASSERT_EQ(tuple.size(), 2u);
+  ASSERT_TRUE(tuple[1].second.equal(mask));
+
+  std::map<std::string, torch::Tensor> dict = {{"input_1", mask}, {"input_0", image}};
+  auto ordered = trtorch::ptq::positional_inputs_impl(trtorch::ptq::calibration_inputs(dict));
+  ASSERT_EQ(ordered.size(), 2u);
+  ASSERT_TRUE(ordered[0].equal(image));
+  ASSERT_TRUE(ordered[1].equal(mask));
+
+  // Staging leaves one contiguous host tensor per input
+  trtorch::ptq::CalibrationInputs inputs = {{"", mask.t()}};
+  ASSERT_FALSE(inputs[0].second.is_contiguous());
+  trtorch::ptq::stage_inputs_impl(inputs);
+  ASSERT_TRUE(inputs[0].second.is_contiguous());
+  ASSERT_TRUE(inputs[0].second.equal(mask.t()));
+}
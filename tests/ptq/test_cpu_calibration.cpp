@@ -0,0 +1,163 @@
+#include <cmath>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+#include "core/calibration/ActivationCollector.h"
+#include "core/calibration/CalibrationTable.h"
+#include "core/calibration/Histogram.h"
+#include "gtest/gtest.h"
+#include "torch/csrc/jit/ir/irparser.h"
+#include "torch/torch.h"
+
+namespace calibration = trtorch::core::calibration;
+
+namespace {
+uint64_t sum(const std::vector<uint64_t>& counts) {
+  uint64_t total = 0;
+  for (auto c : counts) {
+    total += c;
+  }
+  return total;
+}
+
+// Standard normal activations with a single large outlier
+calibration::Histogram normal_with_outlier(float outlier) {
+  std::mt19937 gen(0);
+  std::normal_distribution<float> normal(0, 1);
+  std::vector<float> data(100000);
+  for (auto& x : data) {
+    x = normal(gen);
+  }
+  data[data.size() / 2] = outlier;
+  calibration::Histogram histogram;
+  histogram.Add(data.data(), data.size());
+  return histogram;
+}
+} // namespace
+
+TEST(PTQ, HistogramGrowsToLargestValue) {
+  calibration::Histogram histogram(16);
+  std::vector<float> first = {0.5f, -1.0f};
+  histogram.Add(first.data(), first.size());
+  ASSERT_EQ(histogram.range(), 1.0f);
+  ASSERT_EQ(histogram.counts()[8], 1u);
+  ASSERT_EQ(histogram.counts()[15], 1u);
+
+  std::vector<float> second = {-4.0f, 0.0f};
+  histogram.Add(second.data(), second.size());
+  ASSERT_EQ(histogram.range(), 4.0f);
+  ASSERT_EQ(histogram.max_abs(), 4.0f);
+  ASSERT_EQ(histogram.total(), 4u);
+  ASSERT_EQ(sum(histogram.counts()), 4u);
+  // The old bins are merged into the wider bins holding them
+  ASSERT_EQ(histogram.counts()[0], 1u);
+  ASSERT_EQ(histogram.counts()[2], 1u);
+  ASSERT_EQ(histogram.counts()[3], 1u);
+  ASSERT_EQ(histogram.counts()[15], 1u);
+}
+
+TEST(PTQ, HistogramDropsNonFiniteValues) {
+  calibration::Histogram histogram;
+  std::vector<float> data = {1.0f,
+                             std::numeric_limits<float>::quiet_NaN(),
+                             std::numeric_limits<float>::infinity(),
+                             -std::numeric_limits<float>::infinity()};
+  histogram.Add(data.data(), data.size());
+  ASSERT_EQ(histogram.total(), 1u);
+  ASSERT_EQ(histogram.max_abs(), 1.0f);
+}
+
+TEST(PTQ, ScaleMethodsClipOutliers) {
+  auto histogram = normal_with_outlier(64.0f);
+  ASSERT_EQ(calibration::ComputeAmax(histogram, calibration::ScaleMethod::kMinMax), 64.0f);
+
+  auto percentile = calibration::ComputeAmax(histogram, calibration::ScaleMethod::kPercentile, 99.9);
+  ASSERT_GT(percentile, 3.0f);
+  ASSERT_LT(percentile, 3.7f);
+
+  auto entropy = calibration::ComputeAmax(histogram, calibration::ScaleMethod::kEntropy);
+  ASSERT_GT(entropy, 2.0f);
+  ASSERT_LT(entropy, 16.0f);
+}
+
+TEST(PTQ, ScaleMethodsHandleEmptyHistograms) {
+  calibration::Histogram histogram;
+  std::vector<float> zeros(64, 0.0f);
+  histogram.Add(zeros.data(), zeros.size());
+  ASSERT_EQ(calibration::ComputeAmax(histogram, calibration::ScaleMethod::kEntropy), 0.0f);
+  ASSERT_EQ(calibration::ComputeAmax(histogram, calibration::ScaleMethod::kPercentile), 0.0f);
+}
+
+TEST(PTQ, CalibrationTableMatchesTensorRTFormat) {
+  auto table = calibration::WriteCalibrationTable(
+      7100, calibration::TableAlgorithmName(nvinfer1::CalibrationAlgoType::kENTROPY_CALIBRATION_2),
+      {{"input_0", 63.5f}, {"output_0", 127.0f}});
+  ASSERT_EQ(table, "TRT-7100-EntropyCalibration2\ninput_0: 3f000000\noutput_0: 3f800000\n");
+}
+
+TEST(PTQ, ActivationCollectorNamesTensorsAsTheNetworkDoes) {
+  const auto graph = R"IR(
+    graph(%x : Tensor):
+      %1 : Tensor = aten::relu(%x)
+      %2 : Tensor = aten::neg(%1)
+      return (%2))IR";
+  auto g = std::make_shared<torch::jit::Graph>();
+  torch::jit::parseIR(graph, &*g);
+
+  std::vector<trtorch::core::conversion::InputRange> ranges = {trtorch::core::conversion::InputRange({4})};
+  calibration::CollectorSettings settings;
+  settings.method = calibration::ScaleMethod::kMinMax;
+  calibration::ActivationCollector collector(g, {}, ranges, settings);
+  collector.Collect({torch::tensor({-2.0f, -1.0f, 1.0f, 3.0f})});
+  collector.Collect({torch::tensor({-5.0f, 0.0f, 2.0f, 1.0f})});
+
+  auto amax = collector.Amax();
+  ASSERT_EQ(amax.size(), 3u);
+  ASSERT_EQ(amax[0], std::make_pair(std::string("input_0"), 5.0f));
+  ASSERT_EQ(amax[1], std::make_pair(std::string("1"), 3.0f));
+  ASSERT_EQ(amax[2], std::make_pair(std::string("output_0"), 3.0f));
+
+  // The cache is keyed to the graph and input ranges the engine is built for
+  auto cache = collector.Cache();
+  auto parsed = trtorch::core::util::calibration::ParseCache(std::vector<char>(cache.begin(), cache.end()));
+  ASSERT_TRUE(parsed.has_key);
+  auto expected = trtorch::core::conversion::CalibrationCacheKey(g->block(), ranges, {});
+  expected.algorithm = "entropy2";
+  ASSERT_TRUE(trtorch::core::util::calibration::CheckKey(expected, parsed.key).empty());
+  ASSERT_EQ(cache.compare(parsed.payload_offset, 4, "TRT-"), 0);
+}
+
+TEST(PTQ, CalibrationCacheKeyCoversNamesAndWeights) {
+  auto parse = [](const std::string& ir) {
+    auto g = std::make_shared<torch::jit::Graph>();
+    torch::jit::parseIR(ir, &*g);
+    return g;
+  };
+  auto g = parse(R"IR(
+    graph(%x : Tensor, %w : Tensor):
+      %1 : Tensor = aten::mul(%x, %w)
+      return (%1))IR");
+  auto renamed = parse(R"IR(
+    graph(%input.1 : Tensor, %self.weight : Tensor):
+      %out : Tensor = aten::mul(%input.1, %self.weight)
+      return (%out))IR");
+  auto other_op = parse(R"IR(
+    graph(%x : Tensor, %w : Tensor):
+      %1 : Tensor = aten::add(%x, %w, %x)
+      return (%1))IR");
+
+  std::vector<trtorch::core::conversion::InputRange> ranges = {trtorch::core::conversion::InputRange({4})};
+  auto key = [&](std::shared_ptr<torch::jit::Graph> graph, float weight) {
+    trtorch::core::conversion::GraphParams params = {{graph->inputs()[1], torch::full({4}, weight)}};
+    return trtorch::core::conversion::CalibrationCacheKey(graph->block(), ranges, params).graph_hash;
+  };
+  // TensorRT keys cache entries by tensor name, which follow the debug names
+  ASSERT_EQ(key(g, 1.0f), key(parse(R"IR(
+    graph(%x : Tensor, %w : Tensor):
+      %1 : Tensor = aten::mul(%x, %w)
+      return (%1))IR"), 1.0f));
+  ASSERT_NE(key(g, 1.0f), key(renamed, 1.0f));
+  ASSERT_NE(key(g, 1.0f), key(g, 2.0f));
+  ASSERT_NE(key(g, 1.0f), key(other_op, 1.0f));
+}
@@ -0,0 +1,112 @@
+#include <sys/stat.h>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "core/calibration/NpyFile.h"
+#include "gtest/gtest.h"
+#include "torch/torch.h"
+#include "trtorch/datasets.h"
+
+namespace calibration = trtorch::core::calibration;
+
+namespace {
+// A version 1 .npy file, header padded to 64 bytes as numpy does
+std::string npy_file(const std::string& descr, const std::string& shape, const void* data, size_t size) {
+  std::string header = "{'descr': '" + descr + "', 'fortran_order': False, 'shape': " + shape + ", }";
+  header.append(64 - (10 + header.size() + 1) % 64, ' ');
+  header.push_back('\n');
+  std::string file = "\x93NUMPY";
+  file.push_back(1);
+  file.push_back(0);
+  file.push_back(static_cast<char>(header.size() & 0xff));
+  file.push_back(static_cast<char>(header.size() >> 8));
+  file += header;
+  file.append(static_cast<const char*>(data), size);
+  return file;
+}
+
+template <typename T>
+void write_npy(
+    const std::string& path,
+    const std::string& descr,
+    const std::string& shape,
+    const std::vector<T>& data) {
+  std::ofstream out(path, std::ios::binary);
+  out << npy_file(descr, shape, data.data(), data.size() * sizeof(T));
+}
+} // namespace
+
+TEST(PTQ, ParsesNpyHeader) {
+  std::vector<float> data(6);
+  auto file = npy_file("<f4", "(3, 2)", data.data(), data.size() * sizeof(float));
+  auto header = calibration::ParseNpyHeader(file.data(), file.size());
+  ASSERT_EQ(header.descr, "<f4");
+  ASSERT_EQ(header.item_size, 4u);
+  ASSERT_EQ(header.shape, std::vector<int64_t>({3, 2}));
+  ASSERT_EQ(header.data_offset % 64, 0u);
+  ASSERT_EQ(header.data_offset, file.size() - data.size() * sizeof(float));
+
+  auto vector_file = npy_file("|u1", "(5,)", data.data(), 5);
+  ASSERT_EQ(calibration::ParseNpyHeader(vector_file.data(), vector_file.size()).shape, std::vector<int64_t>({5}));
+}
+
+TEST(PTQ, RejectsUnsupportedNpyFiles) {
+  std::vector<float> data(6);
+  auto truncated = npy_file("<f4", "(3, 2)", data.data(), 5 * sizeof(float));
+  ASSERT_ANY_THROW(calibration::ParseNpyHeader(truncated.data(), truncated.size()));
+
+  auto big_endian = npy_file(">f4", "(3, 2)", data.data(), data.size() * sizeof(float));
+  ASSERT_ANY_THROW(calibration::ParseNpyHeader(big_endian.data(), big_endian.size()));
+
+  auto fortran = npy_file("<f4", "(3, 2)", data.data(), data.size() * sizeof(float));
+  auto pos = fortran.find("False");
+  fortran.replace(pos, 5, "True ");
+  ASSERT_ANY_THROW(calibration::ParseNpyHeader(fortran.data(), fortran.size()));
+
+  std::string not_npy = "PK\x03\x04 not a numpy file";
+  ASSERT_ANY_THROW(calibration::ParseNpyHeader(not_npy.data(), not_npy.size()));
+}
+
+TEST(PTQ, NpyDatasetGathersRowsAcrossShards) {
+  char root_template[] = "/tmp/trtorch_npy_XXXXXX";
+  std::string root = mkdtemp(root_template);
+  mkdir((root + "/images").c_str(), 0755);
+  // images: 5 rows of 3 floats split over two shards, row i holds i * 10 + j
+  write_npy<float>(root + "/images/000.npy", "<f4", "(2, 3)", {0, 1, 2, 10, 11, 12});
+  write_npy<float>(root + "/images/001.npy", "<f4", "(3, 3)", {20, 21, 22, 30, 31, 32, 40, 41, 42});
+  write_npy<int64_t>(root + "/lengths.npy", "<i8", "(5,)", {5, 6, 7, 8, 9});
+  write_npy<uint8_t>(root + "/labels.npy", "|u1", "(5,)", {0, 1, 0, 1, 0});
+
+  trtorch::datasets::NpyDataset dataset(root, {"images", "lengths"}, "labels");
+  ASSERT_EQ(dataset.size().value(), 5u);
+
+  std::vector<size_t> indices = {4, 0, 2};
+  auto batch = dataset.get_batch(indices);
+  ASSERT_EQ(batch.inputs.size(), 2u);
+  ASSERT_EQ(batch.inputs[0].first, "images");
+  ASSERT_TRUE(batch.data.equal(batch.inputs[0].second));
+  ASSERT_TRUE(batch.data.equal(torch::tensor({40.f, 41.f, 42.f, 0.f, 1.f, 2.f, 20.f, 21.f, 22.f}).view({3, 3})));
+  ASSERT_EQ(batch.inputs[1].first, "lengths");
+  ASSERT_TRUE(batch.inputs[1].second.equal(torch::tensor({9, 5, 7}, torch::kLong)));
+  ASSERT_TRUE(batch.target.equal(torch::tensor({0, 0, 0}, torch::kU8)));
+
+  std::vector<size_t> out_of_range = {5};
+  ASSERT_ANY_THROW(dataset.get_batch(out_of_range));
+
+  // Batches are gathered by the dataloader workers ahead of the loop
+  auto dataloader = torch::data::make_data_loader(
+      std::move(dataset), torch::data::DataLoaderOptions().batch_size(2).workers(2).enforce_ordering(true));
+  int64_t rows = 0;
+  float sum = 0;
+  for (auto b : *dataloader) {
+    rows += b.data.size(0);
+    sum += b.data.sum().item<float>();
+  }
+  ASSERT_EQ(rows, 5);
+  ASSERT_EQ(sum, 3 * (0 + 10 + 20 + 30 + 40) + 5 * 3);
+
+  ASSERT_ANY_THROW(trtorch::datasets::NpyDataset(root, {"images", "missing"}).size());
+  std::system(("rm -rf " + root).c_str());
+}
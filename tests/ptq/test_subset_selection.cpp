@@ -0,0 +1,99 @@
+#include <random>
+#include <set>
+#include <vector>
+#include "core/calibration/SubsetSelection.h"
+#include "gtest/gtest.h"
+#include "torch/torch.h"
+#include "trtorch/ptq.h"
+
+namespace calibration = trtorch::core::calibration;
+
+namespace {
+std::vector<float> normal_summaries(size_t num_samples, size_t num_features) {
+  std::mt19937 gen(0);
+  std::normal_distribution<float> normal(0, 1);
+  std::vector<float> summaries(num_samples * num_features);
+  for (auto& x : summaries) {
+    x = normal(gen);
+  }
+  return summaries;
+}
+
+// Example i is a vector filled with i
+class SyntheticDataset : public torch::data::datasets::Dataset<SyntheticDataset> {
+ public:
+  explicit SyntheticDataset(size_t size) : size_(size) {}
+
+  torch::data::Example<> get(size_t index) override {
+    return {torch::full({4}, static_cast<float>(index)), torch::tensor(static_cast<int64_t>(index))};
+  }
+
+  torch::optional<size_t> size() const override {
+    return size_;
+  }
+
+ private:
+  size_t size_;
+};
+} // namespace
+
+TEST(PTQ, StratifiedSubsetMatchesTheFullSet) {
+  auto summaries = normal_summaries(10000, 3);
+  auto subset = calibration::SelectSubset(summaries, 3, 100, calibration::SubsetStrategy::kStratified);
+  ASSERT_EQ(subset.indices.size(), 100u);
+  ASSERT_TRUE(std::is_sorted(subset.indices.begin(), subset.indices.end()));
+  ASSERT_EQ(std::set<size_t>(subset.indices.begin(), subset.indices.end()).size(), 100u);
+  ASSERT_LT(subset.max_mean_shift, 0.1);
+  ASSERT_LT(subset.max_std_error, 0.2);
+}
+
+TEST(PTQ, CoresetSubsetCoversOutliers) {
+  auto summaries = normal_summaries(1000, 2);
+  summaries[10 * 2] = 50.0f;
+  summaries[500 * 2] = -50.0f;
+  summaries[900 * 2 + 1] = 50.0f;
+  auto coreset = calibration::SelectSubset(summaries, 2, 10, calibration::SubsetStrategy::kCoreset);
+  std::set<size_t> selected(coreset.indices.begin(), coreset.indices.end());
+  ASSERT_EQ(selected.size(), 10u);
+  ASSERT_EQ(selected.count(10), 1u);
+  ASSERT_EQ(selected.count(500), 1u);
+  ASSERT_EQ(selected.count(900), 1u);
+
+  auto stratified = calibration::SelectSubset(summaries, 2, 10, calibration::SubsetStrategy::kStratified);
+  ASSERT_LT(coreset.coverage_radius, stratified.coverage_radius);
+}
+
+TEST(PTQ, SubsetSelectionHandlesSmallAndConstantSets) {
+  auto summaries = normal_summaries(5, 2);
+  auto all = calibration::SelectSubset(summaries, 2, 10, calibration::SubsetStrategy::kStratified);
+  ASSERT_EQ(all.indices, std::vector<size_t>({0, 1, 2, 3, 4}));
+  ASSERT_EQ(all.coverage_radius, 0.0);
+
+  std::vector<float> constant(20 * 2, 1.0f);
+  auto coreset = calibration::SelectSubset(constant, 2, 5, calibration::SubsetStrategy::kCoreset);
+  ASSERT_EQ(std::set<size_t>(coreset.indices.begin(), coreset.indices.end()).size(), 5u);
+  ASSERT_EQ(coreset.max_std_error, 0.0);
+
+  ASSERT_ANY_THROW(calibration::SelectSubset(summaries, 3, 2, calibration::SubsetStrategy::kStratified));
+  ASSERT_ANY_THROW(calibration::SelectSubset(summaries, 2, 0, calibration::SubsetStrategy::kStratified));
+}
+
+TEST(PTQ, SubsetSamplerLoadsTheSelectedSamples) {
+  SyntheticDataset dataset(100);
+  auto subset = trtorch::ptq::select_calibration_subset(dataset, 10);
+  ASSERT_EQ(subset.indices.size(), 10u);
+
+  auto loader = torch::data::make_data_loader(
+      dataset.map(torch::data::transforms::Stack<>()),
+      trtorch::ptq::SubsetSampler(subset.indices),
+      torch::data::DataLoaderOptions().batch_size(4));
+  for (int pass = 0; pass < 2; pass++) {
+    std::vector<size_t> loaded;
+    for (auto batch : *loader) {
+      for (int64_t i = 0; i < batch.target.size(0); i++) {
+        loaded.push_back(static_cast<size_t>(batch.target[i].item<int64_t>()));
+      }
+    }
+    ASSERT_EQ(loaded, subset.indices);
+  }
+}
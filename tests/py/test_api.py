@@ -32,6 +32,142 @@ class TestCompile(ModelTestCase):
         self.assertTrue(same < 2e-3)
 
 
+class TestCompileAsync(unittest.TestCase):
+
+    def setUp(self):
+        self.input = torch.randn((1, 3, 224, 224)).to("cuda")
+        self.modules = [
+            torch.jit.trace(models.resnet18(pretrained=True).eval().to("cuda"), [self.input]),
+            torch.jit.trace(models.mobilenet_v2(pretrained=True).eval().to("cuda"), [self.input]),
+        ]
+
+    def test_compile_in_parallel(self):
+        compile_spec = {
+            "input_shapes": [self.input.shape],
+        }
+
+        futures = [trtorch.compile_async(m, compile_spec) for m in self.modules]
+        for module, future in zip(self.modules, futures):
+            trt_mod = future.result()
+            same = (trt_mod(self.input) - module(self.input)).abs().max()
+            self.assertTrue(same < 2e-3)
+
+    def test_spec_errors_are_raised_by_the_caller(self):
+        with self.assertRaises(TypeError):
+            trtorch.compile_async(self.modules[0], {"input_shapes": [self.input.shape], "op_precision": torch.int64})
+
+
+class TestEngineStats(unittest.TestCase):
+
+    def setUp(self):
+        module = models.resnet18(pretrained=True).eval().to("cuda")
+        self.input = torch.randn((1, 3, 224, 224)).to("cuda")
+        self.module = torch.jit.trace(module, [self.input])
+
+    def test_engine_stats(self):
+        compile_spec = {
+            "input_shapes": [self.input.shape],
+        }
+
+        trt_mod = trtorch.compile(self.module, compile_spec)
+        for _ in range(3):
+            trt_mod(self.input)
+
+        stats = trtorch.get_engine_stats(trt_mod)
+        self.assertEqual(len(stats), 1)
+        engine_stats = list(stats.values())[0]
+        self.assertEqual(engine_stats["calls"], 3)
+        self.assertEqual(engine_stats["errors"], 0)
+        # Latencies are sampled, the first call is always timed
+        self.assertEqual(engine_stats["host_overhead_ns.count"], 1)
+        self.assertEqual(engine_stats["shape.[1, 3, 224, 224]"], 3)
+
+    def test_flight_records(self):
+        compile_spec = {
+            "input_shapes": [self.input.shape],
+        }
+
+        trt_mod = trtorch.compile(self.module, compile_spec)
+        for _ in range(3):
+            trt_mod(self.input)
+
+        records = list(trtorch.get_flight_records(trt_mod).values())[0]
+        self.assertEqual(records["recorded"], 3)
+        self.assertEqual(len(records["executions"]), 3)
+        execution = records["executions"][-1]
+        self.assertEqual(execution["outcome"], "success")
+        self.assertEqual(execution["inputs"][0]["shape"], [1, 3, 224, 224])
+
+
+class TestShapeProfiles(unittest.TestCase):
+
+    def test_derive_input_ranges(self):
+        recorder = trtorch.ShapeRecorder(torch.nn.Identity())
+        for batch, calls in [(1, 5), (2, 1), (16, 3), (32, 4)]:
+            for _ in range(calls):
+                recorder(torch.zeros(batch, 8))
+        self.assertEqual(recorder.histogram()[((1, 8),)], 5)
+
+        path = "/tmp/trtorch_shape_histogram.txt"
+        recorder.dump(path)
+        profiles = trtorch.derive_input_ranges(path, num_profiles=2)
+        self.assertEqual(len(profiles), 2)
+        self.assertEqual(profiles[0][0], {"min": [1, 8], "opt": [1, 8], "max": [2, 8]})
+        self.assertEqual(profiles[1][0], {"min": [16, 8], "opt": [32, 8], "max": [32, 8]})
+
+
+class SyntheticCalibrationSet(torch.utils.data.Dataset):
+    # Sample i is filled with i, with a mask of ones as the second input
+
+    def __init__(self, size, fail_at=-1):
+        self.size = size
+        self.fail_at = fail_at
+
+    def __len__(self):
+        return self.size
+
+    def __getitem__(self, i):
+        if i == self.fail_at:
+            raise RuntimeError("Failed to load sample")
+        return (torch.full((4,), float(i)), torch.ones(2)), i
+
+
+class TestDataLoaderCalibrator(unittest.TestCase):
+
+    def test_streams_every_pass_in_order(self):
+        dataloader = torch.utils.data.DataLoader(SyntheticCalibrationSet(10), batch_size=2)
+        calibrator = trtorch.ptq.DataLoaderCalibrator(dataloader, prefetch_batches=2)
+        for _ in range(2):
+            batches = 0
+            batch = calibrator.next_batch()
+            while batch is not None:
+                self.assertEqual(len(batch), 2)
+                self.assertEqual(batch[0][:, 0].tolist(), [batches * 2.0, batches * 2.0 + 1])
+                self.assertEqual(batch[1].shape, (2, 2))
+                batches += 1
+                batch = calibrator.next_batch()
+            self.assertEqual(batches, 5)
+        self.assertLessEqual(calibrator.peak_queued(), 2)
+
+    def test_named_inputs_are_ordered(self):
+        dataloader = torch.utils.data.DataLoader(SyntheticCalibrationSet(4), batch_size=4)
+        calibrator = trtorch.ptq.DataLoaderCalibrator(
+            dataloader, input_fn=lambda batch: {
+                "input_1": batch[0][1],
+                "input_0": batch[0][0]
+            })
+        batch = calibrator.next_batch()
+        self.assertEqual(batch[0].shape, (4, 4))
+        self.assertEqual(batch[1].shape, (4, 2))
+
+    def test_loading_errors_are_raised(self):
+        dataloader = torch.utils.data.DataLoader(SyntheticCalibrationSet(10, fail_at=5), batch_size=2)
+        calibrator = trtorch.ptq.DataLoaderCalibrator(dataloader)
+        with self.assertRaises(Exception):
+            while calibrator.next_batch() is not None:
+                pass
+
+
 class TestCheckMethodOpSupport(unittest.TestCase):
 
     def setUp(self):
@@ -67,6 +203,10 @@ def test_suite():
     suite.addTest(TestCompile.parametrize(TestCompile, model=models.resnet18(pretrained=True)))
     suite.addTest(TestCompile.parametrize(TestCompile, model=models.resnet50(pretrained=True)))
     suite.addTest(TestCompile.parametrize(TestCompile, model=models.mobilenet_v2(pretrained=True)))
+    suite.addTest(unittest.makeSuite(TestCompileAsync))
+    suite.addTest(unittest.makeSuite(TestEngineStats))
+    suite.addTest(unittest.makeSuite(TestShapeProfiles))
+    suite.addTest(unittest.makeSuite(TestDataLoaderCalibrator))
     suite.addTest(unittest.makeSuite(TestCheckMethodOpSupport))
     suite.addTest(unittest.makeSuite(TestLoggingAPIs))
 
@@ -0,0 +1,175 @@
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "cpp/trtorchc/manifest.h"
+#include "gtest/gtest.h"
+
+namespace {
+std::string error_of(const std::string& manifest) {
+  try {
+    trtorchc::ParseManifest(manifest, "/models");
+  } catch (const std::runtime_error& e) {
+    return e.what();
+  }
+  return "";
+}
+
+trtorchc::Job job(const std::string& name, const std::string& input) {
+  trtorchc::Job j;
+  j.name = name;
+  j.input_path = input;
+  return j;
+}
+} // namespace
+
+TEST(Trtorchc, ParsesManifest) {
+  auto jobs = trtorchc::ParseManifest(
+      R"({
+        "defaults": {"input_shapes": [[1, 3, 224, 224]], "workspace_size": 1024, "op_precision": "f16"},
+        "jobs": [
+          {"input": "resnet50.ts", "output": "out/resnet50_fp32.ts", "op_precision": "FLOAT32"},
+          {"name": "resnet50 \"dynamic\" é", "input": "resnet50.ts", "output": "/abs/resnet50_dyn.ts",
+           "input_shapes": [{"min": [1, 3, 224, 224], "opt": [8, 3, 224, 224], "max": [32, 3, 224, 224]}, [4]],
+           "freeze_in_place": true, "save_engine": true},
+          {"input": "bert.ts", "output": "bert_int8.ts", "op_precision": "int8",
+           "calibration_cache_file": "bert.cache", "engine_compression_level": 9, "device_type": "DLA"}
+        ]
+      })",
+      "/models");
+  ASSERT_EQ(jobs.size(), 3u);
+
+  EXPECT_EQ(jobs[0].name, "resnet50_fp32.ts");
+  EXPECT_EQ(jobs[0].input_path, "/models/resnet50.ts");
+  EXPECT_EQ(jobs[0].output_path, "/models/out/resnet50_fp32.ts");
+  EXPECT_EQ(jobs[0].op_precision, "float");
+  EXPECT_EQ(jobs[0].workspace_size, 1024);
+  EXPECT_EQ(jobs[0].max_batch_size, -1);
+  ASSERT_EQ(jobs[0].input_shapes.size(), 1u);
+  EXPECT_EQ(jobs[0].input_shapes[0].min, std::vector<int64_t>({1, 3, 224, 224}));
+  EXPECT_EQ(jobs[0].input_shapes[0].max, std::vector<int64_t>({1, 3, 224, 224}));
+  EXPECT_FALSE(jobs[0].save_engine);
+
+  EXPECT_EQ(jobs[1].name, "resnet50 \"dynamic\" \xc3\xa9");
+  EXPECT_EQ(jobs[1].output_path, "/abs/resnet50_dyn.ts");
+  EXPECT_EQ(jobs[1].op_precision, "half");
+  ASSERT_EQ(jobs[1].input_shapes.size(), 2u);
+  EXPECT_EQ(jobs[1].input_shapes[0].opt, std::vector<int64_t>({8, 3, 224, 224}));
+  EXPECT_EQ(jobs[1].input_shapes[0].max, std::vector<int64_t>({32, 3, 224, 224}));
+  EXPECT_EQ(jobs[1].input_shapes[1].opt, std::vector<int64_t>({4}));
+  EXPECT_TRUE(jobs[1].freeze_in_place);
+  EXPECT_TRUE(jobs[1].save_engine);
+
+  EXPECT_EQ(jobs[2].op_precision, "int8");
+  EXPECT_EQ(jobs[2].calibration_cache_file, "/models/bert.cache");
+  EXPECT_EQ(jobs[2].engine_compression_level, 9);
+  EXPECT_EQ(jobs[2].device_type, "dla");
+}
+
+TEST(Trtorchc, RejectsInvalidManifests) {
+  auto syntax = error_of("{\"jobs\": [\n  {\"input\": \"a.ts\",, }\n]}");
+  EXPECT_NE(syntax.find("line 2, column 20"), std::string::npos) << syntax;
+  EXPECT_NE(error_of("{\"jobs\": [] } x").find("after the manifest"), std::string::npos);
+  EXPECT_NE(error_of("[]").find("\"jobs\""), std::string::npos);
+
+  const std::string shapes = "\"input_shapes\": [[1, 3]]";
+  auto typo = error_of("{\"jobs\": [{\"input\": \"a.ts\", \"output\": \"b.ts\", " + shapes + ", \"debgu\": true}]}");
+  EXPECT_NE(typo.find("Job 0, \"debgu\": unknown setting"), std::string::npos) << typo;
+  auto precision = error_of("{\"jobs\": [{\"input\": \"a.ts\", \"output\": \"b.ts\", " + shapes +
+                            ", \"op_precision\": \"fp64\"}]}");
+  EXPECT_NE(precision.find("invalid value \"fp64\""), std::string::npos) << precision;
+  auto int8 = error_of("{\"jobs\": [{\"input\": \"a.ts\", \"output\": \"b.ts\", " + shapes +
+                       ", \"op_precision\": \"int8\"}]}");
+  EXPECT_NE(int8.find("calibration cache"), std::string::npos) << int8;
+  auto range = error_of("{\"jobs\": [{\"input\": \"a.ts\", \"output\": \"b.ts\", "
+                        "\"input_shapes\": [{\"min\": [1, 3], \"max\": [4, 3]}]}]}");
+  EXPECT_NE(range.find("min, opt and max"), std::string::npos) << range;
+  EXPECT_NE(error_of("{\"jobs\": [{\"input\": \"a.ts\", " + shapes + "}]}").find("\"output\""), std::string::npos);
+  EXPECT_NE(error_of("{\"jobs\": [{\"input\": \"a.ts\", \"output\": \"b.ts\", \"input_shapes\": [[1.5]]}]}")
+                .find("expected an integer"),
+            std::string::npos);
+  auto duplicate = error_of("{\"defaults\": {" + shapes + ", \"output\": \"b.ts\"}, "
+                            "\"jobs\": [{\"input\": \"a.ts\"}, {\"input\": \"c.ts\"}]}");
+  EXPECT_NE(duplicate.find("already written by job 0"), std::string::npos) << duplicate;
+}
+
+TEST(Trtorchc, RunsJobsGroupedByModel) {
+  std::vector<trtorchc::Job> jobs = {
+      job("a_fp32", "a.ts"), job("b_fp32", "b.ts"), job("a_fp16", "a.ts"), job("fails", "b.ts"), job("c", "c.ts")};
+
+  std::vector<std::string> started;
+  std::vector<std::string> finished;
+  auto results = trtorchc::RunJobs(
+      jobs,
+      1,
+      [&](const trtorchc::Job& j) {
+        started.push_back(j.name);
+        if (j.name == "fails") {
+          throw std::runtime_error("Conversion failed");
+        }
+      },
+      [&](const trtorchc::JobResult& r) { finished.push_back(r.name); });
+  EXPECT_EQ(started, std::vector<std::string>({"a_fp32", "a_fp16", "b_fp32", "fails", "c"}));
+  EXPECT_EQ(finished, started);
+
+  ASSERT_EQ(results.size(), jobs.size());
+  for (size_t i = 0; i < jobs.size(); i++) {
+    EXPECT_EQ(results[i].name, jobs[i].name);
+    EXPECT_EQ(results[i].ok, jobs[i].name != "fails");
+    EXPECT_GE(results[i].seconds, 0);
+  }
+  EXPECT_EQ(results[3].error, "Conversion failed");
+}
+
+TEST(Trtorchc, LoadsEachModelOnce) {
+  std::vector<trtorchc::Job> jobs;
+  for (int i = 0; i < 12; i++) {
+    jobs.push_back(job("job_" + std::to_string(i), i % 3 == 2 ? "broken.ts" : "model_" + std::to_string(i % 2)));
+  }
+
+  std::atomic<int> live(0);
+  std::atomic<int> running(0);
+  std::atomic<int> peak_running(0);
+  struct Model {
+    Model(std::string path, std::atomic<int>& live) : path(std::move(path)), live(live) {
+      live++;
+    }
+    ~Model() {
+      live--;
+    }
+    std::string path;
+    std::atomic<int>& live;
+  };
+  trtorchc::ModelStore<Model> store(jobs, [&](const std::string& path) {
+    if (path == "broken.ts") {
+      throw std::runtime_error("Unable to load " + path);
+    }
+    // Slow enough for the other workers to ask for the model while it loads
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    return std::make_shared<Model>(path, live);
+  });
+
+  auto results = trtorchc::RunJobs(jobs, 4, [&](const trtorchc::Job& j) {
+    auto now = ++running;
+    for (int peak = peak_running; now > peak && !peak_running.compare_exchange_weak(peak, now);) {
+    }
+    auto model = store.Acquire(j.input_path);
+    running--;
+    ASSERT_EQ(model->path, j.input_path);
+  });
+
+  EXPECT_EQ(store.loads(), 3u);
+  EXPECT_GT(peak_running, 1);
+  // Released once every job of the model had it
+  EXPECT_EQ(live, 0);
+  for (size_t i = 0; i < jobs.size(); i++) {
+    if (jobs[i].input_path == "broken.ts") {
+      EXPECT_FALSE(results[i].ok);
+      EXPECT_EQ(results[i].error, "Unable to load broken.ts");
+    } else {
+      EXPECT_TRUE(results[i].ok) << results[i].error;
+    }
+  }
+}